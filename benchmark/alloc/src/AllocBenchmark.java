@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import com.google.caliper.SimpleBenchmark;
+
+import java.util.ArrayList;
+
+public class AllocBenchmark extends SimpleBenchmark {
+  static final int smallLength = 16;
+  static final int mediumLength = 1024;
+  static final int largeLength = 128 * 1024;
+  static final int stringCount = 1024;
+  static final int listSize = 4096;
+
+  // Keep the last allocation reachable so that it is not optimized away.
+  static Object sink;
+
+  public void timeSmallObjects(int reps) {
+    for (int i = 0; i < reps; i++) {
+      sink = new Object();
+    }
+  }
+
+  public void timeSmallIntArrays(int reps) {
+    for (int i = 0; i < reps; i++) {
+      sink = new int[smallLength];
+    }
+  }
+
+  public void timeMediumByteArrays(int reps) {
+    for (int i = 0; i < reps; i++) {
+      sink = new byte[mediumLength];
+    }
+  }
+
+  // Allocates many small objects in a burst, as when building a String[].
+  public void timeStringArrays(int reps) {
+    for (int i = 0; i < reps; i++) {
+      String[] strings = new String[stringCount];
+      for (int j = 0; j < stringCount; j++) {
+        strings[j] = new String("string");
+      }
+      sink = strings;
+    }
+  }
+
+  // Allocates arrays of increasing sizes, as when an ArrayList grows.
+  public void timeArrayListGrowth(int reps) {
+    for (int i = 0; i < reps; i++) {
+      ArrayList<Object> list = new ArrayList<Object>();
+      for (int j = 0; j < listSize; j++) {
+        list.add(list);
+      }
+      sink = list;
+    }
+  }
+
+  // Interleaves large and small allocations, so that the large arrays often do not fit in
+  // the rest of the TLAB.
+  public void timeLargeIntArrays(int reps) {
+    for (int i = 0; i < reps; i++) {
+      sink = new int[largeLength / 4];
+      sink = new Object();
+    }
+  }
+}
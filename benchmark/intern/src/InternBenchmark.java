@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import com.google.caliper.SimpleBenchmark;
+
+public class InternBenchmark extends SimpleBenchmark {
+  static final int threadCount = 4;
+  static final int stringCount = 256;
+
+  // Field names, as a JSON parser would intern them. Built at runtime so that they are not
+  // string literals, which are already interned.
+  static final String[] names = new String[stringCount];
+  static {
+    for (int i = 0; i < stringCount; i++) {
+      names[i] = new StringBuilder("field").append(i).toString();
+      names[i].intern();
+    }
+  }
+
+  // Keep the last interned string reachable so that the calls are not optimized away.
+  static volatile String sink;
+
+  static void internExisting(int reps) {
+    for (int i = 0; i < reps; i++) {
+      sink = names[i % stringCount].intern();
+    }
+  }
+
+  static void internNew(int reps, int seed) {
+    for (int i = 0; i < reps; i++) {
+      sink = new StringBuilder("new").append(seed).append('_').append(i).toString().intern();
+    }
+  }
+
+  // Interns from threadCount threads, each doing a share of the repetitions.
+  static void runOnThreads(final int reps, final boolean existing) throws InterruptedException {
+    Thread[] threads = new Thread[threadCount];
+    for (int t = 0; t < threadCount; t++) {
+      final int seed = t;
+      threads[t] = new Thread() {
+        public void run() {
+          if (existing) {
+            internExisting(reps / threadCount);
+          } else {
+            internNew(reps / threadCount, seed);
+          }
+        }
+      };
+    }
+    for (Thread thread : threads) {
+      thread.start();
+    }
+    for (Thread thread : threads) {
+      thread.join();
+    }
+  }
+
+  public void timeInternExisting(int reps) {
+    internExisting(reps);
+  }
+
+  public void timeInternNew(int reps) {
+    internNew(reps, -1);
+  }
+
+  public void timeInternExistingContended(int reps) throws InterruptedException {
+    runOnThreads(reps, true);
+  }
+
+  public void timeInternNewContended(int reps) throws InterruptedException {
+    runOnThreads(reps, false);
+  }
+}
@@ -21,6 +21,7 @@ include art/build/Android.common_build.mk
 LIBART_COMPILER_SRC_FILES := \
 	compiled_method.cc \
 	debug/elf_debug_writer.cc \
+	dex/dex_layout.cc \
 	dex/dex_to_dex_compiler.cc \
 	dex/verified_method.cc \
 	dex/verification_results.cc \
@@ -68,6 +69,7 @@ LIBART_COMPILER_SRC_FILES := \
 	optimizing/prepare_for_register_allocation.cc \
 	optimizing/reference_type_propagation.cc \
 	optimizing/register_allocator.cc \
+	optimizing/scheduler.cc \
 	optimizing/select_generator.cc \
 	optimizing/sharpening.cc \
 	optimizing/side_effects_analysis.cc \
@@ -108,6 +110,7 @@ LIBART_COMPILER_SRC_FILES_arm64 := \
 	optimizing/instruction_simplifier_arm64.cc \
 	optimizing/instruction_simplifier_shared.cc \
 	optimizing/intrinsics_arm64.cc \
+	optimizing/scheduler_arm64.cc \
 	utils/arm64/assembler_arm64.cc \
 	utils/arm64/managed_register_arm64.cc \
 
@@ -143,6 +146,7 @@ LIBART_COMPILER_SRC_FILES_x86_64 := \
 	linker/x86_64/relative_patcher_x86_64.cc \
 	optimizing/intrinsics_x86_64.cc \
 	optimizing/code_generator_x86_64.cc \
+	optimizing/scheduler_x86_64.cc \
 	utils/x86_64/assembler_x86_64.cc \
 	utils/x86_64/managed_register_x86_64.cc \
 
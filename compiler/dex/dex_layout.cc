@@ -0,0 +1,371 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dex_layout.h"
+
+#include <string.h>
+#include <zlib.h>
+
+#include "base/bit_utils.h"
+#include "base/logging.h"
+#include "dex_file-inl.h"
+#include "dex_instruction-inl.h"
+#include "jit/offline_profiling_info.h"
+#include "leb128.h"
+#include "safe_map.h"
+
+namespace art {
+
+namespace {
+
+// An item of a data section.
+struct Item {
+  uint32_t offset;
+  uint32_t size;
+};
+
+size_t CodeItemSize(const uint8_t* begin) {
+  const DexFile::CodeItem& code_item = *reinterpret_cast<const DexFile::CodeItem*>(begin);
+  if (code_item.tries_size_ == 0u) {
+    const uint16_t* insns_end = &code_item.insns_[code_item.insns_size_in_code_units_];
+    return reinterpret_cast<const uint8_t*>(insns_end) - begin;
+  }
+  // The encoded catch handler list ends the code item.
+  const uint8_t* ptr = DexFile::GetCatchHandlerData(code_item, 0u);
+  uint32_t handlers_size = DecodeUnsignedLeb128(&ptr);
+  for (uint32_t i = 0; i != handlers_size; ++i) {
+    int32_t size = DecodeSignedLeb128(&ptr);
+    for (int32_t j = 0, count = std::abs(size); j != count; ++j) {
+      DecodeUnsignedLeb128(&ptr);  // Type index.
+      DecodeUnsignedLeb128(&ptr);  // Handler address.
+    }
+    if (size <= 0) {
+      DecodeUnsignedLeb128(&ptr);  // Catch-all handler address.
+    }
+  }
+  return ptr - begin;
+}
+
+size_t StringDataSize(const uint8_t* begin) {
+  const uint8_t* ptr = begin;
+  DecodeUnsignedLeb128(&ptr);  // UTF-16 length.
+  return (ptr - begin) + strlen(reinterpret_cast<const char*>(ptr)) + 1u;
+}
+
+size_t ClassDataSize(const DexFile& dex_file, const uint8_t* begin) {
+  ClassDataItemIterator it(dex_file, begin);
+  while (it.HasNext()) {
+    it.Next();
+  }
+  return it.EndDataPointer() - begin;
+}
+
+template <typename SizeFunction>
+std::vector<Item> GetSectionItems(const uint8_t* data,
+                                  const DexFile::MapItem* section,
+                                  size_t alignment,
+                                  SizeFunction size_function) {
+  std::vector<Item> items;
+  if (section != nullptr) {
+    items.reserve(section->size_);
+    uint32_t offset = section->offset_;
+    for (uint32_t i = 0; i != section->size_; ++i) {
+      offset = RoundUp(offset, alignment);
+      uint32_t size = dchecked_integral_cast<uint32_t>(size_function(data + offset));
+      items.push_back(Item { offset, size });
+      offset += size;
+    }
+  }
+  return items;
+}
+
+// Copy the `items` of a section from `input` to `output`, the items at `hot_offsets` first, and
+// record their new offsets. Returns false and leaves `output` unchanged if they do not fit in
+// the space of the section.
+bool LayoutSection(const std::vector<Item>& items,
+                   const std::vector<uint32_t>& hot_offsets,
+                   size_t alignment,
+                   const uint8_t* input,
+                   uint8_t* output,
+                   SafeMap<uint32_t, uint32_t>* new_offsets) {
+  if (items.empty()) {
+    return true;
+  }
+  SafeMap<uint32_t, size_t> item_indexes;
+  for (size_t i = 0; i != items.size(); ++i) {
+    item_indexes.Put(items[i].offset, i);
+  }
+  std::vector<size_t> order;
+  order.reserve(items.size());
+  std::vector<bool> placed(items.size(), false);
+  for (uint32_t offset : hot_offsets) {
+    auto it = item_indexes.find(offset);
+    if (it != item_indexes.end() && !placed[it->second]) {
+      placed[it->second] = true;
+      order.push_back(it->second);
+    }
+  }
+  for (size_t i = 0; i != items.size(); ++i) {
+    if (!placed[i]) {
+      order.push_back(i);
+    }
+  }
+
+  const uint32_t section_begin = items.front().offset;
+  const uint32_t section_end = items.back().offset + items.back().size;
+  std::vector<uint32_t> offsets(items.size());
+  uint32_t offset = section_begin;
+  for (size_t i : order) {
+    offset = RoundUp(offset, alignment);
+    offsets[i] = offset;
+    offset += items[i].size;
+  }
+  if (offset > section_end) {
+    // Only possible when the last item is hot and does not end aligned.
+    return false;
+  }
+  memset(output + section_begin, 0, section_end - section_begin);
+  for (size_t i = 0; i != items.size(); ++i) {
+    memcpy(output + offsets[i], input + items[i].offset, items[i].size);
+    new_offsets->Put(items[i].offset, offsets[i]);
+  }
+  return true;
+}
+
+uint32_t GetNewOffset(const SafeMap<uint32_t, uint32_t>& new_offsets, uint32_t offset) {
+  auto it = new_offsets.find(offset);
+  return (it != new_offsets.end()) ? it->second : offset;
+}
+
+// Overwrite the `length` bytes of an encoded Leb128 with `value`, using a longer encoding than
+// necessary if needed. Returns false if the value needs more than `length` bytes.
+bool ReplaceUnsignedLeb128(uint8_t* dest, size_t length, uint32_t value) {
+  if (UnsignedLeb128Size(value) > length) {
+    return false;
+  }
+  for (uint8_t* end = EncodeUnsignedLeb128(dest, value); end < dest + length; end++) {
+    end[-1] |= 0x80;
+    end[0] = 0;
+  }
+  return true;
+}
+
+// Update the code item offsets in the class data item at `class_data`.
+bool UpdateCodeItemOffsets(uint8_t* class_data, const SafeMap<uint32_t, uint32_t>& new_offsets) {
+  const uint8_t* ptr = class_data;
+  uint32_t static_fields_size = DecodeUnsignedLeb128(&ptr);
+  uint32_t instance_fields_size = DecodeUnsignedLeb128(&ptr);
+  uint32_t direct_methods_size = DecodeUnsignedLeb128(&ptr);
+  uint32_t virtual_methods_size = DecodeUnsignedLeb128(&ptr);
+  for (uint32_t i = 0; i != static_fields_size + instance_fields_size; ++i) {
+    DecodeUnsignedLeb128(&ptr);  // Field index delta.
+    DecodeUnsignedLeb128(&ptr);  // Access flags.
+  }
+  for (uint32_t i = 0; i != direct_methods_size + virtual_methods_size; ++i) {
+    DecodeUnsignedLeb128(&ptr);  // Method index delta.
+    DecodeUnsignedLeb128(&ptr);  // Access flags.
+    uint8_t* code_off_begin = class_data + (ptr - class_data);
+    uint32_t code_off = DecodeUnsignedLeb128(&ptr);
+    if (code_off != 0u &&
+        !ReplaceUnsignedLeb128(code_off_begin,
+                               ptr - code_off_begin,
+                               GetNewOffset(new_offsets, code_off))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const DexFile::MapItem* FindSection(const DexFile::MapList* map_list, uint16_t type) {
+  for (uint32_t i = 0; i != map_list->size_; ++i) {
+    if (map_list->list_[i].type_ == type) {
+      return &map_list->list_[i];
+    }
+  }
+  return nullptr;
+}
+
+// Returns the classes of the profile methods in the order of their first method, then the other
+// profile classes.
+std::vector<uint16_t> GetProfileClassDefs(const DexFile& dex_file,
+                                          const ProfileCompilationInfo& info) {
+  const size_t num_class_defs = dex_file.NumClassDefs();
+  std::vector<uint16_t> order;
+  std::vector<bool> added(num_class_defs, false);
+  auto add = [&](uint16_t class_def_idx) {
+    if (class_def_idx < num_class_defs && !added[class_def_idx]) {
+      added[class_def_idx] = true;
+      order.push_back(class_def_idx);
+    }
+  };
+  for (uint16_t method_idx : info.GetMethodsInOrder(dex_file)) {
+    if (method_idx < dex_file.NumMethodIds()) {
+      const DexFile::ClassDef* class_def =
+          dex_file.FindClassDef(dex_file.GetMethodId(method_idx).class_idx_);
+      if (class_def != nullptr) {
+        add(dex_file.GetIndexForClassDef(*class_def));
+      }
+    }
+  }
+  for (uint16_t class_def_idx : info.GetClassesInOrder(dex_file)) {
+    add(class_def_idx);
+  }
+  return order;
+}
+
+}  // namespace
+
+std::vector<uint16_t> DexLayout::GetClassDefOrder(const DexFile& dex_file,
+                                                  const ProfileCompilationInfo& info) {
+  const size_t num_class_defs = dex_file.NumClassDefs();
+  std::vector<uint16_t> order = GetProfileClassDefs(dex_file, info);
+  order.reserve(num_class_defs);
+  std::vector<bool> added(num_class_defs, false);
+  for (uint16_t class_def_idx : order) {
+    added[class_def_idx] = true;
+  }
+  for (size_t i = 0; i != num_class_defs; ++i) {
+    if (!added[i]) {
+      order.push_back(dchecked_integral_cast<uint16_t>(i));
+    }
+  }
+  return order;
+}
+
+std::vector<uint32_t> DexLayout::GetCodeItemOffsets(const DexFile& dex_file) {
+  std::vector<uint32_t> code_item_offsets(dex_file.NumMethodIds(), 0u);
+  for (size_t i = 0; i != dex_file.NumClassDefs(); ++i) {
+    const uint8_t* class_data = dex_file.GetClassData(dex_file.GetClassDef(i));
+    if (class_data == nullptr) {
+      continue;
+    }
+    ClassDataItemIterator it(dex_file, class_data);
+    while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+      it.Next();
+    }
+    for (; it.HasNextDirectMethod() || it.HasNextVirtualMethod(); it.Next()) {
+      code_item_offsets[it.GetMemberIndex()] = it.GetMethodCodeItemOffset();
+    }
+  }
+  return code_item_offsets;
+}
+
+std::vector<uint32_t> DexLayout::GetConstStringIndexes(const DexFile& dex_file,
+                                                       const DexFile::CodeItem& code_item) {
+  std::vector<uint32_t> string_indexes;
+  const uint16_t* code_ptr = code_item.insns_;
+  const uint16_t* code_end = code_item.insns_ + code_item.insns_size_in_code_units_;
+  for (; code_ptr < code_end; code_ptr += Instruction::At(code_ptr)->SizeInCodeUnits()) {
+    const Instruction* inst = Instruction::At(code_ptr);
+    uint32_t string_idx;
+    if (inst->Opcode() == Instruction::CONST_STRING) {
+      string_idx = inst->VRegB_21c();
+    } else if (inst->Opcode() == Instruction::CONST_STRING_JUMBO) {
+      string_idx = inst->VRegB_31c();
+    } else {
+      continue;
+    }
+    if (string_idx < dex_file.NumStringIds()) {
+      string_indexes.push_back(string_idx);
+    }
+  }
+  return string_indexes;
+}
+
+bool DexLayout::Layout(const DexFile& dex_file, const ProfileCompilationInfo& info, uint8_t* data) {
+  DCHECK_EQ(data, dex_file.Begin());
+  std::vector<uint16_t> hot_methods = info.GetMethodsInOrder(dex_file);
+  if (hot_methods.empty()) {
+    return false;
+  }
+  const DexFile::Header& header = dex_file.GetHeader();
+  const DexFile::MapList* map_list =
+      reinterpret_cast<const DexFile::MapList*>(data + header.map_off_);
+
+  std::vector<uint32_t> code_item_offsets = GetCodeItemOffsets(dex_file);
+
+  // The hot items of each section, in first use order.
+  std::vector<uint32_t> hot_code_items;
+  std::vector<uint32_t> hot_strings;
+  for (uint16_t method_idx : hot_methods) {
+    if (method_idx >= code_item_offsets.size() || code_item_offsets[method_idx] == 0u) {
+      continue;
+    }
+    hot_code_items.push_back(code_item_offsets[method_idx]);
+    const DexFile::CodeItem* code_item = dex_file.GetCodeItem(code_item_offsets[method_idx]);
+    for (uint32_t string_idx : GetConstStringIndexes(dex_file, *code_item)) {
+      hot_strings.push_back(dex_file.GetStringId(string_idx).string_data_off_);
+    }
+  }
+  std::vector<uint32_t> hot_class_data;
+  for (uint16_t class_def_idx : GetProfileClassDefs(dex_file, info)) {
+    uint32_t class_data_off = dex_file.GetClassDef(class_def_idx).class_data_off_;
+    if (class_data_off != 0u) {
+      hot_class_data.push_back(class_data_off);
+    }
+  }
+
+  std::vector<Item> code_items = GetSectionItems(
+      data, FindSection(map_list, DexFile::kDexTypeCodeItem), 4u, CodeItemSize);
+  std::vector<Item> string_data = GetSectionItems(
+      data, FindSection(map_list, DexFile::kDexTypeStringDataItem), 1u, StringDataSize);
+  std::vector<Item> class_data = GetSectionItems(
+      data,
+      FindSection(map_list, DexFile::kDexTypeClassDataItem),
+      1u,
+      [&dex_file](const uint8_t* begin) { return ClassDataSize(dex_file, begin); });
+
+  // Sections that do not fit keep their original layout.
+  std::vector<uint8_t> output(data, data + header.file_size_);
+  SafeMap<uint32_t, uint32_t> new_code_item_offsets;
+  SafeMap<uint32_t, uint32_t> new_string_data_offsets;
+  SafeMap<uint32_t, uint32_t> new_class_data_offsets;
+  LayoutSection(code_items, hot_code_items, 4u, data, output.data(), &new_code_item_offsets);
+  LayoutSection(string_data, hot_strings, 1u, data, output.data(), &new_string_data_offsets);
+  LayoutSection(class_data, hot_class_data, 1u, data, output.data(), &new_class_data_offsets);
+
+  // Update the references to the moved items.
+  DexFile::StringId* string_ids =
+      reinterpret_cast<DexFile::StringId*>(output.data() + header.string_ids_off_);
+  for (size_t i = 0; i != header.string_ids_size_; ++i) {
+    string_ids[i].string_data_off_ =
+        GetNewOffset(new_string_data_offsets, string_ids[i].string_data_off_);
+  }
+  DexFile::ClassDef* class_defs =
+      reinterpret_cast<DexFile::ClassDef*>(output.data() + header.class_defs_off_);
+  for (size_t i = 0; i != header.class_defs_size_; ++i) {
+    class_defs[i].class_data_off_ =
+        GetNewOffset(new_class_data_offsets, class_defs[i].class_data_off_);
+  }
+  for (const Item& item : class_data) {
+    uint8_t* new_class_data = output.data() + GetNewOffset(new_class_data_offsets, item.offset);
+    if (!UpdateCodeItemOffsets(new_class_data, new_code_item_offsets)) {
+      VLOG(compiler) << "Code item offsets do not fit the class data of " << dex_file.GetLocation();
+      return false;
+    }
+  }
+
+  DexFile::Header* output_header = reinterpret_cast<DexFile::Header*>(output.data());
+  const size_t non_sum = sizeof(output_header->magic_) + sizeof(output_header->checksum_);
+  output_header->checksum_ =
+      adler32(adler32(0L, Z_NULL, 0), output.data() + non_sum, output.size() - non_sum);
+  memcpy(data, output.data(), output.size());
+  VLOG(compiler) << "Laid out " << dex_file.GetLocation() << " with " << hot_code_items.size()
+                 << " hot code items and " << hot_strings.size() << " hot strings";
+  return true;
+}
+
+}  // namespace art
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_DEX_DEX_LAYOUT_H_
+#define ART_COMPILER_DEX_DEX_LAYOUT_H_
+
+#include <stdint.h>
+#include <vector>
+
+#include "base/macros.h"
+#include "dex_file.h"
+
+namespace art {
+
+class ProfileCompilationInfo;
+
+// Profile guided layout of the data section of a dex file.
+//
+// The code items of the profile methods, the string data of the strings they load and the class
+// data of their classes are moved to the start of their sections, in profile order. The other
+// items follow in their original order, so the cold code ends up at the end of the code items.
+// Items only move within their section: the sections keep their offset and size, the map list
+// stays valid and all indexes are unchanged.
+class DexLayout {
+ public:
+  // Returns the class def indexes of `dex_file` in layout order: the classes of the profile
+  // methods in the order of their first method, the other profile classes, then the rest.
+  static std::vector<uint16_t> GetClassDefOrder(const DexFile& dex_file,
+                                                const ProfileCompilationInfo& info);
+
+  // Returns the code item offset of each method id of `dex_file`, 0 for the methods that it does
+  // not define or that have no code.
+  static std::vector<uint32_t> GetCodeItemOffsets(const DexFile& dex_file);
+
+  // Returns the string indexes that the const-string instructions of `code_item` load, in code
+  // order. Indexes past the string ids of `dex_file` are left out.
+  static std::vector<uint32_t> GetConstStringIndexes(const DexFile& dex_file,
+                                                     const DexFile::CodeItem& code_item);
+
+  // Lay out the dex file `data` that `dex_file` was opened from and update its checksum. The
+  // contents of `dex_file` are stale afterwards and it must be opened again. Returns false and
+  // leaves `data` unchanged if the profile has no methods of `dex_file` or if the new layout does
+  // not fit, e.g. because the offset of a moved code item needs a longer encoding.
+  static bool Layout(const DexFile& dex_file, const ProfileCompilationInfo& info, uint8_t* data);
+
+ private:
+  DISALLOW_IMPLICIT_CONSTRUCTORS(DexLayout);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_DEX_DEX_LAYOUT_H_
@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "dex_layout.h"
+
+#include <string.h>
+#include <limits>
+#include <map>
+
+#include "common_runtime_test.h"
+#include "dex_file-inl.h"
+#include "jit/offline_profiling_info.h"
+#include "method_reference.h"
+
+namespace art {
+
+class DexLayoutTest : public CommonRuntimeTest {
+ protected:
+  // Returns the code item offsets of the methods of `descriptor`, by method name.
+  static std::map<std::string, uint32_t> GetCodeItemOffsets(const DexFile& dex_file,
+                                                            const char* descriptor) {
+    std::map<std::string, uint32_t> offsets;
+    const DexFile::TypeId* type_id = dex_file.FindTypeId(descriptor);
+    CHECK(type_id != nullptr);
+    const DexFile::ClassDef* class_def =
+        dex_file.FindClassDef(dex_file.GetIndexForTypeId(*type_id));
+    CHECK(class_def != nullptr);
+    ClassDataItemIterator it(dex_file, dex_file.GetClassData(*class_def));
+    while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+      it.Next();
+    }
+    for (; it.HasNextDirectMethod() || it.HasNextVirtualMethod(); it.Next()) {
+      const char* name = dex_file.GetMethodName(dex_file.GetMethodId(it.GetMemberIndex()));
+      offsets.emplace(name, it.GetMethodCodeItemOffset());
+    }
+    return offsets;
+  }
+
+  static uint32_t GetStringDataOffset(const DexFile& dex_file, const char* string) {
+    const DexFile::StringId* string_id = dex_file.FindStringId(string);
+    CHECK(string_id != nullptr);
+    return string_id->string_data_off_;
+  }
+};
+
+TEST_F(DexLayoutTest, HotItemsFirst) {
+  std::unique_ptr<const DexFile> main_dex_file;
+  for (std::unique_ptr<const DexFile>& dex_file : OpenTestDexFiles("ProfileTestMultiDex")) {
+    if (dex_file->FindTypeId("LMain;") != nullptr) {
+      main_dex_file = std::move(dex_file);
+    }
+  }
+  ASSERT_TRUE(main_dex_file != nullptr);
+  std::vector<uint8_t> data(main_dex_file->Begin(),
+                            main_dex_file->Begin() + main_dex_file->Size());
+  std::string error_msg;
+  std::unique_ptr<const DexFile> dex_file = DexFile::Open(data.data(),
+                                                          data.size(),
+                                                          main_dex_file->GetLocation(),
+                                                          main_dex_file->GetLocationChecksum(),
+                                                          /* oat_dex_file */ nullptr,
+                                                          /* verify */ false,
+                                                          &error_msg);
+  ASSERT_TRUE(dex_file != nullptr) << error_msg;
+
+  // Nothing to do without profile methods.
+  ProfileCompilationInfo info;
+  EXPECT_FALSE(DexLayout::Layout(*dex_file, info, data.data()));
+  EXPECT_EQ(0, memcmp(data.data(), main_dex_file->Begin(), data.size()));
+
+  const DexFile::TypeId* main_type_id = dex_file->FindTypeId("LMain;");
+  std::map<std::string, uint32_t> method_indexes;
+  for (size_t i = 0; i != dex_file->NumMethodIds(); ++i) {
+    const DexFile::MethodId& method_id = dex_file->GetMethodId(i);
+    if (&dex_file->GetTypeId(method_id.class_idx_) == main_type_id) {
+      method_indexes.emplace(dex_file->GetMethodName(method_id), i);
+    }
+  }
+  ASSERT_EQ(1u, method_indexes.count("getC"));
+  ASSERT_TRUE(info.AddMethod(MethodReference(dex_file.get(), method_indexes["getC"])));
+  ASSERT_TRUE(info.AddMethod(MethodReference(dex_file.get(), method_indexes["getA"])));
+
+  std::map<std::string, uint32_t> old_code_items = GetCodeItemOffsets(*dex_file, "LMain;");
+  ASSERT_TRUE(DexLayout::Layout(*dex_file, info, data.data()));
+  dex_file.reset();
+  std::unique_ptr<const DexFile> laid_out = DexFile::Open(data.data(),
+                                                          data.size(),
+                                                          main_dex_file->GetLocation(),
+                                                          main_dex_file->GetLocationChecksum(),
+                                                          /* oat_dex_file */ nullptr,
+                                                          /* verify */ true,
+                                                          &error_msg);
+  ASSERT_TRUE(laid_out != nullptr) << error_msg;
+
+  // The profile methods come first in the code items, in profile order.
+  std::map<std::string, uint32_t> new_code_items = GetCodeItemOffsets(*laid_out, "LMain;");
+  uint32_t first_code_item = std::numeric_limits<uint32_t>::max();
+  for (const auto& entry : old_code_items) {
+    first_code_item = std::min(first_code_item, entry.second);
+  }
+  EXPECT_EQ(first_code_item, new_code_items["getC"]);
+  EXPECT_LT(new_code_items["getC"], new_code_items["getA"]);
+  EXPECT_LT(new_code_items["getA"], new_code_items["getB"]);
+
+  // So do the strings they load.
+  EXPECT_LT(GetStringDataOffset(*laid_out, "C"), GetStringDataOffset(*laid_out, "A"));
+  EXPECT_LT(GetStringDataOffset(*laid_out, "A"), GetStringDataOffset(*laid_out, "B"));
+  EXPECT_LT(GetStringDataOffset(*laid_out, "A"), GetStringDataOffset(*laid_out, "LMain;"));
+
+  // The contents are unchanged.
+  ASSERT_EQ(main_dex_file->NumStringIds(), laid_out->NumStringIds());
+  for (size_t i = 0; i != laid_out->NumStringIds(); ++i) {
+    EXPECT_STREQ(main_dex_file->StringDataByIdx(i), laid_out->StringDataByIdx(i));
+  }
+  for (const auto& entry : old_code_items) {
+    const DexFile::CodeItem* old_code_item = main_dex_file->GetCodeItem(entry.second);
+    const DexFile::CodeItem* new_code_item = laid_out->GetCodeItem(new_code_items[entry.first]);
+    ASSERT_EQ(old_code_item->insns_size_in_code_units_, new_code_item->insns_size_in_code_units_);
+    EXPECT_EQ(0, memcmp(old_code_item->insns_,
+                        new_code_item->insns_,
+                        old_code_item->insns_size_in_code_units_ * sizeof(uint16_t)))
+        << entry.first;
+  }
+}
+
+}  // namespace art
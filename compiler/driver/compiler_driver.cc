@@ -16,6 +16,7 @@
 
 #include "compiler_driver.h"
 
+#include <algorithm>
 #include <unordered_set>
 #include <vector>
 #include <unistd.h>
@@ -73,6 +74,7 @@
 #include "utils/swap_space.h"
 #include "verifier/method_verifier.h"
 #include "verifier/method_verifier-inl.h"
+#include "verifier/verifier_deps.h"
 
 namespace art {
 
@@ -986,6 +988,11 @@ bool CompilerDriver::ShouldCompileBasedOnProfile(const MethodReference& method_r
   return result;
 }
 
+bool CompilerDriver::IsMethodInProfile(const MethodReference& method_ref) const {
+  return profile_compilation_info_ != nullptr &&
+      profile_compilation_info_->ContainsMethod(method_ref);
+}
+
 bool CompilerDriver::ShouldVerifyClassBasedOnProfile(const DexFile& dex_file,
                                                      uint16_t class_idx) const {
   if (!compiler_options_->VerifyOnlyProfile()) {
@@ -1897,13 +1904,30 @@ class ParallelCompilationManager {
 
   void ForAll(size_t begin, size_t end, CompilationVisitor* visitor, size_t work_units)
       REQUIRES(!*Locks::mutator_lock_) {
+    ForAll(begin, end, /* order */ nullptr, visitor, work_units);
+  }
+
+  // Visit all the class definitions of the dex file in CompilerDriver::GetClassDefVisitOrder().
+  // Threads take the next class as soon as they are done with one.
+  void ForAllClassDefsByDecreasingCost(CompilationVisitor* visitor, size_t work_units)
+      REQUIRES(!*Locks::mutator_lock_) {
+    std::vector<uint32_t> order = CompilerDriver::GetClassDefVisitOrder(*GetDexFile(), work_units);
+    ForAll(0, order.size(), &order, visitor, work_units);
+  }
+
+  void ForAll(size_t begin,
+              size_t end,
+              const std::vector<uint32_t>* order,
+              CompilationVisitor* visitor,
+              size_t work_units)
+      REQUIRES(!*Locks::mutator_lock_) {
     Thread* self = Thread::Current();
     self->AssertNoPendingException();
     CHECK_GT(work_units, 0U);
 
     index_.StoreRelaxed(begin);
     for (size_t i = 0; i < work_units; ++i) {
-      thread_pool_->AddTask(self, new ForAllClosure(this, end, visitor));
+      thread_pool_->AddTask(self, new ForAllClosure(this, end, order, visitor));
     }
     thread_pool_->StartWorkers(self);
 
@@ -1925,9 +1949,13 @@ class ParallelCompilationManager {
  private:
   class ForAllClosure : public Task {
    public:
-    ForAllClosure(ParallelCompilationManager* manager, size_t end, CompilationVisitor* visitor)
+    ForAllClosure(ParallelCompilationManager* manager,
+                  size_t end,
+                  const std::vector<uint32_t>* order,
+                  CompilationVisitor* visitor)
         : manager_(manager),
           end_(end),
+          order_(order),
           visitor_(visitor) {}
 
     virtual void Run(Thread* self) {
@@ -1936,7 +1964,7 @@ class ParallelCompilationManager {
         if (UNLIKELY(index >= end_)) {
           break;
         }
-        visitor_->Visit(index);
+        visitor_->Visit(order_ == nullptr ? index : (*order_)[index]);
         self->AssertNoPendingException();
       }
     }
@@ -1948,6 +1976,8 @@ class ParallelCompilationManager {
    private:
     ParallelCompilationManager* const manager_;
     const size_t end_;
+    // The indices to visit, in order, or null to visit the indices from `begin` to `end_`.
+    const std::vector<uint32_t>* const order_;
     CompilationVisitor* const visitor_;
   };
 
@@ -1962,6 +1992,46 @@ class ParallelCompilationManager {
   DISALLOW_COPY_AND_ASSIGN(ParallelCompilationManager);
 };
 
+size_t CompilerDriver::EstimateClassDefCost(const DexFile& dex_file,
+                                            const DexFile::ClassDef& class_def) {
+  // The cost of compiling or verifying a class grows with the size of its code. Count one
+  // unit per method as well, so that classes with many small methods are not underestimated.
+  const uint8_t* class_data = dex_file.GetClassData(class_def);
+  if (class_data == nullptr) {
+    return 0u;
+  }
+  ClassDataItemIterator it(dex_file, class_data);
+  while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+    it.Next();
+  }
+  size_t cost = 0u;
+  for (; it.HasNextDirectMethod() || it.HasNextVirtualMethod(); it.Next()) {
+    const DexFile::CodeItem* code_item = it.GetMethodCodeItem();
+    cost += 1u + ((code_item != nullptr) ? code_item->insns_size_in_code_units_ : 0u);
+  }
+  return cost;
+}
+
+std::vector<uint32_t> CompilerDriver::GetClassDefVisitOrder(const DexFile& dex_file,
+                                                            size_t thread_count) {
+  std::vector<uint32_t> order(dex_file.NumClassDefs());
+  for (uint32_t i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  if (thread_count == 1) {
+    // A single thread gains nothing from the reordering; keep the class definition order.
+    return order;
+  }
+  std::vector<size_t> costs(dex_file.NumClassDefs());
+  for (uint32_t i = 0; i < costs.size(); ++i) {
+    costs[i] = EstimateClassDefCost(dex_file, dex_file.GetClassDef(i));
+  }
+  std::stable_sort(order.begin(), order.end(), [&costs](uint32_t lhs, uint32_t rhs) {
+    return costs[lhs] > costs[rhs];
+  });
+  return order;
+}
+
 // A fast version of SkipClass above if the class pointer is available
 // that avoids the expensive FindInClassPath search.
 static bool SkipClass(jobject class_loader, const DexFile& dex_file, mirror::Class* klass)
@@ -2222,6 +2292,9 @@ void CompilerDriver::Verify(jobject class_loader,
   // Note: verification should not be pulling in classes anymore when compiling the boot image,
   //       as all should have been resolved before. As such, doing this in parallel should still
   //       be deterministic.
+  if (!IsBootImage() && dex_files_for_oat_file_ != nullptr && verifier_deps_ == nullptr) {
+    verifier_deps_.reset(new verifier::VerifierDepsTable(*dex_files_for_oat_file_));
+  }
   for (const DexFile* dex_file : dex_files) {
     CHECK(dex_file != nullptr);
     VerifyDexFile(class_loader,
@@ -2295,6 +2368,10 @@ class VerifyClassVisitor : public CompilationVisitor {
       CHECK(klass->IsCompileTimeVerified() || klass->IsErroneous())
           << PrettyDescriptor(klass.Get()) << ": state=" << klass->GetStatus();
 
+      if (klass->GetStatus() == mirror::Class::kStatusRetryVerificationAtRuntime) {
+        manager_->GetCompiler()->RecordVerifierDeps(soa.Self(), klass);
+      }
+
       // It is *very* problematic if there are verification errors in the boot classpath. For example,
       // we rely on things working OK without verification when the decryption dialog is brought up.
       // So abort in a debug build if we find this violated.
@@ -2309,6 +2386,27 @@ class VerifyClassVisitor : public CompilationVisitor {
   const LogSeverity log_level_;
 };
 
+void CompilerDriver::RecordVerifierDeps(Thread* self, Handle<mirror::Class> klass) {
+  if (verifier_deps_ == nullptr) {
+    return;
+  }
+  verifier::VerifierDeps deps(verifier_deps_->GetDexFiles());
+  std::string error_msg;
+  verifier::MethodVerifier::FailureKind failure =
+      verifier::MethodVerifier::VerifyClass(self,
+                                            klass.Get(),
+                                            nullptr /* callbacks */,
+                                            false /* allow soft failures, as the runtime */,
+                                            LogSeverity::NONE,
+                                            &error_msg,
+                                            &deps);
+  // Hard failures are left to the runtime, which reports them.
+  if (failure != verifier::MethodVerifier::kHardFailure && deps.IsUsable()) {
+    deps.SetSoftFailure(failure == verifier::MethodVerifier::kSoftFailure);
+    verifier_deps_->AddClass(klass->GetDexFile(), klass->GetDexClassDefIndex(), deps);
+  }
+}
+
 void CompilerDriver::VerifyDexFile(jobject class_loader,
                                    const DexFile& dex_file,
                                    const std::vector<const DexFile*>& dex_files,
@@ -2323,7 +2421,7 @@ void CompilerDriver::VerifyDexFile(jobject class_loader,
                               ? LogSeverity::INTERNAL_FATAL
                               : LogSeverity::WARNING;
   VerifyClassVisitor visitor(&context, log_level);
-  context.ForAll(0, dex_file.NumClassDefs(), &visitor, thread_count);
+  context.ForAllClassDefsByDecreasingCost(&visitor, thread_count);
 }
 
 class SetVerifiedClassVisitor : public CompilationVisitor {
@@ -2732,7 +2830,7 @@ void CompilerDriver::CompileDexFile(jobject class_loader,
   ParallelCompilationManager context(Runtime::Current()->GetClassLinker(), class_loader, this,
                                      &dex_file, dex_files, thread_pool);
   CompileClassVisitor visitor(&context);
-  context.ForAll(0, dex_file.NumClassDefs(), &visitor, thread_count);
+  context.ForAllClassDefsByDecreasingCost(&visitor, thread_count);
 }
 
 void CompilerDriver::AddCompiledMethod(const MethodReference& method_ref,
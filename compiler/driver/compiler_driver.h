@@ -50,6 +50,7 @@ class DexCache;
 
 namespace verifier {
 class MethodVerifier;
+class VerifierDepsTable;
 }  // namespace verifier
 
 class BitVector;
@@ -123,6 +124,14 @@ class CompilerDriver {
                   TimingLogger* timings)
       REQUIRES(!Locks::mutator_lock_, !compiled_classes_lock_, !dex_to_dex_references_lock_);
 
+  // Get the order in which `thread_count` threads verify and compile the class definitions of
+  // `dex_file`. With several threads, the classes with the highest EstimateClassDefCost() come
+  // first so that a large class is not picked last and left to run alone at the end.
+  static std::vector<uint32_t> GetClassDefVisitOrder(const DexFile& dex_file, size_t thread_count);
+
+  // Estimate the cost of verifying and compiling a class definition from the size of its code.
+  static size_t EstimateClassDefCost(const DexFile& dex_file, const DexFile::ClassDef& class_def);
+
   // Compile a single Method.
   void CompileOne(Thread* self, ArtMethod* method, TimingLogger* timings)
       SHARED_REQUIRES(Locks::mutator_lock_)
@@ -434,10 +443,19 @@ class CompilerDriver {
   // according to the profile file.
   bool ShouldCompileBasedOnProfile(const MethodReference& method_ref) const;
 
+  // Checks whether a profile is used and contains the method, that is whether the
+  // method is known to be hot.
+  bool IsMethodInProfile(const MethodReference& method_ref) const;
+
   // Checks whether profile guided verification is enabled and if the method should be verified
   // according to the profile file.
   bool ShouldVerifyClassBasedOnProfile(const DexFile& dex_file, uint16_t class_idx) const;
 
+  // Returns the profile used for profile guided compilation, null if there is none.
+  const ProfileCompilationInfo* GetProfileCompilationInfo() const {
+    return profile_compilation_info_;
+  }
+
   void RecordClassStatus(ClassReference ref, mirror::Class::Status status)
       REQUIRES(!compiled_classes_lock_);
 
@@ -457,6 +475,16 @@ class CompilerDriver {
     had_hard_verifier_failure_ = true;
   }
 
+  // Verify `klass` as the runtime would and record the dependencies of the result, so that the
+  // runtime can check them instead of verifying the class again.
+  void RecordVerifierDeps(Thread* self, Handle<mirror::Class> klass)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // The verifier dependencies to store in the oat file, null if none are recorded.
+  const verifier::VerifierDepsTable* GetVerifierDeps() const {
+    return verifier_deps_.get();
+  }
+
   Compiler::Kind GetCompilerKind() {
     return compiler_kind_;
   }
@@ -679,6 +707,9 @@ class CompilerDriver {
 
   bool had_hard_verifier_failure_;
 
+  // Verifier dependencies of the classes to verify at runtime.
+  std::unique_ptr<verifier::VerifierDepsTable> verifier_deps_;
+
   // A thread pool that can (potentially) run tasks in parallel.
   std::unique_ptr<ThreadPool> parallel_thread_pool_;
   size_t parallel_thread_count_;
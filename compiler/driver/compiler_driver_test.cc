@@ -108,7 +108,8 @@ TEST_F(CompilerDriverTest, DISABLED_LARGE_CompileDexLibCore) {
   const DexFile& dex = *java_lang_dex_file_;
   mirror::DexCache* dex_cache = class_linker_->FindDexCache(soa.Self(), dex);
   EXPECT_EQ(dex.NumStringIds(), dex_cache->NumStrings());
-  for (size_t i = 0; i < dex_cache->NumStrings(); i++) {
+  // Strings may have been evicted from a hash-indexed strings array.
+  for (size_t i = 0; !dex_cache->HasHashedStrings() && i < dex_cache->NumStrings(); i++) {
     const mirror::String* string = dex_cache->GetResolvedString(i);
     EXPECT_TRUE(string != nullptr) << "string_idx=" << i;
   }
@@ -175,6 +176,45 @@ TEST_F(CompilerDriverTest, AbstractMethodErrorStub) {
   }
 }
 
+// Several threads get the class definitions by decreasing cost, the classes of equal cost in
+// class definition order.
+TEST_F(CompilerDriverTest, ClassDefVisitOrderByDecreasingCost) {
+  const DexFile& dex_file = *java_lang_dex_file_;
+  ASSERT_GT(dex_file.NumClassDefs(), 1u);
+  std::vector<uint32_t> order = CompilerDriver::GetClassDefVisitOrder(dex_file, 4u);
+  ASSERT_EQ(dex_file.NumClassDefs(), order.size());
+
+  std::vector<bool> visited(order.size(), false);
+  for (size_t i = 0; i != order.size(); ++i) {
+    ASSERT_LT(order[i], order.size());
+    EXPECT_FALSE(visited[order[i]]) << order[i];
+    visited[order[i]] = true;
+    if (i != 0u) {
+      size_t previous_cost =
+          CompilerDriver::EstimateClassDefCost(dex_file, dex_file.GetClassDef(order[i - 1u]));
+      size_t cost = CompilerDriver::EstimateClassDefCost(dex_file, dex_file.GetClassDef(order[i]));
+      EXPECT_GE(previous_cost, cost) << i;
+      if (previous_cost == cost) {
+        EXPECT_LT(order[i - 1u], order[i]) << i;
+      }
+    }
+  }
+  // The core library has classes of very different sizes, so the order did change.
+  EXPECT_NE(0u, order[0]);
+  EXPECT_GT(CompilerDriver::EstimateClassDefCost(dex_file, dex_file.GetClassDef(order[0])),
+            CompilerDriver::EstimateClassDefCost(dex_file, dex_file.GetClassDef(order.back())));
+}
+
+// A single thread gets the class definitions in class definition order.
+TEST_F(CompilerDriverTest, ClassDefVisitOrderSingleThread) {
+  const DexFile& dex_file = *java_lang_dex_file_;
+  std::vector<uint32_t> order = CompilerDriver::GetClassDefVisitOrder(dex_file, 1u);
+  ASSERT_EQ(dex_file.NumClassDefs(), order.size());
+  for (size_t i = 0; i != order.size(); ++i) {
+    EXPECT_EQ(i, order[i]);
+  }
+}
+
 class CompilerDriverMethodsTest : public CompilerDriverTest {
  protected:
   std::unordered_set<std::string>* GetCompiledMethods() OVERRIDE {
@@ -16,6 +16,7 @@
 
 #include "image.h"
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -29,6 +30,8 @@
 #include "elf_writer_quick.h"
 #include "gc/space/image_space.h"
 #include "image_writer.h"
+#include "intern_table.h"
+#include "jit/offline_profiling_info.h"
 #include "linker/multi_oat_relative_patcher.h"
 #include "lock_word.h"
 #include "mirror/object-inl.h"
@@ -48,6 +51,8 @@ struct CompilationHelper {
   std::vector<ScratchFile> image_files;
   std::vector<ScratchFile> oat_files;
   std::string image_dir;
+  // Called once the writer has laid out the image objects, before it writes them.
+  std::function<void(ImageWriter*)> check_layout;
 
   void Compile(CompilerDriver* driver,
                ImageHeader::StorageMode storage_mode);
@@ -69,12 +74,33 @@ class ImageTest : public CommonCompilerTest {
   void Compile(ImageHeader::StorageMode storage_mode,
                CompilationHelper& out_helper,
                const std::string& extra_dex = "",
-               const std::string& image_class = "");
+               const std::vector<std::string>& image_classes = {});
 
   std::unordered_set<std::string>* GetImageClasses() OVERRIDE {
     return new std::unordered_set<std::string>(image_classes_);
   }
 
+  ProfileCompilationInfo* GetProfileCompilationInfo() OVERRIDE {
+    return use_profile_ ? &profile_info_ : nullptr;
+  }
+
+  // Returns whether `object` comes first in its bin, once the image objects are laid out.
+  static bool IsAtStartOfBin(const ImageWriter& writer, mirror::Object* object)
+      SHARED_REQUIRES(Locks::mutator_lock_) {
+    const ImageWriter::ImageInfo& image_info = writer.GetImageInfo(writer.GetOatIndex(object));
+    const size_t offset = writer.GetImageOffset(object);
+    for (size_t bin = 0; bin != ImageWriter::kBinMirrorCount; ++bin) {
+      const size_t bin_offset = image_info.bin_slot_offsets_[bin];
+      if (offset >= bin_offset && offset < bin_offset + image_info.bin_slot_sizes_[bin]) {
+        return offset == bin_offset;
+      }
+    }
+    return false;
+  }
+
+  ProfileCompilationInfo profile_info_;
+  bool use_profile_ = false;
+
  private:
   std::unordered_set<std::string> image_classes_;
 };
@@ -204,7 +230,9 @@ void CompilationHelper::Compile(CompilerDriver* driver,
                                                       &driver->GetCompilerOptions(),
                                                       oat_file.GetFile()));
         elf_writers.back()->Start();
-        oat_writers.emplace_back(new OatWriter(/*compiling_boot_image*/true, &timings));
+        oat_writers.emplace_back(new OatWriter(/*compiling_boot_image*/true,
+                                               &timings,
+                                               /*profile_compilation_info*/nullptr));
       }
 
       std::vector<OutputStream*> rodata;
@@ -247,6 +275,9 @@ void CompilationHelper::Compile(CompilerDriver* driver,
 
       bool image_space_ok = writer->PrepareImageAddressSpace();
       ASSERT_TRUE(image_space_ok);
+      if (check_layout != nullptr) {
+        check_layout(writer.get());
+      }
 
       for (size_t i = 0, size = oat_files.size(); i != size; ++i) {
         linker::MultiOatRelativePatcher patcher(driver->GetInstructionSet(),
@@ -308,10 +339,8 @@ void CompilationHelper::Compile(CompilerDriver* driver,
 void ImageTest::Compile(ImageHeader::StorageMode storage_mode,
                         CompilationHelper& helper,
                         const std::string& extra_dex,
-                        const std::string& image_class) {
-  if (!image_class.empty()) {
-    image_classes_.insert(image_class);
-  }
+                        const std::vector<std::string>& image_classes) {
+  image_classes_.insert(image_classes.begin(), image_classes.end());
   CreateCompilerDriver(Compiler::kOptimizing, kRuntimeISA, kIsTargetBuild ? 2U : 16U);
   // Set inline filter values.
   compiler_options_->SetInlineDepthLimit(CompilerOptions::kDefaultInlineDepthLimit);
@@ -321,13 +350,13 @@ void ImageTest::Compile(ImageHeader::StorageMode storage_mode,
     helper.extra_dex_files = OpenTestDexFiles(extra_dex.c_str());
   }
   helper.Compile(compiler_driver_.get(), storage_mode);
-  if (!image_class.empty()) {
+  for (const std::string& image_class : image_classes) {
     // Make sure the class got initialized.
     ScopedObjectAccess soa(Thread::Current());
     ClassLinker* const class_linker = Runtime::Current()->GetClassLinker();
     mirror::Class* klass = class_linker->FindSystemClass(Thread::Current(), image_class.c_str());
-    EXPECT_TRUE(klass != nullptr);
-    EXPECT_TRUE(klass->IsInitialized());
+    EXPECT_TRUE(klass != nullptr) << image_class;
+    EXPECT_TRUE(klass->IsInitialized()) << image_class;
   }
 }
 
@@ -456,7 +485,7 @@ TEST_F(ImageTest, TestImageLayout) {
   // Compile multi-image with ImageLayoutA being the last image.
   {
     CompilationHelper helper;
-    Compile(ImageHeader::kStorageModeUncompressed, helper, "ImageLayoutA", "LMyClass;");
+    Compile(ImageHeader::kStorageModeUncompressed, helper, "ImageLayoutA", {"LMyClass;"});
     image_sizes = helper.GetImageObjectSectionSizes();
   }
   TearDown();
@@ -465,7 +494,7 @@ TEST_F(ImageTest, TestImageLayout) {
   // Compile multi-image with ImageLayoutB being the last image.
   {
     CompilationHelper helper;
-    Compile(ImageHeader::kStorageModeUncompressed, helper, "ImageLayoutB", "LMyClass;");
+    Compile(ImageHeader::kStorageModeUncompressed, helper, "ImageLayoutB", {"LMyClass;"});
     image_sizes_extra = helper.GetImageObjectSectionSizes();
   }
   // Make sure that the new stuff in the clinit in ImageLayoutB is in the last image and not in the
@@ -479,6 +508,64 @@ TEST_F(ImageTest, TestImageLayout) {
   EXPECT_LT(image_sizes.back(), image_sizes_extra.back());
 }
 
+TEST_F(ImageTest, TestProfileLayout) {
+  static const char* const kStrings[] = {
+      "FIRST_UNIQUE_STRING", "SECOND_UNIQUE_STRING", "STARTUP_UNIQUE_STRING"
+  };
+  Thread* const self = Thread::Current();
+  {
+    // The profile names Startup and its method get().
+    std::unique_ptr<const DexFile> dex_file = OpenTestDexFile("ImageLayoutProfile");
+    const DexFile::ClassDef* class_def =
+        dex_file->FindClassDef("LStartup;", ComputeModifiedUtf8Hash("LStartup;"));
+    ASSERT_TRUE(class_def != nullptr);
+    ASSERT_TRUE(profile_info_.AddClass(*dex_file, dex_file->GetIndexForClassDef(*class_def)));
+    ClassDataItemIterator it(*dex_file, dex_file->GetClassData(*class_def));
+    while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+      it.Next();
+    }
+    for (; it.HasNextDirectMethod(); it.Next()) {
+      if (strcmp(dex_file->GetMethodName(dex_file->GetMethodId(it.GetMemberIndex())), "get") == 0) {
+        ASSERT_TRUE(profile_info_.AddMethod(MethodReference(dex_file.get(), it.GetMemberIndex())));
+      }
+    }
+    ASSERT_EQ(1u, profile_info_.GetMethodsInOrder(*dex_file).size());
+    use_profile_ = true;
+    // The strings are interned like the compiler does when it resolves their const-string.
+    ScopedObjectAccess soa(self);
+    for (const char* string : kStrings) {
+      ASSERT_TRUE(Runtime::Current()->GetInternTable()->InternStrong(string) != nullptr);
+    }
+  }
+
+  CompilationHelper helper;
+  bool checked = false;
+  helper.check_layout = [&](ImageWriter* writer) {
+    ScopedObjectAccess soa(self);
+    ClassLinker* const class_linker = Runtime::Current()->GetClassLinker();
+    InternTable* const intern_table = Runtime::Current()->GetInternTable();
+    mirror::Class* startup = class_linker->FindSystemClass(self, "LStartup;");
+    ASSERT_TRUE(startup != nullptr);
+    EXPECT_TRUE(IsAtStartOfBin(*writer, startup));
+    std::vector<mirror::String*> strings;
+    for (const char* string : kStrings) {
+      strings.push_back(intern_table->LookupStrong(self, strlen(string), string));
+      ASSERT_TRUE(strings.back() != nullptr) << string;
+    }
+    // The string of Startup.get() comes first, although the strings of the dex file are
+    // otherwise laid out in string id order.
+    EXPECT_FALSE(IsAtStartOfBin(*writer, strings[0]));
+    EXPECT_FALSE(IsAtStartOfBin(*writer, strings[1]));
+    EXPECT_TRUE(IsAtStartOfBin(*writer, strings[2]));
+    checked = true;
+  };
+  Compile(ImageHeader::kStorageModeUncompressed,
+          helper,
+          "ImageLayoutProfile",
+          {"LFirst;", "LSecond;", "LStartup;"});
+  EXPECT_TRUE(checked);
+}
+
 TEST_F(ImageTest, ImageHeaderIsValid) {
     uint32_t image_begin = ART_BASE_ADDRESS;
     uint32_t image_size_ = 16 * KB;
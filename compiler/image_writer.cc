@@ -31,6 +31,7 @@
 #include "base/unix_file/fd_file.h"
 #include "class_linker-inl.h"
 #include "compiled_method.h"
+#include "dex/dex_layout.h"
 #include "dex_file-inl.h"
 #include "driver/compiler_driver.h"
 #include "elf_file.h"
@@ -45,6 +46,7 @@
 #include "globals.h"
 #include "image.h"
 #include "intern_table.h"
+#include "jit/offline_profiling_info.h"
 #include "linear_alloc.h"
 #include "lock_word.h"
 #include "mirror/abstract_method.h"
@@ -1388,6 +1390,51 @@ void ImageWriter::ProcessWorkStack(WorkStack* work_stack) {
   }
 }
 
+void ImageWriter::AssignProfileBinSlots(WorkStack* work_stack) {
+  const ProfileCompilationInfo* profile = compiler_driver_.GetProfileCompilationInfo();
+  if (profile == nullptr) {
+    return;
+  }
+  Thread* const self = Thread::Current();
+  Runtime* const runtime = Runtime::Current();
+  ClassLinker* const class_linker = runtime->GetClassLinker();
+  InternTable* const intern_table = runtime->GetInternTable();
+  for (const DexFile* dex_file : compiler_driver_.GetDexFilesForOatFile()) {
+    const size_t oat_index = GetOatIndexForDexFile(dex_file);
+    mirror::DexCache* dex_cache =
+        class_linker->FindDexCache(self, *dex_file, /* allow_failure */ true);
+    if (dex_cache == nullptr) {
+      continue;
+    }
+    // Classes that were pruned are no longer in the dex cache and are skipped.
+    for (uint16_t class_def_idx : profile->GetClassesInOrder(*dex_file)) {
+      if (class_def_idx < dex_file->NumClassDefs()) {
+        const DexFile::ClassDef& class_def = dex_file->GetClassDef(class_def_idx);
+        TryAssignBinSlot(*work_stack, dex_cache->GetResolvedType(class_def.class_idx_), oat_index);
+      }
+    }
+    // The strings of the startup code, in the order the methods are first run.
+    std::vector<uint16_t> methods = profile->GetMethodsInOrder(*dex_file);
+    if (methods.empty()) {
+      continue;
+    }
+    const std::vector<uint32_t> code_item_offsets = DexLayout::GetCodeItemOffsets(*dex_file);
+    for (uint16_t method_idx : methods) {
+      if (method_idx >= code_item_offsets.size() || code_item_offsets[method_idx] == 0u) {
+        continue;
+      }
+      const DexFile::CodeItem* code_item = dex_file->GetCodeItem(code_item_offsets[method_idx]);
+      for (uint32_t string_index : DexLayout::GetConstStringIndexes(*dex_file, *code_item)) {
+        uint32_t utf16_length;
+        const char* utf8_data = dex_file->StringDataAndUtf16LengthByIdx(string_index,
+                                                                        &utf16_length);
+        mirror::String* string = intern_table->LookupStrong(self, utf16_length, utf8_data);
+        TryAssignBinSlot(*work_stack, string, oat_index);
+      }
+    }
+  }
+}
+
 void ImageWriter::CalculateNewObjectOffsets() {
   Thread* const self = Thread::Current();
   StackHandleScopeCollection handles(self);
@@ -1431,6 +1478,10 @@ void ImageWriter::CalculateNewObjectOffsets() {
   // assigned a bin slot.
   WorkStack work_stack;
 
+  // Lay out the objects used during startup first. The work stack is processed only after all of
+  // them got their bin slots so that the objects they reference do not get in between.
+  AssignProfileBinSlots(&work_stack);
+
   // Special case interned strings to put them in the image they are likely to be resolved from.
   for (const DexFile* dex_file : compiler_driver_.GetDexFilesForOatFile()) {
     auto it = dex_file_oat_index_map_.find(dex_file);
@@ -1511,6 +1562,10 @@ void ImageWriter::CalculateNewObjectOffsets() {
           bin_offset = RoundUp(bin_offset, target_ptr_size_);
           break;
         }
+        case kBinDexCacheArray: {
+          bin_offset = RoundUp(bin_offset, DexCacheArraysLayout::Alignment(target_ptr_size_));
+          break;
+        }
         default: {
           // Normal alignment.
         }
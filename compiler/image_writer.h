@@ -386,6 +386,11 @@ class ImageWriter FINAL {
       SHARED_REQUIRES(Locks::mutator_lock_);
   void ProcessWorkStack(WorkStack* work_stack)
       SHARED_REQUIRES(Locks::mutator_lock_);
+  // For images compiled with a profile, assign bin slots to the profile classes and to the
+  // strings used by the profile methods first, in profile order, so that the objects touched
+  // during startup are grouped at the start of their bins.
+  void AssignProfileBinSlots(WorkStack* work_stack)
+      SHARED_REQUIRES(Locks::mutator_lock_);
   void CreateHeader(size_t oat_index)
       SHARED_REQUIRES(Locks::mutator_lock_);
   mirror::ObjectArray<mirror::Object>* CreateImageRoots(size_t oat_index) const
@@ -585,6 +590,7 @@ class ImageWriter FINAL {
   friend class FixupRootVisitor;
   friend class FixupVisitor;
   class GetRootsVisitor;
+  friend class ImageTest;
   friend class NativeLocationVisitor;
   friend class NonImageClassesVisitor;
   class VisitReferencesVisitor;
@@ -30,6 +30,7 @@
 #include "compiled_class.h"
 #include "compiled_method.h"
 #include "debug/method_debug_info.h"
+#include "dex/dex_layout.h"
 #include "dex/verification_results.h"
 #include "dex_file-inl.h"
 #include "driver/compiler_driver.h"
@@ -51,6 +52,7 @@
 #include "type_lookup_table.h"
 #include "utils/dex_cache_arrays_layout-inl.h"
 #include "verifier/method_verifier.h"
+#include "verifier/verifier_deps.h"
 #include "zip_archive.h"
 
 namespace art {
@@ -265,7 +267,9 @@ class OatWriter::OatDexFile {
   DCHECK_EQ(static_cast<off_t>(file_offset + offset_), out->Seek(0, kSeekCurrent)) \
     << "file_offset=" << file_offset << " offset_=" << offset_
 
-OatWriter::OatWriter(bool compiling_boot_image, TimingLogger* timings)
+OatWriter::OatWriter(bool compiling_boot_image,
+                     TimingLogger* timings,
+                     const ProfileCompilationInfo* info)
   : write_state_(WriteState::kAddingDexFileSources),
     timings_(timings),
     raw_dex_files_(),
@@ -275,7 +279,9 @@ OatWriter::OatWriter(bool compiling_boot_image, TimingLogger* timings)
     compiler_driver_(nullptr),
     image_writer_(nullptr),
     compiling_boot_image_(compiling_boot_image),
+    profile_compilation_info_(info),
     dex_files_(nullptr),
+    class_def_orders_(),
     size_(0u),
     bss_size_(0u),
     oat_data_offset_(0u),
@@ -313,6 +319,8 @@ OatWriter::OatWriter(bool compiling_boot_image, TimingLogger* timings)
     size_oat_class_status_(0),
     size_oat_class_method_bitmaps_(0),
     size_oat_class_method_offsets_(0),
+    size_verifier_deps_alignment_(0),
+    size_verifier_deps_(0),
     relative_patcher_(nullptr),
     absolute_patch_locations_() {
 }
@@ -478,6 +486,14 @@ void OatWriter::PrepareLayout(const CompilerDriver* compiler,
   relative_patcher_ = relative_patcher;
   SetMultiOatRelativePatcherAdjustment();
 
+  if (profile_compilation_info_ != nullptr) {
+    // Write the compiled code of the profile classes first, in the same order as their dex code.
+    for (const DexFile* dex_file : dex_files) {
+      class_def_orders_.push_back(
+          DexLayout::GetClassDefOrder(*dex_file, *profile_compilation_info_));
+    }
+  }
+
   if (compiling_boot_image_) {
     CHECK(image_writer_ != nullptr);
   }
@@ -489,6 +505,10 @@ void OatWriter::PrepareLayout(const CompilerDriver* compiler,
     TimingLogger::ScopedTiming split("InitOatClasses", timings_);
     offset = InitOatClasses(offset);
   }
+  {
+    TimingLogger::ScopedTiming split("InitVerifierDeps", timings_);
+    offset = InitVerifierDeps(offset);
+  }
   {
     TimingLogger::ScopedTiming split("InitOatMaps", timings_);
     offset = InitOatMaps(offset);
@@ -1169,6 +1189,14 @@ class OatWriter::WriteCodeMethodVisitor : public OatDexMethodVisitor {
 
   mirror::String* GetTargetString(const LinkerPatch& patch) SHARED_REQUIRES(Locks::mutator_lock_) {
     mirror::String* string = dex_cache_->GetResolvedString(patch.TargetStringIndex());
+    if (string == nullptr) {
+      // The string may have been evicted from a hash-indexed strings array.
+      DCHECK(dex_cache_->HasHashedStrings());
+      StackHandleScope<1> hs(Thread::Current());
+      string = class_linker_->LookupString(*dex_cache_->GetDexFile(),
+                                           patch.TargetStringIndex(),
+                                           hs.NewHandle(dex_cache_));
+    }
     DCHECK(string != nullptr);
     DCHECK(writer_->HasBootImage() ||
            Runtime::Current()->GetHeap()->ObjectIsInBootImageSpace(string));
@@ -1329,9 +1357,11 @@ class OatWriter::WriteMapMethodVisitor : public OatDexMethodVisitor {
 
 // Visit all methods from all classes in all dex files with the specified visitor.
 bool OatWriter::VisitDexMethods(DexMethodVisitor* visitor) {
-  for (const DexFile* dex_file : *dex_files_) {
+  for (size_t dex_file_index = 0; dex_file_index != dex_files_->size(); ++dex_file_index) {
+    const DexFile* dex_file = (*dex_files_)[dex_file_index];
     const size_t class_def_count = dex_file->NumClassDefs();
-    for (size_t class_def_index = 0; class_def_index != class_def_count; ++class_def_index) {
+    for (size_t position = 0; position != class_def_count; ++position) {
+      size_t class_def_index = GetVisitedClassDefIndex(dex_file_index, position);
       if (UNLIKELY(!visitor->StartClass(dex_file, class_def_index))) {
         return false;
       }
@@ -1400,12 +1430,14 @@ size_t OatWriter::InitOatClasses(size_t offset) {
   CHECK(success);
   offset = visitor.GetOffset();
 
-  // Update oat_dex_files_.
+  // Update oat_dex_files_. The oat classes are in visiting order.
   auto oat_class_it = oat_classes_.begin();
-  for (OatDexFile& oat_dex_file : oat_dex_files_) {
-    for (uint32_t& class_offset : oat_dex_file.class_offsets_) {
+  for (size_t dex_file_index = 0; dex_file_index != oat_dex_files_.size(); ++dex_file_index) {
+    OatDexFile& oat_dex_file = oat_dex_files_[dex_file_index];
+    for (size_t position = 0; position != oat_dex_file.class_offsets_.size(); ++position) {
       DCHECK(oat_class_it != oat_classes_.end());
-      class_offset = oat_class_it->offset_;
+      size_t class_def_index = GetVisitedClassDefIndex(dex_file_index, position);
+      oat_dex_file.class_offsets_[class_def_index] = oat_class_it->offset_;
       ++oat_class_it;
     }
   }
@@ -1414,6 +1446,23 @@ size_t OatWriter::InitOatClasses(size_t offset) {
   return offset;
 }
 
+size_t OatWriter::InitVerifierDeps(size_t offset) {
+  const verifier::VerifierDepsTable* verifier_deps = compiler_driver_->GetVerifierDeps();
+  // The table refers to dex files by their index in the oat file.
+  if (verifier_deps == nullptr || verifier_deps->GetDexFiles() != *dex_files_) {
+    return offset;
+  }
+  verifier_deps->Encode(&verifier_deps_);
+  if (verifier_deps_.empty()) {
+    return offset;
+  }
+  size_t aligned_offset = RoundUp(offset, sizeof(uint32_t));
+  size_verifier_deps_alignment_ = aligned_offset - offset;
+  size_verifier_deps_ = verifier_deps_.size();
+  oat_header_->SetVerifierDeps(aligned_offset, verifier_deps_.size());
+  return aligned_offset + verifier_deps_.size();
+}
+
 size_t OatWriter::InitOatMaps(size_t offset) {
   InitMapMethodVisitor visitor(this, offset);
   bool success = VisitDexMethods(&visitor);
@@ -1496,6 +1545,11 @@ bool OatWriter::WriteRodata(OutputStream* out) {
     return false;
   }
 
+  if (!WriteVerifierDeps(out)) {
+    LOG(ERROR) << "Failed to write verifier dependencies to " << out->GetLocation();
+    return false;
+  }
+
   off_t tables_end_offset = out->Seek(0, kSeekCurrent);
   if (tables_end_offset == static_cast<off_t>(-1)) {
     LOG(ERROR) << "Failed to seek to oat code position in " << out->GetLocation();
@@ -1595,6 +1649,8 @@ bool OatWriter::WriteCode(OutputStream* out) {
     DO_STAT(size_oat_class_status_);
     DO_STAT(size_oat_class_method_bitmaps_);
     DO_STAT(size_oat_class_method_offsets_);
+    DO_STAT(size_verifier_deps_alignment_);
+    DO_STAT(size_verifier_deps_);
     #undef DO_STAT
 
     VLOG(compiler) << "size_total=" << PrettySize(size_total) << " (" << size_total << "B)"; \
@@ -1694,6 +1750,24 @@ bool OatWriter::WriteClasses(OutputStream* out) {
   return true;
 }
 
+bool OatWriter::WriteVerifierDeps(OutputStream* out) {
+  if (verifier_deps_.empty()) {
+    return true;
+  }
+  uint32_t expected_offset = oat_data_offset_ + oat_header_->GetVerifierDepsOffset();
+  off_t actual_offset = out->Seek(expected_offset, kSeekSet);
+  if (static_cast<uint32_t>(actual_offset) != expected_offset) {
+    PLOG(ERROR) << "Failed to seek to verifier dependencies section. Actual: " << actual_offset
+                << " Expected: " << expected_offset << " File: " << out->GetLocation();
+    return false;
+  }
+  if (!out->WriteFully(verifier_deps_.data(), verifier_deps_.size())) {
+    PLOG(ERROR) << "Failed to write verifier dependencies to " << out->GetLocation();
+    return false;
+  }
+  return true;
+}
+
 size_t OatWriter::WriteMaps(OutputStream* out, const size_t file_offset, size_t relative_offset) {
   size_t vmap_tables_offset = relative_offset;
   WriteMapMethodVisitor visitor(this, out, file_offset, relative_offset);
@@ -2151,7 +2225,7 @@ bool OatWriter::OpenDexFiles(
   for (OatDexFile& oat_dex_file : oat_dex_files_) {
     // Make sure no one messed with input files while we were copying data.
     // At the very least we need consistent file size and number of class definitions.
-    const uint8_t* raw_dex_file =
+    uint8_t* raw_dex_file =
         dex_files_map->Begin() + oat_dex_file.dex_file_offset_ - map_offset;
     if (!ValidateDexFileHeader(raw_dex_file, oat_dex_file.GetLocation())) {
       // Note: ValidateDexFileHeader() already logged an error message.
@@ -2174,6 +2248,10 @@ bool OatWriter::OpenDexFiles(
       return false;
     }
 
+    if (profile_compilation_info_ != nullptr) {
+      LayoutDexFile(oat_dex_file, raw_dex_file);
+    }
+
     // Now, open the dex file.
     dex_files.emplace_back(DexFile::Open(raw_dex_file,
                                          oat_dex_file.dex_file_size_,
@@ -2194,6 +2272,25 @@ bool OatWriter::OpenDexFiles(
   return true;
 }
 
+void OatWriter::LayoutDexFile(const OatDexFile& oat_dex_file, uint8_t* raw_dex_file) {
+  // The layout is applied to the written data, so the dex file is opened from it twice. The
+  // second time is verified, if requested, which also checks the new layout.
+  std::string error_msg;
+  std::unique_ptr<const DexFile> dex_file(DexFile::Open(raw_dex_file,
+                                                        oat_dex_file.dex_file_size_,
+                                                        oat_dex_file.GetLocation(),
+                                                        oat_dex_file.dex_file_location_checksum_,
+                                                        /* oat_dex_file */ nullptr,
+                                                        /* verify */ false,
+                                                        &error_msg));
+  if (dex_file == nullptr) {
+    LOG(WARNING) << "Failed to open dex file for layout. File: " << oat_dex_file.GetLocation()
+                 << " Error: " << error_msg;
+    return;
+  }
+  DexLayout::Layout(*dex_file, *profile_compilation_info_, raw_dex_file);
+}
+
 bool OatWriter::WriteTypeLookupTables(
     MemMap* opened_dex_files_map,
     const std::vector<std::unique_ptr<const DexFile>>& opened_dex_files) {
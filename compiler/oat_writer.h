@@ -39,6 +39,7 @@ class CompiledMethod;
 class CompilerDriver;
 class ImageWriter;
 class OutputStream;
+class ProfileCompilationInfo;
 class TimingLogger;
 class TypeLookupTable;
 class ZipEntry;
@@ -111,7 +112,9 @@ class OatWriter {
     kDefault = kCreate
   };
 
-  OatWriter(bool compiling_boot_image, TimingLogger* timings);
+  // If `info` is not null, the dex files and the compiled code are laid out based on it, see
+  // DexLayout.
+  OatWriter(bool compiling_boot_image, TimingLogger* timings, const ProfileCompilationInfo* info);
 
   // To produce a valid oat file, the user must first add sources with any combination of
   //   - AddDexFileSource(),
@@ -236,6 +239,11 @@ class OatWriter {
   // Visit all the methods in all the compiled dex files in their definition order
   // with a given DexMethodVisitor.
   bool VisitDexMethods(DexMethodVisitor* visitor);
+  // Returns the class def index of the class visited at `position` in the dex file
+  // `dex_file_index`.
+  size_t GetVisitedClassDefIndex(size_t dex_file_index, size_t position) const {
+    return class_def_orders_.empty() ? position : class_def_orders_[dex_file_index][position];
+  }
 
   size_t InitOatHeader(InstructionSet instruction_set,
                        const InstructionSetFeatures* instruction_set_features,
@@ -243,12 +251,14 @@ class OatWriter {
                        SafeMap<std::string, std::string>* key_value_store);
   size_t InitOatDexFiles(size_t offset);
   size_t InitOatClasses(size_t offset);
+  size_t InitVerifierDeps(size_t offset);
   size_t InitOatMaps(size_t offset);
   size_t InitOatCode(size_t offset);
   size_t InitOatCodeDexFiles(size_t offset);
 
   bool WriteClassOffsets(OutputStream* out);
   bool WriteClasses(OutputStream* out);
+  bool WriteVerifierDeps(OutputStream* out);
   size_t WriteMaps(OutputStream* out, const size_t file_offset, size_t relative_offset);
   size_t WriteCode(OutputStream* out, const size_t file_offset, size_t relative_offset);
   size_t WriteCodeDexFiles(OutputStream* out, const size_t file_offset, size_t relative_offset);
@@ -264,6 +274,7 @@ class OatWriter {
   bool WriteDexFile(OutputStream* rodata, OatDexFile* oat_dex_file, const uint8_t* dex_file);
   bool WriteOatDexFiles(OutputStream* rodata);
   bool ExtendForTypeLookupTables(OutputStream* rodata, File* file, size_t offset);
+  void LayoutDexFile(const OatDexFile& oat_dex_file, uint8_t* raw_dex_file);
   bool OpenDexFiles(File* file,
                     bool verify,
                     /*out*/ std::unique_ptr<MemMap>* opened_dex_files_map,
@@ -299,9 +310,16 @@ class OatWriter {
   ImageWriter* image_writer_;
   const bool compiling_boot_image_;
 
+  // Profile for the layout of the dex files and of the compiled code, null for the default layout.
+  const ProfileCompilationInfo* profile_compilation_info_;
+
   // note OatFile does not take ownership of the DexFiles
   const std::vector<const DexFile*>* dex_files_;
 
+  // The order in which the classes of each dex file are visited, and their compiled code is
+  // written, if it is not the class def order.
+  std::vector<std::vector<uint16_t>> class_def_orders_;
+
   // Size required for Oat data structures.
   size_t size_;
 
@@ -319,6 +337,7 @@ class OatWriter {
   std::unique_ptr<OatHeader> oat_header_;
   dchecked_vector<OatDexFile> oat_dex_files_;
   dchecked_vector<OatClass> oat_classes_;
+  std::vector<uint8_t> verifier_deps_;
   std::unique_ptr<const std::vector<uint8_t>> jni_dlsym_lookup_;
   std::unique_ptr<const std::vector<uint8_t>> quick_generic_jni_trampoline_;
   std::unique_ptr<const std::vector<uint8_t>> quick_imt_conflict_trampoline_;
@@ -359,6 +378,8 @@ class OatWriter {
   uint32_t size_oat_class_status_;
   uint32_t size_oat_class_method_bitmaps_;
   uint32_t size_oat_class_method_offsets_;
+  uint32_t size_verifier_deps_alignment_;
+  uint32_t size_verifier_deps_;
 
   // The helper for processing relative patches is external so that we can patch across oat files.
   linker::MultiOatRelativePatcher* relative_patcher_;
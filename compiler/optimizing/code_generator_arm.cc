@@ -5269,6 +5269,15 @@ HLoadString::LoadKind CodeGeneratorARM::GetSupportedLoadStringKind(
       break;
     case HLoadString::LoadKind::kDexCacheViaMethod:
       break;
+    case HLoadString::LoadKind::kHashedDexCacheViaMethod:
+      if (kEmitCompilerReadBarrier && !kUseBakerReadBarrier) {
+        // The slow path read barrier loads the root again, which may then belong to a newer pair
+        // than the one whose string index was checked.
+        return HLoadString::LoadKind::kRuntimeCall;
+      }
+      break;
+    case HLoadString::LoadKind::kRuntimeCall:
+      break;
   }
   return desired_string_load_kind;
 }
@@ -5280,10 +5289,15 @@ void LocationsBuilderARM::VisitLoadString(HLoadString* load) {
   LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(load, call_kind);
   HLoadString::LoadKind load_kind = load->GetLoadKind();
   if (load_kind == HLoadString::LoadKind::kDexCacheViaMethod ||
+      load_kind == HLoadString::LoadKind::kHashedDexCacheViaMethod ||
       load_kind == HLoadString::LoadKind::kDexCachePcRelative) {
     locations->SetInAt(0, Location::RequiresRegister());
   }
   locations->SetOut(Location::RequiresRegister());
+  if (load_kind == HLoadString::LoadKind::kHashedDexCacheViaMethod) {
+    // Receives the string index half of the pair.
+    locations->AddTemp(Location::RequiresRegister());
+  }
 }
 
 void InstructionCodeGeneratorARM::VisitLoadString(HLoadString* load) {
@@ -5353,6 +5367,44 @@ void InstructionCodeGeneratorARM::VisitLoadString(HLoadString* load) {
           load, out_loc, out, CodeGenerator::GetCacheOffset(load->GetStringIndex()));
       break;
     }
+    case HLoadString::LoadKind::kHashedDexCacheViaMethod: {
+      DCHECK(!kEmitCompilerReadBarrier || kUseBakerReadBarrier);
+      Register current_method = locations->InAt(0).AsRegister<Register>();
+      Register temp = locations->GetTemp(0).AsRegister<Register>();
+      const uint32_t string_index = load->GetStringIndex();
+      const uint32_t offset = (string_index % mirror::DexCache::kDexCacheStringCacheSize) *
+          sizeof(mirror::StringDexCachePair);
+
+      // /* GcRoot<mirror::Class> */ out = current_method->declaring_class_
+      GenerateGcRootFieldLoad(
+          load, out_loc, current_method, ArtMethod::DeclaringClassOffset().Int32Value());
+      // /* mirror::StringDexCachePair[] */ out = out->dex_cache_strings_
+      __ LoadFromOffset(kLoadWord, out, out, mirror::Class::DexCacheStringsOffset().Int32Value());
+      // The runtime writes pairs atomically, load out[offset] with a single ldrexd.
+      __ AddConstant(IP, out, offset);
+      __ ldrexd(out, temp, IP);
+      SlowPathCode* slow_path = new (GetGraph()->GetArena()) LoadStringSlowPathARM(load);
+      codegen_->AddSlowPath(slow_path);
+      __ CmpConstant(temp, string_index);
+      __ b(slow_path->GetEntryLabel(), NE);
+      if (string_index == 0u) {
+        // Pairs start out as (null, 0), so the string may still be missing.
+        __ CompareAndBranchIfZero(out, slow_path->GetEntryLabel());
+      }
+      if (kEmitCompilerReadBarrier) {
+        // Mark the string of the pair, as GenerateGcRootFieldLoad() does after its load.
+        GenerateGcRootMarkWithBakerReadBarrier(load, out_loc);
+      }
+      __ Bind(slow_path->GetExitLabel());
+      return;
+    }
+    case HLoadString::LoadKind::kRuntimeCall: {
+      SlowPathCode* slow_path = new (GetGraph()->GetArena()) LoadStringSlowPathARM(load);
+      codegen_->AddSlowPath(slow_path);
+      __ b(slow_path->GetEntryLabel());
+      __ Bind(slow_path->GetExitLabel());
+      return;
+    }
     default:
       LOG(FATAL) << "Unexpected load kind: " << load->GetLoadKind();
       UNREACHABLE();
@@ -6115,16 +6167,7 @@ void InstructionCodeGeneratorARM::GenerateGcRootFieldLoad(HInstruction* instruct
                     "art::mirror::CompressedReference<mirror::Object> and int32_t "
                     "have different sizes.");
 
-      // Slow path used to mark the GC root `root`.
-      SlowPathCode* slow_path =
-          new (GetGraph()->GetArena()) ReadBarrierMarkSlowPathARM(instruction, root, root);
-      codegen_->AddSlowPath(slow_path);
-
-      // IP = Thread::Current()->GetIsGcMarking()
-      __ LoadFromOffset(
-          kLoadWord, IP, TR, Thread::IsGcMarkingOffset<kArmWordSize>().Int32Value());
-      __ CompareAndBranchIfNonZero(IP, slow_path->GetEntryLabel());
-      __ Bind(slow_path->GetExitLabel());
+      GenerateGcRootMarkWithBakerReadBarrier(instruction, root);
     } else {
       // GC root loaded through a slow path for read barriers other
       // than Baker's.
@@ -6142,6 +6185,22 @@ void InstructionCodeGeneratorARM::GenerateGcRootFieldLoad(HInstruction* instruct
   }
 }
 
+void InstructionCodeGeneratorARM::GenerateGcRootMarkWithBakerReadBarrier(HInstruction* instruction,
+                                                                          Location root) {
+  DCHECK(kEmitCompilerReadBarrier);
+  DCHECK(kUseBakerReadBarrier);
+
+  // Slow path used to mark the GC root `root`.
+  SlowPathCode* slow_path =
+      new (GetGraph()->GetArena()) ReadBarrierMarkSlowPathARM(instruction, root, root);
+  codegen_->AddSlowPath(slow_path);
+
+  // IP = Thread::Current()->GetIsGcMarking()
+  __ LoadFromOffset(kLoadWord, IP, TR, Thread::IsGcMarkingOffset<kArmWordSize>().Int32Value());
+  __ CompareAndBranchIfNonZero(IP, slow_path->GetEntryLabel());
+  __ Bind(slow_path->GetExitLabel());
+}
+
 void CodeGeneratorARM::GenerateFieldLoadWithBakerReadBarrier(HInstruction* instruction,
                                                              Location ref,
                                                              Register obj,
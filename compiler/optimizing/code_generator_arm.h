@@ -273,6 +273,9 @@ class InstructionCodeGeneratorARM : public InstructionCodeGenerator {
                                Location root,
                                Register obj,
                                uint32_t offset);
+  // Mark the GC root `root`, already loaded into its register, if the GC is marking. For Baker's
+  // read barriers only.
+  void GenerateGcRootMarkWithBakerReadBarrier(HInstruction* instruction, Location root);
   void GenerateTestAndBranch(HInstruction* instruction,
                              size_t condition_input_index,
                              Label* true_target,
@@ -4065,6 +4065,15 @@ HLoadString::LoadKind CodeGeneratorARM64::GetSupportedLoadStringKind(
       break;
     case HLoadString::LoadKind::kDexCacheViaMethod:
       break;
+    case HLoadString::LoadKind::kHashedDexCacheViaMethod:
+      if (kEmitCompilerReadBarrier && !kUseBakerReadBarrier) {
+        // The slow path read barrier loads the root again, which may then belong to a newer pair
+        // than the one whose string index was checked.
+        return HLoadString::LoadKind::kRuntimeCall;
+      }
+      break;
+    case HLoadString::LoadKind::kRuntimeCall:
+      break;
   }
   return desired_string_load_kind;
 }
@@ -4074,7 +4083,8 @@ void LocationsBuilderARM64::VisitLoadString(HLoadString* load) {
       ? LocationSummary::kCallOnSlowPath
       : LocationSummary::kNoCall;
   LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(load, call_kind);
-  if (load->GetLoadKind() == HLoadString::LoadKind::kDexCacheViaMethod) {
+  if (load->GetLoadKind() == HLoadString::LoadKind::kDexCacheViaMethod ||
+      load->GetLoadKind() == HLoadString::LoadKind::kHashedDexCacheViaMethod) {
     locations->SetInAt(0, Location::RequiresRegister());
   }
   locations->SetOut(Location::RequiresRegister());
@@ -4160,6 +4170,46 @@ void InstructionCodeGeneratorARM64::VisitLoadString(HLoadString* load) {
           load, out_loc, out.X(), CodeGenerator::GetCacheOffset(load->GetStringIndex()));
       break;
     }
+    case HLoadString::LoadKind::kHashedDexCacheViaMethod: {
+      DCHECK(!kEmitCompilerReadBarrier || kUseBakerReadBarrier);
+      Register current_method = InputRegisterAt(load, 0);
+      const uint32_t string_index = load->GetStringIndex();
+      const uint32_t offset = (string_index % mirror::DexCache::kDexCacheStringCacheSize) *
+          sizeof(mirror::StringDexCachePair);
+      UseScratchRegisterScope temps(GetVIXLAssembler());
+      Register pair = temps.AcquireX();
+
+      // /* GcRoot<mirror::Class> */ out = current_method->declaring_class_
+      GenerateGcRootFieldLoad(
+          load, out_loc, current_method, ArtMethod::DeclaringClassOffset().Int32Value());
+      // /* mirror::StringDexCachePair[] */ out = out->dex_cache_strings_
+      __ Ldr(out.X(), HeapOperand(out, mirror::Class::DexCacheStringsOffset().Uint32Value()));
+      // The runtime writes pairs atomically, load out[offset] with a single 64-bit load.
+      __ Ldr(pair, MemOperand(out.X(), offset));
+      __ Mov(out, pair.W());
+      __ Lsr(pair, pair, 32);
+      SlowPathCodeARM64* slow_path = new (GetGraph()->GetArena()) LoadStringSlowPathARM64(load);
+      codegen_->AddSlowPath(slow_path);
+      __ Cmp(pair, Operand(string_index));
+      __ B(ne, slow_path->GetEntryLabel());
+      if (string_index == 0u) {
+        // Pairs start out as (null, 0), so the string may still be missing.
+        __ Cbz(out, slow_path->GetEntryLabel());
+      }
+      if (kEmitCompilerReadBarrier) {
+        // Mark the string of the pair, as GenerateGcRootFieldLoad() does after its load.
+        GenerateGcRootMarkWithBakerReadBarrier(load, out_loc);
+      }
+      __ Bind(slow_path->GetExitLabel());
+      return;
+    }
+    case HLoadString::LoadKind::kRuntimeCall: {
+      SlowPathCodeARM64* slow_path = new (GetGraph()->GetArena()) LoadStringSlowPathARM64(load);
+      codegen_->AddSlowPath(slow_path);
+      __ B(slow_path->GetEntryLabel());
+      __ Bind(slow_path->GetExitLabel());
+      return;
+    }
     default:
       LOG(FATAL) << "Unexpected load kind: " << load->GetLoadKind();
       UNREACHABLE();
@@ -4970,18 +5020,7 @@ void InstructionCodeGeneratorARM64::GenerateGcRootFieldLoad(HInstruction* instru
                     "art::mirror::CompressedReference<mirror::Object> and int32_t "
                     "have different sizes.");
 
-      // Slow path used to mark the GC root `root`.
-      SlowPathCodeARM64* slow_path =
-          new (GetGraph()->GetArena()) ReadBarrierMarkSlowPathARM64(instruction, root, root);
-      codegen_->AddSlowPath(slow_path);
-
-      MacroAssembler* masm = GetVIXLAssembler();
-      UseScratchRegisterScope temps(masm);
-      Register temp = temps.AcquireW();
-      // temp = Thread::Current()->GetIsGcMarking()
-      __ Ldr(temp, MemOperand(tr, Thread::IsGcMarkingOffset<kArm64WordSize>().Int32Value()));
-      __ Cbnz(temp, slow_path->GetEntryLabel());
-      __ Bind(slow_path->GetExitLabel());
+      GenerateGcRootMarkWithBakerReadBarrier(instruction, root);
     } else {
       // GC root loaded through a slow path for read barriers other
       // than Baker's.
@@ -5011,6 +5050,25 @@ void InstructionCodeGeneratorARM64::GenerateGcRootFieldLoad(HInstruction* instru
   }
 }
 
+void InstructionCodeGeneratorARM64::GenerateGcRootMarkWithBakerReadBarrier(
+    HInstruction* instruction, Location root) {
+  DCHECK(kEmitCompilerReadBarrier);
+  DCHECK(kUseBakerReadBarrier);
+
+  // Slow path used to mark the GC root `root`.
+  SlowPathCodeARM64* slow_path =
+      new (GetGraph()->GetArena()) ReadBarrierMarkSlowPathARM64(instruction, root, root);
+  codegen_->AddSlowPath(slow_path);
+
+  MacroAssembler* masm = GetVIXLAssembler();
+  UseScratchRegisterScope temps(masm);
+  Register temp = temps.AcquireW();
+  // temp = Thread::Current()->GetIsGcMarking()
+  __ Ldr(temp, MemOperand(tr, Thread::IsGcMarkingOffset<kArm64WordSize>().Int32Value()));
+  __ Cbnz(temp, slow_path->GetEntryLabel());
+  __ Bind(slow_path->GetExitLabel());
+}
+
 void CodeGeneratorARM64::GenerateFieldLoadWithBakerReadBarrier(HInstruction* instruction,
                                                                Location ref,
                                                                vixl::Register obj,
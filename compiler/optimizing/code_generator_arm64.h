@@ -262,6 +262,9 @@ class InstructionCodeGeneratorARM64 : public InstructionCodeGenerator {
                                vixl::Register obj,
                                uint32_t offset,
                                vixl::Label* fixup_label = nullptr);
+  // Mark the GC root `root`, already loaded into its register, if the GC is marking. For Baker's
+  // read barriers only.
+  void GenerateGcRootMarkWithBakerReadBarrier(HInstruction* instruction, Location root);
 
   // Generate a floating-point comparison.
   void GenerateFcmp(HInstruction* instruction);
@@ -3802,7 +3802,12 @@ static bool TryGenerateIntrinsicCode(HInvoke* invoke, CodeGeneratorMIPS* codegen
 }
 
 HLoadString::LoadKind CodeGeneratorMIPS::GetSupportedLoadStringKind(
-    HLoadString::LoadKind desired_string_load_kind ATTRIBUTE_UNUSED) {
+    HLoadString::LoadKind desired_string_load_kind) {
+  if (desired_string_load_kind == HLoadString::LoadKind::kHashedDexCacheViaMethod) {
+    // The runtime writes string pairs under a swap mutex on this architecture, see
+    // QuasiAtomic::NeedSwapMutexes(), so compiled code cannot load them atomically.
+    return HLoadString::LoadKind::kRuntimeCall;
+  }
   // TODO: Implement other kinds.
   return HLoadString::LoadKind::kDexCacheViaMethod;
 }
@@ -4054,11 +4059,20 @@ void LocationsBuilderMIPS::VisitLoadString(HLoadString* load) {
       ? LocationSummary::kCallOnSlowPath
       : LocationSummary::kNoCall;
   LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(load, call_kind);
-  locations->SetInAt(0, Location::RequiresRegister());
+  if (load->GetLoadKind() == HLoadString::LoadKind::kDexCacheViaMethod) {
+    locations->SetInAt(0, Location::RequiresRegister());
+  }
   locations->SetOut(Location::RequiresRegister());
 }
 
 void InstructionCodeGeneratorMIPS::VisitLoadString(HLoadString* load) {
+  if (load->GetLoadKind() == HLoadString::LoadKind::kRuntimeCall) {
+    SlowPathCodeMIPS* slow_path = new (GetGraph()->GetArena()) LoadStringSlowPathMIPS(load);
+    codegen_->AddSlowPath(slow_path);
+    __ B(slow_path->GetEntryLabel());
+    __ Bind(slow_path->GetExitLabel());
+    return;
+  }
   LocationSummary* locations = load->GetLocations();
   Register out = locations->Out().AsRegister<Register>();
   Register current_method = locations->InAt(0).AsRegister<Register>();
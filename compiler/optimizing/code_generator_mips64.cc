@@ -3017,7 +3017,12 @@ static bool TryGenerateIntrinsicCode(HInvoke* invoke, CodeGeneratorMIPS64* codeg
 }
 
 HLoadString::LoadKind CodeGeneratorMIPS64::GetSupportedLoadStringKind(
-    HLoadString::LoadKind desired_string_load_kind ATTRIBUTE_UNUSED) {
+    HLoadString::LoadKind desired_string_load_kind) {
+  if (desired_string_load_kind == HLoadString::LoadKind::kHashedDexCacheViaMethod) {
+    // The runtime writes string pairs under a swap mutex on this architecture, see
+    // QuasiAtomic::NeedSwapMutexes(), so compiled code cannot load them atomically.
+    return HLoadString::LoadKind::kRuntimeCall;
+  }
   // TODO: Implement other kinds.
   return HLoadString::LoadKind::kDexCacheViaMethod;
 }
@@ -3273,11 +3278,20 @@ void LocationsBuilderMIPS64::VisitLoadString(HLoadString* load) {
       ? LocationSummary::kCallOnSlowPath
       : LocationSummary::kNoCall;
   LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(load, call_kind);
-  locations->SetInAt(0, Location::RequiresRegister());
+  if (load->GetLoadKind() == HLoadString::LoadKind::kDexCacheViaMethod) {
+    locations->SetInAt(0, Location::RequiresRegister());
+  }
   locations->SetOut(Location::RequiresRegister());
 }
 
 void InstructionCodeGeneratorMIPS64::VisitLoadString(HLoadString* load) {
+  if (load->GetLoadKind() == HLoadString::LoadKind::kRuntimeCall) {
+    SlowPathCodeMIPS64* slow_path = new (GetGraph()->GetArena()) LoadStringSlowPathMIPS64(load);
+    codegen_->AddSlowPath(slow_path);
+    __ Bc(slow_path->GetEntryLabel());
+    __ Bind(slow_path->GetExitLabel());
+    return;
+  }
   LocationSummary* locations = load->GetLocations();
   GpuRegister out = locations->Out().AsRegister<GpuRegister>();
   GpuRegister current_method = locations->InAt(0).AsRegister<GpuRegister>();
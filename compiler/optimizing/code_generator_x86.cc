@@ -6072,6 +6072,15 @@ HLoadString::LoadKind CodeGeneratorX86::GetSupportedLoadStringKind(
       break;
     case HLoadString::LoadKind::kDexCacheViaMethod:
       break;
+    case HLoadString::LoadKind::kHashedDexCacheViaMethod:
+      if (kEmitCompilerReadBarrier && !kUseBakerReadBarrier) {
+        // The slow path read barrier loads the root again, which may then belong to a newer pair
+        // than the one whose string index was checked.
+        return HLoadString::LoadKind::kRuntimeCall;
+      }
+      break;
+    case HLoadString::LoadKind::kRuntimeCall:
+      break;
   }
   return desired_string_load_kind;
 }
@@ -6083,11 +6092,17 @@ void LocationsBuilderX86::VisitLoadString(HLoadString* load) {
   LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(load, call_kind);
   HLoadString::LoadKind load_kind = load->GetLoadKind();
   if (load_kind == HLoadString::LoadKind::kDexCacheViaMethod ||
+      load_kind == HLoadString::LoadKind::kHashedDexCacheViaMethod ||
       load_kind == HLoadString::LoadKind::kBootImageLinkTimePcRelative ||
       load_kind == HLoadString::LoadKind::kDexCachePcRelative) {
     locations->SetInAt(0, Location::RequiresRegister());
   }
   locations->SetOut(Location::RequiresRegister());
+  if (load_kind == HLoadString::LoadKind::kHashedDexCacheViaMethod) {
+    // Receive the pair and its string index half.
+    locations->AddTemp(Location::RequiresFpuRegister());
+    locations->AddTemp(Location::RequiresRegister());
+  }
 }
 
 void InstructionCodeGeneratorX86::VisitLoadString(HLoadString* load) {
@@ -6145,6 +6160,48 @@ void InstructionCodeGeneratorX86::VisitLoadString(HLoadString* load) {
           load, out_loc, Address(out, CodeGenerator::GetCacheOffset(load->GetStringIndex())));
       break;
     }
+    case HLoadString::LoadKind::kHashedDexCacheViaMethod: {
+      DCHECK(!kEmitCompilerReadBarrier || kUseBakerReadBarrier);
+      Register current_method = locations->InAt(0).AsRegister<Register>();
+      XmmRegister pair = locations->GetTemp(0).AsFpuRegister<XmmRegister>();
+      Register temp = locations->GetTemp(1).AsRegister<Register>();
+      const uint32_t string_index = load->GetStringIndex();
+      const uint32_t offset = (string_index % mirror::DexCache::kDexCacheStringCacheSize) *
+          sizeof(mirror::StringDexCachePair);
+
+      // /* GcRoot<mirror::Class> */ out = current_method->declaring_class_
+      GenerateGcRootFieldLoad(
+          load, out_loc, Address(current_method, ArtMethod::DeclaringClassOffset().Int32Value()));
+      // /* mirror::StringDexCachePair[] */ out = out->dex_cache_strings_
+      __ movl(out, Address(out, mirror::Class::DexCacheStringsOffset().Int32Value()));
+      // The runtime writes pairs atomically, load out[offset] with a single movsd.
+      __ movsd(pair, Address(out, offset));
+      __ movd(out, pair);
+      __ psrlq(pair, Immediate(32));
+      __ movd(temp, pair);
+      SlowPathCode* slow_path = new (GetGraph()->GetArena()) LoadStringSlowPathX86(load);
+      codegen_->AddSlowPath(slow_path);
+      __ cmpl(temp, Immediate(string_index));
+      __ j(kNotEqual, slow_path->GetEntryLabel());
+      if (string_index == 0u) {
+        // Pairs start out as (null, 0), so the string may still be missing.
+        __ testl(out, out);
+        __ j(kEqual, slow_path->GetEntryLabel());
+      }
+      if (kEmitCompilerReadBarrier) {
+        // Mark the string of the pair, as GenerateGcRootFieldLoad() does after its load.
+        GenerateGcRootMarkWithBakerReadBarrier(load, out_loc);
+      }
+      __ Bind(slow_path->GetExitLabel());
+      return;
+    }
+    case HLoadString::LoadKind::kRuntimeCall: {
+      SlowPathCode* slow_path = new (GetGraph()->GetArena()) LoadStringSlowPathX86(load);
+      codegen_->AddSlowPath(slow_path);
+      __ jmp(slow_path->GetEntryLabel());
+      __ Bind(slow_path->GetExitLabel());
+      return;
+    }
     default:
       LOG(FATAL) << "Unexpected load kind: " << load->GetLoadKind();
       UNREACHABLE();
@@ -6872,15 +6929,7 @@ void InstructionCodeGeneratorX86::GenerateGcRootFieldLoad(HInstruction* instruct
                     "art::mirror::CompressedReference<mirror::Object> and int32_t "
                     "have different sizes.");
 
-      // Slow path used to mark the GC root `root`.
-      SlowPathCode* slow_path =
-          new (GetGraph()->GetArena()) ReadBarrierMarkSlowPathX86(instruction, root, root);
-      codegen_->AddSlowPath(slow_path);
-
-      __ fs()->cmpl(Address::Absolute(Thread::IsGcMarkingOffset<kX86WordSize>().Int32Value()),
-                    Immediate(0));
-      __ j(kNotEqual, slow_path->GetEntryLabel());
-      __ Bind(slow_path->GetExitLabel());
+      GenerateGcRootMarkWithBakerReadBarrier(instruction, root);
     } else {
       // GC root loaded through a slow path for read barriers other
       // than Baker's.
@@ -6904,6 +6953,22 @@ void InstructionCodeGeneratorX86::GenerateGcRootFieldLoad(HInstruction* instruct
   }
 }
 
+void InstructionCodeGeneratorX86::GenerateGcRootMarkWithBakerReadBarrier(HInstruction* instruction,
+                                                                         Location root) {
+  DCHECK(kEmitCompilerReadBarrier);
+  DCHECK(kUseBakerReadBarrier);
+
+  // Slow path used to mark the GC root `root`.
+  SlowPathCode* slow_path =
+      new (GetGraph()->GetArena()) ReadBarrierMarkSlowPathX86(instruction, root, root);
+  codegen_->AddSlowPath(slow_path);
+
+  __ fs()->cmpl(Address::Absolute(Thread::IsGcMarkingOffset<kX86WordSize>().Int32Value()),
+                Immediate(0));
+  __ j(kNotEqual, slow_path->GetEntryLabel());
+  __ Bind(slow_path->GetExitLabel());
+}
+
 void CodeGeneratorX86::GenerateFieldLoadWithBakerReadBarrier(HInstruction* instruction,
                                                              Location ref,
                                                              Register obj,
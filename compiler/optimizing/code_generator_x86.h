@@ -265,6 +265,9 @@ class InstructionCodeGeneratorX86 : public InstructionCodeGenerator {
                                Location root,
                                const Address& address,
                                Label* fixup_label = nullptr);
+  // Mark the GC root `root`, already loaded into its register, if the GC is marking. For Baker's
+  // read barriers only.
+  void GenerateGcRootMarkWithBakerReadBarrier(HInstruction* instruction, Location root);
 
   // Push value to FPU stack. `is_fp` specifies whether the value is floating point or not.
   // `is_wide` specifies whether it is long/double or not.
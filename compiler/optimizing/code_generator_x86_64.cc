@@ -5434,6 +5434,15 @@ HLoadString::LoadKind CodeGeneratorX86_64::GetSupportedLoadStringKind(
       break;
     case HLoadString::LoadKind::kDexCacheViaMethod:
       break;
+    case HLoadString::LoadKind::kHashedDexCacheViaMethod:
+      if (kEmitCompilerReadBarrier && !kUseBakerReadBarrier) {
+        // The slow path read barrier loads the root again, which may then belong to a newer pair
+        // than the one whose string index was checked.
+        return HLoadString::LoadKind::kRuntimeCall;
+      }
+      break;
+    case HLoadString::LoadKind::kRuntimeCall:
+      break;
   }
   return desired_string_load_kind;
 }
@@ -5443,10 +5452,15 @@ void LocationsBuilderX86_64::VisitLoadString(HLoadString* load) {
       ? LocationSummary::kCallOnSlowPath
       : LocationSummary::kNoCall;
   LocationSummary* locations = new (GetGraph()->GetArena()) LocationSummary(load, call_kind);
-  if (load->GetLoadKind() == HLoadString::LoadKind::kDexCacheViaMethod) {
+  if (load->GetLoadKind() == HLoadString::LoadKind::kDexCacheViaMethod ||
+      load->GetLoadKind() == HLoadString::LoadKind::kHashedDexCacheViaMethod) {
     locations->SetInAt(0, Location::RequiresRegister());
   }
   locations->SetOut(Location::RequiresRegister());
+  if (load->GetLoadKind() == HLoadString::LoadKind::kHashedDexCacheViaMethod) {
+    // Receives the pair.
+    locations->AddTemp(Location::RequiresRegister());
+  }
 }
 
 void InstructionCodeGeneratorX86_64::VisitLoadString(HLoadString* load) {
@@ -5502,6 +5516,46 @@ void InstructionCodeGeneratorX86_64::VisitLoadString(HLoadString* load) {
           load, out_loc, Address(out, CodeGenerator::GetCacheOffset(load->GetStringIndex())));
       break;
     }
+    case HLoadString::LoadKind::kHashedDexCacheViaMethod: {
+      DCHECK(!kEmitCompilerReadBarrier || kUseBakerReadBarrier);
+      CpuRegister current_method = locations->InAt(0).AsRegister<CpuRegister>();
+      CpuRegister pair = locations->GetTemp(0).AsRegister<CpuRegister>();
+      const uint32_t string_index = load->GetStringIndex();
+      const uint32_t offset = (string_index % mirror::DexCache::kDexCacheStringCacheSize) *
+          sizeof(mirror::StringDexCachePair);
+
+      // /* GcRoot<mirror::Class> */ out = current_method->declaring_class_
+      GenerateGcRootFieldLoad(
+          load, out_loc, Address(current_method, ArtMethod::DeclaringClassOffset().Int32Value()));
+      // /* mirror::StringDexCachePair[] */ out = out->dex_cache_strings_
+      __ movq(out, Address(out, mirror::Class::DexCacheStringsOffset().Uint32Value()));
+      // The runtime writes pairs atomically, load out[offset] with a single movq.
+      __ movq(pair, Address(out, offset));
+      __ movl(out, pair);  // Zero-extended.
+      __ shrq(pair, Immediate(32));
+      SlowPathCode* slow_path = new (GetGraph()->GetArena()) LoadStringSlowPathX86_64(load);
+      codegen_->AddSlowPath(slow_path);
+      __ cmpl(pair, Immediate(string_index));
+      __ j(kNotEqual, slow_path->GetEntryLabel());
+      if (string_index == 0u) {
+        // Pairs start out as (null, 0), so the string may still be missing.
+        __ testl(out, out);
+        __ j(kEqual, slow_path->GetEntryLabel());
+      }
+      if (kEmitCompilerReadBarrier) {
+        // Mark the string of the pair, as GenerateGcRootFieldLoad() does after its load.
+        GenerateGcRootMarkWithBakerReadBarrier(load, out_loc);
+      }
+      __ Bind(slow_path->GetExitLabel());
+      return;
+    }
+    case HLoadString::LoadKind::kRuntimeCall: {
+      SlowPathCode* slow_path = new (GetGraph()->GetArena()) LoadStringSlowPathX86_64(load);
+      codegen_->AddSlowPath(slow_path);
+      __ jmp(slow_path->GetEntryLabel());
+      __ Bind(slow_path->GetExitLabel());
+      return;
+    }
     default:
       LOG(FATAL) << "Unexpected load kind: " << load->GetLoadKind();
       UNREACHABLE();
@@ -6270,16 +6324,7 @@ void InstructionCodeGeneratorX86_64::GenerateGcRootFieldLoad(HInstruction* instr
                     "art::mirror::CompressedReference<mirror::Object> and int32_t "
                     "have different sizes.");
 
-      // Slow path used to mark the GC root `root`.
-      SlowPathCode* slow_path =
-          new (GetGraph()->GetArena()) ReadBarrierMarkSlowPathX86_64(instruction, root, root);
-      codegen_->AddSlowPath(slow_path);
-
-      __ gs()->cmpl(Address::Absolute(Thread::IsGcMarkingOffset<kX86_64WordSize>().Int32Value(),
-                                      /* no_rip */ true),
-                    Immediate(0));
-      __ j(kNotEqual, slow_path->GetEntryLabel());
-      __ Bind(slow_path->GetExitLabel());
+      GenerateGcRootMarkWithBakerReadBarrier(instruction, root);
     } else {
       // GC root loaded through a slow path for read barriers other
       // than Baker's.
@@ -6303,6 +6348,23 @@ void InstructionCodeGeneratorX86_64::GenerateGcRootFieldLoad(HInstruction* instr
   }
 }
 
+void InstructionCodeGeneratorX86_64::GenerateGcRootMarkWithBakerReadBarrier(
+    HInstruction* instruction, Location root) {
+  DCHECK(kEmitCompilerReadBarrier);
+  DCHECK(kUseBakerReadBarrier);
+
+  // Slow path used to mark the GC root `root`.
+  SlowPathCode* slow_path =
+      new (GetGraph()->GetArena()) ReadBarrierMarkSlowPathX86_64(instruction, root, root);
+  codegen_->AddSlowPath(slow_path);
+
+  __ gs()->cmpl(Address::Absolute(Thread::IsGcMarkingOffset<kX86_64WordSize>().Int32Value(),
+                                  /* no_rip */ true),
+                Immediate(0));
+  __ j(kNotEqual, slow_path->GetEntryLabel());
+  __ Bind(slow_path->GetExitLabel());
+}
+
 void CodeGeneratorX86_64::GenerateFieldLoadWithBakerReadBarrier(HInstruction* instruction,
                                                                 Location ref,
                                                                 CpuRegister obj,
@@ -260,6 +260,9 @@ class InstructionCodeGeneratorX86_64 : public InstructionCodeGenerator {
                                Location root,
                                const Address& address,
                                Label* fixup_label = nullptr);
+  // Mark the GC root `root`, already loaded into its register, if the GC is marking. For Baker's
+  // read barriers only.
+  void GenerateGcRootMarkWithBakerReadBarrier(HInstruction* instruction, Location root);
 
   void PushOntoFPStack(Location source, uint32_t temp_offset,
                        uint32_t stack_adjustment, bool is_float);
@@ -185,6 +185,37 @@ static ArtMethod* FindVirtualOrInterfaceTarget(HInvoke* invoke, ArtMethod* resol
   }
 }
 
+/**
+ * Given the `resolved_method` of a virtual call, find the method the call
+ * resolves to for the static type of the receiver, if class hierarchy
+ * analysis found that no loaded class overrides it.
+ * Return nullptr otherwise.
+ */
+static ArtMethod* FindSingleImplementationTarget(HInvoke* invoke, ArtMethod* resolved_method)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  DCHECK(invoke->IsInvokeVirtual());
+  HInstruction* receiver = invoke->InputAt(0);
+  if (receiver->IsNullCheck()) {
+    receiver = receiver->InputAt(0);
+  }
+  ReferenceTypeInfo info = receiver->GetReferenceTypeInfo();
+  DCHECK(info.IsValid()) << "Invalid RTI for " << receiver->DebugName();
+  mirror::Class* receiver_class = info.GetTypeHandle().Get();
+  if (receiver_class->IsInterface() ||
+      receiver_class->IsErroneous() ||
+      !receiver_class->IsResolved() ||
+      !resolved_method->GetDeclaringClass()->IsAssignableFrom(receiver_class)) {
+    return nullptr;
+  }
+
+  size_t pointer_size = Runtime::Current()->GetClassLinker()->GetImagePointerSize();
+  ArtMethod* target = receiver_class->FindVirtualMethodForVirtual(resolved_method, pointer_size);
+  if (target == nullptr || !target->IsInvokable() || !target->HasSingleImplementation()) {
+    return nullptr;
+  }
+  return target;
+}
+
 static uint32_t FindClassIndexIn(mirror::Class* cls,
                                  const DexFile& dex_file,
                                  Handle<mirror::DexCache> dex_cache)
@@ -327,12 +358,17 @@ bool HInliner::TryInline(HInvoke* invoke_instruction) {
         return TryInlinePolymorphicCall(invoke_instruction, resolved_method, ic);
       } else {
         DCHECK(ic.IsMegamorphic());
+        MaybeRecordStat(kMegamorphicCall);
+        if (TryInlineFromCHA(invoke_instruction, resolved_method)) {
+          return true;
+        }
         VLOG(compiler) << "Interface or virtual call to "
                        << PrettyMethod(method_index, caller_dex_file)
                        << " is megamorphic and not inlined";
-        MaybeRecordStat(kMegamorphicCall);
         return false;
       }
+    } else if (TryInlineFromCHA(invoke_instruction, resolved_method)) {
+      return true;
     }
   }
 
@@ -682,6 +718,27 @@ bool HInliner::TryInlinePolymorphicCallToSameTarget(HInvoke* invoke_instruction,
   }
 
   // We successfully inlined, now add a guard.
+  AddMethodTableGuard(receiver,
+                      cursor,
+                      bb_cursor,
+                      actual_method,
+                      method_index,
+                      invoke_instruction,
+                      return_replacement);
+
+  MaybeRecordStat(kInlinedPolymorphicCall);
+
+  return true;
+}
+
+void HInliner::AddMethodTableGuard(HInstruction* receiver,
+                                   HInstruction* cursor,
+                                   HBasicBlock* bb_cursor,
+                                   ArtMethod* actual_method,
+                                   size_t method_index,
+                                   HInvoke* invoke_instruction,
+                                   HInstruction* return_replacement) {
+  ClassLinker* class_linker = caller_compilation_unit_.GetClassLinker();
   HInstanceFieldGet* receiver_class = BuildGetReceiverClass(
       class_linker, receiver, invoke_instruction->GetDexPc());
 
@@ -734,8 +791,44 @@ bool HInliner::TryInlinePolymorphicCallToSameTarget(HInvoke* invoke_instruction,
                                      handles_,
                                      /* is_first_run */ false);
   rtp_fixup.Run();
+}
 
-  MaybeRecordStat(kInlinedPolymorphicCall);
+bool HInliner::TryInlineFromCHA(HInvoke* invoke_instruction, ArtMethod* resolved_method) {
+  // This optimization only works under JIT for now, as only the JIT code cache
+  // can invalidate compiled code when a class breaking the assumption gets loaded.
+  DCHECK(Runtime::Current()->UseJitCompilation());
+  if (!invoke_instruction->IsInvokeVirtual() || graph_->GetInstructionSet() == kMips64) {
+    // TODO: Support HClassTableGet for mips64.
+    return false;
+  }
+
+  ArtMethod* single_implementation = FindSingleImplementationTarget(invoke_instruction,
+                                                                   resolved_method);
+  if (single_implementation == nullptr) {
+    return false;
+  }
+
+  HInstruction* receiver = invoke_instruction->InputAt(0);
+  HInstruction* cursor = invoke_instruction->GetPrevious();
+  HBasicBlock* bb_cursor = invoke_instruction->GetBlock();
+
+  HInstruction* return_replacement = nullptr;
+  if (!TryBuildAndInline(invoke_instruction, single_implementation, &return_replacement)) {
+    return false;
+  }
+
+  // The guard keeps the code correct until it gets invalidated, including for frames
+  // already executing it when a class overriding `single_implementation` gets loaded.
+  AddMethodTableGuard(receiver,
+                      cursor,
+                      bb_cursor,
+                      single_implementation,
+                      invoke_instruction->AsInvokeVirtual()->GetVTableIndex(),
+                      invoke_instruction,
+                      return_replacement);
+  outermost_graph_->AddCHASingleImplementationDependency(single_implementation);
+
+  MaybeRecordStat(kInlinedCHA);
 
   return true;
 }
@@ -118,6 +118,26 @@ class HInliner : public HOptimization {
                                             const InlineCache& ic)
     SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Try to inline the single implementation class hierarchy analysis found for
+  // the target of a virtual call. If successful, the code in the graph will look like:
+  // if (receiver.getClass().vtable[index] != single_implementation) deopt
+  // ... // inlined code
+  bool TryInlineFromCHA(HInvoke* invoke_instruction, ArtMethod* resolved_method)
+    SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Add a guard checking that the entry `method_index` of the vtable or IMT of the
+  // receiver's class is `actual_method`, deoptimizing (or, for OSR, calling
+  // `invoke_instruction`) if it is not, and remove `invoke_instruction` in favor of
+  // the inlined code.
+  void AddMethodTableGuard(HInstruction* receiver,
+                           HInstruction* cursor,
+                           HBasicBlock* bb_cursor,
+                           ArtMethod* actual_method,
+                           size_t method_index,
+                           HInvoke* invoke_instruction,
+                           HInstruction* return_replacement)
+    SHARED_REQUIRES(Locks::mutator_lock_);
+
 
   HInstanceFieldGet* BuildGetReceiverClass(ClassLinker* class_linker,
                                            HInstruction* receiver,
@@ -1209,6 +1209,9 @@ void IntrinsicLocationsBuilderARM64::VisitStringEquals(HInvoke* invoke) {
   // Temporary registers to store lengths of strings and for calculations.
   locations->AddTemp(Location::RequiresRegister());
   locations->AddTemp(Location::RequiresRegister());
+  // Temporary registers for the NEON comparison loop.
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
 
   locations->SetOut(Location::RequiresRegister(), Location::kOutputOverlap);
 }
@@ -1225,7 +1228,11 @@ void IntrinsicCodeGeneratorARM64::VisitStringEquals(HInvoke* invoke) {
   Register temp = scratch_scope.AcquireW();
   Register temp1 = WRegisterFrom(locations->GetTemp(0));
   Register temp2 = WRegisterFrom(locations->GetTemp(1));
+  FPRegister str_chars = DRegisterFrom(locations->GetTemp(2));
+  FPRegister arg_chars = DRegisterFrom(locations->GetTemp(3));
 
+  vixl::Label neon_loop;
+  vixl::Label remaining_chars;
   vixl::Label loop;
   vixl::Label end;
   vixl::Label return_true;
@@ -1273,7 +1280,25 @@ void IntrinsicCodeGeneratorARM64::VisitStringEquals(HInvoke* invoke) {
   temp1 = temp1.X();
   temp2 = temp2.X();
 
-  // Loop to compare strings 4 characters at a time starting at the beginning of the string.
+  // Loop to compare strings 8 characters at a time while at least 8 characters remain.
+  __ Bind(&neon_loop);
+  __ Cmp(temp, 8);
+  __ B(&remaining_chars, lt);
+  __ Ldr(str_chars.Q(), MemOperand(str.X(), temp1));
+  __ Ldr(arg_chars.Q(), MemOperand(arg.X(), temp1));
+  __ Add(temp1, temp1, Operand(2 * sizeof(uint64_t)));
+  __ Eor(str_chars.V16B(), str_chars.V16B(), arg_chars.V16B());
+  // The highest difference between characters is zero only if all characters are equal.
+  __ Umaxv(str_chars.H(), str_chars.V8H());
+  __ Fmov(temp2.W(), str_chars.S());
+  __ Cbnz(temp2.W(), &return_false);
+  __ Sub(temp, temp, Operand(8));
+  __ B(&neon_loop);
+
+  __ Bind(&remaining_chars);
+  __ Cbz(temp, &return_true);
+
+  // Loop to compare the remaining characters 4 at a time.
   // Ok to do this because strings are zero-padded to be 8-byte aligned.
   __ Bind(&loop);
   __ Ldr(out, MemOperand(str.X(), temp1));
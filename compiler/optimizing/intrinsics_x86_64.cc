@@ -1394,6 +1394,10 @@ void IntrinsicLocationsBuilderX86_64::VisitStringEquals(HInvoke* invoke) {
   // Request temporary registers, RCX and RDI needed for repe_cmpsq instruction.
   locations->AddTemp(Location::RegisterLocation(RCX));
   locations->AddTemp(Location::RegisterLocation(RDI));
+  // Temporary registers for the SSE2 comparison loop.
+  locations->AddTemp(Location::RequiresRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
+  locations->AddTemp(Location::RequiresFpuRegister());
 
   // Set output, RSI needed for repe_cmpsq instruction anyways.
   locations->SetOut(Location::RegisterLocation(RSI), Location::kOutputOverlap);
@@ -1408,8 +1412,11 @@ void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
   CpuRegister rcx = locations->GetTemp(0).AsRegister<CpuRegister>();
   CpuRegister rdi = locations->GetTemp(1).AsRegister<CpuRegister>();
   CpuRegister rsi = locations->Out().AsRegister<CpuRegister>();
+  CpuRegister mask = locations->GetTemp(2).AsRegister<CpuRegister>();
+  XmmRegister str_chars = locations->GetTemp(3).AsFpuRegister<XmmRegister>();
+  XmmRegister arg_chars = locations->GetTemp(4).AsFpuRegister<XmmRegister>();
 
-  NearLabel end, return_true, return_false;
+  NearLabel end, return_true, return_false, sse_loop, remaining_chars;
 
   // Get offsets of count, value, and class fields within a string object.
   const uint32_t count_offset = mirror::String::CountOffset().Uint32Value();
@@ -1447,6 +1454,27 @@ void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
   __ leal(rsi, Address(str, value_offset));
   __ leal(rdi, Address(arg, value_offset));
 
+  // Compare strings eight characters at a time while at least eight characters remain.
+  // The loads are unaligned, and never go past the end of the strings.
+  __ Bind(&sse_loop);
+  __ cmpl(rcx, Immediate(8));
+  __ j(kLess, &remaining_chars);
+  __ movdqu(str_chars, Address(rsi, 0));
+  __ movdqu(arg_chars, Address(rdi, 0));
+  __ pcmpeqb(str_chars, arg_chars);
+  __ pmovmskb(mask, str_chars);
+  // All sixteen bytes are equal if all the bits of the mask are set.
+  __ cmpl(mask, Immediate(0xFFFF));
+  __ j(kNotEqual, &return_false);
+  __ addq(rsi, Immediate(16));
+  __ addq(rdi, Immediate(16));
+  __ subl(rcx, Immediate(8));
+  __ jmp(&sse_loop);
+
+  __ Bind(&remaining_chars);
+  // Return true if all the characters have been compared.
+  __ jrcxz(&return_true);
+
   // Divide string length by 4 and adjust for lengths not divisible by 4.
   __ addl(rcx, Immediate(3));
   __ shrl(rcx, Immediate(2));
@@ -1455,7 +1483,7 @@ void IntrinsicCodeGeneratorX86_64::VisitStringEquals(HInvoke* invoke) {
   DCHECK_ALIGNED(value_offset, 8);
   static_assert(IsAligned<8>(kObjectAlignment), "String is not zero padded");
 
-  // Loop to compare strings four characters at a time starting at the beginning of the string.
+  // Loop to compare the remaining characters four at a time.
   __ repe_cmpsq();
   // If strings are not equal, zero flag will be cleared.
   __ j(kNotEqual, &return_false);
@@ -243,4 +243,24 @@ TEST_F(LinearizeTest, CFG7) {
   TestCode(data, blocks);
 }
 
+TEST_F(LinearizeTest, ThrowingBlockLast) {
+  // Structure of this graph (* is a throwing block)
+  //            Block0
+  //              |
+  //            Block1
+  //      false /    \ true
+  //       Block2*  Block3
+  //            \    /
+  //            Block4
+  //
+  const uint16_t data[] = ONE_REGISTER_CODE_ITEM(
+    Instruction::CONST_4 | 0 | 0,
+    Instruction::IF_EQZ, 3,
+    Instruction::THROW,
+    Instruction::RETURN_VOID);
+
+  const uint32_t blocks[] = {0, 1, 3, 2, 4};
+  TestCode(data, blocks);
+}
+
 }  // namespace art
@@ -312,7 +312,8 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
         cached_double_constants_(std::less<int64_t>(), arena->Adapter(kArenaAllocConstantsMap)),
         cached_current_method_(nullptr),
         inexact_object_rti_(ReferenceTypeInfo::CreateInvalid()),
-        osr_(osr) {
+        osr_(osr),
+        cha_single_implementation_list_(arena->Adapter(kArenaAllocGraph)) {
     blocks_.reserve(kDefaultNumberOfBlocks);
   }
 
@@ -502,6 +503,19 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
 
   bool IsCompilingOsr() const { return osr_; }
 
+  // Methods the compiled code assumes are not overridden, see HInliner::TryInlineFromCHA.
+  const ArenaVector<ArtMethod*>& GetCHASingleImplementationList() const {
+    return cha_single_implementation_list_;
+  }
+
+  void AddCHASingleImplementationDependency(ArtMethod* method) {
+    if (std::find(cha_single_implementation_list_.begin(),
+                  cha_single_implementation_list_.end(),
+                  method) == cha_single_implementation_list_.end()) {
+      cha_single_implementation_list_.push_back(method);
+    }
+  }
+
   bool HasTryCatch() const { return has_try_catch_; }
   void SetHasTryCatch(bool value) { has_try_catch_ = value; }
 
@@ -637,6 +651,10 @@ class HGraph : public ArenaObject<kArenaAllocGraph> {
   // compiled code entries which the interpreter can directly jump to.
   const bool osr_;
 
+  // Methods found by class hierarchy analysis to have a single implementation, and that
+  // the compiled code relies on not being overridden.
+  ArenaVector<ArtMethod*> cha_single_implementation_list_;
+
   friend class SsaBuilder;           // For caching constants.
   friend class SsaLivenessAnalysis;  // For the linear order.
   friend class HInliner;             // For the reverse post order.
@@ -5510,7 +5528,17 @@ class HLoadString : public HExpression<1> {
     // all other types are unavailable.
     kDexCacheViaMethod,
 
-    kLast = kDexCacheViaMethod
+    // Load from the hash-indexed strings array accessed through the class loaded from
+    // the compiled method's own ArtMethod*, see mirror::DexCache::HasHashedStrings().
+    // Used for strings outside the boot image of dex files with such an array. The string
+    // is resolved with a runtime call if its pair holds another string index.
+    kHashedDexCacheViaMethod,
+
+    // Resolve the string with a runtime call. Used instead of kHashedDexCacheViaMethod
+    // by codegens that cannot load a string pair atomically.
+    kRuntimeCall,
+
+    kLast = kRuntimeCall
   };
 
   HLoadString(HCurrentMethod* current_method,
@@ -5586,7 +5614,8 @@ class HLoadString : public HExpression<1> {
   }
 
   bool NeedsDexCacheOfDeclaringClass() const OVERRIDE {
-    return GetLoadKind() == LoadKind::kDexCacheViaMethod;
+    return GetLoadKind() == LoadKind::kDexCacheViaMethod ||
+        GetLoadKind() == LoadKind::kHashedDexCacheViaMethod;
   }
 
   bool CanBeNull() const OVERRIDE { return false; }
@@ -5625,7 +5654,9 @@ class HLoadString : public HExpression<1> {
   static bool HasStringReference(LoadKind load_kind) {
     return load_kind == LoadKind::kBootImageLinkTimeAddress ||
         load_kind == LoadKind::kBootImageLinkTimePcRelative ||
-        load_kind == LoadKind::kDexCacheViaMethod;
+        load_kind == LoadKind::kDexCacheViaMethod ||
+        load_kind == LoadKind::kHashedDexCacheViaMethod ||
+        load_kind == LoadKind::kRuntimeCall;
   }
 
   static bool HasAddress(LoadKind load_kind) {
@@ -73,6 +73,7 @@
 #include "prepare_for_register_allocation.h"
 #include "reference_type_propagation.h"
 #include "register_allocator.h"
+#include "scheduler.h"
 #include "select_generator.h"
 #include "sharpening.h"
 #include "side_effects_analysis.h"
@@ -427,6 +428,7 @@ static void MaybeRunInliner(HGraph* graph,
 }
 
 static void RunArchOptimizations(InstructionSet instruction_set,
+                                 const InstructionSetFeatures* features,
                                  HGraph* graph,
                                  CodeGenerator* codegen,
                                  OptimizingCompilerStats* stats,
@@ -453,10 +455,13 @@ static void RunArchOptimizations(InstructionSet instruction_set,
           new (arena) arm64::InstructionSimplifierArm64(graph, stats);
       SideEffectsAnalysis* side_effects = new (arena) SideEffectsAnalysis(graph);
       GVNOptimization* gvn = new (arena) GVNOptimization(graph, *side_effects, "GVN_after_arch");
+      HInstructionScheduling* scheduling =
+          new (arena) HInstructionScheduling(graph, instruction_set, features);
       HOptimization* arm64_optimizations[] = {
         simplifier,
         side_effects,
-        gvn
+        gvn,
+        scheduling
       };
       RunOptimizations(arm64_optimizations, arraysize(arm64_optimizations), pass_observer);
       break;
@@ -472,16 +477,46 @@ static void RunArchOptimizations(InstructionSet instruction_set,
       RunOptimizations(x86_optimizations, arraysize(x86_optimizations), pass_observer);
       break;
     }
+#endif
+#ifdef ART_ENABLE_CODEGEN_x86_64
+    case kX86_64: {
+      HInstructionScheduling* scheduling =
+          new (arena) HInstructionScheduling(graph, instruction_set, features);
+      HOptimization* x86_64_optimizations[] = {
+          scheduling
+      };
+      RunOptimizations(x86_64_optimizations, arraysize(x86_64_optimizations), pass_observer);
+      break;
+    }
 #endif
     default:
       break;
   }
 }
 
+static RegisterAllocator::Strategy GetRegisterAllocationStrategy(
+    CompilerDriver* driver,
+    const DexCompilationUnit& dex_compilation_unit) {
+  RegisterAllocator::Strategy strategy =
+      driver->GetCompilerOptions().GetRegisterAllocationStrategy();
+  if (strategy == RegisterAllocator::kRegisterAllocatorAdaptive) {
+    // Only spend more compile time on hot methods. The JIT only compiles hot
+    // methods, the AOT compiler knows them from the profile.
+    bool is_hot = !Runtime::Current()->IsAotCompiler() ||
+        driver->IsMethodInProfile(MethodReference(dex_compilation_unit.GetDexFile(),
+                                                  dex_compilation_unit.GetDexMethodIndex()));
+    if (!is_hot) {
+      return RegisterAllocator::kRegisterAllocatorLinearScan;
+    }
+  }
+  return strategy;
+}
+
 NO_INLINE  // Avoid increasing caller's frame size by large stack-allocated objects.
 static void AllocateRegisters(HGraph* graph,
                               CodeGenerator* codegen,
-                              PassObserver* pass_observer) {
+                              PassObserver* pass_observer,
+                              RegisterAllocator::Strategy strategy) {
   {
     PassScope scope(PrepareForRegisterAllocation::kPrepareForRegisterAllocationPassName,
                     pass_observer);
@@ -494,7 +529,7 @@ static void AllocateRegisters(HGraph* graph,
   }
   {
     PassScope scope(RegisterAllocator::kRegisterAllocatorPassName, pass_observer);
-    RegisterAllocator(graph->GetArena(), codegen, liveness).AllocateRegisters();
+    RegisterAllocator(graph->GetArena(), codegen, liveness, strategy).AllocateRegisters();
   }
 }
 
@@ -560,8 +595,16 @@ static void RunOptimizations(HGraph* graph,
   };
   RunOptimizations(optimizations2, arraysize(optimizations2), pass_observer);
 
-  RunArchOptimizations(driver->GetInstructionSet(), graph, codegen, stats, pass_observer);
-  AllocateRegisters(graph, codegen, pass_observer);
+  RunArchOptimizations(driver->GetInstructionSet(),
+                       driver->GetInstructionSetFeatures(),
+                       graph,
+                       codegen,
+                       stats,
+                       pass_observer);
+  AllocateRegisters(graph,
+                    codegen,
+                    pass_observer,
+                    GetRegisterAllocationStrategy(driver, dex_compilation_unit));
 }
 
 static ArenaVector<LinkerPatch> EmitAndSortLinkerPatches(CodeGenerator* codegen) {
@@ -945,6 +988,17 @@ bool OptimizingCompiler::JitCompile(Thread* self,
     return false;
   }
 
+  // Classes overriding the methods the code was compiled assuming had a single
+  // implementation may have been linked while compiling.
+  const auto* committed_header = reinterpret_cast<const OatQuickMethodHeader*>(code);
+  for (ArtMethod* single_implementation : codegen->GetGraph()->GetCHASingleImplementationList()) {
+    if (!code_cache->AddSingleImplementationDependency(
+            self, single_implementation, method, committed_header)) {
+      code_cache->InvalidateCompiledCodeFor(method, committed_header);
+      break;
+    }
+  }
+
   const CompilerOptions& compiler_options = GetCompilerDriver()->GetCompilerOptions();
   if (compiler_options.GetGenerateDebugInfo()) {
     const auto* method_header = reinterpret_cast<const OatQuickMethodHeader*>(code);
@@ -17,8 +17,10 @@
 #include "register_allocator.h"
 
 #include <iostream>
+#include <limits>
 #include <sstream>
 
+#include "base/bit_utils.h"
 #include "base/bit_vector-inl.h"
 #include "code_generator.h"
 #include "ssa_liveness_analysis.h"
@@ -39,10 +41,12 @@ static bool IsLowOfUnalignedPairInterval(LiveInterval* low) {
 
 RegisterAllocator::RegisterAllocator(ArenaAllocator* allocator,
                                      CodeGenerator* codegen,
-                                     const SsaLivenessAnalysis& liveness)
+                                     const SsaLivenessAnalysis& liveness,
+                                     Strategy strategy)
       : allocator_(allocator),
         codegen_(codegen),
         liveness_(liveness),
+        strategy_(strategy),
         unhandled_core_intervals_(allocator->Adapter(kArenaAllocRegisterAllocator)),
         unhandled_fp_intervals_(allocator->Adapter(kArenaAllocRegisterAllocator)),
         unhandled_(nullptr),
@@ -193,16 +197,20 @@ void RegisterAllocator::AllocateRegistersInternal() {
                                                     kArenaAllocRegisterAllocator);
   processing_core_registers_ = true;
   unhandled_ = &unhandled_core_intervals_;
-  for (LiveInterval* fixed : physical_core_register_intervals_) {
-    if (fixed != nullptr) {
-      // Fixed interval is added to inactive_ instead of unhandled_.
-      // It's also the only type of inactive interval whose start position
-      // can be after the current interval during linear scan.
-      // Fixed interval is never split and never moves to unhandled_.
-      inactive_.push_back(fixed);
+  if (ShouldUseGraphColoring()) {
+    GraphColorScan();
+  } else {
+    for (LiveInterval* fixed : physical_core_register_intervals_) {
+      if (fixed != nullptr) {
+        // Fixed interval is added to inactive_ instead of unhandled_.
+        // It's also the only type of inactive interval whose start position
+        // can be after the current interval during linear scan.
+        // Fixed interval is never split and never moves to unhandled_.
+        inactive_.push_back(fixed);
+      }
     }
+    LinearScan();
   }
-  LinearScan();
 
   inactive_.clear();
   active_.clear();
@@ -213,16 +221,20 @@ void RegisterAllocator::AllocateRegistersInternal() {
                                                     kArenaAllocRegisterAllocator);
   processing_core_registers_ = false;
   unhandled_ = &unhandled_fp_intervals_;
-  for (LiveInterval* fixed : physical_fp_register_intervals_) {
-    if (fixed != nullptr) {
-      // Fixed interval is added to inactive_ instead of unhandled_.
-      // It's also the only type of inactive interval whose start position
-      // can be after the current interval during linear scan.
-      // Fixed interval is never split and never moves to unhandled_.
-      inactive_.push_back(fixed);
+  if (ShouldUseGraphColoring()) {
+    GraphColorScan();
+  } else {
+    for (LiveInterval* fixed : physical_fp_register_intervals_) {
+      if (fixed != nullptr) {
+        // Fixed interval is added to inactive_ instead of unhandled_.
+        // It's also the only type of inactive interval whose start position
+        // can be after the current interval during linear scan.
+        // Fixed interval is never split and never moves to unhandled_.
+        inactive_.push_back(fixed);
+      }
     }
+    LinearScan();
   }
-  LinearScan();
 }
 
 void RegisterAllocator::ProcessInstruction(HInstruction* instruction) {
@@ -1169,6 +1181,558 @@ bool RegisterAllocator::AllocateBlockedReg(LiveInterval* current) {
   }
 }
 
+// Graph coloring strategy.
+//
+// Unlike linear scan, which splits intervals on the fly, the graph coloring strategy
+// colors whole intervals: an interval either gets one register for all of its
+// lifetime, or is spilled. The interference graph has a node per interval of the
+// register kind being processed, and an edge between two intervals that are live at
+// the same position. Fixed intervals, and intervals whose register is imposed by the
+// location summary, are precolored: they are not part of the graph, but remove their
+// register from the ones available to the intervals they intersect.
+//
+// Nodes are removed from the graph in the order of Chaitin and Briggs: trivially
+// colorable nodes first, then the node that is the cheapest to spill. Registers are
+// then assigned in the reverse order, using the hints linear scan uses to avoid moves.
+// When a node cannot be colored, its interval is given a spill slot and short siblings
+// are split off around its register uses. These siblings cannot be spilled anymore:
+// if they cannot be colored, the cheapest colored neighbors are evicted instead. The
+// whole graph is colored again until no interval is left to spill.
+
+// Compile-time budget of the adaptive strategy: above this number of intervals of a
+// register kind, building and coloring the interference graph is not worth it.
+static constexpr size_t kMaxGraphColoringIntervals = 1024;
+
+// Uses deeper in a loop nest than this do not make an interval more expensive to spill.
+static constexpr size_t kMaxLoopDepthForSpillWeight = 4;
+
+static constexpr float kInfiniteSpillWeight = std::numeric_limits<float>::max();
+
+static float ComputeSpillWeight(LiveInterval* interval, bool must_have_register) {
+  if (must_have_register || interval->IsTemp()) {
+    return kInfiniteSpillWeight;
+  }
+  size_t start = interval->GetStart();
+  size_t end = interval->GetEnd();
+  float use_weight = 1.0f;  // For the definition or the reload at the start of the interval.
+  for (UsePosition* use = interval->GetFirstUse();
+       use != nullptr && use->GetPosition() <= end;
+       use = use->GetNext()) {
+    if (use->GetPosition() < start || use->IsSynthesized()) {
+      continue;
+    }
+    // A use in a loop is executed more often: weight it by the loop depth.
+    float weight = 1.0f;
+    size_t depth = 0;
+    for (HLoopInformationOutwardIterator it(*use->GetUser()->GetBlock());
+         !it.Done() && depth < kMaxLoopDepthForSpillWeight;
+         it.Advance()) {
+      weight *= 10.0f;
+      ++depth;
+    }
+    use_weight += weight;
+  }
+  return use_weight / static_cast<float>(end - start);
+}
+
+// Returns the first position where both `first` and `second` are live, or
+// `kNoLifetime` if they do not intersect. Unlike `LiveInterval::FirstIntersectionWith`,
+// this does not depend on the linear scan search cache.
+static size_t FirstIntersection(LiveInterval* first, LiveInterval* second) {
+  LiveRange* first_range = first->GetFirstRange();
+  LiveRange* second_range = second->GetFirstRange();
+  while (first_range != nullptr && second_range != nullptr) {
+    if (first_range->IsBefore(*second_range)) {
+      first_range = first_range->GetNext();
+    } else if (second_range->IsBefore(*first_range)) {
+      second_range = second_range->GetNext();
+    } else {
+      return std::max(first_range->GetStart(), second_range->GetStart());
+    }
+  }
+  return kNoLifetime;
+}
+
+// Returns whether `interval` intersects one of `ranges`, which are sorted and disjoint.
+static bool IntersectsAny(LiveInterval* interval, const ArenaVector<LiveRange*>& ranges) {
+  for (LiveRange* range = interval->GetFirstRange(); range != nullptr; range = range->GetNext()) {
+    // Find the first range that ends after the start of `range`.
+    auto it = std::upper_bound(ranges.begin(),
+                               ranges.end(),
+                               range->GetStart(),
+                               [](size_t position, LiveRange* other) {
+                                 return position < other->GetEnd();
+                               });
+    if (it != ranges.end() && (*it)->GetStart() < range->GetEnd()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// A node of the interference graph, standing for a live interval.
+class InterferenceNode : public ArenaObject<kArenaAllocRegisterAllocator> {
+ public:
+  InterferenceNode(ArenaAllocator* allocator, LiveInterval* interval, bool must_have_register)
+      : interval_(interval),
+        adjacent_nodes_(allocator->Adapter(kArenaAllocRegisterAllocator)),
+        is_precolored_(interval->HasRegister()),
+        spill_weight_(ComputeSpillWeight(interval, must_have_register)),
+        excluded_registers_(0u),
+        degree_(0u),
+        in_graph_(false),
+        is_spilled_(false) {}
+
+  LiveInterval* GetInterval() const { return interval_; }
+  const ArenaVector<InterferenceNode*>& GetAdjacentNodes() const { return adjacent_nodes_; }
+
+  bool IsPrecolored() const { return is_precolored_; }
+  float GetSpillWeight() const { return spill_weight_; }
+  bool MustHaveRegister() const { return spill_weight_ == kInfiniteSpillWeight; }
+
+  // Registers held by fixed or precolored intervals live at the same time as this node.
+  uint64_t GetExcludedRegisters() const { return excluded_registers_; }
+  void ExcludeRegister(int reg) { excluded_registers_ |= UINT64_C(1) << reg; }
+
+  // Number of adjacent nodes still in the graph.
+  size_t GetDegree() const { return degree_; }
+  void DecrementDegree() {
+    DCHECK_NE(degree_, 0u);
+    --degree_;
+  }
+
+  bool IsInGraph() const { return in_graph_; }
+  void SetInGraph(bool in_graph) { in_graph_ = in_graph; }
+
+  bool IsSpilled() const { return is_spilled_; }
+  void SetSpilled() { is_spilled_ = true; }
+
+  // A node is trivially colorable if it has fewer neighbors in the graph than
+  // registers it may use: whatever colors the neighbors get, one register is left.
+  bool IsTriviallyColorable(uint64_t allowed_registers) const {
+    return degree_ < static_cast<size_t>(POPCOUNT(allowed_registers & ~excluded_registers_));
+  }
+
+  void AddInterference(InterferenceNode* other) {
+    if (is_precolored_ && other->is_precolored_) {
+      DCHECK_NE(interval_->GetRegister(), other->interval_->GetRegister());
+    } else if (other->is_precolored_) {
+      ExcludeRegister(other->interval_->GetRegister());
+    } else if (is_precolored_) {
+      other->ExcludeRegister(interval_->GetRegister());
+    } else {
+      adjacent_nodes_.push_back(other);
+      other->adjacent_nodes_.push_back(this);
+      ++degree_;
+      ++other->degree_;
+    }
+  }
+
+  // Forget the state of a previous coloring round.
+  void Reset() {
+    adjacent_nodes_.clear();
+    excluded_registers_ = 0u;
+    degree_ = 0u;
+    in_graph_ = false;
+    if (!is_precolored_) {
+      interval_->ClearRegister();
+    }
+  }
+
+ private:
+  LiveInterval* const interval_;
+  ArenaVector<InterferenceNode*> adjacent_nodes_;
+  const bool is_precolored_;
+  const float spill_weight_;
+  uint64_t excluded_registers_;
+  size_t degree_;
+  bool in_graph_;
+  bool is_spilled_;
+
+  DISALLOW_COPY_AND_ASSIGN(InterferenceNode);
+};
+
+size_t RegisterAllocator::GetNumberOfAllocatableRegisters() const {
+  size_t count = 0u;
+  for (size_t reg = 0; reg < number_of_registers_; ++reg) {
+    if (!IsBlocked(reg)) {
+      ++count;
+    }
+  }
+  return count;
+}
+
+bool RegisterAllocator::ShouldUseGraphColoring() const {
+  if (strategy_ == kRegisterAllocatorLinearScan) {
+    return false;
+  }
+  // Register pairs are only handled by linear scan.
+  DCHECK_LE(number_of_registers_, 64u);
+  for (LiveInterval* interval : *unhandled_) {
+    if (interval->IsLowInterval() || interval->IsHighInterval()) {
+      return false;
+    }
+  }
+  if (strategy_ == kRegisterAllocatorGraphColor) {
+    return true;
+  }
+
+  DCHECK_EQ(strategy_, kRegisterAllocatorAdaptive);
+  if (unhandled_->size() > kMaxGraphColoringIntervals) {
+    return false;
+  }
+  // Compute the maximum number of intervals live at the same position. If it does not
+  // exceed the number of registers, linear scan does not need to spill.
+  ArenaVector<size_t> starts(allocator_->Adapter(kArenaAllocRegisterAllocator));
+  ArenaVector<size_t> ends(allocator_->Adapter(kArenaAllocRegisterAllocator));
+  for (LiveInterval* interval : *unhandled_) {
+    if (interval->IsSlowPathSafepoint()) {
+      continue;
+    }
+    for (LiveRange* range = interval->GetFirstRange();
+         range != nullptr;
+         range = range->GetNext()) {
+      starts.push_back(range->GetStart());
+      ends.push_back(range->GetEnd());
+    }
+  }
+  std::sort(starts.begin(), starts.end());
+  std::sort(ends.begin(), ends.end());
+  size_t max_pressure = 0u;
+  size_t pressure = 0u;
+  for (size_t i = 0, j = 0; i < starts.size(); ++i) {
+    while (j < ends.size() && ends[j] <= starts[i]) {
+      --pressure;
+      ++j;
+    }
+    ++pressure;
+    max_pressure = std::max(max_pressure, pressure);
+  }
+  return max_pressure > GetNumberOfAllocatableRegisters();
+}
+
+void RegisterAllocator::GraphColorScan() {
+  const ArenaVector<LiveInterval*>& fixed_intervals = processing_core_registers_
+      ? physical_core_register_intervals_
+      : physical_fp_register_intervals_;
+
+  ArenaVector<InterferenceNode*> nodes(allocator_->Adapter(kArenaAllocRegisterAllocator));
+  ArenaVector<LiveInterval*> slow_path_intervals(
+      allocator_->Adapter(kArenaAllocRegisterAllocator));
+  for (LiveInterval* interval : *unhandled_) {
+    if (interval->IsSlowPathSafepoint()) {
+      // Synthesized interval to record the maximum number of live registers
+      // at safepoints. No need to allocate a register for it.
+      slow_path_intervals.push_back(interval);
+    } else {
+      DCHECK(!interval->IsFixed() && !interval->HasSpillSlot());
+      nodes.push_back(new (allocator_) InterferenceNode(
+          allocator_, interval, /* must_have_register */ false));
+    }
+  }
+  unhandled_->clear();
+
+  // An interval with an imposed register cannot keep it where a fixed interval
+  // needs that register. Split it there: the new sibling is colored like any
+  // other interval.
+  for (size_t i = 0, e = nodes.size(); i < e; ++i) {
+    LiveInterval* interval = nodes[i]->GetInterval();
+    if (!nodes[i]->IsPrecolored() || fixed_intervals[interval->GetRegister()] == nullptr) {
+      continue;
+    }
+    size_t conflict = FirstIntersection(interval, fixed_intervals[interval->GetRegister()]);
+    if (conflict != kNoLifetime) {
+      DCHECK_GT(conflict, interval->GetStart());
+      LiveInterval* split = Split(interval, conflict);
+      nodes.push_back(new (allocator_) InterferenceNode(
+          allocator_, split, /* must_have_register */ false));
+    }
+  }
+
+  ArenaVector<LiveInterval*> register_pieces(allocator_->Adapter(kArenaAllocRegisterAllocator));
+  while (true) {
+    ColorInterferenceGraph(nodes, fixed_intervals);
+
+    auto spilled_begin = std::partition(nodes.begin(),
+                                        nodes.end(),
+                                        [](InterferenceNode* node) { return !node->IsSpilled(); });
+    if (spilled_begin == nodes.end()) {
+      break;
+    }
+    // Replace the spilled intervals with the siblings covering their register uses,
+    // and color again.
+    register_pieces.clear();
+    for (auto it = spilled_begin; it != nodes.end(); ++it) {
+      SplitAroundRegisterUses((*it)->GetInterval(), &register_pieces);
+    }
+    nodes.erase(spilled_begin, nodes.end());
+    for (LiveInterval* piece : register_pieces) {
+      nodes.push_back(new (allocator_) InterferenceNode(
+          allocator_, piece, /* must_have_register */ true));
+    }
+  }
+
+  for (InterferenceNode* node : nodes) {
+    LiveInterval* interval = node->GetInterval();
+    DCHECK(interval->HasRegister());
+    codegen_->AddAllocatedRegister(processing_core_registers_
+        ? Location::RegisterLocation(interval->GetRegister())
+        : Location::FpuRegisterLocation(interval->GetRegister()));
+    handled_.push_back(interval);
+  }
+
+  for (LiveInterval* slow_path_interval : slow_path_intervals) {
+    size_t position = slow_path_interval->GetStart();
+    uint64_t live_registers = 0u;
+    for (LiveInterval* interval : handled_) {
+      if (interval->CoversSlow(position)) {
+        live_registers |= UINT64_C(1) << interval->GetRegister();
+      }
+    }
+    size_t number_of_live_registers = POPCOUNT(live_registers);
+    if (processing_core_registers_) {
+      maximum_number_of_live_core_registers_ =
+          std::max(maximum_number_of_live_core_registers_, number_of_live_registers);
+    } else {
+      maximum_number_of_live_fp_registers_ =
+          std::max(maximum_number_of_live_fp_registers_, number_of_live_registers);
+    }
+  }
+}
+
+void RegisterAllocator::ColorInterferenceGraph(
+    const ArenaVector<InterferenceNode*>& nodes,
+    const ArenaVector<LiveInterval*>& fixed_intervals) {
+  uint64_t allowed_registers = 0u;
+  for (size_t reg = 0; reg < number_of_registers_; ++reg) {
+    if (!IsBlocked(reg)) {
+      allowed_registers |= UINT64_C(1) << reg;
+    }
+  }
+
+  for (InterferenceNode* node : nodes) {
+    node->Reset();
+  }
+
+  // (1) Exclude the registers of fixed intervals from the nodes they intersect.
+  ArenaVector<LiveRange*> fixed_ranges(allocator_->Adapter(kArenaAllocRegisterAllocator));
+  for (size_t reg = 0; reg < fixed_intervals.size(); ++reg) {
+    if (fixed_intervals[reg] == nullptr) {
+      continue;
+    }
+    fixed_ranges.clear();
+    for (LiveRange* range = fixed_intervals[reg]->GetFirstRange();
+         range != nullptr;
+         range = range->GetNext()) {
+      fixed_ranges.push_back(range);
+    }
+    for (InterferenceNode* node : nodes) {
+      if (!node->IsPrecolored() && IntersectsAny(node->GetInterval(), fixed_ranges)) {
+        node->ExcludeRegister(reg);
+      }
+    }
+  }
+
+  // (2) Build the interference edges, visiting the nodes by increasing start position
+  //     and only testing the nodes that are not dead yet.
+  ArenaVector<InterferenceNode*> sorted_nodes(nodes.begin(),
+                                              nodes.end(),
+                                              allocator_->Adapter(kArenaAllocRegisterAllocator));
+  std::sort(sorted_nodes.begin(),
+            sorted_nodes.end(),
+            [](InterferenceNode* lhs, InterferenceNode* rhs) {
+              return lhs->GetInterval()->GetStart() < rhs->GetInterval()->GetStart();
+            });
+  ArenaVector<InterferenceNode*> live_nodes(allocator_->Adapter(kArenaAllocRegisterAllocator));
+  for (InterferenceNode* node : sorted_nodes) {
+    LiveInterval* interval = node->GetInterval();
+    size_t start = interval->GetStart();
+    live_nodes.erase(std::remove_if(live_nodes.begin(),
+                                    live_nodes.end(),
+                                    [start](InterferenceNode* other) {
+                                      return other->GetInterval()->IsDeadAt(start);
+                                    }),
+                     live_nodes.end());
+    for (InterferenceNode* other : live_nodes) {
+      if (FirstIntersection(interval, other->GetInterval()) != kNoLifetime) {
+        node->AddInterference(other);
+      }
+    }
+    live_nodes.push_back(node);
+  }
+
+  // (3) Remove the nodes from the graph, pushing them on the coloring stack.
+  ArenaVector<InterferenceNode*> low_degree_nodes(
+      allocator_->Adapter(kArenaAllocRegisterAllocator));
+  ArenaVector<InterferenceNode*> high_degree_nodes(
+      allocator_->Adapter(kArenaAllocRegisterAllocator));
+  ArenaVector<InterferenceNode*> stack(allocator_->Adapter(kArenaAllocRegisterAllocator));
+  for (InterferenceNode* node : nodes) {
+    if (!node->IsPrecolored()) {
+      node->SetInGraph(true);
+      if (node->IsTriviallyColorable(allowed_registers)) {
+        low_degree_nodes.push_back(node);
+      } else {
+        high_degree_nodes.push_back(node);
+      }
+    }
+  }
+  size_t nodes_in_graph = low_degree_nodes.size() + high_degree_nodes.size();
+  while (nodes_in_graph != 0u) {
+    InterferenceNode* removed = nullptr;
+    if (!low_degree_nodes.empty()) {
+      removed = low_degree_nodes.back();
+      low_degree_nodes.pop_back();
+    } else {
+      // No node is trivially colorable: optimistically push the node that is the
+      // cheapest to spill, relative to the number of neighbors it frees.
+      auto best = high_degree_nodes.end();
+      for (auto it = high_degree_nodes.begin(); it != high_degree_nodes.end(); ++it) {
+        InterferenceNode* node = *it;
+        if (!node->IsInGraph()) {
+          continue;
+        }
+        if (best == high_degree_nodes.end() ||
+            node->GetSpillWeight() / (node->GetDegree() + 1) <
+                (*best)->GetSpillWeight() / ((*best)->GetDegree() + 1) ||
+            (*best)->MustHaveRegister()) {
+          best = it;
+        }
+      }
+      DCHECK(best != high_degree_nodes.end());
+      removed = *best;
+      high_degree_nodes.erase(best);
+    }
+    if (!removed->IsInGraph()) {
+      // Already removed through the other list.
+      continue;
+    }
+    removed->SetInGraph(false);
+    --nodes_in_graph;
+    stack.push_back(removed);
+    for (InterferenceNode* adjacent : removed->GetAdjacentNodes()) {
+      if (adjacent->IsInGraph()) {
+        bool was_trivially_colorable = adjacent->IsTriviallyColorable(allowed_registers);
+        adjacent->DecrementDegree();
+        if (!was_trivially_colorable && adjacent->IsTriviallyColorable(allowed_registers)) {
+          // The node stays in `high_degree_nodes`, where it is skipped once removed.
+          low_degree_nodes.push_back(adjacent);
+        }
+      }
+    }
+  }
+
+  // (4) Pop the nodes and give each a register its colored neighbors do not hold.
+  size_t* free_until = registers_array_;
+  while (!stack.empty()) {
+    InterferenceNode* node = stack.back();
+    stack.pop_back();
+    LiveInterval* interval = node->GetInterval();
+    uint64_t available_registers = allowed_registers & ~node->GetExcludedRegisters();
+    for (InterferenceNode* adjacent : node->GetAdjacentNodes()) {
+      if (adjacent->GetInterval()->HasRegister()) {
+        available_registers &= ~(UINT64_C(1) << adjacent->GetInterval()->GetRegister());
+      }
+    }
+    if (available_registers == 0u && node->MustHaveRegister()) {
+      available_registers = EvictForRegister(node, allowed_registers);
+    }
+    if (available_registers == 0u) {
+      node->SetSpilled();
+      continue;
+    }
+
+    // Pick the register the same way linear scan does for a register free for the
+    // whole interval: follow the hints first, then prefer caller-save registers.
+    for (size_t reg = 0; reg < number_of_registers_; ++reg) {
+      free_until[reg] = ((available_registers >> reg) & 1u) != 0u ? kMaxLifetimePosition : 0u;
+    }
+    int reg = interval->FindFirstRegisterHint(free_until, liveness_);
+    if (reg == kNoRegister) {
+      reg = FindAvailableRegister(free_until, interval);
+    }
+    DCHECK_NE(reg, kNoRegister);
+    DCHECK_EQ(free_until[reg], kMaxLifetimePosition);
+    interval->SetRegister(reg);
+  }
+}
+
+// Called when `node` must have a register but all the registers it may use are held by
+// its neighbors. Take the register whose holders are the cheapest to spill, spill them,
+// and return that register as a mask.
+uint64_t RegisterAllocator::EvictForRegister(InterferenceNode* node, uint64_t allowed_registers) {
+  uint64_t candidates = allowed_registers & ~node->GetExcludedRegisters();
+  int best_reg = kNoRegister;
+  float best_cost = kInfiniteSpillWeight;
+  for (size_t reg = 0; reg < number_of_registers_; ++reg) {
+    if (((candidates >> reg) & 1u) == 0u) {
+      continue;
+    }
+    float cost = 0.0f;
+    for (InterferenceNode* adjacent : node->GetAdjacentNodes()) {
+      if (adjacent->GetInterval()->GetRegister() == static_cast<int>(reg)) {
+        if (adjacent->MustHaveRegister()) {
+          cost = kInfiniteSpillWeight;
+          break;
+        }
+        cost += adjacent->GetSpillWeight();
+      }
+    }
+    if (cost < best_cost) {
+      best_reg = static_cast<int>(reg);
+      best_cost = cost;
+    }
+  }
+
+  if (best_reg == kNoRegister) {
+    // This situation would make linear scan loop forever as well.
+    HInstruction* defined_by = node->GetInterval()->GetParent()->GetDefinedBy();
+    LOG(FATAL) << "There is not enough registers available for "
+               << (defined_by == nullptr ? "temporary" : defined_by->DebugName())
+               << " at " << node->GetInterval()->GetStart();
+    UNREACHABLE();
+  }
+
+  for (InterferenceNode* adjacent : node->GetAdjacentNodes()) {
+    if (adjacent->GetInterval()->GetRegister() == best_reg) {
+      adjacent->GetInterval()->ClearRegister();
+      adjacent->SetSpilled();
+    }
+  }
+  return UINT64_C(1) << best_reg;
+}
+
+void RegisterAllocator::SplitAroundRegisterUses(LiveInterval* interval,
+                                                ArenaVector<LiveInterval*>* register_pieces) {
+  DCHECK(!interval->HasRegister());
+  DCHECK(!interval->IsTemp());
+  AllocateSpillSlotFor(interval);
+
+  LiveInterval* current = interval;
+  size_t use = current->FirstRegisterUse();
+  while (use != kNoLifetime) {
+    if (use > current->GetStart() + 1) {
+      // Reload from the spill slot just before the use.
+      current = Split(current, use - 1);
+    }
+    // Keep the register after the use if the next register use is too close
+    // for a sibling to start in between.
+    size_t end = use + 1;
+    // Note that the definition is the only register use at the start of an interval.
+    size_t next_use = current->FirstRegisterUseAfter(std::max(use, current->GetStart() + 1));
+    while (next_use != kNoLifetime && next_use <= end + 1) {
+      end = next_use + 1;
+      next_use = current->FirstRegisterUseAfter(next_use);
+    }
+    register_pieces->push_back(current);
+    if (current->IsDeadAt(end)) {
+      break;
+    }
+    current = Split(current, end);
+    use = current->FirstRegisterUse();
+  }
+}
+
 void RegisterAllocator::AddSorted(ArenaVector<LiveInterval*>* array, LiveInterval* interval) {
   DCHECK(!interval->IsFixed() && !interval->HasSpillSlot());
   size_t insert_at = 0;
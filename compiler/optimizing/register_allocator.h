@@ -30,18 +30,33 @@ class HGraph;
 class HInstruction;
 class HParallelMove;
 class HPhi;
+class InterferenceNode;
 class LiveInterval;
 class Location;
 class SsaLivenessAnalysis;
 
 /**
  * An implementation of a linear scan register allocator on an `HGraph` with SSA form.
+ * Methods with a high register pressure can alternatively be allocated with a graph
+ * coloring allocator, see `Strategy`.
  */
 class RegisterAllocator {
  public:
+  enum Strategy {
+    kRegisterAllocatorLinearScan,
+    kRegisterAllocatorGraphColor,
+    // Use graph coloring for a register kind when linear scan would have to spill,
+    // and when the number of intervals fits the compile-time budget. Use linear
+    // scan otherwise.
+    kRegisterAllocatorAdaptive
+  };
+
+  static constexpr Strategy kRegisterAllocatorDefault = kRegisterAllocatorLinearScan;
+
   RegisterAllocator(ArenaAllocator* allocator,
                     CodeGenerator* codegen,
-                    const SsaLivenessAnalysis& analysis);
+                    const SsaLivenessAnalysis& analysis,
+                    Strategy strategy = kRegisterAllocatorDefault);
 
   // Main entry point for the register allocator. Given the liveness analysis,
   // allocates registers to live intervals.
@@ -86,6 +101,22 @@ class RegisterAllocator {
   bool AllocateBlockedReg(LiveInterval* interval);
   void Resolve();
 
+  // Main methods of the graph coloring strategy. `GraphColorScan` is the counterpart
+  // of `LinearScan`: it allocates registers to the intervals in `unhandled_`.
+  bool ShouldUseGraphColoring() const;
+  void GraphColorScan();
+  void ColorInterferenceGraph(const ArenaVector<InterferenceNode*>& nodes,
+                              const ArenaVector<LiveInterval*>& fixed_intervals);
+  uint64_t EvictForRegister(InterferenceNode* node, uint64_t allowed_registers);
+
+  // Allocate a spill slot for `interval` and split it so that each of its register
+  // uses is covered by a short sibling, added to `register_pieces`. The other
+  // siblings live in the spill slot.
+  void SplitAroundRegisterUses(LiveInterval* interval,
+                               ArenaVector<LiveInterval*>* register_pieces);
+
+  size_t GetNumberOfAllocatableRegisters() const;
+
   // Add `interval` in the given sorted list.
   static void AddSorted(ArenaVector<LiveInterval*>* array, LiveInterval* interval);
 
@@ -162,6 +193,7 @@ class RegisterAllocator {
   ArenaAllocator* const allocator_;
   CodeGenerator* const codegen_;
   const SsaLivenessAnalysis& liveness_;
+  const Strategy strategy_;
 
   // List of intervals for core registers that must be processed, ordered by start
   // position. Last entry is the interval that has the lowest start position.
@@ -35,7 +35,9 @@ namespace art {
 
 class RegisterAllocatorTest : public CommonCompilerTest {};
 
-static bool Check(const uint16_t* data) {
+static bool Check(const uint16_t* data,
+                  RegisterAllocator::Strategy strategy =
+                      RegisterAllocator::kRegisterAllocatorLinearScan) {
   ArenaPool pool;
   ArenaAllocator allocator(&pool);
   HGraph* graph = CreateCFG(&allocator, data);
@@ -44,7 +46,7 @@ static bool Check(const uint16_t* data) {
   x86::CodeGeneratorX86 codegen(graph, *features_x86.get(), CompilerOptions());
   SsaLivenessAnalysis liveness(graph, &codegen);
   liveness.Analyze();
-  RegisterAllocator register_allocator(&allocator, &codegen, liveness);
+  RegisterAllocator register_allocator(&allocator, &codegen, liveness, strategy);
   register_allocator.AllocateRegisters();
   return register_allocator.Validate(false);
 }
@@ -160,6 +162,7 @@ TEST_F(RegisterAllocatorTest, CFG1) {
     Instruction::RETURN);
 
   ASSERT_TRUE(Check(data));
+  ASSERT_TRUE(Check(data, RegisterAllocator::kRegisterAllocatorGraphColor));
 }
 
 TEST_F(RegisterAllocatorTest, Loop1) {
@@ -199,6 +202,7 @@ TEST_F(RegisterAllocatorTest, Loop1) {
     Instruction::RETURN | 1 << 8);
 
   ASSERT_TRUE(Check(data));
+  ASSERT_TRUE(Check(data, RegisterAllocator::kRegisterAllocatorGraphColor));
 }
 
 TEST_F(RegisterAllocatorTest, Loop2) {
@@ -248,6 +252,77 @@ TEST_F(RegisterAllocatorTest, Loop2) {
     Instruction::RETURN | 1 << 8);
 
   ASSERT_TRUE(Check(data));
+  ASSERT_TRUE(Check(data, RegisterAllocator::kRegisterAllocatorGraphColor));
+}
+
+TEST_F(RegisterAllocatorTest, GraphColorHighPressure) {
+  /*
+   * Test the following snippet:
+   *  int a0 = 1;
+   *  int a1 = a0 + 1;
+   *  ...
+   *  int a9 = a8 + 1;
+   *  return a0 + a1 + ... + a9;
+   *
+   * All the values are live at the first addition, which is more than the
+   * x86 core registers, so the graph coloring allocator has to spill and split.
+   */
+  const uint16_t data[] = N_REGISTERS_CODE_ITEM(10,
+    Instruction::CONST_4 | 1 << 12 | 0,
+    Instruction::ADD_INT_LIT8 | 1 << 8, 1 << 8 | 0,
+    Instruction::ADD_INT_LIT8 | 2 << 8, 1 << 8 | 1,
+    Instruction::ADD_INT_LIT8 | 3 << 8, 1 << 8 | 2,
+    Instruction::ADD_INT_LIT8 | 4 << 8, 1 << 8 | 3,
+    Instruction::ADD_INT_LIT8 | 5 << 8, 1 << 8 | 4,
+    Instruction::ADD_INT_LIT8 | 6 << 8, 1 << 8 | 5,
+    Instruction::ADD_INT_LIT8 | 7 << 8, 1 << 8 | 6,
+    Instruction::ADD_INT_LIT8 | 8 << 8, 1 << 8 | 7,
+    Instruction::ADD_INT_LIT8 | 9 << 8, 1 << 8 | 8,
+    Instruction::ADD_INT_2ADDR | 1 << 12 | 0 << 8,
+    Instruction::ADD_INT_2ADDR | 2 << 12 | 0 << 8,
+    Instruction::ADD_INT_2ADDR | 3 << 12 | 0 << 8,
+    Instruction::ADD_INT_2ADDR | 4 << 12 | 0 << 8,
+    Instruction::ADD_INT_2ADDR | 5 << 12 | 0 << 8,
+    Instruction::ADD_INT_2ADDR | 6 << 12 | 0 << 8,
+    Instruction::ADD_INT_2ADDR | 7 << 12 | 0 << 8,
+    Instruction::ADD_INT_2ADDR | 8 << 12 | 0 << 8,
+    Instruction::ADD_INT_2ADDR | 9 << 12 | 0 << 8,
+    Instruction::RETURN | 0 << 8);
+
+  ASSERT_TRUE(Check(data));
+
+  ArenaPool pool;
+  ArenaAllocator allocator(&pool);
+  HGraph* graph = CreateCFG(&allocator, data);
+  std::unique_ptr<const X86InstructionSetFeatures> features_x86(
+      X86InstructionSetFeatures::FromCppDefines());
+  x86::CodeGeneratorX86 codegen(graph, *features_x86.get(), CompilerOptions());
+  SsaLivenessAnalysis liveness(graph, &codegen);
+  liveness.Analyze();
+  RegisterAllocator register_allocator(
+      &allocator, &codegen, liveness, RegisterAllocator::kRegisterAllocatorGraphColor);
+  register_allocator.AllocateRegisters();
+
+  ASSERT_GT(register_allocator.GetNumberOfSpillSlots(), 0u);
+  ArenaVector<LiveInterval*> intervals(allocator.Adapter());
+  bool has_split = false;
+  for (size_t i = 0; i < liveness.GetNumberOfSsaValues(); ++i) {
+    LiveInterval* interval = liveness.GetInstructionFromSsaIndex(i)->GetLiveInterval();
+    if (interval->GetType() == Primitive::kPrimInt) {
+      intervals.push_back(interval);
+      has_split = has_split || interval->GetNextSibling() != nullptr;
+    }
+  }
+  ASSERT_TRUE(has_split);
+  ASSERT_TRUE(RegisterAllocator::ValidateIntervals(
+      intervals,
+      register_allocator.GetNumberOfSpillSlots(),
+      /* number_of_out_slots */ 0u,
+      codegen,
+      &allocator,
+      /* processing_core_registers */ true,
+      /* log_fatal_on_failure */ false));
+  ASSERT_TRUE(register_allocator.Validate(false));
 }
 
 TEST_F(RegisterAllocatorTest, Loop3) {
@@ -0,0 +1,321 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "scheduler.h"
+
+#ifdef ART_ENABLE_CODEGEN_arm64
+#include "scheduler_arm64.h"
+#endif
+
+#ifdef ART_ENABLE_CODEGEN_x86_64
+#include "scheduler_x86_64.h"
+#endif
+
+namespace art {
+
+void HScheduler::Schedule(HGraph* graph) {
+  for (HReversePostOrderIterator it(*graph); !it.Done(); it.Advance()) {
+    Schedule(it.Current());
+  }
+}
+
+void HScheduler::Schedule(HBasicBlock* block) {
+  ArenaVector<HInstruction*> region(arena_->Adapter(kArenaAllocScheduler));
+  HInstruction* instruction = block->GetFirstInstruction();
+  while (instruction != nullptr) {
+    if (IsSchedulingBarrier(instruction)) {
+      instruction = instruction->GetNext();
+      continue;
+    }
+    region.clear();
+    while (instruction != nullptr &&
+           !IsSchedulingBarrier(instruction) &&
+           // Do not split a region between an instruction and the user it is fused with.
+           (region.size() < kMaxRegionSize || IsFusedWithNext(region.back()))) {
+      region.push_back(instruction);
+      instruction = instruction->GetNext();
+    }
+    // Blocks end with a control flow instruction, which is never schedulable.
+    DCHECK(instruction != nullptr);
+    if (region.size() > 1u) {
+      ScheduleRegion(region, instruction);
+    }
+  }
+}
+
+bool HScheduler::IsSchedulable(const HInstruction* instruction) const {
+  if (instruction->IsRem() && Primitive::IsFloatingPointType(instruction->GetType())) {
+    // Floating-point remainders are calls to the runtime.
+    return false;
+  }
+  return instruction->IsBinaryOperation()  // Includes conditions and HCompare.
+      || instruction->IsUnaryOperation()
+      || instruction->IsTypeConversion()
+      || instruction->IsSelect()
+      || instruction->IsArrayGet()
+      || instruction->IsArraySet()
+      || instruction->IsArrayLength()
+      || instruction->IsBoundsCheck()
+      || instruction->IsNullCheck()
+      || instruction->IsDivZeroCheck()
+      || instruction->IsInstanceFieldGet()
+      || instruction->IsInstanceFieldSet()
+      || instruction->IsStaticFieldGet()
+      || instruction->IsStaticFieldSet();
+}
+
+bool HScheduler::IsFusedWithNext(const HInstruction* instruction) {
+  // Conditions are emitted at their use site and null checks are folded into the
+  // memory access of their user when they immediately precede it.
+  if (!instruction->IsCondition() && !instruction->IsNullCheck()) {
+    return false;
+  }
+  const HInstruction* next = instruction->GetNext();
+  if (next == nullptr) {
+    return false;
+  }
+  for (size_t i = 0, e = next->InputCount(); i < e; ++i) {
+    if (next->InputAt(i) == instruction) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool HScheduler::IsSchedulingBarrier(const HInstruction* instruction) const {
+  if (!IsSchedulable(instruction)) {
+    return true;
+  }
+  // Keep the instruction next to a user that cannot be moved.
+  return IsFusedWithNext(instruction) && !IsSchedulable(instruction->GetNext());
+}
+
+static SideEffects GetNodeSideEffects(const SchedulingNode* node) {
+  SideEffects side_effects = node->GetInstruction()->GetSideEffects();
+  if (node->GetFusedInput() != nullptr) {
+    side_effects = side_effects.Union(node->GetFusedInput()->GetSideEffects());
+  }
+  return side_effects;
+}
+
+static bool NodeCanThrow(const SchedulingNode* node) {
+  return node->GetInstruction()->CanThrow() ||
+      (node->GetFusedInput() != nullptr && node->GetFusedInput()->CanThrow());
+}
+
+bool HScheduler::HasOrderingDependency(const SchedulingNode* earlier,
+                                       const SchedulingNode* later) {
+  SideEffects earlier_effects = GetNodeSideEffects(earlier);
+  SideEffects later_effects = GetNodeSideEffects(later);
+  // Read after write, write after read (including the GC dependencies), and write after write.
+  if (later_effects.MayDependOn(earlier_effects) ||
+      earlier_effects.MayDependOn(later_effects) ||
+      (earlier_effects.DoesAnyWrite() && later_effects.DoesAnyWrite())) {
+    return true;
+  }
+  // Exceptions must be thrown in program order, and the heap state must be the
+  // same as in program order when they are thrown.
+  bool earlier_can_throw = NodeCanThrow(earlier);
+  bool later_can_throw = NodeCanThrow(later);
+  return (earlier_can_throw && later_can_throw) ||
+      (earlier_can_throw && later_effects.DoesAnyWrite()) ||
+      (later_can_throw && earlier_effects.DoesAnyWrite());
+}
+
+static bool IsBetterCandidate(const SchedulingNode* lhs,
+                              const SchedulingNode* rhs,
+                              uint32_t cycle) {
+  bool lhs_is_available = lhs->GetEarliestCycle() <= cycle;
+  bool rhs_is_available = rhs->GetEarliestCycle() <= cycle;
+  if (lhs_is_available != rhs_is_available) {
+    return lhs_is_available;
+  }
+  if (!lhs_is_available && lhs->GetEarliestCycle() != rhs->GetEarliestCycle()) {
+    return lhs->GetEarliestCycle() < rhs->GetEarliestCycle();
+  }
+  if (lhs->GetCriticalPath() != rhs->GetCriticalPath()) {
+    return lhs->GetCriticalPath() > rhs->GetCriticalPath();
+  }
+  // Keep the original order when nothing else matters.
+  return lhs->GetPosition() < rhs->GetPosition();
+}
+
+SchedulingNode* HScheduler::SelectNode(ArenaVector<SchedulingNode*>* ready_nodes,
+                                       uint32_t cycle) const {
+  DCHECK(!ready_nodes->empty());
+  size_t best = 0u;
+  for (size_t i = 1u, e = ready_nodes->size(); i < e; ++i) {
+    if (IsBetterCandidate((*ready_nodes)[i], (*ready_nodes)[best], cycle)) {
+      best = i;
+    }
+  }
+  SchedulingNode* node = (*ready_nodes)[best];
+  (*ready_nodes)[best] = ready_nodes->back();
+  ready_nodes->pop_back();
+  return node;
+}
+
+void HScheduler::ScheduleRegion(const ArenaVector<HInstruction*>& region, HInstruction* cursor) {
+  // Create the nodes, fusing instructions emitted at their use site with their user.
+  ArenaVector<SchedulingNode*> nodes(arena_->Adapter(kArenaAllocScheduler));
+  ArenaSafeMap<const HInstruction*, SchedulingNode*> instruction_nodes(
+      std::less<const HInstruction*>(), arena_->Adapter(kArenaAllocScheduler));
+  for (size_t i = 0, e = region.size(); i < e; ++i) {
+    HInstruction* instruction = region[i];
+    HInstruction* fused_input = nullptr;
+    if (i + 1u < e && IsFusedWithNext(instruction)) {
+      fused_input = instruction;
+      instruction = region[++i];
+    }
+    SchedulingNode* node = new (arena_) SchedulingNode(instruction, nodes.size(), arena_);
+    node->SetFusedInput(fused_input);
+    latency_visitor_->CalculateLatency(node);
+    nodes.push_back(node);
+    instruction_nodes.Put(instruction, node);
+    if (fused_input != nullptr) {
+      instruction_nodes.Put(fused_input, node);
+    }
+  }
+  if (nodes.size() < 2u) {
+    return;
+  }
+
+  // Data dependencies, including the uses by environments.
+  auto add_data_dependencies = [&instruction_nodes](SchedulingNode* node,
+                                                    HInstruction* instruction) {
+    for (const HUseListNode<HInstruction*>& use : instruction->GetUses()) {
+      auto it = instruction_nodes.find(use.GetUser());
+      if (it != instruction_nodes.end() && it->second != node) {
+        DCHECK_GT(it->second->GetPosition(), node->GetPosition());
+        node->AddSuccessor(it->second, node->GetLatency());
+      }
+    }
+    for (const HUseListNode<HEnvironment*>& use : instruction->GetEnvUses()) {
+      auto it = instruction_nodes.find(use.GetUser()->GetHolder());
+      if (it != instruction_nodes.end() && it->second != node) {
+        DCHECK_GT(it->second->GetPosition(), node->GetPosition());
+        node->AddSuccessor(it->second, node->GetLatency());
+      }
+    }
+  };
+  // Nodes accessing memory or throwing, which may need to stay ordered.
+  ArenaVector<SchedulingNode*> ordered_nodes(arena_->Adapter(kArenaAllocScheduler));
+  for (SchedulingNode* node : nodes) {
+    if (node->GetFusedInput() != nullptr) {
+      add_data_dependencies(node, node->GetFusedInput());
+    }
+    add_data_dependencies(node, node->GetInstruction());
+    if (!GetNodeSideEffects(node).DoesNothing() || NodeCanThrow(node)) {
+      for (SchedulingNode* other : ordered_nodes) {
+        if (HasOrderingDependency(other, node)) {
+          other->AddSuccessor(node, 0u);
+        }
+      }
+      ordered_nodes.push_back(node);
+    }
+  }
+
+  // Successors are always after their predecessors in the original order.
+  for (auto it = nodes.rbegin(), end = nodes.rend(); it != end; ++it) {
+    SchedulingNode* node = *it;
+    uint32_t critical_path = node->GetLatency();
+    const ArenaVector<SchedulingNode*>& successors = node->GetSuccessors();
+    for (size_t i = 0, e = successors.size(); i < e; ++i) {
+      critical_path = std::max(critical_path,
+                               node->GetSuccessorLatency(i) + successors[i]->GetCriticalPath());
+    }
+    node->SetCriticalPath(critical_path);
+  }
+
+  // Issue the nodes top-down, modeling the issue width and the non-pipelined
+  // instructions of the core.
+  ArenaVector<SchedulingNode*> ready_nodes(arena_->Adapter(kArenaAllocScheduler));
+  for (SchedulingNode* node : nodes) {
+    if (node->GetUnscheduledPredecessors() == 0u) {
+      ready_nodes.push_back(node);
+    }
+  }
+  ArenaVector<SchedulingNode*> schedule(arena_->Adapter(kArenaAllocScheduler));
+  schedule.reserve(nodes.size());
+  const size_t issue_width = latency_visitor_->GetIssueWidth();
+  uint32_t cycle = 0u;
+  size_t issued_in_cycle = 0u;
+  bool reordered = false;
+  while (!ready_nodes.empty()) {
+    SchedulingNode* node = SelectNode(&ready_nodes, cycle);
+    if (node->GetEarliestCycle() > cycle) {
+      cycle = node->GetEarliestCycle();
+      issued_in_cycle = 0u;
+    }
+    reordered = reordered || (node->GetPosition() != schedule.size());
+    schedule.push_back(node);
+    const ArenaVector<SchedulingNode*>& successors = node->GetSuccessors();
+    for (size_t i = 0, e = successors.size(); i < e; ++i) {
+      SchedulingNode* successor = successors[i];
+      successor->UpdateEarliestCycle(cycle + node->GetSuccessorLatency(i));
+      successor->DecrementUnscheduledPredecessors();
+      if (successor->GetUnscheduledPredecessors() == 0u) {
+        ready_nodes.push_back(successor);
+      }
+    }
+    ++issued_in_cycle;
+    if (node->GetInternalLatency() != 0u) {
+      cycle += node->GetInternalLatency();
+      issued_in_cycle = 0u;
+    } else if (issued_in_cycle == issue_width) {
+      ++cycle;
+      issued_in_cycle = 0u;
+    }
+  }
+  DCHECK_EQ(schedule.size(), nodes.size());
+
+  if (reordered) {
+    for (SchedulingNode* node : schedule) {
+      if (node->GetFusedInput() != nullptr) {
+        node->GetFusedInput()->MoveBefore(cursor);
+      }
+      node->GetInstruction()->MoveBefore(cursor);
+    }
+  }
+}
+
+void HInstructionScheduling::Run() {
+  ArenaAllocator* arena = graph_->GetArena();
+  switch (instruction_set_) {
+#ifdef ART_ENABLE_CODEGEN_arm64
+    case kArm64: {
+      arm64::SchedulingLatencyVisitorARM64 latency_visitor(
+          *features_->AsArm64InstructionSetFeatures());
+      arm64::HSchedulerARM64 scheduler(arena, &latency_visitor);
+      scheduler.Schedule(graph_);
+      break;
+    }
+#endif
+#ifdef ART_ENABLE_CODEGEN_x86_64
+    case kX86_64: {
+      x86_64::SchedulingLatencyVisitorX86_64 latency_visitor;
+      HScheduler scheduler(arena, &latency_visitor);
+      scheduler.Schedule(graph_);
+      break;
+    }
+#endif
+    default:
+      UNUSED(arena);
+      break;
+  }
+}
+
+}  // namespace art
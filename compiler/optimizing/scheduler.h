@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_SCHEDULER_H_
+#define ART_COMPILER_OPTIMIZING_SCHEDULER_H_
+
+#include "arch/instruction_set.h"
+#include "base/arena_containers.h"
+#include "nodes.h"
+#include "optimization.h"
+
+namespace art {
+
+class InstructionSetFeatures;
+
+// A node of the dependency graph built for a scheduling region. A node usually
+// holds a single instruction. Instructions that the code generators emit at
+// their use site (conditions, implicit null checks) are fused with their user
+// so that the scheduler never separates them.
+class SchedulingNode : public ArenaObject<kArenaAllocScheduler> {
+ public:
+  SchedulingNode(HInstruction* instruction, size_t position, ArenaAllocator* arena)
+      : instruction_(instruction),
+        fused_input_(nullptr),
+        position_(position),
+        latency_(0),
+        internal_latency_(0),
+        critical_path_(0),
+        earliest_cycle_(0),
+        unscheduled_predecessors_(0),
+        successors_(arena->Adapter(kArenaAllocScheduler)),
+        successor_latencies_(arena->Adapter(kArenaAllocScheduler)) {}
+
+  HInstruction* GetInstruction() const { return instruction_; }
+
+  // The instruction emitted immediately before `instruction_`, if any.
+  HInstruction* GetFusedInput() const { return fused_input_; }
+  void SetFusedInput(HInstruction* input) { fused_input_ = input; }
+
+  // Index of the node in the original order of the region.
+  size_t GetPosition() const { return position_; }
+
+  // Number of cycles before the result of the node can be used.
+  uint32_t GetLatency() const { return latency_; }
+  void SetLatency(uint32_t latency) { latency_ = latency; }
+
+  // Number of cycles the node blocks the pipeline after being issued, for
+  // instructions that are not pipelined or expand to several instructions.
+  uint32_t GetInternalLatency() const { return internal_latency_; }
+  void SetInternalLatency(uint32_t latency) { internal_latency_ = latency; }
+
+  // Longest latency-weighted path from this node to the end of the region.
+  uint32_t GetCriticalPath() const { return critical_path_; }
+  void SetCriticalPath(uint32_t critical_path) { critical_path_ = critical_path; }
+
+  // First cycle at which all the inputs of the node are available.
+  uint32_t GetEarliestCycle() const { return earliest_cycle_; }
+  void UpdateEarliestCycle(uint32_t cycle) { earliest_cycle_ = std::max(earliest_cycle_, cycle); }
+
+  size_t GetUnscheduledPredecessors() const { return unscheduled_predecessors_; }
+  void DecrementUnscheduledPredecessors() {
+    DCHECK_NE(unscheduled_predecessors_, 0u);
+    --unscheduled_predecessors_;
+  }
+
+  // Record that `node` must be scheduled at least `latency` cycles after this node.
+  void AddSuccessor(SchedulingNode* node, uint32_t latency) {
+    successors_.push_back(node);
+    successor_latencies_.push_back(latency);
+    ++node->unscheduled_predecessors_;
+  }
+
+  const ArenaVector<SchedulingNode*>& GetSuccessors() const { return successors_; }
+  uint32_t GetSuccessorLatency(size_t index) const { return successor_latencies_[index]; }
+
+ private:
+  HInstruction* const instruction_;
+  HInstruction* fused_input_;
+  const size_t position_;
+  uint32_t latency_;
+  uint32_t internal_latency_;
+  uint32_t critical_path_;
+  uint32_t earliest_cycle_;
+  size_t unscheduled_predecessors_;
+  ArenaVector<SchedulingNode*> successors_;
+  ArenaVector<uint32_t> successor_latencies_;
+
+  DISALLOW_COPY_AND_ASSIGN(SchedulingNode);
+};
+
+// Computes the latencies of the scheduling nodes. Architecture-specific
+// sub-classes implement the visit functions for all the instructions their
+// scheduler considers schedulable and set `last_visited_latency_` and
+// `last_visited_internal_latency_`.
+class SchedulingLatencyVisitor : public HGraphDelegateVisitor {
+ public:
+  // The visitor is only used on individual instructions, never on a graph.
+  SchedulingLatencyVisitor()
+      : HGraphDelegateVisitor(nullptr),
+        last_visited_latency_(0),
+        last_visited_internal_latency_(0) {}
+
+  void VisitInstruction(HInstruction* instruction) OVERRIDE {
+    LOG(FATAL) << "Error visiting " << instruction->DebugName() << ". "
+        "Architecture-specific scheduling latency visitors must handle all instructions "
+        "considered schedulable.";
+    UNREACHABLE();
+  }
+
+  void CalculateLatency(SchedulingNode* node) {
+    last_visited_latency_ = 0;
+    last_visited_internal_latency_ = 0;
+    node->GetInstruction()->Accept(this);
+    node->SetLatency(last_visited_latency_);
+    node->SetInternalLatency(last_visited_internal_latency_);
+  }
+
+  // Number of independent instructions the core can issue per cycle.
+  virtual size_t GetIssueWidth() const { return 1u; }
+
+ protected:
+  uint32_t last_visited_latency_;
+  uint32_t last_visited_internal_latency_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(SchedulingLatencyVisitor);
+};
+
+// A list scheduler working on the regions of schedulable instructions of a
+// basic block. A region ends at the first instruction the scheduler does not
+// know how to move (invokes, allocations, control flow, ...), so that such
+// instructions keep their position relative to all other instructions.
+//
+// Within a region, the scheduler builds a dependency graph from the data
+// dependencies (including environment uses), the memory dependencies given by
+// `SideEffects`, and the ordering between throwing instructions and writes.
+// It then issues nodes top-down, preferring nodes whose inputs are available
+// at the current cycle and, among those, the ones on the longest path to the
+// end of the region.
+class HScheduler {
+ public:
+  HScheduler(ArenaAllocator* arena, SchedulingLatencyVisitor* latency_visitor)
+      : arena_(arena), latency_visitor_(latency_visitor) {}
+  virtual ~HScheduler() {}
+
+  void Schedule(HGraph* graph);
+
+  // Maximum number of instructions scheduled together. Longer regions are
+  // split to bound the quadratic cost of building the dependency graph.
+  static constexpr size_t kMaxRegionSize = 256;
+
+ protected:
+  // Whether `instruction` can be moved within its block. Architectures with
+  // specific instructions override this and accept those they know about.
+  virtual bool IsSchedulable(const HInstruction* instruction) const;
+
+ private:
+  void Schedule(HBasicBlock* block);
+  void ScheduleRegion(const ArenaVector<HInstruction*>& region, HInstruction* cursor);
+
+  // Whether `instruction` must not move, nor have any instruction move across it.
+  bool IsSchedulingBarrier(const HInstruction* instruction) const;
+
+  // Whether `instruction` must stay immediately before the next instruction.
+  static bool IsFusedWithNext(const HInstruction* instruction);
+
+  static bool HasOrderingDependency(const SchedulingNode* earlier, const SchedulingNode* later);
+
+  SchedulingNode* SelectNode(ArenaVector<SchedulingNode*>* ready_nodes, uint32_t cycle) const;
+
+  ArenaAllocator* const arena_;
+  SchedulingLatencyVisitor* const latency_visitor_;
+
+  DISALLOW_COPY_AND_ASSIGN(HScheduler);
+};
+
+// Schedules the instructions of every basic block of the graph, for the
+// architectures that provide a latency model.
+class HInstructionScheduling : public HOptimization {
+ public:
+  HInstructionScheduling(HGraph* graph,
+                         InstructionSet instruction_set,
+                         const InstructionSetFeatures* features)
+      : HOptimization(graph, kInstructionSchedulingPassName),
+        instruction_set_(instruction_set),
+        features_(features) {}
+
+  void Run() OVERRIDE;
+
+  static constexpr const char* kInstructionSchedulingPassName = "scheduler";
+
+ private:
+  const InstructionSet instruction_set_;
+  const InstructionSetFeatures* const features_;
+
+  DISALLOW_COPY_AND_ASSIGN(HInstructionScheduling);
+};
+
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_SCHEDULER_H_
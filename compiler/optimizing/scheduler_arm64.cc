@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "scheduler_arm64.h"
+
+namespace art {
+namespace arm64 {
+
+// In-order, dual-issue cores (Cortex-A53, Cortex-A55). Scheduling matters most
+// on these, as they cannot hide the latency of loads and multiplications.
+static constexpr Arm64SchedulingLatencies kCortexA53Latencies = {
+  /* integer_op */ 1u,
+  /* data_proc_with_shifter_op */ 2u,
+  /* mul_integer */ 3u,
+  /* div_integer */ 12u,
+  /* floating_point_op */ 4u,
+  /* mul_floating_point */ 4u,
+  /* div_float */ 13u,
+  /* div_double */ 22u,
+  /* type_conversion */ 4u,
+  /* memory_load */ 3u,
+  /* memory_store */ 1u,
+  /* issue_width */ 2u,
+};
+
+// Out-of-order, triple-issue cores (Cortex-A57, Cortex-A72, Cortex-A73).
+static constexpr Arm64SchedulingLatencies kCortexA57Latencies = {
+  /* integer_op */ 1u,
+  /* data_proc_with_shifter_op */ 2u,
+  /* mul_integer */ 3u,
+  /* div_integer */ 12u,
+  /* floating_point_op */ 3u,
+  /* mul_floating_point */ 3u,
+  /* div_float */ 10u,
+  /* div_double */ 15u,
+  /* type_conversion */ 3u,
+  /* memory_load */ 4u,
+  /* memory_store */ 1u,
+  /* issue_width */ 3u,
+};
+
+const Arm64SchedulingLatencies& SchedulingLatencyVisitorARM64::GetLatencies(
+    const Arm64InstructionSetFeatures& features) {
+  // The Cortex-A53 errata workarounds are enabled for the Cortex-A53 and for the
+  // generic variants, which are pessimistically assumed to be Cortex-A53s.
+  return features.NeedFixCortexA53_835769() ? kCortexA53Latencies : kCortexA57Latencies;
+}
+
+void SchedulingLatencyVisitorARM64::VisitBinaryOperation(HBinaryOperation* instruction) {
+  last_visited_latency_ = Primitive::IsFloatingPointType(instruction->GetResultType())
+      ? latencies_.floating_point_op
+      : latencies_.integer_op;
+}
+
+void SchedulingLatencyVisitorARM64::VisitUnaryOperation(HUnaryOperation* instruction) {
+  last_visited_latency_ = Primitive::IsFloatingPointType(instruction->GetResultType())
+      ? latencies_.floating_point_op
+      : latencies_.integer_op;
+}
+
+void SchedulingLatencyVisitorARM64::VisitMul(HMul* instruction) {
+  last_visited_latency_ = Primitive::IsFloatingPointType(instruction->GetResultType())
+      ? latencies_.mul_floating_point
+      : latencies_.mul_integer;
+}
+
+void SchedulingLatencyVisitorARM64::VisitDiv(HDiv* instruction) {
+  // Divisions are not pipelined.
+  Primitive::Type type = instruction->GetResultType();
+  if (type == Primitive::kPrimFloat) {
+    last_visited_latency_ = latencies_.div_float;
+  } else if (type == Primitive::kPrimDouble) {
+    last_visited_latency_ = latencies_.div_double;
+  } else if (instruction->GetRight()->IsConstant()) {
+    // Divisions by constants are strength-reduced to multiplications and shifts.
+    last_visited_latency_ = latencies_.mul_integer + latencies_.integer_op;
+    return;
+  } else {
+    last_visited_latency_ = latencies_.div_integer;
+  }
+  last_visited_internal_latency_ = last_visited_latency_;
+}
+
+void SchedulingLatencyVisitorARM64::VisitRem(HRem* instruction) {
+  // Only integer remainders are schedulable; they are a division followed by an msub.
+  DCHECK(Primitive::IsIntegralType(instruction->GetResultType()));
+  if (instruction->GetRight()->IsConstant()) {
+    last_visited_latency_ = 2u * latencies_.mul_integer + latencies_.integer_op;
+  } else {
+    last_visited_internal_latency_ = latencies_.div_integer;
+    last_visited_latency_ = latencies_.div_integer + latencies_.mul_integer;
+  }
+}
+
+void SchedulingLatencyVisitorARM64::VisitTypeConversion(HTypeConversion* instruction) {
+  if (Primitive::IsFloatingPointType(instruction->GetResultType()) ||
+      Primitive::IsFloatingPointType(instruction->GetInputType())) {
+    last_visited_latency_ = latencies_.type_conversion;
+  } else {
+    last_visited_latency_ = latencies_.integer_op;
+  }
+}
+
+void SchedulingLatencyVisitorARM64::VisitSelect(HSelect* instruction) {
+  last_visited_latency_ = Primitive::IsFloatingPointType(instruction->GetType())
+      ? latencies_.floating_point_op
+      : latencies_.integer_op;
+}
+
+void SchedulingLatencyVisitorARM64::VisitArrayGet(HArrayGet* instruction) {
+  if (!instruction->GetIndex()->IsConstant() &&
+      !instruction->GetArray()->IsArm64IntermediateAddress()) {
+    // The address is computed separately.
+    last_visited_internal_latency_ = latencies_.integer_op;
+  }
+  last_visited_latency_ = latencies_.memory_load;
+}
+
+void SchedulingLatencyVisitorARM64::VisitArraySet(HArraySet* instruction ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = latencies_.memory_store;
+}
+
+void SchedulingLatencyVisitorARM64::VisitArrayLength(HArrayLength* instruction ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = latencies_.memory_load;
+}
+
+void SchedulingLatencyVisitorARM64::VisitBoundsCheck(HBoundsCheck* instruction ATTRIBUTE_UNUSED) {
+  // A compare and a branch. The result is the index, available immediately.
+  last_visited_internal_latency_ = latencies_.integer_op;
+}
+
+void SchedulingLatencyVisitorARM64::VisitNullCheck(HNullCheck* instruction ATTRIBUTE_UNUSED) {
+  // Either folded into the user or a compare and branch; the result is the input.
+  last_visited_latency_ = 0u;
+}
+
+void SchedulingLatencyVisitorARM64::VisitDivZeroCheck(HDivZeroCheck* instruction ATTRIBUTE_UNUSED) {
+  // A compare and branch; the result is the input.
+  last_visited_latency_ = 0u;
+}
+
+void SchedulingLatencyVisitorARM64::VisitInstanceFieldGet(
+    HInstanceFieldGet* instruction ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = latencies_.memory_load;
+}
+
+void SchedulingLatencyVisitorARM64::VisitInstanceFieldSet(
+    HInstanceFieldSet* instruction ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = latencies_.memory_store;
+}
+
+void SchedulingLatencyVisitorARM64::VisitStaticFieldGet(
+    HStaticFieldGet* instruction ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = latencies_.memory_load;
+}
+
+void SchedulingLatencyVisitorARM64::VisitStaticFieldSet(
+    HStaticFieldSet* instruction ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = latencies_.memory_store;
+}
+
+void SchedulingLatencyVisitorARM64::VisitArm64DataProcWithShifterOp(
+    HArm64DataProcWithShifterOp* instruction ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = latencies_.data_proc_with_shifter_op;
+}
+
+void SchedulingLatencyVisitorARM64::VisitArm64IntermediateAddress(
+    HArm64IntermediateAddress* instruction ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = latencies_.integer_op;
+}
+
+void SchedulingLatencyVisitorARM64::VisitMultiplyAccumulate(
+    HMultiplyAccumulate* instruction ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = latencies_.mul_integer;
+}
+
+bool HSchedulerARM64::IsSchedulable(const HInstruction* instruction) const {
+  return HScheduler::IsSchedulable(instruction)
+      || instruction->IsArm64DataProcWithShifterOp()
+      || instruction->IsArm64IntermediateAddress()
+      || instruction->IsMultiplyAccumulate();
+}
+
+}  // namespace arm64
+}  // namespace art
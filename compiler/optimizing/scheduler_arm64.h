@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_COMPILER_OPTIMIZING_SCHEDULER_ARM64_H_
+#define ART_COMPILER_OPTIMIZING_SCHEDULER_ARM64_H_
+
+#include "arch/arm64/instruction_set_features_arm64.h"
+#include "scheduler.h"
+
+namespace art {
+namespace arm64 {
+
+// Approximate latencies, in cycles, of the instructions generated for the HIR.
+struct Arm64SchedulingLatencies {
+  uint32_t integer_op;
+  uint32_t data_proc_with_shifter_op;
+  uint32_t mul_integer;
+  uint32_t div_integer;
+  uint32_t floating_point_op;
+  uint32_t mul_floating_point;
+  uint32_t div_float;
+  uint32_t div_double;
+  uint32_t type_conversion;
+  uint32_t memory_load;
+  uint32_t memory_store;
+  size_t issue_width;
+};
+
+class SchedulingLatencyVisitorARM64 : public SchedulingLatencyVisitor {
+ public:
+  explicit SchedulingLatencyVisitorARM64(const Arm64InstructionSetFeatures& features)
+      : latencies_(GetLatencies(features)) {}
+
+  // Returns the latencies of the in-order Cortex-A53 class cores, or of the
+  // out-of-order Cortex-A57/A72/A73 class cores.
+  static const Arm64SchedulingLatencies& GetLatencies(const Arm64InstructionSetFeatures& features);
+
+  size_t GetIssueWidth() const OVERRIDE { return latencies_.issue_width; }
+
+  void VisitBinaryOperation(HBinaryOperation* instruction) OVERRIDE;
+  void VisitUnaryOperation(HUnaryOperation* instruction) OVERRIDE;
+  void VisitMul(HMul* instruction) OVERRIDE;
+  void VisitDiv(HDiv* instruction) OVERRIDE;
+  void VisitRem(HRem* instruction) OVERRIDE;
+  void VisitTypeConversion(HTypeConversion* instruction) OVERRIDE;
+  void VisitSelect(HSelect* instruction) OVERRIDE;
+  void VisitArrayGet(HArrayGet* instruction) OVERRIDE;
+  void VisitArraySet(HArraySet* instruction) OVERRIDE;
+  void VisitArrayLength(HArrayLength* instruction) OVERRIDE;
+  void VisitBoundsCheck(HBoundsCheck* instruction) OVERRIDE;
+  void VisitNullCheck(HNullCheck* instruction) OVERRIDE;
+  void VisitDivZeroCheck(HDivZeroCheck* instruction) OVERRIDE;
+  void VisitInstanceFieldGet(HInstanceFieldGet* instruction) OVERRIDE;
+  void VisitInstanceFieldSet(HInstanceFieldSet* instruction) OVERRIDE;
+  void VisitStaticFieldGet(HStaticFieldGet* instruction) OVERRIDE;
+  void VisitStaticFieldSet(HStaticFieldSet* instruction) OVERRIDE;
+  void VisitArm64DataProcWithShifterOp(HArm64DataProcWithShifterOp* instruction) OVERRIDE;
+  void VisitArm64IntermediateAddress(HArm64IntermediateAddress* instruction) OVERRIDE;
+  void VisitMultiplyAccumulate(HMultiplyAccumulate* instruction) OVERRIDE;
+
+ private:
+  const Arm64SchedulingLatencies& latencies_;
+
+  DISALLOW_COPY_AND_ASSIGN(SchedulingLatencyVisitorARM64);
+};
+
+class HSchedulerARM64 : public HScheduler {
+ public:
+  HSchedulerARM64(ArenaAllocator* arena, SchedulingLatencyVisitorARM64* latency_visitor)
+      : HScheduler(arena, latency_visitor) {}
+
+ protected:
+  bool IsSchedulable(const HInstruction* instruction) const OVERRIDE;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(HSchedulerARM64);
+};
+
+}  // namespace arm64
+}  // namespace art
+
+#endif  // ART_COMPILER_OPTIMIZING_SCHEDULER_ARM64_H_
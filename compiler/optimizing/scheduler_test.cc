@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "base/arena_allocator.h"
+#include "nodes.h"
+#include "optimizing_unit_test.h"
+#include "scheduler.h"
+
+namespace art {
+
+// A latency model where array loads are much slower than anything else.
+class TestSchedulingLatencyVisitor : public SchedulingLatencyVisitor {
+ public:
+  TestSchedulingLatencyVisitor() {}
+
+  void VisitInstruction(HInstruction* instruction) OVERRIDE {
+    last_visited_latency_ = instruction->IsArrayGet() ? 10u : 1u;
+  }
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(TestSchedulingLatencyVisitor);
+};
+
+class SchedulerTest : public CommonCompilerTest {
+ public:
+  SchedulerTest() : pool_(), allocator_(&pool_) {
+    graph_ = CreateGraph(&allocator_);
+  }
+
+  ~SchedulerTest() { }
+
+  // Builds an entry block with parameters, a single block to be populated by
+  // the tests, and an exit block.
+  void BuildGraph() {
+    entry_ = new (&allocator_) HBasicBlock(graph_);
+    block_ = new (&allocator_) HBasicBlock(graph_);
+    exit_ = new (&allocator_) HBasicBlock(graph_);
+    graph_->AddBlock(entry_);
+    graph_->AddBlock(block_);
+    graph_->AddBlock(exit_);
+    graph_->SetEntryBlock(entry_);
+    graph_->SetExitBlock(exit_);
+    entry_->AddSuccessor(block_);
+    block_->AddSuccessor(exit_);
+
+    array_ = new (&allocator_) HParameterValue(graph_->GetDexFile(), 0, 0, Primitive::kPrimNot);
+    i_ = new (&allocator_) HParameterValue(graph_->GetDexFile(), 0, 1, Primitive::kPrimInt);
+    j_ = new (&allocator_) HParameterValue(graph_->GetDexFile(), 0, 2, Primitive::kPrimInt);
+    entry_->AddInstruction(array_);
+    entry_->AddInstruction(i_);
+    entry_->AddInstruction(j_);
+    entry_->AddInstruction(new (&allocator_) HGoto());
+    exit_->AddInstruction(new (&allocator_) HExit());
+  }
+
+  void PerformScheduling() {
+    graph_->BuildDominatorTree();
+    TestSchedulingLatencyVisitor latency_visitor;
+    HScheduler scheduler(&allocator_, &latency_visitor);
+    scheduler.Schedule(graph_);
+  }
+
+  static size_t PositionOf(HInstruction* instruction) {
+    size_t position = 0u;
+    for (HInstructionIterator it(instruction->GetBlock()->GetInstructions());
+         it.Current() != instruction;
+         it.Advance()) {
+      ++position;
+    }
+    return position;
+  }
+
+  // Check that all inputs from the block are defined before their users.
+  void CheckInputsBeforeUsers() {
+    for (HInstructionIterator it(block_->GetInstructions()); !it.Done(); it.Advance()) {
+      HInstruction* instruction = it.Current();
+      for (size_t i = 0, e = instruction->InputCount(); i < e; ++i) {
+        HInstruction* input = instruction->InputAt(i);
+        if (input->GetBlock() == block_) {
+          EXPECT_LT(PositionOf(input), PositionOf(instruction));
+        }
+      }
+    }
+  }
+
+  ArenaPool pool_;
+  ArenaAllocator allocator_;
+
+  HGraph* graph_;
+  HBasicBlock* entry_;
+  HBasicBlock* block_;
+  HBasicBlock* exit_;
+  HInstruction* array_;
+  HInstruction* i_;
+  HInstruction* j_;
+};
+
+TEST_F(SchedulerTest, StartLongLatencyLoadsEarly) {
+  BuildGraph();
+  HInstruction* c0 = graph_->GetIntConstant(0);
+  HInstruction* c1 = graph_->GetIntConstant(1);
+  HInstruction* c2 = graph_->GetIntConstant(2);
+
+  HInstruction* add1 = new (&allocator_) HAdd(Primitive::kPrimInt, i_, j_);
+  HInstruction* add2 = new (&allocator_) HAdd(Primitive::kPrimInt, add1, j_);
+  HInstruction* get1 = new (&allocator_) HArrayGet(array_, c0, Primitive::kPrimInt, 0);
+  HInstruction* get2 = new (&allocator_) HArrayGet(array_, get1, Primitive::kPrimInt, 0);
+  HInstruction* add3 = new (&allocator_) HAdd(Primitive::kPrimInt, add2, get2);
+  HInstruction* set = new (&allocator_) HArraySet(array_, c1, add3, Primitive::kPrimInt, 0);
+  HInstruction* get3 = new (&allocator_) HArrayGet(array_, c2, Primitive::kPrimInt, 0);
+  HInstruction* ret = new (&allocator_) HReturn(get3);
+  block_->AddInstruction(add1);
+  block_->AddInstruction(add2);
+  block_->AddInstruction(get1);
+  block_->AddInstruction(get2);
+  block_->AddInstruction(add3);
+  block_->AddInstruction(set);
+  block_->AddInstruction(get3);
+  block_->AddInstruction(ret);
+
+  PerformScheduling();
+
+  // The chain of loads is the critical path and starts the block.
+  EXPECT_EQ(block_->GetFirstInstruction(), get1);
+  EXPECT_LT(PositionOf(get1), PositionOf(add1));
+  // The load after the store must not be moved above it.
+  EXPECT_LT(PositionOf(set), PositionOf(get3));
+  EXPECT_EQ(block_->GetLastInstruction(), ret);
+  CheckInputsBeforeUsers();
+}
+
+TEST_F(SchedulerTest, KeepThrowingAndFusedInstructionsInOrder) {
+  BuildGraph();
+  HInstruction* c0 = graph_->GetIntConstant(0);
+
+  HInstruction* add1 = new (&allocator_) HAdd(Primitive::kPrimInt, i_, j_);
+  HInstruction* add2 = new (&allocator_) HAdd(Primitive::kPrimInt, add1, j_);
+  HInstruction* null_check = new (&allocator_) HNullCheck(array_, 0);
+  HInstruction* length = new (&allocator_) HArrayLength(null_check, 0);
+  HInstruction* bounds_check = new (&allocator_) HBoundsCheck(i_, length, 0);
+  HInstruction* set =
+      new (&allocator_) HArraySet(null_check, bounds_check, add2, Primitive::kPrimInt, 0);
+  HInstruction* div_zero_check = new (&allocator_) HDivZeroCheck(j_, 0);
+  HInstruction* div = new (&allocator_) HDiv(Primitive::kPrimInt, add1, div_zero_check, 0);
+  HInstruction* condition = new (&allocator_) HGreaterThan(length, c0);
+  HInstruction* select = new (&allocator_) HSelect(condition, div, add2, 0);
+  HInstruction* ret = new (&allocator_) HReturn(select);
+  block_->AddInstruction(add1);
+  block_->AddInstruction(add2);
+  block_->AddInstruction(null_check);
+  block_->AddInstruction(length);
+  block_->AddInstruction(bounds_check);
+  block_->AddInstruction(set);
+  block_->AddInstruction(div_zero_check);
+  block_->AddInstruction(div);
+  block_->AddInstruction(condition);
+  block_->AddInstruction(select);
+  block_->AddInstruction(ret);
+
+  PerformScheduling();
+
+  // Instructions emitted at their use site stay next to their user.
+  EXPECT_EQ(null_check->GetNext(), length);
+  EXPECT_EQ(condition->GetNext(), select);
+  // Exceptions are thrown in order, and writes do not move across throwing instructions.
+  EXPECT_LT(PositionOf(null_check), PositionOf(bounds_check));
+  EXPECT_LT(PositionOf(bounds_check), PositionOf(set));
+  EXPECT_LT(PositionOf(bounds_check), PositionOf(div_zero_check));
+  EXPECT_LT(PositionOf(set), PositionOf(div_zero_check));
+  EXPECT_EQ(block_->GetLastInstruction(), ret);
+  CheckInputsBeforeUsers();
+}
+
+}  // namespace art
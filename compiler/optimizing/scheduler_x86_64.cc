@@ -0,0 +1,152 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "scheduler_x86_64.h"
+
+namespace art {
+namespace x86_64 {
+
+static constexpr uint32_t kX86_64IntegerOpLatency = 1u;
+static constexpr uint32_t kX86_64MulIntegerLatency = 3u;
+static constexpr uint32_t kX86_64DivIntLatency = 26u;
+static constexpr uint32_t kX86_64DivLongLatency = 40u;
+static constexpr uint32_t kX86_64FloatingPointOpLatency = 3u;
+static constexpr uint32_t kX86_64MulFloatingPointLatency = 5u;
+static constexpr uint32_t kX86_64DivFloatLatency = 11u;
+static constexpr uint32_t kX86_64DivDoubleLatency = 14u;
+static constexpr uint32_t kX86_64TypeConversionLatency = 4u;
+static constexpr uint32_t kX86_64MemoryLoadLatency = 4u;
+static constexpr uint32_t kX86_64MemoryStoreLatency = 1u;
+
+void SchedulingLatencyVisitorX86_64::VisitBinaryOperation(HBinaryOperation* instruction) {
+  last_visited_latency_ = Primitive::IsFloatingPointType(instruction->GetResultType())
+      ? kX86_64FloatingPointOpLatency
+      : kX86_64IntegerOpLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitUnaryOperation(HUnaryOperation* instruction) {
+  last_visited_latency_ = Primitive::IsFloatingPointType(instruction->GetResultType())
+      ? kX86_64FloatingPointOpLatency
+      : kX86_64IntegerOpLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitMul(HMul* instruction) {
+  last_visited_latency_ = Primitive::IsFloatingPointType(instruction->GetResultType())
+      ? kX86_64MulFloatingPointLatency
+      : kX86_64MulIntegerLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitDiv(HDiv* instruction) {
+  switch (instruction->GetResultType()) {
+    case Primitive::kPrimFloat:
+      last_visited_latency_ = kX86_64DivFloatLatency;
+      break;
+    case Primitive::kPrimDouble:
+      last_visited_latency_ = kX86_64DivDoubleLatency;
+      break;
+    default:
+      if (instruction->GetRight()->IsConstant()) {
+        // Divisions by constants are strength-reduced to multiplications and shifts.
+        last_visited_latency_ = kX86_64MulIntegerLatency + kX86_64IntegerOpLatency;
+        return;
+      }
+      last_visited_latency_ = (instruction->GetResultType() == Primitive::kPrimLong)
+          ? kX86_64DivLongLatency
+          : kX86_64DivIntLatency;
+      break;
+  }
+  // Divisions are not pipelined.
+  last_visited_internal_latency_ = last_visited_latency_;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitRem(HRem* instruction) {
+  // Only integer remainders are schedulable; idiv computes them along with the quotient.
+  DCHECK(Primitive::IsIntegralType(instruction->GetResultType()));
+  if (instruction->GetRight()->IsConstant()) {
+    last_visited_latency_ = 2u * kX86_64MulIntegerLatency + kX86_64IntegerOpLatency;
+    return;
+  }
+  last_visited_latency_ = (instruction->GetResultType() == Primitive::kPrimLong)
+      ? kX86_64DivLongLatency
+      : kX86_64DivIntLatency;
+  last_visited_internal_latency_ = last_visited_latency_;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitTypeConversion(HTypeConversion* instruction) {
+  if (Primitive::IsFloatingPointType(instruction->GetResultType()) ||
+      Primitive::IsFloatingPointType(instruction->GetInputType())) {
+    last_visited_latency_ = kX86_64TypeConversionLatency;
+  } else {
+    last_visited_latency_ = kX86_64IntegerOpLatency;
+  }
+}
+
+void SchedulingLatencyVisitorX86_64::VisitSelect(HSelect* instruction ATTRIBUTE_UNUSED) {
+  // A cmov, or a branch for floating-point values.
+  last_visited_latency_ = kX86_64IntegerOpLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitArrayGet(HArrayGet* instruction ATTRIBUTE_UNUSED) {
+  // The address computation is folded into the addressing mode.
+  last_visited_latency_ = kX86_64MemoryLoadLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitArraySet(HArraySet* instruction ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = kX86_64MemoryStoreLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitArrayLength(HArrayLength* instruction ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = kX86_64MemoryLoadLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitBoundsCheck(HBoundsCheck* instruction ATTRIBUTE_UNUSED) {
+  // A compare and a branch. The result is the index, available immediately.
+  last_visited_internal_latency_ = kX86_64IntegerOpLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitNullCheck(HNullCheck* instruction ATTRIBUTE_UNUSED) {
+  // Either folded into the user or a test and branch; the result is the input.
+  last_visited_latency_ = 0u;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitDivZeroCheck(
+    HDivZeroCheck* instruction ATTRIBUTE_UNUSED) {
+  // A test and branch; the result is the input.
+  last_visited_latency_ = 0u;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitInstanceFieldGet(
+    HInstanceFieldGet* instruction ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = kX86_64MemoryLoadLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitInstanceFieldSet(
+    HInstanceFieldSet* instruction ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = kX86_64MemoryStoreLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitStaticFieldGet(
+    HStaticFieldGet* instruction ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = kX86_64MemoryLoadLatency;
+}
+
+void SchedulingLatencyVisitorX86_64::VisitStaticFieldSet(
+    HStaticFieldSet* instruction ATTRIBUTE_UNUSED) {
+  last_visited_latency_ = kX86_64MemoryStoreLatency;
+}
+
+}  // namespace x86_64
+}  // namespace art
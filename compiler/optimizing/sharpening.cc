@@ -159,6 +159,9 @@ void HSharpening::ProcessLoadString(HLoadString* load_string) {
 
   const DexFile& dex_file = load_string->GetDexFile();
   uint32_t string_index = load_string->GetStringIndex();
+  // Strings can be evicted from hash-indexed dex cache strings arrays at any time,
+  // so compiled code checks the string index of the pair it loads the string from.
+  const bool has_hashed_strings = mirror::DexCache::HasHashedStrings(dex_file.NumStringIds());
 
   bool is_in_dex_cache = false;
   HLoadString::LoadKind desired_load_kind;
@@ -195,6 +198,8 @@ void HSharpening::ProcessLoadString(HLoadString* load_string) {
       if (string != nullptr && runtime->GetHeap()->ObjectIsInBootImageSpace(string)) {
         desired_load_kind = HLoadString::LoadKind::kBootImageAddress;
         address = reinterpret_cast64<uint64_t>(string);
+      } else if (has_hashed_strings) {
+        desired_load_kind = HLoadString::LoadKind::kHashedDexCacheViaMethod;
       } else {
         // Note: If the string is not in the dex cache, the instruction needs environment
         // and will not be inlined across dex files. Within a dex file, the slow-path helper
@@ -220,19 +225,36 @@ void HSharpening::ProcessLoadString(HLoadString* load_string) {
         }
       } else {
         // Not JIT and the string is not in boot image.
-        desired_load_kind = HLoadString::LoadKind::kDexCachePcRelative;
+        desired_load_kind = has_hashed_strings
+            ? HLoadString::LoadKind::kHashedDexCacheViaMethod
+            : HLoadString::LoadKind::kDexCachePcRelative;
       }
     }
   }
+
+  HLoadString::LoadKind load_kind = codegen_->GetSupportedLoadStringKind(desired_load_kind);
+  if (has_hashed_strings &&
+      (load_kind == HLoadString::LoadKind::kDexCacheAddress ||
+       load_kind == HLoadString::LoadKind::kDexCachePcRelative ||
+       load_kind == HLoadString::LoadKind::kDexCacheViaMethod)) {
+    // Dex cache loads of boot image strings from PIC code or codegen fallbacks to them.
+    load_kind = codegen_->GetSupportedLoadStringKind(
+        HLoadString::LoadKind::kHashedDexCacheViaMethod);
+  }
+  if (load_kind == HLoadString::LoadKind::kHashedDexCacheViaMethod ||
+      load_kind == HLoadString::LoadKind::kRuntimeCall) {
+    is_in_dex_cache = false;
+  }
   if (is_in_dex_cache) {
     load_string->MarkInDexCache();
   }
 
-  HLoadString::LoadKind load_kind = codegen_->GetSupportedLoadStringKind(desired_load_kind);
   switch (load_kind) {
     case HLoadString::LoadKind::kBootImageLinkTimeAddress:
     case HLoadString::LoadKind::kBootImageLinkTimePcRelative:
     case HLoadString::LoadKind::kDexCacheViaMethod:
+    case HLoadString::LoadKind::kHashedDexCacheViaMethod:
+    case HLoadString::LoadKind::kRuntimeCall:
       load_string->SetLoadKindWithStringReference(load_kind, dex_file, string_index);
       break;
     case HLoadString::LoadKind::kBootImageAddress:
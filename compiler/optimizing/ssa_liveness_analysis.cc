@@ -59,10 +59,34 @@ static void AddToListForLinearization(ArenaVector<HBasicBlock*>* worklist, HBasi
   worklist->insert(insert_pos.base(), block);
 }
 
+// Returns whether all paths from `block` end with a throw that leaves the method. Such blocks
+// handle errors, so they are unlikely to run. The successors of `block` must have been visited.
+static bool IsThrowingBlock(HBasicBlock* block, const ArenaBitVector& throwing_blocks) {
+  if (block->IsEntryBlock() ||
+      block->IsExitBlock() ||
+      block->IsInLoop() ||
+      block->IsCatchBlock() ||
+      block->IsTryBlock()) {
+    return false;
+  }
+  if (block->GetLastInstruction()->IsThrow()) {
+    return true;
+  }
+  for (HBasicBlock* successor : block->GetSuccessors()) {
+    if (!throwing_blocks.IsBitSet(successor->GetBlockId())) {
+      return false;
+    }
+  }
+  return !block->GetSuccessors().empty();
+}
+
 void SsaLivenessAnalysis::LinearizeGraph() {
   // Create a reverse post ordering with the following properties:
   // - Blocks in a loop are consecutive,
-  // - Back-edge is the last block before loop exits.
+  // - Back-edge is the last block before loop exits,
+  // - Blocks that can only end up throwing are placed after the other blocks so that the code
+  //   of the exception paths is moved out of the way of the code that runs. They stay in the
+  //   code of the method: nothing is split into a separate section.
 
   // (1): Record the number of forward predecessors for each block. This is to
   //      ensure the resulting order is reverse post order. We could use the
@@ -79,13 +103,23 @@ void SsaLivenessAnalysis::LinearizeGraph() {
     }
     forward_predecessors[block->GetBlockId()] = number_of_forward_predecessors;
   }
+  ArenaBitVector throwing_blocks(
+      graph_->GetArena(), graph_->GetBlocks().size(), false, kArenaAllocSsaLiveness);
+  for (HPostOrderIterator it(*graph_); !it.Done(); it.Advance()) {
+    if (IsThrowingBlock(it.Current(), throwing_blocks)) {
+      throwing_blocks.SetBit(it.Current()->GetBlockId());
+    }
+  }
 
   // (2): Following a worklist approach, first start with the entry block, and
   //      iterate over the successors. When all non-back edge predecessors of a
   //      successor block are visited, the successor block is added in the worklist
   //      following an order that satisfies the requirements to build our linear graph.
+  //      Throwing blocks are held back until the worklist runs empty. They are not in loops, so
+  //      this keeps the blocks of loops consecutive.
   graph_->linear_order_.reserve(graph_->GetReversePostOrder().size());
   ArenaVector<HBasicBlock*> worklist(graph_->GetArena()->Adapter(kArenaAllocSsaLiveness));
+  ArenaVector<HBasicBlock*> throwing_worklist(graph_->GetArena()->Adapter(kArenaAllocSsaLiveness));
   worklist.push_back(graph_->GetEntryBlock());
   do {
     HBasicBlock* current = worklist.back();
@@ -95,10 +129,19 @@ void SsaLivenessAnalysis::LinearizeGraph() {
       int block_id = successor->GetBlockId();
       size_t number_of_remaining_predecessors = forward_predecessors[block_id];
       if (number_of_remaining_predecessors == 1) {
-        AddToListForLinearization(&worklist, successor);
+        if (throwing_blocks.IsBitSet(block_id)) {
+          throwing_worklist.push_back(successor);
+        } else {
+          AddToListForLinearization(&worklist, successor);
+        }
       }
       forward_predecessors[block_id] = number_of_remaining_predecessors - 1;
     }
+    if (worklist.empty()) {
+      // Keep the throwing blocks in the order they became ready.
+      worklist.assign(throwing_worklist.rbegin(), throwing_worklist.rend());
+      throwing_worklist.clear();
+    }
   } while (!worklist.empty());
 }
 
@@ -1219,7 +1219,8 @@ class SsaLivenessAnalysis : public ValueObject {
  private:
   // Linearize the graph so that:
   // (1): a block is always after its dominator,
-  // (2): blocks of loops are contiguous.
+  // (2): blocks of loops are contiguous,
+  // (3): blocks that can only end up throwing come last.
   // This creates a natural and efficient ordering when visualizing live ranges.
   void LinearizeGraph();
 
@@ -391,6 +391,8 @@ class X86_64Assembler FINAL : public Assembler {
 
   void movaps(XmmRegister dst, XmmRegister src);
 
+  void movdqu(XmmRegister dst, const Address& src);
+
   void movss(XmmRegister dst, const Address& src);
   void movss(const Address& dst, XmmRegister src);
   void movss(XmmRegister dst, XmmRegister src);
@@ -467,6 +469,9 @@ class X86_64Assembler FINAL : public Assembler {
   void xorps(XmmRegister dst, const Address& src);
   void xorps(XmmRegister dst, XmmRegister src);
 
+  void pcmpeqb(XmmRegister dst, XmmRegister src);
+  void pmovmskb(CpuRegister dst, XmmRegister src);
+
   void andpd(XmmRegister dst, const Address& src);
   void andpd(XmmRegister dst, XmmRegister src);
   void andps(XmmRegister dst, XmmRegister src);
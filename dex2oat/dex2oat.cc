@@ -317,6 +317,12 @@ NO_RETURN static void Usage(const char* fmt, ...) {
              CompilerOptions::kDefaultInlineMaxCodeUnits);
   UsageError("      Default: %d", CompilerOptions::kDefaultInlineMaxCodeUnits);
   UsageError("");
+  UsageError("  --register-allocation-strategy=(linear-scan|graph-color|adaptive): the");
+  UsageError("      register allocator used by Optimizing. 'adaptive' uses graph coloring for");
+  UsageError("      methods in the profile whose register pressure is high, and linear scan");
+  UsageError("      for the others.");
+  UsageError("      Default: linear-scan");
+  UsageError("");
   UsageError("  --dump-timing: display a breakdown of where time was spent");
   UsageError("");
   UsageError("  --include-patch-information: Include patching information so the generated code");
@@ -378,6 +384,10 @@ NO_RETURN static void Usage(const char* fmt, ...) {
   UsageError("  --multi-image: specify that separate oat and image files be generated for each "
              "input dex file.");
   UsageError("");
+  UsageError("  --layout-dex-files: rewrite the dex files stored in the oat file so that the");
+  UsageError("      code, strings and classes of the profile methods are grouped at the start of");
+  UsageError("      their sections, and write their compiled code first. Requires a profile.");
+  UsageError("");
   UsageError("  --force-determinism: force the compiler to emit a deterministic output.");
   UsageError("      This option is incompatible with read barriers (e.g., if dex2oat has been");
   UsageError("      built with the environment variable `ART_USE_READ_BARRIER` set to `true`).");
@@ -519,6 +529,7 @@ class Dex2Oat FINAL {
       app_image_(false),
       boot_image_(false),
       multi_image_(false),
+      layout_dex_files_(false),
       is_host_(false),
       class_loader_(nullptr),
       elf_writers_(),
@@ -870,6 +881,9 @@ class Dex2Oat FINAL {
     if (!IsBootImage() && multi_image_) {
       Usage("--multi-image can only be used when creating boot images");
     }
+    if (layout_dex_files_ && !UseProfileGuidedCompilation()) {
+      Usage("--layout-dex-files requires a profile");
+    }
     if (IsBootImage() && multi_image_ && image_filenames_.size() > 1) {
       Usage("--multi-image cannot be used with multiple image names");
     }
@@ -1163,6 +1177,8 @@ class Dex2Oat FINAL {
         Split(option.substr(strlen("--verbose-methods=")).ToString(), ',', &verbose_methods_);
       } else if (option == "--multi-image") {
         multi_image_ = true;
+      } else if (option == "--layout-dex-files") {
+        layout_dex_files_ = true;
       } else if (option.starts_with("--no-inline-from=")) {
         no_inline_from_string_ = option.substr(strlen("--no-inline-from=")).data();
       } else if (option == "--force-determinism") {
@@ -1273,9 +1289,11 @@ class Dex2Oat FINAL {
           profile_compilation_info_->GetResolvedClasses());
 
       // Filter out class path classes since we don't want to include these in the image.
+      // The resolved classes are keyed by profile key rather than by full dex location.
       std::unordered_set<std::string> dex_files_locations;
       for (const DexFile* dex_file : dex_files_) {
-        dex_files_locations.insert(dex_file->GetLocation());
+        dex_files_locations.insert(
+            ProfileCompilationInfo::GetProfileDexFileKey(dex_file->GetLocation()));
       }
       for (auto it = resolved_classes.begin(); it != resolved_classes.end(); ) {
         if (dex_files_locations.find(it->GetDexLocation()) == dex_files_locations.end()) {
@@ -2144,7 +2162,10 @@ class Dex2Oat FINAL {
                                                      compiler_options_.get(),
                                                      oat_file.get()));
       elf_writers_.back()->Start();
-      oat_writers_.emplace_back(new OatWriter(IsBootImage(), timings_));
+      oat_writers_.emplace_back(new OatWriter(
+          IsBootImage(),
+          timings_,
+          layout_dex_files_ ? profile_compilation_info_.get() : nullptr));
     }
   }
 
@@ -2470,6 +2491,7 @@ class Dex2Oat FINAL {
   bool app_image_;
   bool boot_image_;
   bool multi_image_;
+  bool layout_dex_files_;
   bool is_host_;
   std::string android_root_;
   // Dex files we are compiling, does not include the class path dex files.
@@ -61,17 +61,20 @@ class ProfileAssistantTest : public CommonRuntimeTest {
     ASSERT_TRUE(file_info.Equals(info));
   }
 
-    // Runs test with given arguments.
-  int ProcessProfiles(const std::vector<int>& profiles_fd, int reference_profile_fd) {
+  std::string GetProfmanCmd() {
     std::string file_path = GetTestAndroidRoot();
     file_path += "/bin/profman";
     if (kIsDebugBuild) {
       file_path += "d";
     }
-
     EXPECT_TRUE(OS::FileExists(file_path.c_str())) << file_path << " should be a valid file path";
+    return file_path;
+  }
+
+    // Runs test with given arguments.
+  int ProcessProfiles(const std::vector<int>& profiles_fd, int reference_profile_fd) {
     std::vector<std::string> argv_str;
-    argv_str.push_back(file_path);
+    argv_str.push_back(GetProfmanCmd());
     for (size_t k = 0; k < profiles_fd.size(); k++) {
       argv_str.push_back("--profile-file-fd=" + std::to_string(profiles_fd[k]));
     }
@@ -80,6 +83,28 @@ class ProfileAssistantTest : public CommonRuntimeTest {
     std::string error;
     return ExecAndReturnCode(argv_str, &error);
   }
+
+  // Runs profman to create `reference_profile` from the text profile `content`, resolved
+  // against the dex file `dex_location`.
+  int CreateProfile(const std::string& content,
+                    const std::string& dex_location,
+                    const ScratchFile& reference_profile) {
+    ScratchFile text_profile;
+    EXPECT_TRUE(text_profile.GetFile()->WriteFully(content.c_str(), content.length()));
+    EXPECT_EQ(0, text_profile.GetFile()->Flush());
+    int apk_fd = open(dex_location.c_str(), O_RDONLY);
+    EXPECT_GE(apk_fd, 0);
+    std::vector<std::string> argv_str;
+    argv_str.push_back(GetProfmanCmd());
+    argv_str.push_back("--create-profile-from=" + text_profile.GetFilename());
+    argv_str.push_back("--reference-profile-file-fd=" + std::to_string(GetFd(reference_profile)));
+    argv_str.push_back("--apk-fd=" + std::to_string(apk_fd));
+    argv_str.push_back("--dex-location=" + dex_location);
+    std::string error;
+    int result = ExecAndReturnCode(argv_str, &error);
+    close(apk_fd);
+    return result;
+  }
 };
 
 TEST_F(ProfileAssistantTest, AdviseCompilationEmptyReferences) {
@@ -282,4 +307,39 @@ TEST_F(ProfileAssistantTest, FailProcessingBecauseOfReferenceProfiles) {
   CheckProfileInfo(profile1, info1);
 }
 
+TEST_F(ProfileAssistantTest, CreateProfileKeepsOrder) {
+  ScratchFile reference_profile;
+  const DexFile& dex_file = *java_lang_dex_file_;
+  std::string content =
+      "# Startup trace.\n"
+      "Ljava/lang/String;->length()I\n"
+      "Ljava/lang/Object;\n"
+      "Lcom/example/DoesNotExist;\n"
+      "Ljava/lang/String;\n"
+      "Ljava/lang/Object;->hashCode()I\n";
+  ASSERT_EQ(0, CreateProfile(content, dex_file.GetLocation(), reference_profile));
+
+  ProfileCompilationInfo info;
+  ASSERT_TRUE(reference_profile.GetFile()->ResetOffset());
+  ASSERT_TRUE(info.Load(GetFd(reference_profile)));
+
+  const DexFile::ClassDef* string_def = dex_file.FindClassDef("Ljava/lang/String;",
+                                                              ComputeModifiedUtf8Hash(
+                                                                  "Ljava/lang/String;"));
+  const DexFile::ClassDef* object_def = dex_file.FindClassDef("Ljava/lang/Object;",
+                                                              ComputeModifiedUtf8Hash(
+                                                                  "Ljava/lang/Object;"));
+  ASSERT_TRUE(string_def != nullptr);
+  ASSERT_TRUE(object_def != nullptr);
+  std::vector<uint16_t> expected_classes = {
+      dex_file.GetIndexForClassDef(*string_def),
+      dex_file.GetIndexForClassDef(*object_def),
+  };
+  EXPECT_EQ(expected_classes, info.GetClassesInOrder(dex_file));
+  std::vector<uint16_t> methods = info.GetMethodsInOrder(dex_file);
+  ASSERT_EQ(2u, methods.size());
+  EXPECT_STREQ("length", dex_file.GetMethodName(dex_file.GetMethodId(methods[0])));
+  EXPECT_STREQ("hashCode", dex_file.GetMethodName(dex_file.GetMethodId(methods[1])));
+}
+
 }  // namespace art
@@ -107,6 +107,13 @@ NO_RETURN static void Usage(const char *fmt, ...) {
   UsageError("  --apk-fd=<number>: file descriptor containing an open APK to");
   UsageError("      search for dex files");
   UsageError("");
+  UsageError("  --create-profile-from=<filename>: creates the reference profile from a text");
+  UsageError("      file instead of merging profiles. Each line holds a class descriptor");
+  UsageError("      (Lfoo/Bar;) or a method (Lfoo/Bar;->name(Ljava/lang/String;)V), in the");
+  UsageError("      order they are first used, e.g. as extracted from a startup method trace.");
+  UsageError("      The order is kept in the profile and used to lay out app images.");
+  UsageError("      Requires --apk-fd and --dex-location to find the dex files.");
+  UsageError("");
 
   exit(EXIT_FAILURE);
 }
@@ -159,6 +166,8 @@ class ProfMan FINAL {
         dex_locations_.push_back(option.substr(strlen("--dex-location=")).ToString());
       } else if (option.starts_with("--apk-fd=")) {
         ParseFdForCollection(option, "--apk-fd", &apks_fd_);
+      } else if (option.starts_with("--create-profile-from=")) {
+        create_profile_from_file_ = option.substr(strlen("--create-profile-from=")).ToString();
       } else {
         Usage("Unknown argument '%s'", option.data());
       }
@@ -168,6 +177,18 @@ class ProfMan FINAL {
     bool has_reference_profile = !reference_profile_file_.empty() ||
         FdIsValid(reference_profile_file_fd_);
 
+    if (!create_profile_from_file_.empty()) {
+      if (has_profiles) {
+        Usage("Profile files should not be specified with --create-profile-from");
+      }
+      if (!has_reference_profile) {
+        Usage("No reference profile file specified.");
+      }
+      if (dex_locations_.empty() || dex_locations_.size() != apks_fd_.size()) {
+        Usage("--create-profile-from requires matching --apk-fd and --dex-location");
+      }
+      return;
+    }
     // --dump-only may be specified with only --reference-profiles present.
     if (!dump_only_ && !has_profiles) {
       Usage("No profile files specified.");
@@ -230,31 +251,11 @@ class ProfMan FINAL {
     static const char* kOrdinaryProfile = "=== profile ===";
     static const char* kReferenceProfile = "=== reference profile ===";
 
-    // Open apk/zip files and and read dex files.
-    MemMap::Init();  // for ZipArchive::OpenFromFd
+    std::vector<std::unique_ptr<const DexFile>> opened_dex_files;
+    OpenApkFilesFromLocations(&opened_dex_files);
     std::vector<const DexFile*> dex_files;
-    assert(dex_locations_.size() == apks_fd_.size());
-    for (size_t i = 0; i < dex_locations_.size(); ++i) {
-      std::string error_msg;
-      std::vector<std::unique_ptr<const DexFile>> dex_files_for_location;
-      std::unique_ptr<ZipArchive> zip_archive(ZipArchive::OpenFromFd(apks_fd_[i],
-                                                                     dex_locations_[i].c_str(),
-                                                                     &error_msg));
-      if (zip_archive == nullptr) {
-        LOG(WARNING) << "OpenFromFd failed for '" << dex_locations_[i] << "' " << error_msg;
-        continue;
-      }
-      if (DexFile::OpenFromZip(*zip_archive,
-                               dex_locations_[i],
-                               &error_msg,
-                               &dex_files_for_location)) {
-      } else {
-        LOG(WARNING) << "OpenFromZip failed for '" << dex_locations_[i] << "' " << error_msg;
-        continue;
-      }
-      for (std::unique_ptr<const DexFile>& dex_file : dex_files_for_location) {
-        dex_files.push_back(dex_file.release());
-      }
+    for (const std::unique_ptr<const DexFile>& dex_file : opened_dex_files) {
+      dex_files.push_back(dex_file.get());
     }
 
     std::string dump;
@@ -315,7 +316,128 @@ class ProfMan FINAL {
     return dump_only_;
   }
 
+  bool ShouldCreateProfile() {
+    return !create_profile_from_file_.empty();
+  }
+
+  // Creates the reference profile from the classes and methods listed in
+  // create_profile_from_file_, keeping their order. Entries that cannot be found in the dex files
+  // are skipped with a warning, as traces usually include classes and methods of other class
+  // loaders.
+  int CreateProfile() {
+    std::string content;
+    if (!ReadFileToString(create_profile_from_file_, &content)) {
+      LOG(ERROR) << "Cannot read " << create_profile_from_file_;
+      return -1;
+    }
+    std::vector<std::unique_ptr<const DexFile>> dex_files;
+    OpenApkFilesFromLocations(&dex_files);
+
+    ProfileCompilationInfo info;
+    std::vector<std::string> lines;
+    Split(content, '\n', &lines);
+    for (const std::string& raw_line : lines) {
+      const std::string line = Trim(raw_line);
+      if (line.empty() || line[0] == '#') {
+        continue;
+      }
+      if (!AddProfileLine(dex_files, line, &info)) {
+        LOG(WARNING) << "Could not find '" << line << "' in the dex files";
+      }
+    }
+
+    int fd = reference_profile_file_fd_;
+    if (!reference_profile_file_.empty()) {
+      fd = open(reference_profile_file_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+      if (fd < 0) {
+        PLOG(ERROR) << "Cannot open " << reference_profile_file_;
+        return -1;
+      }
+    }
+    bool result = info.Save(fd);
+    if (close(fd) < 0) {
+      PLOG(WARNING) << "Failed to close descriptor";
+    }
+    return result ? 0 : -1;
+  }
+
  private:
+  // Adds the class or method described by `line` to `info`. Returns false if the class is not
+  // defined in any of the dex files or the method cannot be found.
+  static bool AddProfileLine(const std::vector<std::unique_ptr<const DexFile>>& dex_files,
+                             const std::string& line,
+                             ProfileCompilationInfo* info) {
+    static const char kMethodSeparator[] = "->";
+    size_t separator_pos = line.find(kMethodSeparator);
+    std::string descriptor = line.substr(0, separator_pos);
+    for (const std::unique_ptr<const DexFile>& dex_file : dex_files) {
+      const DexFile::TypeId* type_id = dex_file->FindTypeId(descriptor.c_str());
+      if (type_id == nullptr) {
+        continue;
+      }
+      const DexFile::ClassDef* class_def = dex_file->FindClassDef(
+          dex_file->GetIndexForTypeId(*type_id));
+      if (class_def == nullptr) {
+        // Only referenced from this dex file.
+        continue;
+      }
+      // Using a method implies its class was loaded first.
+      if (!info->AddClass(*dex_file, dex_file->GetIndexForClassDef(*class_def))) {
+        return false;
+      }
+      if (separator_pos == std::string::npos) {
+        return true;
+      }
+      std::string name_and_signature = line.substr(separator_pos + strlen(kMethodSeparator));
+      size_t signature_pos = name_and_signature.find('(');
+      if (signature_pos == std::string::npos) {
+        return false;
+      }
+      std::string name = name_and_signature.substr(0, signature_pos);
+      const DexFile::StringId* name_id = dex_file->FindStringId(name.c_str());
+      uint16_t return_type_idx;
+      std::vector<uint16_t> param_type_idxs;
+      if (name_id == nullptr ||
+          !dex_file->CreateTypeList(name_and_signature.substr(signature_pos),
+                                    &return_type_idx,
+                                    &param_type_idxs)) {
+        return false;
+      }
+      const DexFile::ProtoId* proto_id = dex_file->FindProtoId(return_type_idx, param_type_idxs);
+      if (proto_id == nullptr) {
+        return false;
+      }
+      const DexFile::MethodId* method_id = dex_file->FindMethodId(*type_id, *name_id, *proto_id);
+      if (method_id == nullptr) {
+        return false;
+      }
+      return info->AddMethod(MethodReference(dex_file.get(),
+                                             dex_file->GetIndexForMethodId(*method_id)));
+    }
+    return false;
+  }
+
+  // Opens the dex files of the apks given with --apk-fd and --dex-location.
+  void OpenApkFilesFromLocations(std::vector<std::unique_ptr<const DexFile>>* dex_files) {
+    // Open apk/zip files and and read dex files.
+    MemMap::Init();  // for ZipArchive::OpenFromFd
+    assert(dex_locations_.size() == apks_fd_.size());
+    for (size_t i = 0; i < dex_locations_.size(); ++i) {
+      std::string error_msg;
+      std::unique_ptr<ZipArchive> zip_archive(ZipArchive::OpenFromFd(apks_fd_[i],
+                                                                     dex_locations_[i].c_str(),
+                                                                     &error_msg));
+      if (zip_archive == nullptr) {
+        LOG(WARNING) << "OpenFromFd failed for '" << dex_locations_[i] << "' " << error_msg;
+        continue;
+      }
+      if (!DexFile::OpenFromZip(*zip_archive, dex_locations_[i], &error_msg, dex_files)) {
+        LOG(WARNING) << "OpenFromZip failed for '" << dex_locations_[i] << "' " << error_msg;
+        continue;
+      }
+    }
+  }
+
   static void ParseFdForCollection(const StringPiece& option,
                                    const char* arg_name,
                                    std::vector<int>* fds) {
@@ -346,6 +468,7 @@ class ProfMan FINAL {
   std::vector<int> apks_fd_;
   std::string reference_profile_file_;
   int reference_profile_file_fd_;
+  std::string create_profile_from_file_;
   bool dump_only_;
   int dump_output_to_fd_;
   uint64_t start_ns_;
@@ -361,6 +484,9 @@ static int profman(int argc, char** argv) {
   if (profman.ShouldOnlyDumpProfile()) {
     return profman.DumpProfileInfo();
   }
+  if (profman.ShouldCreateProfile()) {
+    return profman.CreateProfile();
+  }
   // Process profile information and assess if we need to do a profile guided compilation.
   // This operation involves I/O.
   return profman.ProcessProfiles();
@@ -70,6 +70,7 @@ LIBART_COMMON_SRC_FILES := \
   gc/collector/semi_space.cc \
   gc/collector/sticky_mark_sweep.cc \
   gc/gc_cause.cc \
+  gc/gc_record.cc \
   gc/heap.cc \
   gc/reference_processor.cc \
   gc/reference_queue.cc \
@@ -193,6 +194,7 @@ LIBART_COMMON_SRC_FILES := \
   verifier/reg_type.cc \
   verifier/reg_type_cache.cc \
   verifier/register_line.cc \
+  verifier/verifier_deps.cc \
   well_known_classes.cc \
   zip_archive.cc
 
@@ -30,6 +30,14 @@ TEST(Arm64InstructionSetFeaturesTest, Arm64Features) {
   EXPECT_TRUE(arm64_features->Equals(arm64_features.get()));
   EXPECT_STREQ("smp,a53", arm64_features->GetFeatureString().c_str());
   EXPECT_EQ(arm64_features->AsBitmap(), 3U);
+
+  // Build features for a Cortex-A57 class processor, which does not need the A53 fixes.
+  std::unique_ptr<const InstructionSetFeatures> a57_features(
+      InstructionSetFeatures::FromVariant(kArm64, "cortex-a57", &error_msg));
+  ASSERT_TRUE(a57_features.get() != nullptr) << error_msg;
+  EXPECT_FALSE(a57_features->Equals(arm64_features.get()));
+  EXPECT_STREQ("smp,-a53", a57_features->GetFeatureString().c_str());
+  EXPECT_EQ(a57_features->AsBitmap(), 1U);
 }
 
 }  // namespace art
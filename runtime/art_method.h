@@ -371,6 +371,20 @@ class ArtMethod FINAL {
     SetAccessFlags(GetAccessFlags() | kAccSkipAccessChecks);
   }
 
+  // Class hierarchy analysis: whether no loaded class overrides this method. See
+  // ClassLinker::UpdateClassHierarchyAnalysis.
+  bool HasSingleImplementation() {
+    return (GetAccessFlags() & kAccSingleImplementation) != 0;
+  }
+
+  void SetHasSingleImplementation(bool single_implementation) {
+    if (single_implementation) {
+      SetAccessFlags(GetAccessFlags() | kAccSingleImplementation);
+    } else {
+      SetAccessFlags(GetAccessFlags() & ~kAccSingleImplementation);
+    }
+  }
+
   // Should this method be run in the interpreter and count locks (e.g., failed structured-
   // locking verification)?
   bool MustCountLocks() {
@@ -82,6 +82,7 @@ const char* const ArenaAllocatorStatsImpl<kCount>::kAllocNames[] = {
   "GraphChecker ",
   "Verifier     ",
   "CallingConv  ",
+  "Scheduler    ",
 };
 
 template <bool kCount>
@@ -64,7 +64,8 @@ inline mirror::String* ClassLinker::ResolveString(uint32_t string_idx, ArtMethod
   mirror::Class* declaring_class = referrer->GetDeclaringClass();
   // MethodVerifier refuses methods with string_idx out of bounds.
   DCHECK_LT(string_idx, declaring_class->GetDexCache()->NumStrings());
-  mirror::String* resolved_string = declaring_class->GetDexCacheStrings()[string_idx].Read();
+  // The dex cache strings array of the class may be hash-indexed, go through the dex cache.
+  mirror::String* resolved_string = declaring_class->GetDexCache()->GetResolvedString(string_idx);
   if (UNLIKELY(resolved_string == nullptr)) {
     StackHandleScope<1> hs(Thread::Current());
     Handle<mirror::DexCache> dex_cache(hs.NewHandle(declaring_class->GetDexCache()));
@@ -53,6 +53,7 @@
 #include "gc/accounting/heap_bitmap-inl.h"
 #include "gc/heap.h"
 #include "gc/scoped_gc_critical_section.h"
+#include "gc/task_processor.h"
 #include "gc/space/image_space.h"
 #include "handle_scope-inl.h"
 #include "image-inl.h"
@@ -89,11 +90,14 @@
 #include "ScopedLocalRef.h"
 #include "scoped_thread_state_change.h"
 #include "thread-inl.h"
+#include "thread_list.h"
+#include "thread_pool.h"
 #include "trace.h"
 #include "trace_blacklist.h"
 #include "utils.h"
 #include "utils/dex_cache_arrays_layout-inl.h"
 #include "verifier/method_verifier.h"
+#include "verifier/verifier_deps.h"
 #include "well_known_classes.h"
 
 namespace art {
@@ -313,6 +317,8 @@ static void ShuffleForward(size_t* current_field_idx,
 ClassLinker::ClassLinker(InternTable* intern_table)
     // dex_lock_ is recursive as it may be used in stack dumping.
     : dex_lock_("ClassLinker dex lock", kDefaultMutexLevel),
+      num_dex_files_being_preloaded_(0u),
+      preload_thread_pool_exiting_(false),
       dex_cache_boot_image_class_lookup_required_(false),
       failed_dex_cache_class_lookups_(0),
       class_roots_(nullptr),
@@ -1290,14 +1296,16 @@ bool ClassLinker::UpdateAppImageClassLoadersAndDexCaches(
         // The space is not yet visible to the GC, we can avoid the read barriers and use
         // std::copy_n.
         if (num_strings != 0u) {
-          GcRoot<mirror::String>* const image_resolved_strings = dex_cache->GetStrings();
-          GcRoot<mirror::String>* const strings =
-              reinterpret_cast<GcRoot<mirror::String>*>(raw_arrays + layout.StringsOffset());
-          for (size_t j = 0; kIsDebugBuild && j < num_strings; ++j) {
-            DCHECK(strings[j].IsNull());
+          // The strings array may be hash-indexed, copy it as raw memory.
+          const uint8_t* const image_resolved_strings =
+              reinterpret_cast<const uint8_t*>(dex_cache->GetStrings());
+          uint8_t* const strings = raw_arrays + layout.StringsOffset();
+          const size_t strings_size = layout.StringsSize(num_strings);
+          for (size_t j = 0; kIsDebugBuild && j < strings_size; ++j) {
+            DCHECK_EQ(strings[j], 0u);
           }
-          std::copy_n(image_resolved_strings, num_strings, strings);
-          dex_cache->SetStrings(strings);
+          std::copy_n(image_resolved_strings, strings_size, strings);
+          dex_cache->SetStrings(reinterpret_cast<GcRoot<mirror::String>*>(strings));
         }
         if (num_types != 0u) {
           GcRoot<mirror::Class>* const image_resolved_types = dex_cache->GetResolvedTypes();
@@ -2099,8 +2107,9 @@ mirror::DexCache* ClassLinker::AllocDexCache(Thread* self,
       reinterpret_cast<ArtField**>(raw_arrays + layout.FieldsOffset());
   if (kIsDebugBuild) {
     // Sanity check to make sure all the dex cache arrays are empty. b/28992179
-    for (size_t i = 0; i < dex_file.NumStringIds(); ++i) {
-      CHECK(strings[i].Read<kWithoutReadBarrier>() == nullptr);
+    const uint8_t* raw_strings = reinterpret_cast<const uint8_t*>(strings);
+    for (size_t i = 0, size = layout.StringsSize(dex_file.NumStringIds()); i < size; ++i) {
+      CHECK_EQ(raw_strings[i], 0u);
     }
     for (size_t i = 0; i < dex_file.NumTypeIds(); ++i) {
       CHECK(types[i].Read<kWithoutReadBarrier>() == nullptr);
@@ -2472,6 +2481,17 @@ mirror::Class* ClassLinker::DefineClass(Thread* self,
   NANO_TRACE_SCOPE_FROM_STRING(self, "Class ClassLinker.DefineClass()");
   auto klass = hs.NewHandle<mirror::Class>(nullptr);
 
+  // Verify the code items the dex file verifier left for class definition.
+  std::string error_msg;
+  if (UNLIKELY(!dex_file.VerifyClassCodeItemsIfNeeded(dex_class_def, &error_msg))) {
+    ThrowClassFormatError(nullptr,
+                          "Invalid code item in class %s of '%s': %s",
+                          descriptor,
+                          dex_file.GetLocation().c_str(),
+                          error_msg.c_str());
+    return nullptr;
+  }
+
   // Load the class from the dex file.
   if (UNLIKELY(!init_done_)) {
     // finish up init of hand crafted class_roots_
@@ -3288,8 +3308,11 @@ mirror::DexCache* ClassLinker::RegisterDexFile(const DexFile& dex_file,
   // Don't alloc while holding the lock, since allocation may need to
   // suspend all threads and another thread may need the dex_lock_ to
   // get to a suspend point.
-  StackHandleScope<1> hs(self);
+  StackHandleScope<2> hs(self);
+  Handle<mirror::ClassLoader> h_class_loader(hs.NewHandle(class_loader));
   Handle<mirror::DexCache> h_dex_cache(hs.NewHandle(AllocDexCache(self, dex_file, linear_alloc)));
+  bool preload_classes = false;
+  std::vector<uint16_t> class_defs_to_preload;
   {
     WriterMutexLock mu(self, dex_lock_);
     mirror::DexCache* dex_cache = FindDexCacheLocked(self, dex_file, true);
@@ -3301,8 +3324,23 @@ mirror::DexCache* ClassLinker::RegisterDexFile(const DexFile& dex_file,
       return nullptr;
     }
     RegisterDexFileLocked(dex_file, h_dex_cache);
+    if (UNLIKELY(!classes_to_preload_.empty())) {
+      auto it = classes_to_preload_.find(DexCacheResolvedClasses(
+          ProfileCompilationInfo::GetProfileDexFileKey(dex_file.GetLocation()),
+          dex_file.GetLocation(),
+          dex_file.GetLocationChecksum()));
+      if (it != classes_to_preload_.end()) {
+        preload_classes = true;
+        ++num_dex_files_being_preloaded_;
+        class_defs_to_preload.assign(it->GetClasses().begin(), it->GetClasses().end());
+        classes_to_preload_.erase(it);
+      }
+    }
   }
   table->InsertStrongRoot(h_dex_cache.Get());
+  if (UNLIKELY(preload_classes)) {
+    PreloadClasses(self, dex_file, h_class_loader, &class_defs_to_preload);
+  }
   return h_dex_cache.Get();
 }
 
@@ -3965,12 +4003,22 @@ void ClassLinker::VerifyClass(Thread* self, Handle<mirror::Class> klass, LogSeve
   std::string error_msg;
   if (!preverified) {
     Runtime* runtime = Runtime::Current();
-    verifier_failure = verifier::MethodVerifier::VerifyClass(self,
-                                                             klass.Get(),
-                                                             runtime->GetCompilerCallbacks(),
-                                                             runtime->IsAotCompiler(),
-                                                             log_level,
-                                                             &error_msg);
+    bool soft_failure;
+    if (oat_file_class_status == mirror::Class::kStatusRetryVerificationAtRuntime &&
+        !runtime->IsAotCompiler() &&
+        VerifyClassUsingVerifierDeps(self, klass, &soft_failure)) {
+      if (soft_failure) {
+        verifier_failure = verifier::MethodVerifier::kSoftFailure;
+        error_msg = "soft failure recorded in the oat file";
+      }
+    } else {
+      verifier_failure = verifier::MethodVerifier::VerifyClass(self,
+                                                               klass.Get(),
+                                                               runtime->GetCompilerCallbacks(),
+                                                               runtime->IsAotCompiler(),
+                                                               log_level,
+                                                               &error_msg);
+    }
   }
 
   // Verification is done, grab the lock again.
@@ -4036,6 +4084,46 @@ void ClassLinker::VerifyClass(Thread* self, Handle<mirror::Class> klass, LogSeve
   }
 }
 
+bool ClassLinker::VerifyClassUsingVerifierDeps(Thread* self,
+                                               Handle<mirror::Class> klass,
+                                               bool* soft_failure) {
+  const OatFile::OatDexFile* oat_dex_file = klass->GetDexFile().GetOatDexFile();
+  if (oat_dex_file == nullptr || oat_dex_file->GetOatFile() == nullptr) {
+    return false;
+  }
+  const OatFile& oat_file = *oat_dex_file->GetOatFile();
+  if (oat_file.GetVerifierDepsSize() == 0u) {
+    return false;
+  }
+  const std::vector<const OatFile::OatDexFile*>& oat_dex_files = oat_file.GetOatDexFiles();
+  auto it = std::find(oat_dex_files.begin(), oat_dex_files.end(), oat_dex_file);
+  DCHECK(it != oat_dex_files.end());
+  verifier::VerifierDeps deps;
+  if (!verifier::VerifierDepsTable::FindClass(oat_file.GetVerifierDepsBegin(),
+                                              oat_file.GetVerifierDepsSize(),
+                                              std::distance(oat_dex_files.begin(), it),
+                                              klass->GetDexClassDefIndex(),
+                                              &deps)) {
+    return false;
+  }
+  StackHandleScope<1> hs(self);
+  Handle<mirror::ClassLoader> class_loader(hs.NewHandle(klass->GetClassLoader()));
+  std::string error_msg;
+  if (!deps.Validate(self, class_loader, oat_file, &error_msg)) {
+    VLOG(verifier) << "Verifying " << PrettyDescriptor(klass.Get()) << " again: " << error_msg;
+    return false;
+  }
+  // Apply the access flags the verifier would have set.
+  for (ArtMethod& method : klass->GetDeclaredMethods(image_pointer_size_)) {
+    uint32_t access_flags = deps.GetMethodAccessFlags(method.GetDexMethodIndex());
+    if (access_flags != 0u) {
+      method.SetAccessFlags(method.GetAccessFlags() | access_flags);
+    }
+  }
+  *soft_failure = deps.HasSoftFailure();
+  return true;
+}
+
 void ClassLinker::EnsureSkipAccessChecksMethods(Handle<mirror::Class> klass) {
   if (!klass->WasVerificationAttempted()) {
     klass->SetSkipAccessChecksFlagOnAllMethods(image_pointer_size_);
@@ -5200,6 +5288,7 @@ bool ClassLinker::LinkClass(Thread* self,
     if (klass->ShouldHaveImt()) {
       klass->SetImt(imt, image_pointer_size_);
     }
+    UpdateClassHierarchyAnalysis(self, klass);
     // This will notify waiters on klass that saw the not yet resolved
     // class in the class_table_ during EnsureResolved.
     mirror::Class::SetStatus(klass, mirror::Class::kStatusResolved, self);
@@ -5256,6 +5345,7 @@ bool ClassLinker::LinkClass(Thread* self,
     mirror::Class::SetStatus(klass, mirror::Class::kStatusRetired, self);
 
     CHECK_EQ(h_new_class->GetStatus(), mirror::Class::kStatusResolving);
+    UpdateClassHierarchyAnalysis(self, h_new_class);
     // This will notify waiters on new_class that saw the not yet resolved
     // class in the class_table_ during EnsureResolved.
     mirror::Class::SetStatus(h_new_class, mirror::Class::kStatusResolved, self);
@@ -5265,6 +5355,42 @@ bool ClassLinker::LinkClass(Thread* self,
   return true;
 }
 
+void ClassLinker::UpdateClassHierarchyAnalysis(Thread* self, Handle<mirror::Class> klass) {
+  // Classes in images are not linked again at runtime, so they could not unmark the methods
+  // they override. Only track the hierarchy of classes linked at runtime.
+  if (Runtime::Current()->IsAotCompiler() || klass->IsInterface()) {
+    return;
+  }
+  std::vector<ArtMethod*> overridden_methods;
+  {
+    MutexLock mu(self, *Locks::cha_lock_);
+    for (ArtMethod& method : klass->GetDeclaredVirtualMethods(image_pointer_size_)) {
+      if (!method.IsAbstract()) {
+        method.SetHasSingleImplementation(true);
+      }
+    }
+    if (klass->HasSuperClass()) {
+      mirror::Class* super_class = klass->GetSuperClass();
+      for (int32_t i = 0, e = super_class->GetVTableLength(); i < e; ++i) {
+        ArtMethod* super_method = super_class->GetVTableEntry(i, image_pointer_size_);
+        if (super_method->HasSingleImplementation() &&
+            klass->GetVTableEntry(i, image_pointer_size_) != super_method) {
+          // The methods of the super classes of `super_class` that are overridden at index `i`
+          // have already been unmarked, when `super_method` was linked.
+          super_method->SetHasSingleImplementation(false);
+          overridden_methods.push_back(super_method);
+        }
+      }
+    }
+  }
+  jit::Jit* jit = Runtime::Current()->GetJit();
+  if (jit != nullptr) {
+    for (ArtMethod* method : overridden_methods) {
+      jit->GetCodeCache()->InvalidateSingleImplementationDependents(method);
+    }
+  }
+}
+
 static void CountMethodsAndFields(ClassDataItemIterator& dex_data,
                                   size_t* virtual_methods,
                                   size_t* direct_methods,
@@ -8422,6 +8548,202 @@ std::unordered_set<std::string> ClassLinker::GetClassDescriptorsForProfileKeys(
   return ret;
 }
 
+static constexpr size_t kPreloadClassesPerTask = 64;
+// How long after PreloadClassesFromProfile the classes of the profile dex files that are still not
+// registered are dropped. The app may never open some of them.
+static constexpr uint64_t kPreloadClassesTimeout = MsToNs(10 * 1000);
+
+// Loads, verifies and, when that runs no code, initializes a chunk of the profile classes of a dex
+// file, so that the app finds them ready when it first uses them. The classes are only looked up
+// through the class loaders that the runtime walks without running Java code, since the pool
+// workers cannot call into Java.
+class PreloadClassesTask FINAL : public Task {
+ public:
+  PreloadClassesTask(jobject class_loader, std::vector<std::string>&& descriptors)
+      : class_loader_(class_loader), descriptors_(std::move(descriptors)) {}
+
+  void Run(Thread* self) OVERRIDE {
+    ScopedObjectAccess soa(self);
+    ClassLinker* const class_linker = Runtime::Current()->GetClassLinker();
+    StackHandleScope<2> hs(self);
+    Handle<mirror::ClassLoader> class_loader(
+        hs.NewHandle(soa.Decode<mirror::ClassLoader*>(class_loader_)));
+    MutableHandle<mirror::Class> klass(hs.NewHandle<mirror::Class>(nullptr));
+    for (const std::string& descriptor : descriptors_) {
+      const char* const descriptor_chars = descriptor.c_str();
+      mirror::Class* result = nullptr;
+      if (!class_linker->FindClassInPathClassLoader(soa,
+                                                    self,
+                                                    descriptor_chars,
+                                                    ComputeModifiedUtf8Hash(descriptor_chars),
+                                                    class_loader,
+                                                    &result)) {
+        // The class loader chain has a class loader that only Java code can walk.
+        break;
+      }
+      if (result == nullptr) {
+        // Leave it to the app to report the error if it uses the class.
+        self->ClearException();
+        continue;
+      }
+      klass.Assign(result);
+      if (!klass->IsVerified()) {
+        class_linker->VerifyClass(self, klass);
+      }
+      // Only initialize the classes without a class initializer or static values, nor parents
+      // or default method interfaces needing one, so that the app cannot observe it.
+      if (klass->IsVerified()) {
+        class_linker->EnsureInitialized(self,
+                                        klass,
+                                        /* can_init_fields */ false,
+                                        /* can_init_parents */ true);
+      }
+      self->ClearException();
+    }
+    soa.Vm()->DeleteGlobalRef(self, class_loader_);
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  const jobject class_loader_;
+  const std::vector<std::string> descriptors_;
+
+  DISALLOW_COPY_AND_ASSIGN(PreloadClassesTask);
+};
+
+// Drops the profile classes of the dex files not registered yet so that the pool workers exit.
+class StopPreloadingClassesTask : public gc::HeapTask {
+ public:
+  explicit StopPreloadingClassesTask(uint64_t target_time) : HeapTask(target_time) {
+  }
+
+  void Run(Thread* self) OVERRIDE {
+    Runtime::Current()->GetClassLinker()->StopPreloadingClassesFromProfile(self);
+  }
+};
+
+void ClassLinker::PreloadClassesFromProfile(const std::set<DexCacheResolvedClasses>& classes,
+                                            size_t num_threads) {
+  ScopedTrace trace(__PRETTY_FUNCTION__);
+  DCHECK_NE(num_threads, 0u);
+  Thread* const self = Thread::Current();
+  if (classes.empty()) {
+    return;
+  }
+  if (preload_thread_pool_ == nullptr) {
+    preload_thread_pool_.reset(new ThreadPool("Class preload thread pool", num_threads));
+    preload_thread_pool_->StartWorkers(self);
+    Runtime::Current()->GetHeap()->GetTaskProcessor()->AddTask(
+        self, new StopPreloadingClassesTask(NanoTime() + kPreloadClassesTimeout));
+  }
+  ScopedObjectAccess soa(self);
+  WriterMutexLock mu(self, dex_lock_);
+  if (preload_thread_pool_exiting_) {
+    VLOG(class_linker) << "Not preloading the classes of another profile after the first one";
+    return;
+  }
+  for (const DexCacheResolvedClasses& dex_file_classes : classes) {
+    auto it = classes_to_preload_.insert(dex_file_classes).first;
+    it->AddClasses(dex_file_classes.GetClasses().begin(), dex_file_classes.GetClasses().end());
+  }
+}
+
+void ClassLinker::PreloadClasses(Thread* self,
+                                 const DexFile& dex_file,
+                                 Handle<mirror::ClassLoader> class_loader,
+                                 std::vector<uint16_t>* class_def_indexes) {
+  // The pool is only deleted with all threads suspended.
+  ThreadPool* const thread_pool = preload_thread_pool_.get();
+  // Other class loaders find classes with Java code, which the pool workers cannot run. Their
+  // parents are checked by the tasks.
+  ScopedObjectAccessUnchecked soa(self);
+  if (thread_pool != nullptr &&
+      (class_loader.Get() == nullptr ||
+       class_loader->GetClass() ==
+           soa.Decode<mirror::Class*>(WellKnownClasses::dalvik_system_PathClassLoader))) {
+    // Superclasses and interfaces come first in the dex file when they are in the same one, so
+    // preload the classes in class def order.
+    std::sort(class_def_indexes->begin(), class_def_indexes->end());
+    std::vector<std::string> descriptors;
+    for (uint16_t class_def_idx : *class_def_indexes) {
+      if (class_def_idx >= dex_file.NumClassDefs()) {
+        LOG(WARNING) << "Class def index " << class_def_idx << " >= " << dex_file.NumClassDefs();
+        continue;
+      }
+      descriptors.push_back(dex_file.GetClassDescriptor(dex_file.GetClassDef(class_def_idx)));
+    }
+    VLOG(class_linker) << "Preloading " << descriptors.size() << " classes of "
+                       << dex_file.GetLocation();
+    JavaVMExt* const vm = Runtime::Current()->GetJavaVM();
+    for (size_t begin = 0; begin < descriptors.size(); begin += kPreloadClassesPerTask) {
+      const size_t end = std::min(begin + kPreloadClassesPerTask, descriptors.size());
+      std::vector<std::string> chunk(std::make_move_iterator(descriptors.begin() + begin),
+                                     std::make_move_iterator(descriptors.begin() + end));
+      thread_pool->AddTask(self,
+                           new PreloadClassesTask(vm->AddGlobalRef(self, class_loader.Get()),
+                                                  std::move(chunk)));
+    }
+  } else {
+    VLOG(class_linker) << "Not preloading the classes of " << dex_file.GetLocation();
+  }
+
+  // Once the classes of all the dex files of the profile are scheduled, let the workers exit when
+  // they are done rather than keep them around for the lifetime of the app.
+  bool last_dex_file;
+  {
+    WriterMutexLock mu(self, dex_lock_);
+    DCHECK_NE(num_dex_files_being_preloaded_, 0u);
+    --num_dex_files_being_preloaded_;
+    last_dex_file = classes_to_preload_.empty() && num_dex_files_being_preloaded_ == 0u;
+    preload_thread_pool_exiting_ = preload_thread_pool_exiting_ || last_dex_file;
+  }
+  if (last_dex_file && thread_pool != nullptr) {
+    thread_pool->ExitWorkersWhenDrained(self);
+  }
+}
+
+void ClassLinker::StopPreloadingClassesFromProfile(Thread* self) {
+  // The pool is only deleted with all threads suspended.
+  ScopedObjectAccess soa(self);
+  ThreadPool* const thread_pool = preload_thread_pool_.get();
+  bool exit_workers;
+  {
+    WriterMutexLock mu(self, dex_lock_);
+    if (!classes_to_preload_.empty()) {
+      VLOG(class_linker) << "Not preloading the classes of " << classes_to_preload_.size()
+                         << " profile dex files that are not registered";
+      classes_to_preload_.clear();
+    }
+    // Otherwise the last PreloadClasses call lets the workers exit.
+    exit_workers = !preload_thread_pool_exiting_ && num_dex_files_being_preloaded_ == 0u;
+    preload_thread_pool_exiting_ = true;
+  }
+  if (exit_workers && thread_pool != nullptr) {
+    thread_pool->ExitWorkersWhenDrained(self);
+  }
+}
+
+void ClassLinker::DeletePreloadThreadPool() {
+  if (preload_thread_pool_ == nullptr) {
+    return;
+  }
+  Thread* const self = Thread::Current();
+  ThreadPool* thread_pool = nullptr;
+  {
+    // Clear preload_thread_pool_ while the threads are suspended, since registering a dex file
+    // may add tasks to it.
+    ScopedSuspendAll ssa(__FUNCTION__);
+    thread_pool = preload_thread_pool_.release();
+  }
+  thread_pool->StopWorkers(self);
+  thread_pool->RemoveAllTasks(self);
+  // The workers may have exited already, so let the destructor wait for the running tasks.
+  delete thread_pool;
+}
+
 class ClassLinker::FindVirtualMethodHolderVisitor : public ClassVisitor {
  public:
   FindVirtualMethodHolderVisitor(const ArtMethod* method, size_t pointer_size)
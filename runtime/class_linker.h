@@ -47,6 +47,7 @@ namespace mirror {
   class ClassLoader;
   class DexCache;
   class DexCachePointerArray;
+  class DexCacheTest_HashedStrings_Test;
   class DexCacheTest_Open_Test;
   class IfTable;
   template<class T> class ObjectArray;
@@ -60,6 +61,7 @@ class InternTable;
 template<class T> class ObjectLock;
 class Runtime;
 class ScopedObjectAccessAlreadyRunnable;
+class ThreadPool;
 template<size_t kNumReferences> class PACKED(4) StackHandleScope;
 
 enum VisitRootFlags : uint8_t;
@@ -467,6 +469,11 @@ class ClassLinker {
                                mirror::Class::Status& oat_file_class_status)
       SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!dex_lock_);
+  // Verify a class that the compiler left for runtime verification by checking the verifier
+  // dependencies recorded in its oat file. Returns false if there are none or if they changed,
+  // otherwise sets `soft_failure` to the recorded result.
+  bool VerifyClassUsingVerifierDeps(Thread* self, Handle<mirror::Class> klass, bool* soft_failure)
+      SHARED_REQUIRES(Locks::mutator_lock_);
   void ResolveClassExceptionHandlerTypes(Handle<mirror::Class> klass)
       SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!dex_lock_);
@@ -612,6 +619,25 @@ class ClassLinker {
       const std::set<DexCacheResolvedClasses>& classes)
       REQUIRES(!dex_lock_);
 
+  // Load, verify and, when it runs no code, initialize the classes of `classes` on a pool of
+  // `num_threads` background threads. The classes of a dex file are preloaded when the dex file is
+  // registered with its class loader, so dex files already registered are ignored, as are the
+  // dex files of class loaders other than PathClassLoader. The pool threads exit once the classes
+  // of all the dex files of `classes` are preloaded, or after a delay for the dex files that are
+  // never registered; the classes of later calls are ignored.
+  void PreloadClassesFromProfile(const std::set<DexCacheResolvedClasses>& classes,
+                                 size_t num_threads)
+      REQUIRES(!dex_lock_, !Locks::mutator_lock_);
+
+  // Drop the profile classes of the dex files not registered yet and let the pool threads exit
+  // once the registered ones are preloaded. A heap task calls it a while after
+  // PreloadClassesFromProfile.
+  void StopPreloadingClassesFromProfile(Thread* self)
+      REQUIRES(!dex_lock_, !Locks::mutator_lock_);
+
+  // Drop the pending preloading tasks, wait for the running ones and delete the thread pool.
+  void DeletePreloadThreadPool() REQUIRES(!Locks::mutator_lock_);
+
   static bool IsBootClassLoader(ScopedObjectAccessAlreadyRunnable& soa,
                                 mirror::ClassLoader* class_loader)
       SHARED_REQUIRES(Locks::mutator_lock_);
@@ -783,6 +809,15 @@ class ClassLinker {
   void RegisterDexFileLocked(const DexFile& dex_file, Handle<mirror::DexCache> dex_cache)
       REQUIRES(dex_lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Schedule the preloading of the classes of `dex_file` at `class_def_indexes` on the
+  // preload_thread_pool_.
+  void PreloadClasses(Thread* self,
+                      const DexFile& dex_file,
+                      Handle<mirror::ClassLoader> class_loader,
+                      std::vector<uint16_t>* class_def_indexes)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
   mirror::DexCache* FindDexCacheLocked(Thread* self, const DexFile& dex_file, bool allow_failure)
       REQUIRES(dex_lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
@@ -825,6 +860,13 @@ class ClassLinker {
       SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!Locks::classlinker_classes_lock_);
 
+  // Class hierarchy analysis. Called once the vtable of `klass` is final: marks the methods
+  // `klass` declares as single implementations, and unmarks the methods of its super classes
+  // that `klass` overrides, invalidating the JIT code compiled assuming they were not.
+  void UpdateClassHierarchyAnalysis(Thread* self, Handle<mirror::Class> klass)
+      SHARED_REQUIRES(Locks::mutator_lock_)
+      REQUIRES(!Locks::cha_lock_);
+
   bool LinkSuperClass(Handle<mirror::Class> klass)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
@@ -1126,6 +1168,14 @@ class ClassLinker {
   // globals when we register new dex files.
   std::list<DexCacheData> dex_caches_ GUARDED_BY(dex_lock_);
 
+  // Profile classes of the dex files not registered yet, see PreloadClassesFromProfile.
+  std::set<DexCacheResolvedClasses> classes_to_preload_ GUARDED_BY(dex_lock_);
+  // The number of registered dex files whose classes are being handed to preload_thread_pool_.
+  size_t num_dex_files_being_preloaded_ GUARDED_BY(dex_lock_);
+  // Whether the preload_thread_pool_ workers exit once they have no more tasks.
+  bool preload_thread_pool_exiting_ GUARDED_BY(dex_lock_);
+  std::unique_ptr<ThreadPool> preload_thread_pool_;
+
   // This contains the class loaders which have class tables. It is populated by
   // InsertClassTableForClassLoader.
   std::list<ClassLoaderData> class_loaders_
@@ -1177,6 +1227,7 @@ class ClassLinker {
   friend class JniCompilerTest;  // for GetRuntimeQuickGenericJniStub
   friend class JniInternalTest;  // for GetRuntimeQuickGenericJniStub
   ART_FRIEND_TEST(ClassLinkerTest, RegisterDexFileName);  // for DexLock, and RegisterDexFileLocked
+  ART_FRIEND_TEST(mirror::DexCacheTest, HashedStrings);  // for AllocDexCache
   ART_FRIEND_TEST(mirror::DexCacheTest, Open);  // for AllocDexCache
   DISALLOW_COPY_AND_ASSIGN(ClassLinker);
 };
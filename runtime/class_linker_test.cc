@@ -27,6 +27,7 @@
 #include "experimental_flags.h"
 #include "entrypoints/entrypoint_utils-inl.h"
 #include "gc/heap.h"
+#include "jit/offline_profiling_info.h"
 #include "mirror/abstract_method.h"
 #include "mirror/accessible_object.h"
 #include "mirror/class-inl.h"
@@ -41,6 +42,7 @@
 #include "handle_scope-inl.h"
 #include "scoped_thread_state_change.h"
 #include "thread-inl.h"
+#include "thread_list.h"
 
 namespace art {
 
@@ -267,8 +269,12 @@ class ClassLinkerTest : public CommonRuntimeTest {
     EXPECT_FALSE(klass->IsArrayClass());
     EXPECT_TRUE(klass->GetComponentType() == nullptr);
     EXPECT_TRUE(klass->IsInSamePackage(klass.Get()));
-    EXPECT_TRUE(klass->GetDexCacheStrings() != nullptr);
-    EXPECT_EQ(klass->GetDexCacheStrings(), klass->GetDexCache()->GetStrings());
+    if (klass->GetDexCache()->HasHashedStrings()) {
+      EXPECT_TRUE(klass->GetDexCacheStrings() == nullptr);
+    } else {
+      EXPECT_TRUE(klass->GetDexCacheStrings() != nullptr);
+      EXPECT_EQ(klass->GetDexCacheStrings(), klass->GetDexCache()->GetStrings());
+    }
     std::string temp2;
     EXPECT_TRUE(mirror::Class::IsInSamePackage(klass->GetDescriptor(&temp),
                                                klass->GetDescriptor(&temp2)));
@@ -1265,4 +1271,123 @@ TEST_F(ClassLinkerTest, RegisterDexFileName) {
   }
 }
 
+// Returns the number of threads attached to the runtime.
+static size_t NumAttachedThreads(Thread* self) {
+  MutexLock mu(self, *Locks::thread_list_lock_);
+  return Runtime::Current()->GetThreadList()->GetList().size();
+}
+
+TEST_F(ClassLinkerTest, PreloadClassesFromProfile) {
+  static const char* const kDescriptors[] = {
+      "LInterfaces$J;", "LInterfaces$K;", "LInterfaces$A;", "LInterfaces$B;"
+  };
+  Thread* self = Thread::Current();
+  std::vector<std::unique_ptr<const DexFile>> dex_files = OpenTestDexFiles("Interfaces");
+  ASSERT_EQ(1u, dex_files.size());
+  const DexFile& dex_file = *dex_files[0];
+  std::vector<uint16_t> class_def_indexes;
+  for (const char* descriptor : kDescriptors) {
+    const DexFile::ClassDef* class_def =
+        dex_file.FindClassDef(descriptor, ComputeModifiedUtf8Hash(descriptor));
+    ASSERT_TRUE(class_def != nullptr) << descriptor;
+    class_def_indexes.push_back(dex_file.GetIndexForClassDef(*class_def));
+  }
+  DexCacheResolvedClasses classes(ProfileCompilationInfo::GetProfileDexFileKey(
+                                      dex_file.GetLocation()),
+                                  dex_file.GetLocation(),
+                                  dex_file.GetLocationChecksum());
+  classes.AddClasses(class_def_indexes.begin(), class_def_indexes.end());
+  const size_t num_attached_threads = NumAttachedThreads(self);
+  class_linker_->PreloadClassesFromProfile({ classes }, /* num_threads */ 2);
+  EXPECT_EQ(num_attached_threads + 2, NumAttachedThreads(self));
+
+  ScopedObjectAccess soa(self);
+  StackHandleScope<1> hs(self);
+  Handle<mirror::ClassLoader> class_loader(
+      hs.NewHandle(soa.Decode<mirror::ClassLoader*>(LoadDex("Interfaces"))));
+  // Registering the dex file with its class loader hands the profile classes to the workers.
+  ASSERT_TRUE(class_linker_->FindClass(self, "LInterfaces$I;", class_loader) != nullptr);
+  {
+    // The workers exit once they have preloaded all the classes of the profile.
+    ScopedThreadSuspension sts(self, kNative);
+    for (size_t i = 0; i < 1000 && NumAttachedThreads(self) != num_attached_threads; ++i) {
+      usleep(10 * 1000);
+    }
+    EXPECT_EQ(num_attached_threads, NumAttachedThreads(self));
+  }
+
+  for (const char* descriptor : kDescriptors) {
+    mirror::Class* klass = class_linker_->LookupClass(
+        self, descriptor, ComputeModifiedUtf8Hash(descriptor), class_loader.Get());
+    ASSERT_TRUE(klass != nullptr) << descriptor;
+    EXPECT_TRUE(klass->IsVerified()) << descriptor;
+  }
+  // The classes without static values are initialized, J's constant is left to the app.
+  EXPECT_TRUE(class_linker_->LookupClass(self,
+                                         "LInterfaces$A;",
+                                         ComputeModifiedUtf8Hash("LInterfaces$A;"),
+                                         class_loader.Get())->IsInitialized());
+  EXPECT_FALSE(class_linker_->LookupClass(self,
+                                          "LInterfaces$J;",
+                                          ComputeModifiedUtf8Hash("LInterfaces$J;"),
+                                          class_loader.Get())->IsInitialized());
+}
+
+TEST_F(ClassLinkerTest, PreloadClassesFromProfileMissingDexFile) {
+  Thread* self = Thread::Current();
+  std::vector<std::unique_ptr<const DexFile>> dex_files = OpenTestDexFiles("Interfaces");
+  ASSERT_EQ(1u, dex_files.size());
+  const DexFile& dex_file = *dex_files[0];
+  const DexFile::ClassDef* class_def =
+      dex_file.FindClassDef("LInterfaces$A;", ComputeModifiedUtf8Hash("LInterfaces$A;"));
+  ASSERT_TRUE(class_def != nullptr);
+  const uint16_t class_def_indexes[] = { dex_file.GetIndexForClassDef(*class_def) };
+  DexCacheResolvedClasses classes(ProfileCompilationInfo::GetProfileDexFileKey(
+                                      dex_file.GetLocation()),
+                                  dex_file.GetLocation(),
+                                  dex_file.GetLocationChecksum());
+  classes.AddClasses(std::begin(class_def_indexes), std::end(class_def_indexes));
+  // The app never opens this dex file of the profile.
+  const std::string missing_location = "/nonexistent/Missing.jar";
+  DexCacheResolvedClasses missing_classes(
+      ProfileCompilationInfo::GetProfileDexFileKey(missing_location),
+      missing_location,
+      /* location_checksum */ 0u);
+  missing_classes.AddClasses(std::begin(class_def_indexes), std::end(class_def_indexes));
+  const size_t num_attached_threads = NumAttachedThreads(self);
+  class_linker_->PreloadClassesFromProfile({ classes, missing_classes }, /* num_threads */ 2);
+  EXPECT_EQ(num_attached_threads + 2, NumAttachedThreads(self));
+
+  {
+    ScopedObjectAccess soa(self);
+    StackHandleScope<1> hs(self);
+    Handle<mirror::ClassLoader> class_loader(
+        hs.NewHandle(soa.Decode<mirror::ClassLoader*>(LoadDex("Interfaces"))));
+    ASSERT_TRUE(class_linker_->FindClass(self, "LInterfaces$I;", class_loader) != nullptr);
+    // Wait for the workers to preload the class of the registered dex file.
+    bool initialized = false;
+    for (size_t i = 0; i < 1000 && !initialized; ++i) {
+      mirror::Class* klass = class_linker_->LookupClass(self,
+                                                        "LInterfaces$A;",
+                                                        ComputeModifiedUtf8Hash("LInterfaces$A;"),
+                                                        class_loader.Get());
+      initialized = klass != nullptr && klass->IsInitialized();
+      if (!initialized) {
+        ScopedThreadSuspension sts(self, kNative);
+        usleep(10 * 1000);
+      }
+    }
+    EXPECT_TRUE(initialized);
+  }
+  // The missing dex file keeps the workers around...
+  EXPECT_EQ(num_attached_threads + 2, NumAttachedThreads(self));
+
+  // ... until its classes are dropped.
+  class_linker_->StopPreloadingClassesFromProfile(self);
+  for (size_t i = 0; i < 1000 && NumAttachedThreads(self) != num_attached_threads; ++i) {
+    usleep(10 * 1000);
+  }
+  EXPECT_EQ(num_attached_threads, NumAttachedThreads(self));
+}
+
 }  // namespace art
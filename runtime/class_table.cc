@@ -20,22 +20,37 @@
 
 namespace art {
 
-ClassTable::ClassTable() : lock_("Class loader classes", kClassLoaderClassesLock) {
+ClassTable::ClassTable()
+    : lock_("Class loader classes", kClassLoaderClassesLock), frozen_classes_(nullptr) {
   Runtime* const runtime = Runtime::Current();
-  classes_.push_back(ClassSet(runtime->GetHashTableMinLoadFactor(),
-                              runtime->GetHashTableMaxLoadFactor()));
+  classes_.emplace_back(new ClassSet(runtime->GetHashTableMinLoadFactor(),
+                                     runtime->GetHashTableMaxLoadFactor()));
+  // No frozen class sets yet.
+  frozen_class_set_arrays_.emplace_back(new FrozenClassSets());
+  frozen_classes_.StoreRelaxed(frozen_class_set_arrays_.back().get());
+}
+
+void ClassTable::PublishFrozenClassSets() {
+  std::unique_ptr<FrozenClassSets> frozen(new FrozenClassSets());
+  frozen->reserve(classes_.size() - 1);
+  for (size_t i = 0; i + 1 < classes_.size(); ++i) {
+    frozen->push_back(classes_[i].get());
+  }
+  frozen_classes_.StoreRelease(frozen.get());
+  frozen_class_set_arrays_.push_back(std::move(frozen));
 }
 
 void ClassTable::FreezeSnapshot() {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.push_back(ClassSet());
+  classes_.emplace_back(new ClassSet());
+  PublishFrozenClassSets();
 }
 
 bool ClassTable::Contains(mirror::Class* klass) {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.Find(GcRoot<mirror::Class>(klass));
-    if (it != class_set.end()) {
+  for (std::unique_ptr<ClassSet>& class_set : classes_) {
+    auto it = class_set->Find(GcRoot<mirror::Class>(klass));
+    if (it != class_set->end()) {
       return it->Read() == klass;
     }
   }
@@ -44,9 +59,9 @@ bool ClassTable::Contains(mirror::Class* klass) {
 
 mirror::Class* ClassTable::LookupByDescriptor(mirror::Class* klass) {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.Find(GcRoot<mirror::Class>(klass));
-    if (it != class_set.end()) {
+  for (std::unique_ptr<ClassSet>& class_set : classes_) {
+    auto it = class_set->Find(GcRoot<mirror::Class>(klass));
+    if (it != class_set->end()) {
       return it->Read();
     }
   }
@@ -56,10 +71,10 @@ mirror::Class* ClassTable::LookupByDescriptor(mirror::Class* klass) {
 mirror::Class* ClassTable::UpdateClass(const char* descriptor, mirror::Class* klass, size_t hash) {
   WriterMutexLock mu(Thread::Current(), lock_);
   // Should only be updating latest table.
-  auto existing_it = classes_.back().FindWithHash(descriptor, hash);
-  if (kIsDebugBuild && existing_it == classes_.back().end()) {
-    for (const ClassSet& class_set : classes_) {
-      if (class_set.FindWithHash(descriptor, hash) != class_set.end()) {
+  auto existing_it = classes_.back()->FindWithHash(descriptor, hash);
+  if (kIsDebugBuild && existing_it == classes_.back()->end()) {
+    for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+      if (class_set->FindWithHash(descriptor, hash) != class_set->end()) {
         LOG(FATAL) << "Updating class found in frozen table " << descriptor;
       }
     }
@@ -81,22 +96,37 @@ size_t ClassTable::NumZygoteClasses() const {
   ReaderMutexLock mu(Thread::Current(), lock_);
   size_t sum = 0;
   for (size_t i = 0; i < classes_.size() - 1; ++i) {
-    sum += classes_[i].Size();
+    sum += classes_[i]->Size();
   }
   return sum;
 }
 
 size_t ClassTable::NumNonZygoteClasses() const {
   ReaderMutexLock mu(Thread::Current(), lock_);
-  return classes_.back().Size();
+  return classes_.back()->Size();
 }
 
 mirror::Class* ClassTable::Lookup(const char* descriptor, size_t hash) {
+  // The frozen class sets, which hold most of the classes after the zygote fork or with an image,
+  // are never modified in place, so they can be searched without the lock. The array is only
+  // replaced, and the replaced arrays and sets stay valid until the table is deleted.
+  const FrozenClassSets* const frozen = frozen_classes_.LoadAcquire();
+  for (const ClassSet* class_set : *frozen) {
+    auto it = class_set->FindWithHash(descriptor, hash);
+    if (it != class_set->end()) {
+      return it->Read();
+    }
+  }
   ReaderMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.FindWithHash(descriptor, hash);
-    if (it != class_set.end()) {
-     return it->Read();
+  if (LIKELY(frozen == frozen_classes_.LoadRelaxed())) {
+    auto it = classes_.back()->FindWithHash(descriptor, hash);
+    return it != classes_.back()->end() ? it->Read() : nullptr;
+  }
+  // The frozen sets changed since we searched them, search all the sets again.
+  for (std::unique_ptr<ClassSet>& class_set : classes_) {
+    auto it = class_set->FindWithHash(descriptor, hash);
+    if (it != class_set->end()) {
+      return it->Read();
     }
   }
   return nullptr;
@@ -104,26 +134,38 @@ mirror::Class* ClassTable::Lookup(const char* descriptor, size_t hash) {
 
 void ClassTable::Insert(mirror::Class* klass) {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.back().Insert(GcRoot<mirror::Class>(klass));
+  classes_.back()->Insert(GcRoot<mirror::Class>(klass));
 }
 
 void ClassTable::InsertWithoutLocks(mirror::Class* klass) {
-  classes_.back().Insert(GcRoot<mirror::Class>(klass));
+  classes_.back()->Insert(GcRoot<mirror::Class>(klass));
 }
 
 void ClassTable::InsertWithHash(mirror::Class* klass, size_t hash) {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.back().InsertWithHash(GcRoot<mirror::Class>(klass), hash);
+  classes_.back()->InsertWithHash(GcRoot<mirror::Class>(klass), hash);
 }
 
 bool ClassTable::Remove(const char* descriptor) {
   WriterMutexLock mu(Thread::Current(), lock_);
-  for (ClassSet& class_set : classes_) {
-    auto it = class_set.Find(descriptor);
-    if (it != class_set.end()) {
-      class_set.Erase(it);
-      return true;
+  for (size_t i = 0; i < classes_.size(); ++i) {
+    ClassSet* const class_set = classes_[i].get();
+    auto it = class_set->Find(descriptor);
+    if (it == class_set->end()) {
+      continue;
+    }
+    if (i + 1 == classes_.size()) {
+      class_set->Erase(it);
+    } else {
+      // Erasing moves elements, which lock-free lookups in the frozen set could miss. Replace the
+      // set by a copy without the class instead.
+      std::unique_ptr<ClassSet> copy(new ClassSet(*class_set));
+      copy->Erase(copy->Find(descriptor));
+      replaced_class_sets_.push_back(std::move(classes_[i]));
+      classes_[i] = std::move(copy);
+      PublishFrozenClassSets();
     }
+    return true;
   }
   return false;
 }
@@ -167,8 +209,8 @@ size_t ClassTable::WriteToMemory(uint8_t* ptr) const {
   ClassSet combined;
   // Combine all the class sets in case there are multiple, also adjusts load factor back to
   // default in case classes were pruned.
-  for (const ClassSet& class_set : classes_) {
-    for (const GcRoot<mirror::Class>& root : class_set) {
+  for (const std::unique_ptr<ClassSet>& class_set : classes_) {
+    for (const GcRoot<mirror::Class>& root : *class_set) {
       combined.Insert(root);
     }
   }
@@ -190,7 +232,8 @@ size_t ClassTable::ReadFromMemory(uint8_t* ptr) {
 
 void ClassTable::AddClassSet(ClassSet&& set) {
   WriterMutexLock mu(Thread::Current(), lock_);
-  classes_.insert(classes_.begin(), std::move(set));
+  classes_.emplace(classes_.begin(), new ClassSet(std::move(set)));
+  PublishFrozenClassSets();
 }
 
 void ClassTable::ClearStrongRoots() {
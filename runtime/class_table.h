@@ -17,10 +17,12 @@
 #ifndef ART_RUNTIME_CLASS_TABLE_H_
 #define ART_RUNTIME_CLASS_TABLE_H_
 
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
 
+#include "atomic.h"
 #include "base/allocator.h"
 #include "base/hash_set.h"
 #include "base/macros.h"
@@ -110,7 +112,12 @@ class ClassTable {
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
-  // Return the first class that matches the descriptor. Returns null if there are none.
+  // Return the first class that matches the descriptor. Returns null if there are none. The frozen
+  // class sets are searched without the lock, so that threads loading classes in parallel only
+  // contend on it for the classes loaded since the last snapshot. Only the boot class table after
+  // the zygote fork and the class loaders with an app image have frozen sets; the live set is not
+  // frozen later on since UpdateClass() expects the temporary classes being loaded to be in it.
+  // NumNonZygoteClasses() is the number of classes still looked up with the lock.
   mirror::Class* Lookup(const char* descriptor, size_t hash)
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
@@ -163,12 +170,27 @@ class ClassTable {
   }
 
  private:
+  typedef std::vector<const ClassSet*> FrozenClassSets;
+
   void InsertWithoutLocks(mirror::Class* klass) NO_THREAD_SAFETY_ANALYSIS;
 
+  // Publish the array of the frozen class sets, all of classes_ but the last, for Lookup().
+  void PublishFrozenClassSets() REQUIRES(lock_);
+
   // Lock to guard inserting and removing.
   mutable ReaderWriterMutex lock_;
   // We have a vector to help prevent dirty pages after the zygote forks by calling FreezeSnapshot.
-  std::vector<ClassSet> classes_ GUARDED_BY(lock_);
+  // Only the last set is inserted into. The others are frozen and never modified in place, except
+  // for the GC updating their roots. The sets are allocated separately so that their addresses
+  // stay valid for the lock-free lookups when the vector grows.
+  std::vector<std::unique_ptr<ClassSet>> classes_ GUARDED_BY(lock_);
+  // The frozen class sets searched by the lock-free lookups. Replaced by a new array, never
+  // modified, when a set is frozen or added, or when a class is removed from a frozen set.
+  Atomic<const FrozenClassSets*> frozen_classes_;
+  // The frozen set arrays and the frozen sets replaced by a copy, which lookups may still be
+  // reading. There are few of them, so they are only freed with the table.
+  std::vector<std::unique_ptr<const FrozenClassSets>> frozen_class_set_arrays_ GUARDED_BY(lock_);
+  std::vector<std::unique_ptr<ClassSet>> replaced_class_sets_ GUARDED_BY(lock_);
   // Extra strong roots that can be either dex files or dex caches. Dex files used by the class
   // loader which may not be owned by the class loader must be held strongly live. Also dex caches
   // are held live to prevent them being unloading once they have classes in them.
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "class_table.h"
+
+#include "class_linker.h"
+#include "common_runtime_test.h"
+#include "mirror/class-inl.h"
+#include "scoped_thread_state_change.h"
+#include "utf.h"
+
+namespace art {
+
+class ClassTableTest : public CommonRuntimeTest {
+ protected:
+  static mirror::Class* Lookup(ClassTable* table, const char* descriptor)
+      SHARED_REQUIRES(Locks::mutator_lock_) {
+    return table->Lookup(descriptor, ComputeModifiedUtf8Hash(descriptor));
+  }
+};
+
+// Classes in a frozen set are found without the lock of the table, the others with it.
+TEST_F(ClassTableTest, LookupFrozen) {
+  ScopedObjectAccess soa(Thread::Current());
+  mirror::Class* object = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;");
+  mirror::Class* string = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/String;");
+  ASSERT_TRUE(object != nullptr);
+  ASSERT_TRUE(string != nullptr);
+
+  ClassTable table;
+  table.Insert(object);
+  table.FreezeSnapshot();
+  table.Insert(string);
+  EXPECT_EQ(1u, table.NumZygoteClasses());
+  EXPECT_EQ(1u, table.NumNonZygoteClasses());
+  EXPECT_EQ(object, Lookup(&table, "Ljava/lang/Object;"));
+  EXPECT_EQ(string, Lookup(&table, "Ljava/lang/String;"));
+  EXPECT_TRUE(Lookup(&table, "Ljava/lang/Integer;") == nullptr);
+
+  // With the lock held, only a lookup that does not take it can complete.
+  WriterMutexLock mu(soa.Self(), table.GetLock());
+  EXPECT_EQ(object, Lookup(&table, "Ljava/lang/Object;"));
+}
+
+// Removing a class from a frozen set replaces the set by a copy without it.
+TEST_F(ClassTableTest, RemoveFromFrozen) {
+  ScopedObjectAccess soa(Thread::Current());
+  mirror::Class* object = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;");
+  mirror::Class* string = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/String;");
+  ASSERT_TRUE(object != nullptr);
+  ASSERT_TRUE(string != nullptr);
+
+  ClassTable table;
+  table.Insert(object);
+  table.Insert(string);
+  table.FreezeSnapshot();
+  EXPECT_EQ(2u, table.NumZygoteClasses());
+
+  EXPECT_TRUE(table.Remove("Ljava/lang/Object;"));
+  EXPECT_FALSE(table.Remove("Ljava/lang/Object;"));
+  EXPECT_EQ(1u, table.NumZygoteClasses());
+  EXPECT_EQ(0u, table.NumNonZygoteClasses());
+  EXPECT_TRUE(Lookup(&table, "Ljava/lang/Object;") == nullptr);
+  EXPECT_FALSE(table.Contains(object));
+
+  // The copy is searched without the lock.
+  WriterMutexLock mu(soa.Self(), table.GetLock());
+  EXPECT_EQ(string, Lookup(&table, "Ljava/lang/String;"));
+}
+
+// Freezing the live set and adding a set, as for an image, both publish the frozen sets again.
+TEST_F(ClassTableTest, FreezeSnapshotAndAddClassSet) {
+  ScopedObjectAccess soa(Thread::Current());
+  mirror::Class* object = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;");
+  mirror::Class* string = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/String;");
+  mirror::Class* integer = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Integer;");
+  ASSERT_TRUE(object != nullptr);
+  ASSERT_TRUE(string != nullptr);
+  ASSERT_TRUE(integer != nullptr);
+
+  ClassTable table;
+  table.Insert(object);
+  table.FreezeSnapshot();
+  ClassTable::ClassSet image_set;
+  image_set.Insert(GcRoot<mirror::Class>(string));
+  table.AddClassSet(std::move(image_set));
+  table.Insert(integer);
+  EXPECT_EQ(2u, table.NumZygoteClasses());
+  EXPECT_EQ(1u, table.NumNonZygoteClasses());
+  EXPECT_EQ(integer, Lookup(&table, "Ljava/lang/Integer;"));
+
+  WriterMutexLock mu(soa.Self(), table.GetLock());
+  EXPECT_EQ(object, Lookup(&table, "Ljava/lang/Object;"));
+  EXPECT_EQ(string, Lookup(&table, "Ljava/lang/String;"));
+}
+
+}  // namespace art
@@ -320,7 +320,19 @@ std::unique_ptr<const DexFile> DexFile::Open(const ZipArchive& zip_archive, cons
     *error_code = ZipOpenErrorCode::kEntryNotFound;
     return nullptr;
   }
-  std::unique_ptr<MemMap> map(zip_entry->ExtractToMemMap(location.c_str(), entry_name, error_msg));
+  std::unique_ptr<MemMap> map;
+  if (zip_entry->IsUncompressed() && zip_entry->IsAlignedTo(alignof(Header))) {
+    // Use the dex file in place rather than copying it out of the zip file.
+    map.reset(zip_entry->MapDirectlyFromFile(location.c_str(), entry_name, error_msg));
+    if (map.get() == nullptr) {
+      LOG(WARNING) << "Failed to map '" << entry_name << "' from '" << location << "': "
+                   << *error_msg << ", extracting it instead";
+      error_msg->clear();
+    }
+  }
+  if (map.get() == nullptr) {
+    map.reset(zip_entry->ExtractToMemMap(location.c_str(), entry_name, error_msg));
+  }
   if (map.get() == nullptr) {
     *error_msg = StringPrintf("Failed to extract '%s' from '%s': %s", entry_name, location.c_str(),
                               error_msg->c_str());
@@ -341,11 +353,19 @@ std::unique_ptr<const DexFile> DexFile::Open(const ZipArchive& zip_archive, cons
     return nullptr;
   }
   CHECK(dex_file->IsReadOnly()) << location;
+  // The code items are the bulk of a dex file and most of them are never used by an app, so the
+  // runtime verifies them class by class, see VerifyClassCodeItemsIfNeeded(). The compiler goes
+  // through all of them anyway.
+  Runtime* const runtime = Runtime::Current();
+  const bool verify_code_items = (runtime == nullptr) || runtime->IsAotCompiler();
   if (!DexFileVerifier::Verify(dex_file.get(), dex_file->Begin(), dex_file->Size(),
-                               location.c_str(), error_msg)) {
+                               location.c_str(), error_msg, verify_code_items)) {
     *error_code = ZipOpenErrorCode::kVerifyError;
     return nullptr;
   }
+  if (!verify_code_items) {
+    dex_file->verified_class_code_items_.reset(new Atomic<bool>[dex_file->NumClassDefs()]);
+  }
   *error_code = ZipOpenErrorCode::kNoError;
   return dex_file;
 }
@@ -454,6 +474,23 @@ DexFile::DexFile(const uint8_t* base, size_t size,
   }
 }
 
+bool DexFile::VerifyClassCodeItemsIfNeeded(const ClassDef& class_def,
+                                           std::string* error_msg) const {
+  if (LIKELY(verified_class_code_items_ == nullptr)) {
+    return true;
+  }
+  Atomic<bool>* verified = &verified_class_code_items_[GetIndexForClassDef(class_def)];
+  if (verified->LoadAcquire()) {
+    return true;
+  }
+  // Threads defining the class concurrently may all verify it, which is harmless.
+  if (!DexFileVerifier::VerifyClassCodeItems(this, class_def, error_msg)) {
+    return false;
+  }
+  verified->StoreRelease(true);
+  return true;
+}
+
 DexFile::~DexFile() {
   // We don't call DeleteGlobalRef on dex_object_ because we're only called by DestroyJavaVM, and
   // that's only called after DetachCurrentThread, which means there's no JNIEnv. We could
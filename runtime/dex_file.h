@@ -1175,6 +1175,10 @@ class DexFile {
 
   void CreateTypeLookupTable(uint8_t* storage = nullptr) const;
 
+  // Dex files opened from a zip file by the runtime only have their code items verified when
+  // the classes using them are defined. Returns false if those of `class_def` are malformed.
+  bool VerifyClassCodeItemsIfNeeded(const ClassDef& class_def, std::string* error_msg) const;
+
  private:
   // Opens a .dex file
   static std::unique_ptr<const DexFile> OpenFile(int fd, const char* location,
@@ -1274,6 +1278,9 @@ class DexFile {
   // null.
   const OatDexFile* oat_dex_file_;
   mutable std::unique_ptr<TypeLookupTable> lookup_table_;
+  // Whether the code items of each class def were verified, null if they all were when the dex
+  // file was opened.
+  mutable std::unique_ptr<Atomic<bool>[]> verified_class_code_items_;
 
   friend class DexFileVerifierTest;
   ART_FRIEND_TEST(ClassLinkerTest, RegisterDexFileName);  // for constructor
@@ -129,8 +129,10 @@ const DexFile::MethodId* DexFileVerifier::CheckLoadMethodId(uint32_t idx, const
   }
 
 bool DexFileVerifier::Verify(const DexFile* dex_file, const uint8_t* begin, size_t size,
-                             const char* location, std::string* error_msg) {
-  std::unique_ptr<DexFileVerifier> verifier(new DexFileVerifier(dex_file, begin, size, location));
+                             const char* location, std::string* error_msg,
+                             bool verify_code_items) {
+  std::unique_ptr<DexFileVerifier> verifier(
+      new DexFileVerifier(dex_file, begin, size, location, verify_code_items));
   if (!verifier->Verify()) {
     *error_msg = verifier->FailureReason();
     return false;
@@ -138,6 +140,25 @@ bool DexFileVerifier::Verify(const DexFile* dex_file, const uint8_t* begin, size
   return true;
 }
 
+bool DexFileVerifier::VerifyClassCodeItems(const DexFile* dex_file,
+                                           const DexFile::ClassDef& class_def,
+                                           std::string* error_msg) {
+  const uint8_t* class_data = dex_file->GetClassData(class_def);
+  if (class_data == nullptr) {
+    return true;
+  }
+  std::unique_ptr<DexFileVerifier> verifier(new DexFileVerifier(dex_file,
+                                                                dex_file->Begin(),
+                                                                dex_file->Size(),
+                                                                dex_file->GetLocation().c_str(),
+                                                                true));
+  if (!verifier->CheckClassCodeItems(class_data)) {
+    *error_msg = verifier->FailureReason();
+    return false;
+  }
+  return true;
+}
+
 bool DexFileVerifier::CheckShortyDescriptorMatch(char shorty_char, const char* descriptor,
                                                 bool is_return_type) {
   switch (shorty_char) {
@@ -1611,13 +1632,25 @@ bool DexFileVerifier::CheckIntraSection() {
         ptr_ += sizeof(uint32_t) + (map->size_ * sizeof(DexFile::MapItem));
         offset = section_offset + sizeof(uint32_t) + (map->size_ * sizeof(DexFile::MapItem));
         break;
+      case DexFile::kDexTypeCodeItem:
+      case DexFile::kDexTypeDebugInfoItem:
+        if (!verify_code_items_) {
+          // The section ends where the next one starts, the overlap check orders the sections.
+          size_t section_end = (count != 0u)
+              ? item[1].offset_
+              : header_->data_off_ + header_->data_size_;
+          if (!CheckDeferredDataSection(section_offset, section_end, type)) {
+            return false;
+          }
+          offset = section_end;
+          break;
+        }
+        FALLTHROUGH_INTENDED;
       case DexFile::kDexTypeTypeList:
       case DexFile::kDexTypeAnnotationSetRefList:
       case DexFile::kDexTypeAnnotationSetItem:
       case DexFile::kDexTypeClassDataItem:
-      case DexFile::kDexTypeCodeItem:
       case DexFile::kDexTypeStringDataItem:
-      case DexFile::kDexTypeDebugInfoItem:
       case DexFile::kDexTypeAnnotationItem:
       case DexFile::kDexTypeEncodedArrayItem:
       case DexFile::kDexTypeAnnotationsDirectoryItem:
@@ -1637,6 +1670,54 @@ bool DexFileVerifier::CheckIntraSection() {
   return true;
 }
 
+bool DexFileVerifier::CheckDeferredDataSection(size_t offset, size_t end, uint16_t type) {
+  size_t data_start = header_->data_off_;
+  size_t data_end = data_start + header_->data_size_;
+  if (UNLIKELY((offset < data_start) || (offset > end) || (end > data_end))) {
+    ErrorStringPrintf("Bad bounds for data subsection %x: %zx-%zx", type, offset, end);
+    return false;
+  }
+  if (type == DexFile::kDexTypeCodeItem) {
+    code_items_begin_ = offset;
+    code_items_end_ = end;
+  }
+  ptr_ = begin_ + end;
+  return true;
+}
+
+bool DexFileVerifier::CheckClassCodeItems(const uint8_t* class_data) {
+  // The class data item was verified with the dex file, including that the code items it
+  // references are within the code item section.
+  ClassDataItemIterator it(*dex_file_, class_data);
+  while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+    it.Next();
+  }
+  for (; it.HasNextDirectMethod() || it.HasNextVirtualMethod(); it.Next()) {
+    const DexFile::CodeItem* code_item = it.GetMethodCodeItem();
+    if (code_item == nullptr) {
+      continue;
+    }
+    ptr_ = reinterpret_cast<const uint8_t*>(code_item);
+    if (!CheckIntraCodeItem()) {
+      return false;
+    }
+    uint32_t debug_info_off = code_item->debug_info_off_;
+    if (debug_info_off != 0) {
+      size_t data_start = header_->data_off_;
+      size_t data_end = data_start + header_->data_size_;
+      if (UNLIKELY((debug_info_off < data_start) || (debug_info_off >= data_end))) {
+        ErrorStringPrintf("Bad debug_info_off: %x", debug_info_off);
+        return false;
+      }
+      ptr_ = begin_ + debug_info_off;
+      if (!CheckIntraDebugInfoItem()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
 bool DexFileVerifier::CheckOffsetToTypeMap(size_t offset, uint16_t type) {
   DCHECK_NE(offset, 0u);
   auto it = offset_to_type_map_.Find(offset);
@@ -2149,8 +2230,17 @@ bool DexFileVerifier::CheckInterClassDataItem() {
   }
   for (; it.HasNextDirectMethod() || it.HasNextVirtualMethod(); it.Next()) {
     uint32_t code_off = it.GetMethodCodeItemOffset();
-    if (code_off != 0 && !CheckOffsetToTypeMap(code_off, DexFile::kDexTypeCodeItem)) {
-      return false;
+    if (code_off != 0) {
+      if (verify_code_items_) {
+        if (!CheckOffsetToTypeMap(code_off, DexFile::kDexTypeCodeItem)) {
+          return false;
+        }
+      } else if (UNLIKELY(!IsAligned<4>(code_off) ||
+                          (code_off < code_items_begin_) ||
+                          (code_off >= code_items_end_))) {
+        ErrorStringPrintf("Bad code_off outside of the code items: %x", code_off);
+        return false;
+      }
     }
     LOAD_METHOD(method, it.GetMemberIndex(), "inter_class_data_item method_id", return false)
     if (UNLIKELY(method->class_idx_ != defining_class)) {
@@ -26,17 +26,31 @@ namespace art {
 
 class DexFileVerifier {
  public:
+  // Unless `verify_code_items` is set, the code items and debug info items are only checked to
+  // be referenced from within their sections, and are left to VerifyClassCodeItems().
   static bool Verify(const DexFile* dex_file, const uint8_t* begin, size_t size,
-                     const char* location, std::string* error_msg);
+                     const char* location, std::string* error_msg,
+                     bool verify_code_items = true);
+
+  // Verify the code items and debug info items of the methods of `class_def`, in a dex file
+  // verified without them.
+  static bool VerifyClassCodeItems(const DexFile* dex_file,
+                                   const DexFile::ClassDef& class_def,
+                                   std::string* error_msg);
 
   const std::string& FailureReason() const {
     return failure_reason_;
   }
 
  private:
-  DexFileVerifier(const DexFile* dex_file, const uint8_t* begin, size_t size, const char* location)
+  DexFileVerifier(const DexFile* dex_file,
+                  const uint8_t* begin,
+                  size_t size,
+                  const char* location,
+                  bool verify_code_items)
       : dex_file_(dex_file), begin_(begin), size_(size), location_(location),
-        header_(&dex_file->GetHeader()), ptr_(nullptr), previous_item_(nullptr)  {
+        header_(&dex_file->GetHeader()), verify_code_items_(verify_code_items),
+        code_items_begin_(0u), code_items_end_(0u), ptr_(nullptr), previous_item_(nullptr)  {
   }
 
   bool Verify();
@@ -111,6 +125,9 @@ class DexFileVerifier {
   bool CheckIntraIdSection(size_t offset, uint32_t count, uint16_t type);
   bool CheckIntraDataSection(size_t offset, uint32_t count, uint16_t type);
   bool CheckIntraSection();
+  // Check the bounds of a data section whose items are not verified, see VerifyClassCodeItems().
+  bool CheckDeferredDataSection(size_t offset, size_t end, uint16_t type);
+  bool CheckClassCodeItems(const uint8_t* class_data);
 
   bool CheckOffsetToTypeMap(size_t offset, uint16_t type);
 
@@ -177,6 +194,10 @@ class DexFileVerifier {
   const size_t size_;
   const char* const location_;
   const DexFile::Header* const header_;
+  const bool verify_code_items_;
+  // Bounds of the code item section, when the code items are not verified.
+  size_t code_items_begin_;
+  size_t code_items_end_;
 
   struct OffsetTypeMapEmptyFn {
     // Make a hash map slot empty by making the offset 0. Offset 0 is a valid dex file offset that
@@ -122,6 +122,10 @@ static void FixUpChecksum(uint8_t* dex_file) {
 
 class DexFileVerifierTest : public CommonRuntimeTest {
  protected:
+  static std::unique_ptr<DexFile> CreateDexFile(const uint8_t* dex_bytes, size_t length) {
+    return std::unique_ptr<DexFile>(new DexFile(dex_bytes, length, "tmp", 0, nullptr, nullptr));
+  }
+
   void VerifyModification(const char* dex_file_base64_content,
                           const char* location,
                           std::function<void(DexFile*)> f,
@@ -213,6 +217,44 @@ TEST_F(DexFileVerifierTest, GoodDex) {
   ASSERT_TRUE(raw.get() != nullptr) << error_msg;
 }
 
+TEST_F(DexFileVerifierTest, DeferredCodeItems) {
+  size_t length;
+  std::unique_ptr<uint8_t[]> dex_bytes = DecodeBase64(kGoodTestDex, &length);
+  CHECK(dex_bytes != nullptr);
+  // Note: `dex_file` will be destroyed before `dex_bytes`.
+  std::unique_ptr<DexFile> dex_file = CreateDexFile(dex_bytes.get(), length);
+  ASSERT_EQ(1u, dex_file->NumClassDefs());
+  const DexFile::ClassDef& class_def = dex_file->GetClassDef(0);
+  ClassDataItemIterator it(*dex_file, dex_file->GetClassData(class_def));
+  while (it.HasNextStaticField() || it.HasNextInstanceField()) {
+    it.Next();
+  }
+  ASSERT_TRUE(it.HasNextDirectMethod());
+  DexFile::CodeItem* code_item = const_cast<DexFile::CodeItem*>(it.GetMethodCodeItem());
+  ASSERT_TRUE(code_item != nullptr);
+  code_item->ins_size_ = code_item->registers_size_ + 1;
+  FixUpChecksum(dex_bytes.get());
+
+  std::string error_msg;
+  EXPECT_FALSE(DexFileVerifier::Verify(dex_file.get(),
+                                       dex_file->Begin(),
+                                       dex_file->Size(),
+                                       "deferred",
+                                       &error_msg));
+  EXPECT_NE(error_msg.find("ins_size"), std::string::npos) << error_msg;
+
+  // The broken code item is only found when verifying the class using it.
+  EXPECT_TRUE(DexFileVerifier::Verify(dex_file.get(),
+                                      dex_file->Begin(),
+                                      dex_file->Size(),
+                                      "deferred",
+                                      &error_msg,
+                                      /* verify_code_items */ false)) << error_msg;
+  error_msg.clear();
+  EXPECT_FALSE(DexFileVerifier::VerifyClassCodeItems(dex_file.get(), class_def, &error_msg));
+  EXPECT_NE(error_msg.find("ins_size"), std::string::npos) << error_msg;
+}
+
 TEST_F(DexFileVerifierTest, MethodId) {
   // Class idx error.
   VerifyModification(
@@ -101,6 +101,26 @@ void SpaceBitmap<kAlignment>::Clear() {
   }
 }
 
+template<size_t kAlignment>
+void SpaceBitmap<kAlignment>::ClearRange(const mirror::Object* begin, const mirror::Object* end) {
+  uintptr_t begin_offset = reinterpret_cast<uintptr_t>(begin) - heap_begin_;
+  uintptr_t end_offset = reinterpret_cast<uintptr_t>(end) - heap_begin_;
+  DCHECK_LE(begin_offset, end_offset);
+  DCHECK_LE(OffsetToIndex(end_offset), bitmap_size_ / sizeof(intptr_t));
+  // Clear the bits of the partial words at both ends one by one, and the whole words at once.
+  while (begin_offset < end_offset && !IsAligned<kBitsPerIntPtrT * kAlignment>(begin_offset)) {
+    Clear(reinterpret_cast<mirror::Object*>(heap_begin_ + begin_offset));
+    begin_offset += kAlignment;
+  }
+  while (begin_offset < end_offset && !IsAligned<kBitsPerIntPtrT * kAlignment>(end_offset)) {
+    end_offset -= kAlignment;
+    Clear(reinterpret_cast<mirror::Object*>(heap_begin_ + end_offset));
+  }
+  std::fill(bitmap_begin_ + OffsetToIndex(begin_offset),
+            bitmap_begin_ + OffsetToIndex(end_offset),
+            0);
+}
+
 template<size_t kAlignment>
 void SpaceBitmap<kAlignment>::CopyFrom(SpaceBitmap* source_bitmap) {
   DCHECK_EQ(Size(), source_bitmap->Size());
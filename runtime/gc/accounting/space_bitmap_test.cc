@@ -87,6 +87,32 @@ TEST_F(SpaceBitmapTest, ScanRange) {
   }
 }
 
+TEST_F(SpaceBitmapTest, ClearRange) {
+  uint8_t* heap_begin = reinterpret_cast<uint8_t*>(0x10000000);
+  size_t heap_capacity = 16 * MB;
+
+  std::unique_ptr<ContinuousSpaceBitmap> bitmap(
+      ContinuousSpaceBitmap::Create("test bitmap", heap_begin, heap_capacity));
+  EXPECT_TRUE(bitmap.get() != nullptr);
+
+  // Try ranges that start and end within words and at word boundaries.
+  const size_t num_objects = kBitsPerIntPtrT * 4;
+  for (size_t i = 0; i < kBitsPerIntPtrT + 2; ++i) {
+    for (size_t j = i; j < num_objects; j += kBitsPerIntPtrT / 2 - 1) {
+      for (size_t k = 0; k < num_objects; ++k) {
+        bitmap->Set(reinterpret_cast<mirror::Object*>(heap_begin + k * kObjectAlignment));
+      }
+      bitmap->ClearRange(reinterpret_cast<mirror::Object*>(heap_begin + i * kObjectAlignment),
+                         reinterpret_cast<mirror::Object*>(heap_begin + j * kObjectAlignment));
+      for (size_t k = 0; k < num_objects; ++k) {
+        const mirror::Object* obj =
+            reinterpret_cast<mirror::Object*>(heap_begin + k * kObjectAlignment);
+        EXPECT_EQ(k < i || k >= j, bitmap->Test(obj)) << i << " " << j << " " << k;
+      }
+    }
+  }
+}
+
 class SimpleCounter {
  public:
   explicit SimpleCounter(size_t* counter) : count_(counter) {}
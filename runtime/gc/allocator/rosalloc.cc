@@ -44,6 +44,9 @@ size_t RosAlloc::numOfPages[kNumOfSizeBrackets];
 size_t RosAlloc::numOfSlots[kNumOfSizeBrackets];
 size_t RosAlloc::headerSizes[kNumOfSizeBrackets];
 bool RosAlloc::initialized_ = false;
+size_t RosAlloc::num_thread_local_size_brackets_ = RosAlloc::kNumThreadLocalSizeBrackets;
+size_t RosAlloc::max_thread_local_bracket_size_ = RosAlloc::kMaxThreadLocalBracketSize;
+size_t RosAlloc::run_pages_overrides_[kNumOfSizeBrackets] = { 0 };
 size_t RosAlloc::dedicated_full_run_storage_[kPageSize / sizeof(size_t)] = { 0 };
 RosAlloc::Run* RosAlloc::dedicated_full_run_ =
     reinterpret_cast<RosAlloc::Run*>(dedicated_full_run_storage_);
@@ -81,7 +84,12 @@ RosAlloc::RosAlloc(void* base, size_t capacity, size_t max_capacity,
         StringPrintf("an rosalloc size bracket %d lock", static_cast<int>(i));
     size_bracket_locks_[i] = new Mutex(size_bracket_lock_names_[i].c_str(), kRosAllocBracketLock);
     current_runs_[i] = dedicated_full_run_;
+    num_shared_run_allocs_[i] = 0;
+    num_thread_local_run_refills_[i] = 0;
+    num_thread_local_run_slots_[i] = 0;
   }
+  num_large_object_allocs_ = 0;
+  num_large_object_alloc_pages_ = 0;
   DCHECK_EQ(footprint_, capacity_);
   size_t num_of_pages = footprint_ / kPageSize;
   size_t max_num_of_pages = max_capacity_ / kPageSize;
@@ -473,6 +481,10 @@ void* RosAlloc::AllocLargeObject(Thread* self, size_t size, size_t* bytes_alloca
   {
     MutexLock mu(self, lock_);
     r = AllocPages(self, num_pages, kPageMapLargeObject);
+    if (LIKELY(r != nullptr)) {
+      ++num_large_object_allocs_;
+      num_large_object_alloc_pages_ += num_pages;
+    }
   }
   if (UNLIKELY(r == nullptr)) {
     if (kTraceRosAlloc) {
@@ -562,7 +574,7 @@ RosAlloc::Run* RosAlloc::AllocRun(Thread* self, size_t idx) {
     new_run->size_bracket_idx_ = idx;
     DCHECK(!new_run->IsThreadLocal());
     DCHECK(!new_run->to_be_bulk_freed_);
-    if (kUsePrefetchDuringAllocRun && idx < kNumThreadLocalSizeBrackets) {
+    if (kUsePrefetchDuringAllocRun && idx < num_thread_local_size_brackets_) {
       // Take ownership of the cache lines if we are likely to be thread local run.
       if (kPrefetchNewRunDataByZeroing) {
         // Zeroing the data is sometimes faster than prefetching but it increases memory usage
@@ -647,6 +659,7 @@ void* RosAlloc::AllocFromRunThreadUnsafe(Thread* self, size_t size, size_t* byte
   Locks::mutator_lock_->AssertExclusiveHeld(self);
   void* slot_addr = AllocFromCurrentRunUnlocked(self, idx);
   if (LIKELY(slot_addr != nullptr)) {
+    ++num_shared_run_allocs_[idx];
     *bytes_allocated = bracket_size;
     *usable_size = bracket_size;
     *bytes_tl_bulk_allocated = bracket_size;
@@ -664,7 +677,7 @@ void* RosAlloc::AllocFromRun(Thread* self, size_t size, size_t* bytes_allocated,
   size_t bracket_size;
   size_t idx = SizeToIndexAndBracketSize(size, &bracket_size);
   void* slot_addr;
-  if (LIKELY(idx < kNumThreadLocalSizeBrackets)) {
+  if (LIKELY(idx < num_thread_local_size_brackets_)) {
     // Use a thread-local run.
     Run* thread_local_run = reinterpret_cast<Run*>(self->GetRosAllocRun(idx));
     // Allow invalid since this will always fail the allocation.
@@ -723,7 +736,10 @@ void* RosAlloc::AllocFromRun(Thread* self, size_t size, size_t* bytes_allocated,
       DCHECK(!thread_local_run->IsFull());
       DCHECK(thread_local_run->IsThreadLocal());
       // Account for all the free slots in the new or refreshed thread local run.
-      *bytes_tl_bulk_allocated = thread_local_run->NumberOfFreeSlots() * bracket_size;
+      const size_t num_free_slots = thread_local_run->NumberOfFreeSlots();
+      ++num_thread_local_run_refills_[idx];
+      num_thread_local_run_slots_[idx] += num_free_slots;
+      *bytes_tl_bulk_allocated = num_free_slots * bracket_size;
       slot_addr = thread_local_run->AllocSlot();
       // Must succeed now with a new run.
       DCHECK(slot_addr != nullptr);
@@ -751,6 +767,7 @@ void* RosAlloc::AllocFromRun(Thread* self, size_t size, size_t* bytes_allocated,
                 << "(" << std::dec << (bracket_size) << ")";
     }
     if (LIKELY(slot_addr != nullptr)) {
+      ++num_shared_run_allocs_[idx];
       *bytes_allocated = bracket_size;
       *usable_size = bracket_size;
       *bytes_tl_bulk_allocated = bracket_size;
@@ -776,7 +793,7 @@ size_t RosAlloc::FreeFromRun(Thread* self, void* ptr, Run* run) {
   }
   if (LIKELY(run->IsThreadLocal())) {
     // It's a thread-local run. Just mark the thread-local free bit map and return.
-    DCHECK_LT(run->size_bracket_idx_, kNumThreadLocalSizeBrackets);
+    DCHECK_LT(run->size_bracket_idx_, num_thread_local_size_brackets_);
     DCHECK(non_full_runs_[idx].find(run) == non_full_runs_[idx].end());
     DCHECK(full_runs_[idx].find(run) == full_runs_[idx].end());
     run->AddToThreadLocalFreeList(ptr);
@@ -1008,17 +1025,39 @@ void RosAlloc::Run::InspectAllSlots(void (*handler)(void* start, void* end, size
 static constexpr bool kReadPageMapEntryWithoutLockInBulkFree = true;
 
 size_t RosAlloc::BulkFree(Thread* self, void** ptrs, size_t num_ptrs) {
-  size_t freed_bytes = 0;
   if ((false)) {
     // Used only to test Free() as GC uses only BulkFree().
+    size_t freed_bytes = 0;
     for (size_t i = 0; i < num_ptrs; ++i) {
       freed_bytes += FreeInternal(self, ptrs[i]);
     }
     return freed_bytes;
   }
-
   WriterMutexLock wmu(self, bulk_free_lock_);
+  return BulkFreeInternal(self, ptrs, num_ptrs);
+}
+
+size_t RosAlloc::BulkFreeDisjoint(Thread* self, void** ptrs, size_t num_ptrs) {
+  // The bulk free lists and the to_be_bulk_freed_ flags are per run, so holding the lock shared
+  // is enough when no other thread frees slots of the same runs. The page map entries read
+  // without lock_ are those of runs with slots to free, which cannot be released meanwhile.
+  ReaderMutexLock rmu(self, bulk_free_lock_);
+  return BulkFreeInternal(self, ptrs, num_ptrs);
+}
 
+uint8_t* RosAlloc::RoundUpToRunBoundary(uint8_t* addr) {
+  DCHECK_LE(base_, addr);
+  MutexLock mu(Thread::Current(), lock_);
+  size_t pm_idx = RoundUp(addr - base_, kPageSize) / kPageSize;
+  while (pm_idx < page_map_size_ &&
+         (page_map_[pm_idx] == kPageMapRunPart || page_map_[pm_idx] == kPageMapLargeObjectPart)) {
+    ++pm_idx;
+  }
+  return base_ + pm_idx * kPageSize;
+}
+
+size_t RosAlloc::BulkFreeInternal(Thread* self, void** ptrs, size_t num_ptrs) {
+  size_t freed_bytes = 0;
   // First mark slots to free in the bulk free bit map without locking the
   // size bracket locks. On host, unordered_set is faster than vector + flag.
 #ifdef __ANDROID__
@@ -1110,7 +1149,7 @@ size_t RosAlloc::BulkFree(Thread* self, void** ptrs, size_t num_ptrs) {
     size_t idx = run->size_bracket_idx_;
     MutexLock brackets_mu(self, *size_bracket_locks_[idx]);
     if (run->IsThreadLocal()) {
-      DCHECK_LT(run->size_bracket_idx_, kNumThreadLocalSizeBrackets);
+      DCHECK_LT(run->size_bracket_idx_, num_thread_local_size_brackets_);
       DCHECK(non_full_runs_[idx].find(run) == non_full_runs_[idx].end());
       DCHECK(full_runs_[idx].find(run) == full_runs_[idx].end());
       run->MergeBulkFreeListToThreadLocalFreeList();
@@ -1513,7 +1552,7 @@ void RosAlloc::SetFootprintLimit(size_t new_capacity) {
 size_t RosAlloc::RevokeThreadLocalRuns(Thread* thread) {
   Thread* self = Thread::Current();
   size_t free_bytes = 0U;
-  for (size_t idx = 0; idx < kNumThreadLocalSizeBrackets; idx++) {
+  for (size_t idx = 0; idx < num_thread_local_size_brackets_; idx++) {
     MutexLock mu(self, *size_bracket_locks_[idx]);
     Run* thread_local_run = reinterpret_cast<Run*>(thread->GetRosAllocRun(idx));
     CHECK(thread_local_run != nullptr);
@@ -1576,7 +1615,7 @@ void RosAlloc::RevokeRun(Thread* self, size_t idx, Run* run) {
 void RosAlloc::RevokeThreadUnsafeCurrentRuns() {
   // Revoke the current runs which share the same idx as thread local runs.
   Thread* self = Thread::Current();
-  for (size_t idx = 0; idx < kNumThreadLocalSizeBrackets; ++idx) {
+  for (size_t idx = 0; idx < num_thread_local_size_brackets_; ++idx) {
     MutexLock mu(self, *size_bracket_locks_[idx]);
     if (current_runs_[idx] != dedicated_full_run_) {
       RevokeRun(self, idx, current_runs_[idx]);
@@ -1604,7 +1643,7 @@ void RosAlloc::AssertThreadLocalRunsAreRevoked(Thread* thread) {
     Thread* self = Thread::Current();
     // Avoid race conditions on the bulk free bit maps with BulkFree() (GC).
     ReaderMutexLock wmu(self, bulk_free_lock_);
-    for (size_t idx = 0; idx < kNumThreadLocalSizeBrackets; idx++) {
+    for (size_t idx = 0; idx < num_thread_local_size_brackets_; idx++) {
       MutexLock mu(self, *size_bracket_locks_[idx]);
       Run* thread_local_run = reinterpret_cast<Run*>(thread->GetRosAllocRun(idx));
       DCHECK(thread_local_run == nullptr || thread_local_run == dedicated_full_run_);
@@ -1621,7 +1660,7 @@ void RosAlloc::AssertAllThreadLocalRunsAreRevoked() {
     for (Thread* t : thread_list) {
       AssertThreadLocalRunsAreRevoked(t);
     }
-    for (size_t idx = 0; idx < kNumThreadLocalSizeBrackets; ++idx) {
+    for (size_t idx = 0; idx < num_thread_local_size_brackets_; ++idx) {
       MutexLock brackets_mu(self, *size_bracket_locks_[idx]);
       CHECK_EQ(current_runs_[idx], dedicated_full_run_);
     }
@@ -1650,7 +1689,9 @@ void RosAlloc::Initialize() {
   }
   // numOfPages.
   for (size_t i = 0; i < kNumOfSizeBrackets; i++) {
-    if (i < kNumThreadLocalSizeBrackets) {
+    if (run_pages_overrides_[i] != 0) {
+      numOfPages[i] = run_pages_overrides_[i];
+    } else if (i < kNumThreadLocalSizeBrackets) {
       numOfPages[i] = 1;
     } else if (i < (kNumThreadLocalSizeBrackets + kNumRegularSizeBrackets) / 2) {
       numOfPages[i] = 1;
@@ -1723,6 +1764,67 @@ void RosAlloc::Initialize() {
   // Check the invariants between the max bracket sizes and the number of brackets.
   DCHECK_EQ(kMaxThreadLocalBracketSize, bracketSizes[kNumThreadLocalSizeBrackets - 1]);
   DCHECK_EQ(kMaxRegularBracketSize, bracketSizes[kNumRegularSizeBrackets - 1]);
+  DCHECK_LE(num_thread_local_size_brackets_, kMaxNumThreadLocalSizeBrackets);
+  DCHECK_EQ(max_thread_local_bracket_size_, bracketSizes[num_thread_local_size_brackets_ - 1]);
+}
+
+bool RosAlloc::ConfigureSizeBrackets(size_t max_thread_local_bracket_size,
+                                     const std::string& run_pages,
+                                     std::string* error_msg) {
+  const size_t largest_thread_local_bracket_size = kMaxThreadLocalBracketSize +
+      (kMaxNumThreadLocalSizeBrackets - kNumThreadLocalSizeBrackets) * kBracketQuantumSize;
+  if (max_thread_local_bracket_size < kMaxThreadLocalBracketSize ||
+      max_thread_local_bracket_size > largest_thread_local_bracket_size ||
+      RoundToBracketSize(max_thread_local_bracket_size) != max_thread_local_bracket_size) {
+    *error_msg = StringPrintf("Invalid thread-local bracket size %zu: it must be a bracket size "
+                              "between %zu and %zu",
+                              max_thread_local_bracket_size,
+                              kMaxThreadLocalBracketSize,
+                              largest_thread_local_bracket_size);
+    return false;
+  }
+  size_t run_pages_overrides[kNumOfSizeBrackets] = { 0 };
+  std::vector<std::string> entries;
+  Split(run_pages, ',', &entries);
+  for (const std::string& entry : entries) {
+    std::vector<std::string> size_and_pages;
+    Split(entry, ':', &size_and_pages);
+    char* end_size = nullptr;
+    char* end_pages = nullptr;
+    size_t bracket_size = 0;
+    size_t num_pages = 0;
+    if (size_and_pages.size() == 2) {
+      bracket_size = strtoul(size_and_pages[0].c_str(), &end_size, 10);
+      num_pages = strtoul(size_and_pages[1].c_str(), &end_pages, 10);
+    }
+    if (end_size == nullptr || *end_size != '\0' || end_pages == nullptr || *end_pages != '\0' ||
+        bracket_size == 0 || bracket_size > kLargeSizeThreshold ||
+        RoundToBracketSize(bracket_size) != bracket_size) {
+      *error_msg = StringPrintf("Invalid run pages entry '%s': expected bracket_size:num_pages",
+                                entry.c_str());
+      return false;
+    }
+    if (num_pages == 0 || num_pages > kMaxNumOfPagesPerRun) {
+      *error_msg = StringPrintf("Invalid number of pages %zu for the %zu bytes bracket: it must be "
+                                "between 1 and %zu",
+                                num_pages,
+                                bracket_size,
+                                kMaxNumOfPagesPerRun);
+      return false;
+    }
+    run_pages_overrides[SizeToIndex(bracket_size)] = num_pages;
+  }
+  // The run specs are computed from these when the first RosAlloc is created, and the threads
+  // only have thread-local runs for the brackets below the cutoff, so neither can change later.
+  const size_t num_thread_local_size_brackets = SizeToIndex(max_thread_local_bracket_size) + 1;
+  DCHECK(!initialized_ || std::equal(run_pages_overrides,
+                                     run_pages_overrides + kNumOfSizeBrackets,
+                                     run_pages_overrides_));
+  DCHECK(!initialized_ || num_thread_local_size_brackets == num_thread_local_size_brackets_);
+  std::copy(run_pages_overrides, run_pages_overrides + kNumOfSizeBrackets, run_pages_overrides_);
+  num_thread_local_size_brackets_ = num_thread_local_size_brackets;
+  max_thread_local_bracket_size_ = max_thread_local_bracket_size;
+  return true;
 }
 
 void RosAlloc::BytesAllocatedCallback(void* start ATTRIBUTE_UNUSED, void* end ATTRIBUTE_UNUSED,
@@ -1847,7 +1949,7 @@ void RosAlloc::Verify() {
   }
   std::list<Thread*> threads = Runtime::Current()->GetThreadList()->GetList();
   for (Thread* thread : threads) {
-    for (size_t i = 0; i < kNumThreadLocalSizeBrackets; ++i) {
+    for (size_t i = 0; i < num_thread_local_size_brackets_; ++i) {
       MutexLock brackets_mu(self, *size_bracket_locks_[i]);
       Run* thread_local_run = reinterpret_cast<Run*>(thread->GetRosAllocRun(i));
       CHECK(thread_local_run != nullptr);
@@ -1891,7 +1993,7 @@ void RosAlloc::Run::Verify(Thread* self, RosAlloc* rosalloc, bool running_on_mem
     std::list<Thread*> thread_list = Runtime::Current()->GetThreadList()->GetList();
     for (auto it = thread_list.begin(); it != thread_list.end(); ++it) {
       Thread* thread = *it;
-      for (size_t i = 0; i < kNumThreadLocalSizeBrackets; i++) {
+      for (size_t i = 0; i < num_thread_local_size_brackets_; i++) {
         MutexLock mu(self, *rosalloc->size_bracket_locks_[i]);
         Run* thread_local_run = reinterpret_cast<Run*>(thread->GetRosAllocRun(i));
         if (thread_local_run == this) {
@@ -2190,6 +2292,86 @@ void RosAlloc::DumpStats(std::ostream& os) {
   os << "\n";
 }
 
+void RosAlloc::DumpBracketHistogram(std::ostream& os) {
+  Thread* self = Thread::Current();
+  os << "RosAlloc bracket histogram (thread-local up to " << max_thread_local_bracket_size_
+     << " bytes):\n";
+  for (size_t i = 0; i < kNumOfSizeBrackets; ++i) {
+    size_t num_shared_run_allocs;
+    size_t num_thread_local_run_refills;
+    size_t num_thread_local_run_slots;
+    {
+      MutexLock mu(self, *size_bracket_locks_[i]);
+      num_shared_run_allocs = num_shared_run_allocs_[i];
+      num_thread_local_run_refills = num_thread_local_run_refills_[i];
+      num_thread_local_run_slots = num_thread_local_run_slots_[i];
+    }
+    if (num_shared_run_allocs == 0 && num_thread_local_run_refills == 0) {
+      continue;
+    }
+    os << "Bracket " << i << " (" << bracketSizes[i] << "):"
+       << " #run_pages=" << numOfPages[i];
+    if (i < num_thread_local_size_brackets_) {
+      os << " #thread_local_refills=" << num_thread_local_run_refills
+         << " #thread_local_slots=" << num_thread_local_run_slots;
+    } else {
+      os << " #shared_allocs=" << num_shared_run_allocs;
+    }
+    // Allocations in brackets that could use thread-local runs but do not are worth raising
+    // the thread-local cutoff for.
+    if (i >= num_thread_local_size_brackets_ && i < kMaxNumThreadLocalSizeBrackets) {
+      os << " (could be thread-local)";
+    }
+    os << "\n";
+  }
+  MutexLock mu(self, lock_);
+  os << "Large #allocations=" << num_large_object_allocs_
+     << " #pages=" << num_large_object_alloc_pages_ << "\n";
+}
+
+void RosAlloc::EstimateFragmentation(size_t* run_bytes,
+                                     size_t* free_run_bytes,
+                                     size_t* large_object_bytes) {
+  *run_bytes = 0;
+  *free_run_bytes = 0;
+  *large_object_bytes = 0;
+  Thread* self = Thread::Current();
+  // Holding bulk_free_lock_ exclusively keeps the bulk free lists from changing and the
+  // thread-local runs from being revoked, and holding lock_ prevents runs from being freed or
+  // allocated while we walk the page map.
+  WriterMutexLock wmu(self, bulk_free_lock_);
+  MutexLock mu(self, lock_);
+  const size_t pm_end = page_map_size_;
+  size_t i = 0;
+  while (i < pm_end) {
+    switch (page_map_[i]) {
+      case kPageMapRun: {
+        Run* run = reinterpret_cast<Run*>(base_ + i * kPageSize);
+        DCHECK_EQ(run->magic_num_, kMagicNum);
+        const size_t idx = run->size_bracket_idx_;
+        // The threads owning thread-local runs allocate from their free lists without locks. Their
+        // free slots are about to be used anyway, so leave these runs out.
+        if (!run->IsThreadLocal()) {
+          const size_t num_free_slots = run->free_list_.Size() + run->bulk_free_list_.Size() +
+              run->thread_local_free_list_.Size();
+          *run_bytes += numOfPages[idx] * kPageSize;
+          *free_run_bytes += num_free_slots * bracketSizes[idx];
+        }
+        i += numOfPages[idx];
+        break;
+      }
+      case kPageMapLargeObject:
+      case kPageMapLargeObjectPart:
+        *large_object_bytes += kPageSize;
+        ++i;
+        break;
+      default:
+        ++i;
+        break;
+    }
+  }
+}
+
 }  // namespace allocator
 }  // namespace gc
 }  // namespace art
@@ -507,6 +507,14 @@ class RosAlloc {
   static void Initialize();
   static bool initialized_;
 
+  // The number of leading size brackets that use thread-local runs, and the size of the largest
+  // of them. These default to kNumThreadLocalSizeBrackets and kMaxThreadLocalBracketSize and can
+  // be raised up to kMaxNumThreadLocalSizeBrackets, see ConfigureSizeBrackets().
+  static size_t num_thread_local_size_brackets_;
+  static size_t max_thread_local_bracket_size_;
+  // The numbers of pages per run requested with ConfigureSizeBrackets(), or 0 for the default.
+  static size_t run_pages_overrides_[kNumOfSizeBrackets];
+
   // Returns the byte size of the bracket size from the index.
   static size_t IndexToBracketSize(size_t idx) {
     DCHECK_LT(idx, kNumOfSizeBrackets);
@@ -537,9 +545,9 @@ class RosAlloc {
   }
   // Returns true if the given allocation size is for a thread local allocation.
   static bool IsSizeForThreadLocal(size_t size) {
-    bool is_size_for_thread_local = size <= kMaxThreadLocalBracketSize;
+    bool is_size_for_thread_local = size <= max_thread_local_bracket_size_;
     DCHECK(size > kLargeSizeThreshold ||
-           (is_size_for_thread_local == (SizeToIndex(size) < kNumThreadLocalSizeBrackets)));
+           (is_size_for_thread_local == (SizeToIndex(size) < num_thread_local_size_brackets_)));
     return is_size_for_thread_local;
   }
   // Rounds up the size up the nearest bracket size.
@@ -658,18 +666,22 @@ class RosAlloc {
   // The default value for page_release_size_threshold_.
   static constexpr size_t kDefaultPageReleaseSizeThreshold = 4 * MB;
 
-  // We use thread-local runs for the size brackets whose indexes
+  // By default, we use thread-local runs for the size brackets whose indexes
   // are less than this index. We use shared (current) runs for the rest.
-  // Sync this with the length of Thread::rosalloc_runs_.
+  // The assembly allocation fast paths only handle these brackets.
   static const size_t kNumThreadLocalSizeBrackets = 16;
-  static_assert(kNumThreadLocalSizeBrackets == kNumRosAllocThreadLocalSizeBracketsInThread,
-                "Mismatch between kNumThreadLocalSizeBrackets and "
-                "kNumRosAllocThreadLocalSizeBracketsInThread");
 
-  // The size of the largest bracket we use thread-local runs for.
+  // The size of the largest bracket we use thread-local runs for by default.
   // This should be equal to bracketSizes[kNumThreadLocalSizeBrackets - 1].
   static const size_t kMaxThreadLocalBracketSize = 128;
 
+  // The largest number of size brackets ConfigureSizeBrackets() accepts to use thread-local runs
+  // for. Sync this with the length of Thread::rosalloc_runs_.
+  static const size_t kMaxNumThreadLocalSizeBrackets = 24;
+  static_assert(kMaxNumThreadLocalSizeBrackets == kNumRosAllocThreadLocalSizeBracketsInThread,
+                "Mismatch between kMaxNumThreadLocalSizeBrackets and "
+                "kNumRosAllocThreadLocalSizeBracketsInThread");
+
   // We use regular (8 or 16-bytes increment) runs for the size brackets whose indexes are less than
   // this index.
   static const size_t kNumRegularSizeBrackets = 40;
@@ -678,6 +690,9 @@ class RosAlloc {
   // 1 KB and the 2 KB brackets. This should be equal to bracketSizes[kNumRegularSizeBrackets - 1].
   static const size_t kMaxRegularBracketSize = 512;
 
+  // The largest number of pages ConfigureSizeBrackets() accepts for the runs of a size bracket.
+  static constexpr size_t kMaxNumOfPagesPerRun = 16;
+
   // The bracket size increment for the thread-local brackets (<= kMaxThreadLocalBracketSize bytes).
   static constexpr size_t kThreadLocalBracketQuantumSize = 8;
 
@@ -727,6 +742,17 @@ class RosAlloc {
   Run* current_runs_[kNumOfSizeBrackets];
   // The mutexes, one per size bracket.
   Mutex* size_bracket_locks_[kNumOfSizeBrackets];
+  // The allocation histograms, per size bracket. The number of allocations made from the shared
+  // current runs, the number of thread-local run refills and the number of slots these refills
+  // handed to threads. Since the thread-local fast paths (including the assembly ones) do not
+  // count, the latter is an upper bound of the thread-local allocations. Element i of each array
+  // is guarded by size_bracket_locks_[i].
+  size_t num_shared_run_allocs_[kNumOfSizeBrackets];
+  size_t num_thread_local_run_refills_[kNumOfSizeBrackets];
+  size_t num_thread_local_run_slots_[kNumOfSizeBrackets];
+  // The number of large object allocations and the pages they used.
+  size_t num_large_object_allocs_ GUARDED_BY(lock_);
+  size_t num_large_object_alloc_pages_ GUARDED_BY(lock_);
   // Bracket lock names (since locks only have char* names).
   std::string size_bracket_lock_names_[kNumOfSizeBrackets];
   // The types of page map entries.
@@ -803,6 +829,9 @@ class RosAlloc {
   // The internal of non-bulk Free().
   size_t FreeInternal(Thread* self, void* ptr) REQUIRES(!lock_);
 
+  // The internal of BulkFree() and BulkFreeDisjoint(), called with bulk_free_lock_ held.
+  size_t BulkFreeInternal(Thread* self, void** ptrs, size_t num_ptrs) REQUIRES(!lock_);
+
   // Allocates large objects.
   void* AllocLargeObject(Thread* self, size_t size, size_t* bytes_allocated,
                          size_t* usable_size, size_t* bytes_tl_bulk_allocated)
@@ -850,6 +879,16 @@ class RosAlloc {
       REQUIRES(!bulk_free_lock_, !lock_);
   size_t BulkFree(Thread* self, void** ptrs, size_t num_ptrs)
       REQUIRES(!bulk_free_lock_, !lock_);
+  // Like BulkFree(), but holds bulk_free_lock_ shared, like Free(), so that several threads can
+  // free at the same time. This is safe because the bulk free lists it updates are per run and
+  // the concurrent callers free the slots of disjoint sets of runs, for example by freeing from
+  // page ranges split at RoundUpToRunBoundary().
+  size_t BulkFreeDisjoint(Thread* self, void** ptrs, size_t num_ptrs)
+      REQUIRES(!bulk_free_lock_, !lock_);
+  // Returns `addr` rounded up to a page boundary that is not inside a run or a large object.
+  // Runs allocated after the call may span the returned boundary, but they have no slots that
+  // were allocated before the call.
+  uint8_t* RoundUpToRunBoundary(uint8_t* addr) REQUIRES(!lock_);
 
   // Returns true if the given allocation request can be allocated in
   // an existing thread local run without allocating a new run.
@@ -931,6 +970,31 @@ class RosAlloc {
   void DumpStats(std::ostream& os)
       REQUIRES(Locks::mutator_lock_) REQUIRES(!lock_) REQUIRES(!bulk_free_lock_);
 
+  // Dump the per size bracket allocation histograms, for picking the thread-local bracket cutoff
+  // and the run sizes with ConfigureSizeBrackets().
+  void DumpBracketHistogram(std::ostream& os) REQUIRES(!lock_);
+
+  // Estimate the fragmentation of the runs. `run_bytes` receives the size of the pages used by
+  // the shared runs, `free_run_bytes` that of their free slots, which only allocations of the same
+  // size bracket can reuse, and `large_object_bytes` that of the pages used by large objects. The
+  // thread-local runs are left out. The free lists of the current runs of the shared brackets are
+  // read without the bracket locks, so the result is approximate.
+  void EstimateFragmentation(size_t* run_bytes, size_t* free_run_bytes, size_t* large_object_bytes)
+      REQUIRES(!lock_, !bulk_free_lock_);
+
+  // Configure the size brackets before the first RosAlloc instance is created.
+  // `max_thread_local_bracket_size` is the size of the largest bracket that uses thread-local
+  // runs. It must be a bracket size between kMaxThreadLocalBracketSize and the size of bracket
+  // kMaxNumThreadLocalSizeBrackets - 1, since Thread has room for that many runs. The assembly
+  // allocation fast paths keep handling the brackets up to kMaxThreadLocalBracketSize, the
+  // allocations of the brackets above it use their thread-local runs from the runtime. `run_pages`
+  // is a comma separated list of bracket_size:num_pages pairs overriding the number of pages of
+  // the runs of these brackets. Returns false and sets `error_msg` if the configuration is
+  // invalid.
+  static bool ConfigureSizeBrackets(size_t max_thread_local_bracket_size,
+                                    const std::string& run_pages,
+                                    std::string* error_msg);
+
  private:
   friend std::ostream& operator<<(std::ostream& os, const RosAlloc::PageMapKind& rhs);
 
@@ -0,0 +1,387 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "rosalloc.h"
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+#include "base/time_utils.h"
+#include "common_runtime_test.h"
+#include "gc/heap.h"
+#include "gc/space/rosalloc_space.h"
+#include "thread-inl.h"
+#include "thread_pool.h"
+
+namespace art {
+namespace gc {
+namespace allocator {
+
+class RosAllocTest : public CommonRuntimeTest {};
+
+// Returns the line of `dump` that contains `key`, or an empty string.
+static std::string FindLine(const std::string& dump, const std::string& key) {
+  std::istringstream is(dump);
+  std::string line;
+  while (std::getline(is, line)) {
+    if (line.find(key) != std::string::npos) {
+      return line;
+    }
+  }
+  return "";
+}
+
+TEST_F(RosAllocTest, DumpBracketHistogram) {
+  Thread* self = Thread::Current();
+  std::unique_ptr<space::RosAllocSpace> space(space::RosAllocSpace::Create("test rosalloc space",
+                                                                           4 * MB,
+                                                                           16 * MB,
+                                                                           16 * MB,
+                                                                           nullptr,
+                                                                           false,
+                                                                           false));
+  ASSERT_TRUE(space != nullptr);
+  RosAlloc* rosalloc = space->GetRosAlloc();
+  // The thread-local runs of this thread must come from the test RosAlloc.
+  Runtime::Current()->GetHeap()->RevokeThreadLocalBuffers(self);
+
+  auto alloc = [self, rosalloc](size_t size) {
+    size_t bytes_allocated;
+    size_t usable_size;
+    size_t bytes_tl_bulk_allocated;
+    return rosalloc->Alloc(self, size, &bytes_allocated, &usable_size, &bytes_tl_bulk_allocated);
+  };
+  // Two thread-local allocations, served by a single run refill.
+  void* small1 = alloc(16);
+  void* small2 = alloc(16);
+  // Two allocations from a shared run.
+  void* medium1 = alloc(1 * KB);
+  void* medium2 = alloc(1 * KB);
+  // A large object.
+  void* large = alloc(4 * kPageSize);
+  ASSERT_TRUE(small1 != nullptr);
+  ASSERT_TRUE(small2 != nullptr);
+  ASSERT_TRUE(medium1 != nullptr);
+  ASSERT_TRUE(medium2 != nullptr);
+  ASSERT_TRUE(large != nullptr);
+
+  std::ostringstream os;
+  rosalloc->DumpBracketHistogram(os);
+  const std::string dump = os.str();
+  std::string small_line = FindLine(dump, "(16):");
+  EXPECT_NE(std::string::npos, small_line.find("#thread_local_refills=1 ")) << dump;
+  EXPECT_EQ(std::string::npos, small_line.find("#shared_allocs")) << dump;
+  std::string medium_line = FindLine(dump, "(1024):");
+  EXPECT_NE(std::string::npos, medium_line.find("#shared_allocs=2")) << dump;
+  EXPECT_EQ(std::string::npos, medium_line.find("#thread_local_refills")) << dump;
+  // Brackets without allocations are not listed.
+  EXPECT_EQ("", FindLine(dump, "(2048):")) << dump;
+  EXPECT_NE(std::string::npos, dump.find("Large #allocations=1 #pages=4\n")) << dump;
+
+  rosalloc->Free(self, large);
+  rosalloc->Free(self, medium2);
+  rosalloc->Free(self, medium1);
+  rosalloc->Free(self, small2);
+  rosalloc->Free(self, small1);
+  rosalloc->RevokeThreadLocalRuns(self);
+}
+
+// Frees a list of slots with BulkFreeDisjoint().
+class BulkFreeDisjointTask : public Task {
+ public:
+  BulkFreeDisjointTask(RosAlloc* rosalloc, std::vector<void*>* ptrs, size_t* freed_bytes)
+      : rosalloc_(rosalloc), ptrs_(ptrs), freed_bytes_(freed_bytes) {}
+
+  void Run(Thread* self) OVERRIDE {
+    *freed_bytes_ = rosalloc_->BulkFreeDisjoint(self, ptrs_->data(), ptrs_->size());
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  RosAlloc* const rosalloc_;
+  std::vector<void*>* const ptrs_;
+  size_t* const freed_bytes_;
+};
+
+TEST_F(RosAllocTest, BulkFreeDisjoint) {
+  static constexpr size_t kNumThreads = 4;
+  static constexpr size_t kNumRanges = kNumThreads * 4;
+  static constexpr size_t kNumAllocations = 8000;
+  // Thread-local, shared run and large object sizes.
+  static const size_t kSizes[] = { 16, 96, 200, 520, 1500, 3 * kPageSize };
+
+  Thread* self = Thread::Current();
+  std::unique_ptr<space::RosAllocSpace> space(space::RosAllocSpace::Create("test rosalloc space",
+                                                                           16 * MB,
+                                                                           64 * MB,
+                                                                           64 * MB,
+                                                                           nullptr,
+                                                                           false,
+                                                                           false));
+  ASSERT_TRUE(space != nullptr);
+  RosAlloc* rosalloc = space->GetRosAlloc();
+  Runtime::Current()->GetHeap()->RevokeThreadLocalBuffers(self);
+
+  // Allocate and pick every other slot to free, as a sweep would.
+  std::vector<void*> garbage;
+  size_t garbage_bytes = 0;
+  size_t live_bytes = 0;
+  for (size_t i = 0; i < kNumAllocations; ++i) {
+    size_t bytes_allocated;
+    size_t usable_size;
+    size_t bytes_tl_bulk_allocated;
+    void* ptr = rosalloc->Alloc(self,
+                                kSizes[i % arraysize(kSizes)],
+                                &bytes_allocated,
+                                &usable_size,
+                                &bytes_tl_bulk_allocated);
+    ASSERT_TRUE(ptr != nullptr) << i;
+    if ((i / arraysize(kSizes)) % 2 == 0) {
+      garbage.push_back(ptr);
+      garbage_bytes += usable_size;
+    } else {
+      live_bytes += usable_size;
+    }
+  }
+  rosalloc->RevokeThreadLocalRuns(self);
+
+  // Split the garbage into ranges that do not share runs, like the parallel sweep does.
+  std::sort(garbage.begin(), garbage.end());
+  uint8_t* const begin = space->Begin();
+  const size_t range_size = RoundUp((space->End() - begin) / kNumRanges, kPageSize);
+  std::vector<std::vector<void*>> ranges;
+  auto it = garbage.begin();
+  for (uint8_t* range_begin = begin; range_begin < space->End(); ) {
+    uint8_t* range_end = rosalloc->RoundUpToRunBoundary(range_begin + range_size);
+    auto range_it = std::lower_bound(it, garbage.end(), static_cast<void*>(range_end));
+    ranges.emplace_back(it, range_it);
+    it = range_it;
+    range_begin = range_end;
+  }
+  ASSERT_TRUE(it == garbage.end());
+  ASSERT_GT(ranges.size(), kNumThreads);
+
+  ThreadPool thread_pool("BulkFreeDisjoint test thread pool", kNumThreads);
+  std::vector<size_t> freed_bytes(ranges.size(), 0u);
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    thread_pool.AddTask(self, new BulkFreeDisjointTask(rosalloc, &ranges[i], &freed_bytes[i]));
+  }
+  thread_pool.StartWorkers(self);
+  thread_pool.Wait(self, true, false);
+
+  size_t total_freed_bytes = 0;
+  for (size_t bytes : freed_bytes) {
+    total_freed_bytes += bytes;
+  }
+  EXPECT_EQ(garbage_bytes, total_freed_bytes);
+  size_t allocated_bytes = 0;
+  rosalloc->InspectAll(RosAlloc::BytesAllocatedCallback, &allocated_bytes);
+  EXPECT_EQ(live_bytes, allocated_bytes);
+}
+
+TEST_F(RosAllocTest, ConfigureSizeBrackets) {
+  const size_t kCutoff = RosAlloc::kMaxThreadLocalBracketSize;
+  std::string error_msg;
+  // The default configuration.
+  EXPECT_TRUE(RosAlloc::ConfigureSizeBrackets(kCutoff, "", &error_msg)) << error_msg;
+
+  // Malformed entries.
+  EXPECT_FALSE(RosAlloc::ConfigureSizeBrackets(kCutoff, "16", &error_msg));
+  EXPECT_FALSE(RosAlloc::ConfigureSizeBrackets(kCutoff, "16:2:3", &error_msg));
+  EXPECT_FALSE(RosAlloc::ConfigureSizeBrackets(kCutoff, "a:2", &error_msg));
+  EXPECT_FALSE(RosAlloc::ConfigureSizeBrackets(kCutoff, "16:2x", &error_msg));
+  // Sizes that are not bracket sizes.
+  EXPECT_FALSE(RosAlloc::ConfigureSizeBrackets(kCutoff, "0:2", &error_msg));
+  EXPECT_FALSE(RosAlloc::ConfigureSizeBrackets(kCutoff, "20:2", &error_msg));
+  EXPECT_FALSE(RosAlloc::ConfigureSizeBrackets(kCutoff, "4096:2", &error_msg));
+  // Run sizes out of range.
+  EXPECT_FALSE(RosAlloc::ConfigureSizeBrackets(kCutoff, "16:0", &error_msg));
+  EXPECT_FALSE(RosAlloc::ConfigureSizeBrackets(kCutoff, "16:17", &error_msg));
+  EXPECT_NE(std::string::npos, error_msg.find("between 1 and 16")) << error_msg;
+  // Thread-local bracket cutoffs that are not bracket sizes, lower than the default or larger
+  // than Thread has room for.
+  EXPECT_FALSE(RosAlloc::ConfigureSizeBrackets(136, "", &error_msg));
+  EXPECT_FALSE(RosAlloc::ConfigureSizeBrackets(120, "", &error_msg));
+  EXPECT_FALSE(RosAlloc::ConfigureSizeBrackets(272, "", &error_msg));
+  EXPECT_NE(std::string::npos, error_msg.find("between 128 and 256")) << error_msg;
+}
+
+class RosAllocDefragmentationTest : public RosAllocTest {
+ protected:
+  // Calls Heap::ShouldDefragmentMainSpace() as if the last defragmentation was `last_time`.
+  static bool ShouldDefragmentMainSpace(size_t run_bytes,
+                                        size_t free_run_bytes,
+                                        size_t large_object_bytes,
+                                        uint64_t last_time) {
+    Heap* heap = Runtime::Current()->GetHeap();
+    heap->last_time_defragmentation_ = last_time;
+    return heap->ShouldDefragmentMainSpace(
+        run_bytes, free_run_bytes, run_bytes - free_run_bytes + large_object_bytes);
+  }
+};
+
+TEST_F(RosAllocDefragmentationTest, EstimateFragmentation) {
+  // Enough allocations for the free slots of a quarter of them to pass the 8 MB defragmentation
+  // threshold.
+  static constexpr size_t kNumAllocations = 12 * KB;
+  static constexpr size_t kSize = 1 * KB;
+
+  Thread* self = Thread::Current();
+  std::unique_ptr<space::RosAllocSpace> space(space::RosAllocSpace::Create("test rosalloc space",
+                                                                           32 * MB,
+                                                                           32 * MB,
+                                                                           32 * MB,
+                                                                           nullptr,
+                                                                           false,
+                                                                           false));
+  ASSERT_TRUE(space != nullptr);
+  RosAlloc* rosalloc = space->GetRosAlloc();
+  Runtime::Current()->GetHeap()->RevokeThreadLocalBuffers(self);
+
+  auto alloc = [self, rosalloc](size_t size) {
+    size_t bytes_allocated;
+    size_t usable_size;
+    size_t bytes_tl_bulk_allocated;
+    return rosalloc->Alloc(self, size, &bytes_allocated, &usable_size, &bytes_tl_bulk_allocated);
+  };
+  size_t run_bytes;
+  size_t free_run_bytes;
+  size_t large_object_bytes;
+  rosalloc->EstimateFragmentation(&run_bytes, &free_run_bytes, &large_object_bytes);
+  EXPECT_EQ(0u, run_bytes);
+  EXPECT_EQ(0u, free_run_bytes);
+  EXPECT_EQ(0u, large_object_bytes);
+
+  // Fill shared runs.
+  std::vector<void*> ptrs;
+  for (size_t i = 0; i < kNumAllocations; ++i) {
+    ptrs.push_back(alloc(kSize));
+    ASSERT_TRUE(ptrs.back() != nullptr) << i;
+  }
+  void* large = alloc(4 * kPageSize);
+  ASSERT_TRUE(large != nullptr);
+  size_t full_run_bytes;
+  size_t full_free_run_bytes;
+  rosalloc->EstimateFragmentation(&full_run_bytes, &full_free_run_bytes, &large_object_bytes);
+  EXPECT_GE(full_run_bytes, kNumAllocations * kSize);
+  EXPECT_EQ(0u, full_run_bytes % kPageSize);
+  EXPECT_EQ(4 * kPageSize, large_object_bytes);
+
+  // A run that belongs to a thread is left out.
+  void* small = alloc(16);
+  ASSERT_TRUE(small != nullptr);
+  rosalloc->EstimateFragmentation(&run_bytes, &free_run_bytes, &large_object_bytes);
+  EXPECT_EQ(full_run_bytes, run_bytes);
+  EXPECT_EQ(full_free_run_bytes, free_run_bytes);
+  rosalloc->RevokeThreadLocalRuns(self);
+  rosalloc->EstimateFragmentation(&run_bytes, &free_run_bytes, &large_object_bytes);
+  EXPECT_GT(run_bytes, full_run_bytes);
+  EXPECT_GT(free_run_bytes, full_free_run_bytes);
+  rosalloc->Free(self, small);
+  rosalloc->EstimateFragmentation(&run_bytes, &free_run_bytes, &large_object_bytes);
+  EXPECT_EQ(full_run_bytes, run_bytes);
+  EXPECT_EQ(full_free_run_bytes, free_run_bytes);
+
+  // The compaction is not worth it while the runs are full.
+  Runtime::Current()->GetHeap()->SetDefragmentationMaxPause(MsToNs(1000));
+  EXPECT_FALSE(ShouldDefragmentMainSpace(run_bytes, free_run_bytes, large_object_bytes, 0u));
+
+  // Free three slots out of four, which leaves live slots in all the full runs.
+  size_t freed_bytes = 0;
+  for (size_t i = 0; i < kNumAllocations; ++i) {
+    if (i % 4 != 0) {
+      freed_bytes += rosalloc->Free(self, ptrs[i]);
+      ptrs[i] = nullptr;
+    }
+  }
+  rosalloc->EstimateFragmentation(&run_bytes, &free_run_bytes, &large_object_bytes);
+  EXPECT_EQ(full_run_bytes, run_bytes);
+  EXPECT_EQ(full_free_run_bytes + freed_bytes, free_run_bytes);
+  EXPECT_EQ(4 * kPageSize, large_object_bytes);
+
+  // Now the runs are fragmented enough, unless the last defragmentation was too recent or the
+  // live objects take too long to copy.
+  EXPECT_TRUE(ShouldDefragmentMainSpace(run_bytes, free_run_bytes, large_object_bytes, 0u));
+  EXPECT_FALSE(
+      ShouldDefragmentMainSpace(run_bytes, free_run_bytes, large_object_bytes, NanoTime()));
+  Runtime::Current()->GetHeap()->SetDefragmentationMaxPause(1u);
+  EXPECT_FALSE(ShouldDefragmentMainSpace(run_bytes, free_run_bytes, large_object_bytes, 0u));
+  Runtime::Current()->GetHeap()->SetDefragmentationMaxPause(0u);
+  EXPECT_FALSE(ShouldDefragmentMainSpace(run_bytes, free_run_bytes, large_object_bytes, 0u));
+
+  rosalloc->Free(self, large);
+  for (void* ptr : ptrs) {
+    if (ptr != nullptr) {
+      rosalloc->Free(self, ptr);
+    }
+  }
+}
+
+// The runtime of this test uses thread-local runs up to 256 bytes.
+class RosAllocThreadLocalCutoffTest : public RosAllocTest {
+ protected:
+  void SetUpRuntimeOptions(RuntimeOptions* options) OVERRIDE {
+    RosAllocTest::SetUpRuntimeOptions(options);
+    options->push_back(std::make_pair("-XX:RosAllocMaxThreadLocalBracketSize=256", nullptr));
+  }
+};
+
+TEST_F(RosAllocThreadLocalCutoffTest, RaisedCutoff) {
+  Thread* self = Thread::Current();
+  std::unique_ptr<space::RosAllocSpace> space(space::RosAllocSpace::Create("test rosalloc space",
+                                                                           4 * MB,
+                                                                           16 * MB,
+                                                                           16 * MB,
+                                                                           nullptr,
+                                                                           false,
+                                                                           false));
+  ASSERT_TRUE(space != nullptr);
+  RosAlloc* rosalloc = space->GetRosAlloc();
+  Runtime::Current()->GetHeap()->RevokeThreadLocalBuffers(self);
+
+  std::vector<void*> ptrs;
+  for (size_t size : { 200u, 200u, 256u, 272u, 272u }) {
+    size_t bytes_allocated;
+    size_t usable_size;
+    size_t bytes_tl_bulk_allocated;
+    ptrs.push_back(
+        rosalloc->Alloc(self, size, &bytes_allocated, &usable_size, &bytes_tl_bulk_allocated));
+    ASSERT_TRUE(ptrs.back() != nullptr) << size;
+  }
+  // The allocations up to 256 bytes use thread-local runs, the larger ones shared runs.
+  std::ostringstream os;
+  rosalloc->DumpBracketHistogram(os);
+  const std::string dump = os.str();
+  EXPECT_NE(std::string::npos, dump.find("(thread-local up to 256 bytes)")) << dump;
+  EXPECT_NE(std::string::npos, FindLine(dump, "(208):").find("#thread_local_refills=1 "))
+      << dump;
+  EXPECT_NE(std::string::npos, FindLine(dump, "(256):").find("#thread_local_refills=1 "))
+      << dump;
+  EXPECT_NE(std::string::npos, FindLine(dump, "(272):").find("#shared_allocs=2")) << dump;
+
+  for (void* ptr : ptrs) {
+    rosalloc->Free(self, ptr);
+  }
+  rosalloc->RevokeThreadLocalRuns(self);
+}
+
+}  // namespace allocator
+}  // namespace gc
+}  // namespace art
@@ -19,10 +19,12 @@
 #include "art_field-inl.h"
 #include "base/stl_util.h"
 #include "debugger.h"
+#include "gc/accounting/card_table-inl.h"
 #include "gc/accounting/heap_bitmap-inl.h"
 #include "gc/accounting/space_bitmap-inl.h"
 #include "gc/reference_processor.h"
 #include "gc/space/image_space.h"
+#include "gc/space/region_space-inl.h"
 #include "gc/space/space-inl.h"
 #include "image-inl.h"
 #include "intern_table.h"
@@ -31,6 +33,7 @@
 #include "scoped_thread_state_change.h"
 #include "thread-inl.h"
 #include "thread_list.h"
+#include "thread_pool.h"
 #include "well_known_classes.h"
 
 namespace art {
@@ -39,7 +42,7 @@ namespace collector {
 
 static constexpr size_t kDefaultGcMarkStackSize = 2 * MB;
 
-ConcurrentCopying::ConcurrentCopying(Heap* heap, const std::string& name_prefix)
+ConcurrentCopying::ConcurrentCopying(Heap* heap, bool young_gen, const std::string& name_prefix)
     : GarbageCollector(heap,
                        name_prefix + (name_prefix.empty() ? "" : " ") +
                        "concurrent copying + mark sweep"),
@@ -50,11 +53,14 @@ ConcurrentCopying::ConcurrentCopying(Heap* heap, const std::string& name_prefix)
       mark_stack_lock_("concurrent copying mark stack lock", kMarkSweepMarkStackLock),
       thread_running_gc_(nullptr),
       is_marking_(false), is_active_(false), is_asserting_to_space_invariant_(false),
-      heap_mark_bitmap_(nullptr), live_stack_freeze_size_(0), mark_stack_mode_(kMarkStackModeOff),
+      heap_mark_bitmap_(nullptr), heap_live_bitmap_(nullptr), live_stack_freeze_size_(0),
+      mark_stack_mode_(kMarkStackModeOff),
       weak_ref_access_enabled_(true),
       skipped_blocks_lock_("concurrent copying bytes blocks lock", kMarkSweepMarkStackLock),
       rb_table_(heap_->GetReadBarrierTable()),
-      force_evacuate_all_(false) {
+      force_evacuate_all_(false),
+      young_gen_(young_gen) {
+  CHECK(!young_gen_ || kEnableGenerationalMode);
   static_assert(space::RegionSpace::kRegionSize == accounting::ReadBarrierTable::kRegionSize,
                 "The region space size and the read barrier table region size must match");
   cc_heap_bitmap_.reset(new accounting::HeapBitmap(heap));
@@ -66,6 +72,7 @@ ConcurrentCopying::ConcurrentCopying(Heap* heap, const std::string& name_prefix)
     // when GC causes a RB while doing GC or a lock order violation
     // (class_linker_lock_ and heap_bitmap_lock_).
     heap_mark_bitmap_ = heap->GetMarkBitmap();
+    heap_live_bitmap_ = heap->GetLiveBitmap();
   }
   {
     MutexLock mu(self, mark_stack_lock_);
@@ -147,12 +154,9 @@ void ConcurrentCopying::BindBitmaps() {
       cc_heap_bitmap_->AddContinuousSpaceBitmap(bitmap);
       cc_bitmaps_.push_back(bitmap);
     } else if (space == region_space_) {
-      accounting::ContinuousSpaceBitmap* bitmap =
-          accounting::ContinuousSpaceBitmap::Create("cc region space bitmap",
-                                                    space->Begin(), space->Capacity());
-      cc_heap_bitmap_->AddContinuousSpaceBitmap(bitmap);
-      cc_bitmaps_.push_back(bitmap);
-      region_space_bitmap_ = bitmap;
+      // Owned by the region space, which keeps the marks after the collection.
+      region_space_bitmap_ = region_space_->GetRegionMarkBitmap();
+      cc_heap_bitmap_->AddContinuousSpaceBitmap(region_space_bitmap_);
     }
   }
 }
@@ -168,9 +172,10 @@ void ConcurrentCopying::InitializePhase() {
   immune_spaces_.Reset();
   bytes_moved_.StoreRelaxed(0);
   objects_moved_.StoreRelaxed(0);
-  if (GetCurrentIteration()->GetGcCause() == kGcCauseExplicit ||
-      GetCurrentIteration()->GetGcCause() == kGcCauseForNativeAlloc ||
-      GetCurrentIteration()->GetClearSoftReferences()) {
+  if (!young_gen_ &&
+      (GetCurrentIteration()->GetGcCause() == kGcCauseExplicit ||
+       GetCurrentIteration()->GetGcCause() == kGcCauseForNativeAlloc ||
+       GetCurrentIteration()->GetClearSoftReferences())) {
     force_evacuate_all_ = true;
   } else {
     force_evacuate_all_ = false;
@@ -238,15 +243,28 @@ class ConcurrentCopying::FlipCallback : public Closure {
     Thread* self = Thread::Current();
     CHECK(thread == self);
     Locks::mutator_lock_->AssertExclusiveHeld(self);
-    cc->region_space_->SetFromSpace(cc->rb_table_, cc->force_evacuate_all_);
+    cc->region_space_->SetFromSpace(cc->rb_table_, cc->force_evacuate_all_, cc->young_gen_);
     cc->SwapStacks();
     if (ConcurrentCopying::kEnableFromSpaceAccountingCheck) {
       cc->RecordLiveStackFreezeSize(self);
-      cc->from_space_num_objects_at_first_pause_ = cc->region_space_->GetObjectsAllocated();
-      cc->from_space_num_bytes_at_first_pause_ = cc->region_space_->GetBytesAllocated();
+      if (cc->young_gen_) {
+        // The old regions stay in the to-space.
+        cc->from_space_num_objects_at_first_pause_ =
+            cc->region_space_->GetObjectsAllocatedInFromSpace();
+        cc->from_space_num_bytes_at_first_pause_ =
+            cc->region_space_->GetBytesAllocatedInFromSpace();
+      } else {
+        cc->from_space_num_objects_at_first_pause_ = cc->region_space_->GetObjectsAllocated();
+        cc->from_space_num_bytes_at_first_pause_ = cc->region_space_->GetBytesAllocated();
+      }
     }
     cc->is_marking_ = true;
     cc->mark_stack_mode_.StoreRelaxed(ConcurrentCopying::kMarkStackModeThreadLocal);
+    if (cc->young_gen_) {
+      cc->GrayDirtyOldObjects();
+    } else if (kEnableGenerationalMode) {
+      cc->ClearCards();
+    }
     if (UNLIKELY(Runtime::Current()->IsActiveTransaction())) {
       CHECK(Runtime::Current()->IsAotCompiler());
       TimingLogger::ScopedTiming split2("(Paused)VisitTransactionRoots", cc->GetTimings());
@@ -296,6 +314,74 @@ void ConcurrentCopying::RecordLiveStackFreezeSize(Thread* self) {
   live_stack_freeze_size_ = heap_->GetLiveStack()->Size();
 }
 
+// Used to gray the old objects on dirty cards in a young collection.
+class ConcurrentCopying::GrayDirtyOldObjectVisitor {
+ public:
+  explicit GrayDirtyOldObjectVisitor(ConcurrentCopying* cc) : collector_(cc) {}
+
+  void operator()(mirror::Object* obj) const REQUIRES(Locks::mutator_lock_) {
+    DCHECK(obj != nullptr);
+    DCHECK(!collector_->region_space_->IsInFromSpace(obj));
+    if (!collector_->region_space_->HasAddress(obj)) {
+      // Mark the object so that ClearBlackPtrs() turns it back to white.
+      accounting::ContinuousSpaceBitmap* bitmap = collector_->immune_spaces_.ContainsObject(obj)
+          ? collector_->cc_heap_bitmap_->GetContinuousSpaceBitmap(obj)
+          : collector_->heap_mark_bitmap_->GetContinuousSpaceBitmap(obj);
+      DCHECK(bitmap != nullptr) << obj;
+      if (bitmap->AtomicTestAndSet(obj)) {
+        // Already marked.
+        return;
+      }
+    }
+    // Until it is scanned, a gray object makes the mutators mark the refs they load from it.
+    if (kUseBakerReadBarrier) {
+      bool success = obj->AtomicSetReadBarrierPointer(ReadBarrier::WhitePtr(),
+                                                      ReadBarrier::GrayPtr());
+      DCHECK(success) << obj << " " << obj->GetReadBarrierPointer();
+    }
+    collector_->PushOntoMarkStack(obj);
+  }
+
+ private:
+  ConcurrentCopying* const collector_;
+};
+
+// In a young collection, the old objects are not traced. The mutators only reach young objects
+// through old objects they stored the references into since the last collection, which dirtied
+// the cards of those objects.
+void ConcurrentCopying::GrayDirtyOldObjects() {
+  TimingLogger::ScopedTiming split("(Paused)GrayDirtyOldObjects", GetTimings());
+  DCHECK(young_gen_);
+  accounting::CardTable* const card_table = heap_->GetCardTable();
+  GrayDirtyOldObjectVisitor visitor(this);
+  region_space_->ScanAndClearCards(card_table, visitor, accounting::CardTable::kCardDirty);
+  ReaderMutexLock mu(Thread::Current(), *Locks::heap_bitmap_lock_);
+  for (space::ContinuousSpace* space : heap_->GetContinuousSpaces()) {
+    if (space == region_space_) {
+      continue;
+    }
+    // The objects allocated since the last collection are on the live stack rather than in the
+    // live bitmap. They are young and traced from the roots if they are reachable.
+    card_table->Scan<true>(space->GetLiveBitmap(), space->Begin(), space->End(), visitor);
+  }
+}
+
+// All the objects that survive a full collection are old, so the next young collection only
+// needs the cards dirtied from now on.
+void ConcurrentCopying::ClearCards() {
+  TimingLogger::ScopedTiming split("(Paused)ClearCards", GetTimings());
+  DCHECK(!young_gen_);
+  accounting::CardTable* const card_table = heap_->GetCardTable();
+  // No region is in the to-space at this point, so this only clears the cards.
+  region_space_->ScanAndClearCards(card_table, VoidFunctor(), accounting::CardTable::kCardDirty);
+  for (space::ContinuousSpace* space : heap_->GetContinuousSpaces()) {
+    if (space != region_space_) {
+      card_table->ClearCardRange(space->Begin(),
+                                 AlignUp(space->End(), accounting::CardTable::kCardSize));
+    }
+  }
+}
+
 // Used to visit objects in the immune spaces.
 class ConcurrentCopying::ImmuneSpaceObjVisitor {
  public:
@@ -386,9 +472,13 @@ void ConcurrentCopying::MarkingPhase() {
     Runtime::Current()->VisitNonThreadRoots(this);
   }
 
-  // Immune spaces.
+  // Immune spaces. A young collection only scans the immune objects on dirty cards, which
+  // GrayDirtyOldObjects() pushed in the flip pause.
   for (auto& space : immune_spaces_.GetSpaces()) {
     DCHECK(space->IsImageSpace() || space->IsZygoteSpace());
+    if (young_gen_) {
+      break;
+    }
     accounting::ContinuousSpaceBitmap* live_bitmap = space->GetLiveBitmap();
     ImmuneSpaceObjVisitor visitor(this);
     live_bitmap->VisitMarkedRange(reinterpret_cast<uintptr_t>(space->Begin()),
@@ -676,7 +766,7 @@ class ConcurrentCopying::VerifyNoFromSpaceRefsVisitor : public SingleRootVisitor
       } else {
         CHECK(ref->GetReadBarrierPointer() == ReadBarrier::BlackPtr() ||
               (ref->GetReadBarrierPointer() == ReadBarrier::WhitePtr() &&
-               collector_->IsOnAllocStack(ref)))
+               (collector_->IsOnAllocStack(ref) || collector_->IsOldNonMovingObject(ref))))
             << "Non-moving/unevac from space ref " << ref << " " << PrettyTypeOf(ref)
             << " has non-black rb_ptr " << ref->GetReadBarrierPointer()
             << " but isn't on the alloc stack (and has white rb_ptr)."
@@ -754,7 +844,7 @@ class ConcurrentCopying::VerifyNoFromSpaceRefsObjectVisitor {
       } else {
         CHECK(obj->GetReadBarrierPointer() == ReadBarrier::BlackPtr() ||
               (obj->GetReadBarrierPointer() == ReadBarrier::WhitePtr() &&
-               collector->IsOnAllocStack(obj)))
+               (collector->IsOnAllocStack(obj) || collector->IsOldNonMovingObject(obj))))
             << "Non-moving space/unevac from space ref " << obj << " " << PrettyTypeOf(obj)
             << " has non-black rb_ptr " << obj->GetReadBarrierPointer()
             << " but isn't on the alloc stack (and has white rb_ptr). Is it in the non-moving space="
@@ -973,6 +1063,10 @@ bool ConcurrentCopying::ProcessMarkStackOnce() {
   size_t count = 0;
   MarkStackMode mark_stack_mode = mark_stack_mode_.LoadRelaxed();
   if (mark_stack_mode == kMarkStackModeThreadLocal) {
+    size_t thread_count = GetMarkingThreadCount();
+    if (thread_count > 1) {
+      count += ProcessMarkStacksParallel(thread_count);
+    }
     // Process the thread-local mark stacks and the GC mark stack.
     count += ProcessThreadLocalMarkStacks(false);
     while (!gc_mark_stack_->IsEmpty()) {
@@ -1043,21 +1137,155 @@ size_t ConcurrentCopying::ProcessThreadLocalMarkStacks(bool disable_weak_ref_acc
       ProcessMarkStackRef(to_ref);
       ++count;
     }
+    RecycleMarkStack(Thread::Current(), mark_stack);
+  }
+  return count;
+}
+
+void ConcurrentCopying::RecycleMarkStack(Thread* self, accounting::ObjectStack* mark_stack) {
+  MutexLock mu(self, mark_stack_lock_);
+  if (pooled_mark_stacks_.size() >= kMarkStackPoolSize) {
+    // The pool has enough. Delete it.
+    delete mark_stack;
+  } else {
+    // Otherwise, put it into the pool for later reuse.
+    mark_stack->Reset();
+    pooled_mark_stacks_.push_back(mark_stack);
+  }
+}
+
+size_t ConcurrentCopying::GetMarkingThreadCount() const {
+  // Like the concurrent phases of mark sweep, leave the other cores to the foreground apps
+  // when in the background.
+  if (heap_->GetThreadPool() == nullptr || !Runtime::Current()->InJankPerceptibleProcessState()) {
+    return 1;
+  }
+  return heap_->GetConcGCThreadCount() + 1;
+}
+
+// Processes a chunk of the collected mark stacks, then whatever the processing pushed onto the
+// mark stack of the thread running the task. Copying and marking are already safe to run
+// concurrently with the mutators, which mark through the read barrier, so they are safe to run
+// on several GC threads as well.
+class ConcurrentCopying::ProcessMarkStackTask : public Task {
+ public:
+  ProcessMarkStackTask(ConcurrentCopying* collector,
+                       std::vector<mirror::Object*>&& refs,
+                       Atomic<size_t>* processed_count)
+      : collector_(collector), refs_(std::move(refs)), processed_count_(processed_count) {}
+
+  void Run(Thread* self) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    // The GC-running thread holds the mutator lock on behalf of the pool workers.
+    for (mirror::Object* ref : refs_) {
+      collector_->ProcessMarkStackRef(ref);
+    }
+    size_t count = refs_.size() + collector_->DrainMarkStacks(self);
+    processed_count_->FetchAndAddSequentiallyConsistent(count);
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  ConcurrentCopying* const collector_;
+  const std::vector<mirror::Object*> refs_;
+  Atomic<size_t>* const processed_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(ProcessMarkStackTask);
+};
+
+size_t ConcurrentCopying::DrainMarkStacks(Thread* self) {
+  size_t count = 0;
+  while (true) {
+    if (self == thread_running_gc_) {
+      // The GC-running thread pushes onto the GC mark stack, which no other thread accesses
+      // in the thread-local mark stack mode.
+      while (!gc_mark_stack_->IsEmpty()) {
+        ProcessMarkStackRef(gc_mark_stack_->PopBack());
+        ++count;
+      }
+    } else {
+      // Processing a ref may push onto the thread-local mark stack, or replace it by a new
+      // one when it is full, so look it up on each iteration.
+      accounting::ObjectStack* tl_mark_stack;
+      while ((tl_mark_stack = self->GetThreadLocalMarkStack()) != nullptr &&
+             !tl_mark_stack->IsEmpty()) {
+        ProcessMarkStackRef(tl_mark_stack->PopBack());
+        ++count;
+      }
+    }
+    // Help with the full mark stacks revoked by other threads.
+    accounting::ObjectStack* revoked_mark_stack;
     {
-      MutexLock mu(Thread::Current(), mark_stack_lock_);
-      if (pooled_mark_stacks_.size() >= kMarkStackPoolSize) {
-        // The pool has enough. Delete it.
-        delete mark_stack;
-      } else {
-        // Otherwise, put it into the pool for later reuse.
-        mark_stack->Reset();
-        pooled_mark_stacks_.push_back(mark_stack);
+      MutexLock mu(self, mark_stack_lock_);
+      if (revoked_mark_stacks_.empty()) {
+        break;
       }
+      revoked_mark_stack = revoked_mark_stacks_.back();
+      revoked_mark_stacks_.pop_back();
     }
+    for (StackReference<mirror::Object>* p = revoked_mark_stack->Begin();
+         p != revoked_mark_stack->End();
+         ++p) {
+      ProcessMarkStackRef(p->AsMirrorPtr());
+      ++count;
+    }
+    RecycleMarkStack(self, revoked_mark_stack);
   }
   return count;
 }
 
+size_t ConcurrentCopying::ProcessMarkStacksParallel(size_t thread_count) {
+  Thread* self = Thread::Current();
+  DCHECK_EQ(self, thread_running_gc_);
+  // Collect the refs of the mutators and of the GC mark stack.
+  RevokeThreadLocalMarkStacks(false);
+  std::vector<accounting::ObjectStack*> mark_stacks;
+  {
+    MutexLock mu(self, mark_stack_lock_);
+    mark_stacks.swap(revoked_mark_stacks_);
+  }
+  std::vector<mirror::Object*> refs;
+  for (accounting::ObjectStack* mark_stack : mark_stacks) {
+    for (StackReference<mirror::Object>* p = mark_stack->Begin(); p != mark_stack->End(); ++p) {
+      refs.push_back(p->AsMirrorPtr());
+    }
+    RecycleMarkStack(self, mark_stack);
+  }
+  for (StackReference<mirror::Object>* p = gc_mark_stack_->Begin();
+       p != gc_mark_stack_->End();
+       ++p) {
+    refs.push_back(p->AsMirrorPtr());
+  }
+  gc_mark_stack_->Reset();
+  if (refs.size() < kMinimumParallelMarkStackSize) {
+    // Not worth waking up the workers.
+    for (mirror::Object* ref : refs) {
+      ProcessMarkStackRef(ref);
+    }
+    return refs.size();
+  }
+
+  TimingLogger::ScopedTiming split("ProcessMarkStacksParallel", GetTimings());
+  ThreadPool* thread_pool = heap_->GetThreadPool();
+  Atomic<size_t> processed_count(0);
+  const size_t chunk_size =
+      std::min(refs.size() / thread_count + 1, kMaxParallelMarkStackChunkSize);
+  for (size_t begin = 0; begin < refs.size(); begin += chunk_size) {
+    size_t end = std::min(begin + chunk_size, refs.size());
+    std::vector<mirror::Object*> chunk(refs.begin() + begin, refs.begin() + end);
+    thread_pool->AddTask(self, new ProcessMarkStackTask(this, std::move(chunk), &processed_count));
+  }
+  thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, /* do_work */ true, /* may_hold_locks */ true);
+  thread_pool->StopWorkers(self);
+  // The refs the workers pushed onto their thread-local mark stacks after their last
+  // drain are collected by the next ProcessThreadLocalMarkStacks().
+  return processed_count.LoadSequentiallyConsistent();
+}
+
 inline void ConcurrentCopying::ProcessMarkStackRef(mirror::Object* to_ref) {
   DCHECK(!region_space_->IsInFromSpace(to_ref));
   if (kUseBakerReadBarrier) {
@@ -1224,6 +1452,56 @@ void ConcurrentCopying::SweepLargeObjects(bool swap_bitmaps) {
   RecordFreeLOS(heap_->GetLargeObjectsSpace()->Sweep(swap_bitmaps));
 }
 
+void ConcurrentCopying::SweepLiveStack() {
+  TimingLogger::ScopedTiming split("SweepLiveStack", GetTimings());
+  DCHECK(young_gen_);
+  Thread* self = Thread::Current();
+  accounting::ObjectStack* live_stack = heap_->GetLiveStack();
+  if (kEnableFromSpaceAccountingCheck) {
+    CHECK_GE(live_stack_freeze_size_, live_stack->Size());
+  }
+  space::MallocSpace* non_moving_space = heap_->GetNonMovingSpace();
+  space::LargeObjectSpace* large_object_space = heap_->GetLargeObjectsSpace();
+  std::vector<mirror::Object*> dead_objects;
+  std::vector<mirror::Object*> dead_large_objects;
+  for (StackReference<mirror::Object>* it = live_stack->Begin(); it != live_stack->End(); ++it) {
+    mirror::Object* obj = it->AsMirrorPtr();
+    if (obj == nullptr) {
+      continue;
+    }
+    if (non_moving_space->HasAddress(obj)) {
+      if (non_moving_space->GetMarkBitmap()->Test(obj)) {
+        non_moving_space->GetLiveBitmap()->Set(obj);
+      } else {
+        dead_objects.push_back(obj);
+      }
+    } else if (large_object_space != nullptr && large_object_space->Contains(obj)) {
+      if (large_object_space->GetMarkBitmap()->Test(obj)) {
+        large_object_space->GetLiveBitmap()->Set(obj);
+      } else {
+        dead_large_objects.push_back(obj);
+      }
+    } else {
+      // Not in a space the young collection frees objects from.
+      accounting::ContinuousSpaceBitmap* live_bitmap =
+          heap_live_bitmap_->GetContinuousSpaceBitmap(obj);
+      CHECK(live_bitmap != nullptr) << obj;
+      live_bitmap->Set(obj);
+    }
+  }
+  live_stack->Reset();
+  if (!dead_objects.empty()) {
+    size_t freed_bytes = non_moving_space->FreeList(self, dead_objects.size(), dead_objects.data());
+    RecordFree(ObjectBytePair(dead_objects.size(), freed_bytes));
+  }
+  if (!dead_large_objects.empty()) {
+    size_t freed_bytes = large_object_space->FreeList(self,
+                                                      dead_large_objects.size(),
+                                                      dead_large_objects.data());
+    RecordFreeLOS(ObjectBytePair(dead_large_objects.size(), freed_bytes));
+  }
+}
+
 class ConcurrentCopying::ClearBlackPtrsVisitor {
  public:
   explicit ClearBlackPtrsVisitor(ConcurrentCopying* cc) : collector_(cc) {}
@@ -1250,6 +1528,11 @@ void ConcurrentCopying::ClearBlackPtrs() {
       continue;
     }
     accounting::ContinuousSpaceBitmap* mark_bitmap = space->GetMarkBitmap();
+    if (young_gen_ && immune_spaces_.ContainsSpace(space)) {
+      // Only the immune objects on dirty cards were marked through.
+      mark_bitmap = cc_heap_bitmap_->GetContinuousSpaceBitmap(
+          reinterpret_cast<mirror::Object*>(space->Begin()));
+    }
     if (kVerboseMode) {
       LOG(INFO) << "ClearBlackPtrs: " << *space << " bitmap: " << *mark_bitmap;
     }
@@ -1334,7 +1617,9 @@ void ConcurrentCopying::ReclaimPhase() {
     }
   }
 
-  {
+  if (!young_gen_) {
+    // A young collection leaves no region unevacuated, and the marks of the regions kept by the
+    // last full collection must not count again.
     TimingLogger::ScopedTiming split3("ComputeUnevacFromSpaceLiveRatio", GetTimings());
     ComputeUnevacFromSpaceLiveRatio();
   }
@@ -1349,8 +1634,12 @@ void ConcurrentCopying::ReclaimPhase() {
     if (kUseBakerReadBarrier) {
       ClearBlackPtrs();
     }
-    Sweep(false);
-    SwapBitmaps();
+    if (young_gen_) {
+      SweepLiveStack();
+    } else {
+      Sweep(false);
+      SwapBitmaps();
+    }
     heap_->UnBindBitmaps();
 
     // Remove bitmaps for the immune spaces.
@@ -1360,6 +1649,7 @@ void ConcurrentCopying::ReclaimPhase() {
       delete cc_bitmap;
       cc_bitmaps_.pop_back();
     }
+    cc_heap_bitmap_->RemoveContinuousSpaceBitmap(region_space_bitmap_);
     region_space_bitmap_ = nullptr;
   }
 
@@ -1546,6 +1836,10 @@ void ConcurrentCopying::LogFromSpaceRefHolder(mirror::Object* obj, MemberOffset
 void ConcurrentCopying::AssertToSpaceInvariantInNonMovingSpace(mirror::Object* obj,
                                                                mirror::Object* ref) {
   // In a non-moving spaces. Check that the ref is marked.
+  if (IsOldNonMovingObject(ref)) {
+    // Kept alive by a young collection without being marked.
+    return;
+  }
   if (immune_spaces_.ContainsObject(ref)) {
     accounting::ContinuousSpaceBitmap* cc_bitmap =
         cc_heap_bitmap_->GetContinuousSpaceBitmap(ref);
@@ -1933,7 +2227,10 @@ mirror::Object* ConcurrentCopying::IsMarked(mirror::Object* from_ref) {
     }
   } else {
     // from_ref is in a non-moving space.
-    if (immune_spaces_.ContainsObject(from_ref)) {
+    if (IsOldNonMovingObject(from_ref)) {
+      // Kept alive by a young collection.
+      to_ref = from_ref;
+    } else if (immune_spaces_.ContainsObject(from_ref)) {
       accounting::ContinuousSpaceBitmap* cc_bitmap =
           cc_heap_bitmap_->GetContinuousSpaceBitmap(from_ref);
       DCHECK(cc_bitmap != nullptr)
@@ -1984,9 +2281,31 @@ bool ConcurrentCopying::IsOnAllocStack(mirror::Object* ref) {
   return alloc_stack->Contains(ref);
 }
 
+bool ConcurrentCopying::IsOldNonMovingObject(mirror::Object* ref) {
+  DCHECK(!region_space_->HasAddress(ref)) << ref;
+  if (!young_gen_) {
+    return false;
+  }
+  if (immune_spaces_.ContainsObject(ref)) {
+    return true;
+  }
+  // Objects allocated since the last collection are on the live stack, not in the live bitmaps.
+  accounting::ContinuousSpaceBitmap* live_bitmap = heap_live_bitmap_->GetContinuousSpaceBitmap(ref);
+  if (live_bitmap != nullptr) {
+    return live_bitmap->Test(ref);
+  }
+  accounting::LargeObjectBitmap* los_bitmap = heap_live_bitmap_->GetLargeObjectBitmap(ref);
+  return los_bitmap != nullptr && los_bitmap->Test(ref);
+}
+
 mirror::Object* ConcurrentCopying::MarkNonMoving(mirror::Object* ref) {
   // ref is in a non-moving space (from_ref == to_ref).
   DCHECK(!region_space_->HasAddress(ref)) << ref;
+  if (IsOldNonMovingObject(ref)) {
+    // Not traced by a young collection. The old objects that may refer to the young generation
+    // were grayed in the flip pause.
+    return ref;
+  }
   if (immune_spaces_.ContainsObject(ref)) {
     accounting::ContinuousSpaceBitmap* cc_bitmap =
         cc_heap_bitmap_->GetContinuousSpaceBitmap(ref);
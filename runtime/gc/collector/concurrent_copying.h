@@ -58,8 +58,12 @@ class ConcurrentCopying : public GarbageCollector {
   static constexpr bool kEnableFromSpaceAccountingCheck = true;
   // Enable verbose mode.
   static constexpr bool kVerboseMode = false;
+  // Enable the young-generation collections, which only evacuate the regions allocated since the
+  // last collection and find the references from older objects with the card table. Graying the
+  // older objects on dirty cards requires the Baker read barrier.
+  static constexpr bool kEnableGenerationalMode = kUseBakerReadBarrier;
 
-  ConcurrentCopying(Heap* heap, const std::string& name_prefix = "");
+  ConcurrentCopying(Heap* heap, bool young_gen, const std::string& name_prefix = "");
   ~ConcurrentCopying();
 
   virtual void RunPhases() OVERRIDE REQUIRES(!mark_stack_lock_, !skipped_blocks_lock_);
@@ -72,11 +76,14 @@ class ConcurrentCopying : public GarbageCollector {
   void BindBitmaps() SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!Locks::heap_bitmap_lock_);
   virtual GcType GetGcType() const OVERRIDE {
-    return kGcTypePartial;
+    return young_gen_ ? kGcTypeSticky : kGcTypePartial;
   }
   virtual CollectorType GetCollectorType() const OVERRIDE {
     return kCollectorTypeCC;
   }
+  virtual uint64_t GetBytesMoved() const OVERRIDE {
+    return bytes_moved_.LoadRelaxed();
+  }
   virtual void RevokeAllThreadLocalBuffers() OVERRIDE;
   void SetRegionSpace(space::RegionSpace* region_space) {
     DCHECK(region_space != nullptr);
@@ -138,6 +145,19 @@ class ConcurrentCopying : public GarbageCollector {
       REQUIRES(!mark_stack_lock_);
   size_t ProcessThreadLocalMarkStacks(bool disable_weak_ref_access)
       SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_);
+  // Number of threads, including the GC-running thread, to process the mark stacks with.
+  size_t GetMarkingThreadCount() const;
+  // Collect the GC mark stack and the thread-local mark stacks and split them between
+  // `thread_count` threads of the heap thread pool. Return the number of refs processed.
+  size_t ProcessMarkStacksParallel(size_t thread_count)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_);
+  // Process the refs on the mark stack of `self`, and the full thread-local mark stacks other
+  // threads revoked, until both are empty. Return the number of refs processed.
+  size_t DrainMarkStacks(Thread* self)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_);
+  // Put a mark stack that has been processed back into the pool.
+  void RecycleMarkStack(Thread* self, accounting::ObjectStack* mark_stack)
+      REQUIRES(!mark_stack_lock_);
   void RevokeThreadLocalMarkStacks(bool disable_weak_ref_access)
       SHARED_REQUIRES(Locks::mutator_lock_);
   void SwitchToSharedMarkStackMode() SHARED_REQUIRES(Locks::mutator_lock_)
@@ -185,6 +205,19 @@ class ConcurrentCopying : public GarbageCollector {
   void ExpandGcMarkStack() SHARED_REQUIRES(Locks::mutator_lock_);
   mirror::Object* MarkNonMoving(mirror::Object* from_ref) SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!mark_stack_lock_, !skipped_blocks_lock_);
+  // Whether `ref`, outside of the region space, is an immune object or was allocated before the
+  // last collection. A young collection keeps those alive without tracing them.
+  bool IsOldNonMovingObject(mirror::Object* ref) SHARED_REQUIRES(Locks::mutator_lock_);
+  // Gray and push the old objects on dirty cards so that the references they hold to the young
+  // generation are marked, and clear the cards. Called in the flip pause of a young collection.
+  void GrayDirtyOldObjects() REQUIRES(Locks::mutator_lock_) REQUIRES(!mark_stack_lock_);
+  // Clear the cards the next young collection must not scan. Called in the flip pause of a full
+  // collection.
+  void ClearCards() REQUIRES(Locks::mutator_lock_);
+  // Free the objects allocated since the last collection outside of the region space that were
+  // not marked. Used by young collections instead of sweeping.
+  void SweepLiveStack()
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::heap_bitmap_lock_);
 
   space::RegionSpace* region_space_;      // The underlying region space.
   std::unique_ptr<Barrier> gc_barrier_;
@@ -194,6 +227,10 @@ class ConcurrentCopying : public GarbageCollector {
       GUARDED_BY(mark_stack_lock_);
   static constexpr size_t kMarkStackSize = kPageSize;
   static constexpr size_t kMarkStackPoolSize = 256;
+  // Minimum number of refs to process for the marking to be split between threads.
+  static constexpr size_t kMinimumParallelMarkStackSize = 1024;
+  // Maximum number of refs handed to a thread at once.
+  static constexpr size_t kMaxParallelMarkStackChunkSize = 4 * KB;
   std::vector<accounting::ObjectStack*> pooled_mark_stacks_
       GUARDED_BY(mark_stack_lock_);
   Thread* thread_running_gc_;
@@ -206,6 +243,8 @@ class ConcurrentCopying : public GarbageCollector {
   accounting::SpaceBitmap<kObjectAlignment>* region_space_bitmap_;
   // A cache of Heap::GetMarkBitmap().
   accounting::HeapBitmap* heap_mark_bitmap_;
+  // A cache of Heap::GetLiveBitmap().
+  accounting::HeapBitmap* heap_live_bitmap_;
   size_t live_stack_freeze_size_;
   size_t from_space_num_objects_at_first_pause_;
   size_t from_space_num_bytes_at_first_pause_;
@@ -236,6 +275,7 @@ class ConcurrentCopying : public GarbageCollector {
 
   accounting::ReadBarrierTable* rb_table_;
   bool force_evacuate_all_;  // True if all regions are evacuated.
+  const bool young_gen_;     // True if only the young generation is collected.
 
   class AssertToSpaceInvariantFieldVisitor;
   class AssertToSpaceInvariantObjectVisitor;
@@ -244,8 +284,10 @@ class ConcurrentCopying : public GarbageCollector {
   class ComputeUnevacFromSpaceLiveRatioVisitor;
   class DisableMarkingCheckpoint;
   class FlipCallback;
+  class GrayDirtyOldObjectVisitor;
   class ImmuneSpaceObjVisitor;
   class LostCopyVisitor;
+  class ProcessMarkStackTask;
   class RefFieldsVisitor;
   class RevokeThreadLocalMarkStackCheckpoint;
   class VerifyNoFromSpaceRefsFieldVisitor;
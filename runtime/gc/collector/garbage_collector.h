@@ -141,6 +141,10 @@ class GarbageCollector : public RootVisitor, public IsMarkedVisitor, public Mark
   }
   virtual GcType GetGcType() const = 0;
   virtual CollectorType GetCollectorType() const = 0;
+  // Returns how many bytes the last iteration copied, for the collectors that move objects.
+  virtual uint64_t GetBytesMoved() const {
+    return 0;
+  }
   // Run the garbage collector.
   void Run(GcCause gc_cause, bool clear_soft_references) REQUIRES(!pause_histogram_lock_);
   Heap* GetHeap() const {
@@ -36,6 +36,7 @@
 #include "gc/heap.h"
 #include "gc/reference_processor.h"
 #include "gc/space/large_object_space.h"
+#include "gc/space/rosalloc_space.h"
 #include "gc/space/space-inl.h"
 #include "mark_sweep-inl.h"
 #include "mirror/object-inl.h"
@@ -64,6 +65,13 @@ static constexpr bool kParallelRecursiveMark = true;
 static constexpr size_t kMinimumParallelMarkStackSize = 128;
 static constexpr bool kParallelProcessMarkStack = true;
 
+// Parallel sweeping constants.
+static constexpr bool kParallelSweep = true;
+// Number of ranges each space swept in parallel is split into, per thread, for load balancing.
+static constexpr size_t kSweepRangesPerThread = 4;
+// Minimum size of a range, to keep the per task overhead small.
+static constexpr size_t kMinSweepRangeSize = 1 * MB;
+
 // Profiling and information flags.
 static constexpr bool kProfileLargeObjects = false;
 static constexpr bool kMeasureOverhead = false;
@@ -1295,6 +1303,11 @@ void MarkSweep::Sweep(bool swap_bitmaps) {
     live_stack->Reset();
     DCHECK(mark_stack_->IsEmpty());
   }
+  const size_t thread_count = GetThreadCount(false);
+  if (kParallelSweep && thread_count > 1) {
+    SweepParallel(swap_bitmaps, thread_count);
+    return;
+  }
   for (const auto& space : GetHeap()->GetContinuousSpaces()) {
     if (space->IsContinuousMemMapAllocSpace()) {
       space::ContinuousMemMapAllocSpace* alloc_space = space->AsContinuousMemMapAllocSpace();
@@ -1315,6 +1328,109 @@ void MarkSweep::SweepLargeObjects(bool swap_bitmaps) {
   }
 }
 
+// A range of a RosAlloc space or of the large object space to sweep in parallel with the others.
+struct ParallelSweepRange {
+  space::Space* space;
+  uint8_t* begin;
+  uint8_t* end;
+};
+
+// Splits `space` into ranges ending at the boundaries the space can be split at for sweeping.
+template <typename SpaceType>
+static void AddSweepRanges(SpaceType* space,
+                           size_t num_ranges,
+                           std::vector<ParallelSweepRange>* ranges) {
+  uint8_t* const begin = space->Begin();
+  uint8_t* const end = space->End();
+  if (begin >= end) {
+    return;
+  }
+  const size_t range_size =
+      std::max(static_cast<size_t>(end - begin) / num_ranges, kMinSweepRangeSize);
+  for (uint8_t* range_begin = begin; range_begin < end; ) {
+    uint8_t* range_end = std::min(space->RoundUpToSweepBoundary(range_begin + range_size), end);
+    DCHECK_GT(range_end, range_begin);
+    ranges->push_back({space, range_begin, range_end});
+    range_begin = range_end;
+  }
+}
+
+class MarkSweep::SweepRangeTask : public Task {
+ public:
+  SweepRangeTask(const ParallelSweepRange& range,
+                 bool swap_bitmaps,
+                 Thread* gc_self,
+                 ObjectBytePair* freed)
+      : range_(range), swap_bitmaps_(swap_bitmaps), gc_self_(gc_self), freed_(freed) {}
+
+  // The GC thread holds the heap bitmap lock for the workers.
+  void Run(Thread* self) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    if (range_.space->IsLargeObjectSpace()) {
+      *freed_ = range_.space->AsLargeObjectSpace()->SweepRange(
+          swap_bitmaps_, range_.begin, range_.end, self, gc_self_);
+    } else {
+      *freed_ = range_.space->AsRosAllocSpace()->SweepRange(
+          swap_bitmaps_, range_.begin, range_.end, self, gc_self_);
+    }
+  }
+
+  void Finalize() OVERRIDE {
+    delete this;
+  }
+
+ private:
+  const ParallelSweepRange range_;
+  const bool swap_bitmaps_;
+  Thread* const gc_self_;
+  ObjectBytePair* const freed_;
+};
+
+void MarkSweep::SweepParallel(bool swap_bitmaps, size_t thread_count) {
+  TimingLogger::ScopedTiming t(__FUNCTION__, GetTimings());
+  Thread* self = Thread::Current();
+  ThreadPool* thread_pool = GetHeap()->GetThreadPool();
+  const size_t num_ranges_per_space = thread_count * kSweepRangesPerThread;
+  std::vector<ParallelSweepRange> ranges;
+  std::vector<space::ContinuousMemMapAllocSpace*> serial_spaces;
+  for (const auto& space : GetHeap()->GetContinuousSpaces()) {
+    if (!space->IsContinuousMemMapAllocSpace()) {
+      continue;
+    }
+    space::ContinuousMemMapAllocSpace* alloc_space = space->AsContinuousMemMapAllocSpace();
+    if (!alloc_space->IsRosAllocSpace()) {
+      serial_spaces.push_back(alloc_space);
+    } else if (alloc_space->GetLiveBitmap() != alloc_space->GetMarkBitmap()) {
+      AddSweepRanges(alloc_space->AsRosAllocSpace(), num_ranges_per_space, &ranges);
+    }
+  }
+  space::LargeObjectSpace* los = heap_->GetLargeObjectsSpace();
+  if (los != nullptr) {
+    AddSweepRanges(los, num_ranges_per_space, &ranges);
+  }
+  // Each task records what it freed in its own slot, added up once all the tasks are done.
+  std::vector<ObjectBytePair> freed(ranges.size());
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    thread_pool->AddTask(self, new SweepRangeTask(ranges[i], swap_bitmaps, self, &freed[i]));
+  }
+  thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool->StartWorkers(self);
+  for (space::ContinuousMemMapAllocSpace* alloc_space : serial_spaces) {
+    TimingLogger::ScopedTiming split(
+        alloc_space->IsZygoteSpace() ? "SweepZygoteSpace" : "SweepMallocSpace",
+        GetTimings());
+    RecordFree(alloc_space->Sweep(swap_bitmaps));
+  }
+  thread_pool->Wait(self, true, true);
+  thread_pool->StopWorkers(self);
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    if (ranges[i].space->IsLargeObjectSpace()) {
+      RecordFreeLOS(freed[i]);
+    } else {
+      RecordFree(freed[i]);
+    }
+  }
+}
+
 // Process the "referent" field in a java.lang.ref.Reference.  If the referent has not yet been
 // marked, put it on the appropriate list in the heap for later processing.
 void MarkSweep::DelayReferenceReferent(mirror::Class* klass, mirror::Reference* ref) {
@@ -79,6 +79,9 @@ class SemiSpace : public GarbageCollector {
   virtual CollectorType GetCollectorType() const OVERRIDE {
     return generational_ ? kCollectorTypeGSS : kCollectorTypeSS;
   }
+  virtual uint64_t GetBytesMoved() const OVERRIDE {
+    return bytes_moved_;
+  }
 
   // Sets which space we will be copying objects to.
   void SetToSpace(space::ContinuousMemMapAllocSpace* to_space);
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gc_record.h"
+
+#include <string.h>
+
+#include "base/logging.h"
+#include "base/stringprintf.h"
+#include "base/timing_logger.h"
+#include "base/unix_file/fd_file.h"
+#include "os.h"
+
+namespace art {
+namespace gc {
+
+void GcRecord::SetPhases(const TimingLogger& timings) {
+  num_phases = 0;
+  size_t depth = 0;
+  uint64_t phase_start = 0;
+  const char* phase_name = nullptr;
+  for (const TimingLogger::Timing& timing : timings.GetTimings()) {
+    if (timing.IsStartTiming()) {
+      if (depth++ == 0) {
+        phase_start = timing.GetTime();
+        phase_name = timing.GetName();
+      }
+    } else {
+      DCHECK_NE(depth, 0u);
+      if (--depth == 0) {
+        if (num_phases < kMaxPhases) {
+          Phase* phase = &phases[num_phases];
+          strncpy(phase->name, phase_name, kMaxPhaseNameLength - 1);
+          phase->name[kMaxPhaseNameLength - 1] = '\0';
+          phase->duration_ns = timing.GetTime() - phase_start;
+        }
+        ++num_phases;
+      }
+    }
+  }
+}
+
+GcRecordRing::GcRecordRing(size_t capacity)
+    : capacity_(capacity), slots_(new Slot[capacity]), num_recorded_(0u) {
+  CHECK_NE(capacity, 0u);
+  for (size_t i = 0; i < capacity; ++i) {
+    slots_[i].sequence.StoreRelaxed(0u);
+  }
+}
+
+void GcRecordRing::Append(const GcRecord& record) {
+  const uint64_t index = num_recorded_.LoadRelaxed();
+  Slot* slot = &slots_[index % capacity_];
+  // An odd sequence number tells the readers that the slot is being written.
+  slot->sequence.StoreRelaxed(2 * index + 1);
+  QuasiAtomic::ThreadFenceRelease();
+  memcpy(&slot->record, &record, sizeof(GcRecord));
+  slot->sequence.StoreRelease(2 * index + 2);
+  num_recorded_.StoreRelease(index + 1);
+}
+
+void GcRecordRing::GetRecords(std::vector<GcRecord>* records) const {
+  const uint64_t num_recorded = num_recorded_.LoadAcquire();
+  const uint64_t first = num_recorded > capacity_ ? num_recorded - capacity_ : 0u;
+  records->clear();
+  records->reserve(num_recorded - first);
+  for (uint64_t index = first; index < num_recorded; ++index) {
+    const Slot* slot = &slots_[index % capacity_];
+    const uint64_t sequence = slot->sequence.LoadAcquire();
+    if (sequence != 2 * index + 2) {
+      // Overwritten by a more recent record since we read num_recorded_.
+      continue;
+    }
+    GcRecord record;
+    memcpy(&record, &slot->record, sizeof(GcRecord));
+    QuasiAtomic::ThreadFenceAcquire();
+    if (slot->sequence.LoadRelaxed() == sequence) {
+      records->push_back(record);
+    }
+  }
+}
+
+bool GcRecordRing::WriteToFile(const std::string& filename, std::string* error_msg) const {
+  std::vector<GcRecord> records;
+  GetRecords(&records);
+  FileHeader header;
+  header.magic = FileHeader::kMagic;
+  header.version = FileHeader::kVersion;
+  header.record_size = sizeof(GcRecord);
+  header.num_records = records.size();
+  header.num_recorded = GetNumRecorded();
+  std::unique_ptr<File> file(OS::CreateEmptyFileWriteOnly(filename.c_str()));
+  if (file == nullptr) {
+    *error_msg = StringPrintf("Failed to create GC record file '%s': %s",
+                              filename.c_str(),
+                              strerror(errno));
+    return false;
+  }
+  if (!file->WriteFully(&header, sizeof(header)) ||
+      !file->WriteFully(records.data(), records.size() * sizeof(GcRecord))) {
+    *error_msg = StringPrintf("Failed to write GC record file '%s': %s",
+                              filename.c_str(),
+                              strerror(errno));
+    file->Erase();
+    return false;
+  }
+  if (file->FlushCloseOrErase() != 0) {
+    *error_msg = StringPrintf("Failed to flush GC record file '%s': %s",
+                              filename.c_str(),
+                              strerror(errno));
+    return false;
+  }
+  return true;
+}
+
+}  // namespace gc
+}  // namespace art
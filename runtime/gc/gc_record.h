@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_GC_GC_RECORD_H_
+#define ART_RUNTIME_GC_GC_RECORD_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "atomic.h"
+#include "base/macros.h"
+
+namespace art {
+
+class TimingLogger;
+
+namespace gc {
+
+// Summary of a GC cycle, kept for monitoring tools to correlate jank with GC. Records are fixed
+// size and trivially copyable, so that they can be copied out of the ring without locks and
+// written to files as is.
+struct GcRecord {
+  static constexpr size_t kMaxPauses = 4;
+  static constexpr size_t kMaxPhases = 8;
+  static constexpr size_t kMaxPhaseNameLength = 32;
+
+  struct Phase {
+    // Truncated and null terminated.
+    char name[kMaxPhaseNameLength];
+    uint64_t duration_ns;
+  };
+
+  // Fill the phases from the top level timings of `timings`.
+  void SetPhases(const TimingLogger& timings);
+
+  // NanoTime() at the start of the GC.
+  uint64_t start_time_ns;
+  uint64_t duration_ns;
+  // GcCause, CollectorType and collector::GcType.
+  uint32_t gc_cause;
+  uint32_t collector_type;
+  uint32_t gc_type;
+  // Number of pauses of the GC, the first kMaxPauses of which are in `pauses_ns`.
+  uint32_t num_pauses;
+  uint64_t pauses_ns[kMaxPauses];
+  uint64_t freed_objects;
+  int64_t freed_bytes;
+  uint64_t freed_large_objects;
+  int64_t freed_large_object_bytes;
+  uint64_t bytes_moved;
+  uint64_t bytes_allocated_before;
+  uint64_t bytes_allocated_after;
+  uint64_t total_memory_after;
+  // Number of top level phases of the GC, the first kMaxPhases of which are in `phases`.
+  uint32_t num_phases;
+  uint32_t padding;
+  Phase phases[kMaxPhases];
+};
+
+// Ring of the records of the last GCs. The GC is the only writer, since only one GC runs at a
+// time. Readers never block it: each slot has a sequence number which is odd while the slot is
+// written, and readers drop the records overwritten while they copy them.
+class GcRecordRing {
+ public:
+  // Header of the files written by WriteToFile(), followed by `num_records` records, oldest
+  // first, in native byte order.
+  struct FileHeader {
+    static constexpr uint32_t kMagic = 0x52434741;  // "AGCR" in little endian.
+    static constexpr uint32_t kVersion = 1;
+
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t num_records;
+    // Total number of GCs recorded, including the ones dropped from the ring.
+    uint64_t num_recorded;
+  };
+
+  explicit GcRecordRing(size_t capacity);
+
+  size_t GetCapacity() const {
+    return capacity_;
+  }
+
+  uint64_t GetNumRecorded() const {
+    return num_recorded_.LoadAcquire();
+  }
+
+  void Append(const GcRecord& record);
+
+  // Copy the records in the ring to `records`, oldest first.
+  void GetRecords(std::vector<GcRecord>* records) const;
+
+  bool WriteToFile(const std::string& filename, std::string* error_msg) const;
+
+ private:
+  struct Slot {
+    Atomic<uint64_t> sequence;
+    GcRecord record;
+  };
+
+  const size_t capacity_;
+  std::unique_ptr<Slot[]> slots_;
+  Atomic<uint64_t> num_recorded_;
+
+  DISALLOW_COPY_AND_ASSIGN(GcRecordRing);
+};
+
+}  // namespace gc
+}  // namespace art
+
+#endif  // ART_RUNTIME_GC_GC_RECORD_H_
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "gc_record.h"
+
+#include <string.h>
+
+#include "base/timing_logger.h"
+#include "base/unix_file/fd_file.h"
+#include "common_runtime_test.h"
+#include "os.h"
+
+namespace art {
+namespace gc {
+
+class GcRecordTest : public CommonRuntimeTest {
+ protected:
+  static GcRecord MakeRecord(uint64_t id) {
+    GcRecord record;
+    memset(&record, 0, sizeof(record));
+    record.start_time_ns = id;
+    record.freed_bytes = static_cast<int64_t>(id) * KB;
+    return record;
+  }
+};
+
+TEST_F(GcRecordTest, KeepsTheLastRecords) {
+  GcRecordRing ring(4);
+  std::vector<GcRecord> records;
+  ring.GetRecords(&records);
+  EXPECT_TRUE(records.empty());
+
+  for (uint64_t i = 0; i < 3; ++i) {
+    ring.Append(MakeRecord(i));
+  }
+  ring.GetRecords(&records);
+  ASSERT_EQ(3u, records.size());
+  for (uint64_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(i, records[i].start_time_ns);
+  }
+
+  for (uint64_t i = 3; i < 10; ++i) {
+    ring.Append(MakeRecord(i));
+  }
+  EXPECT_EQ(10u, ring.GetNumRecorded());
+  ring.GetRecords(&records);
+  ASSERT_EQ(4u, records.size());
+  for (uint64_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(6u + i, records[i].start_time_ns);
+    EXPECT_EQ(static_cast<int64_t>(6u + i) * KB, records[i].freed_bytes);
+  }
+}
+
+TEST_F(GcRecordTest, SetPhases) {
+  TimingLogger timings("test", true, false);
+  {
+    TimingLogger::ScopedTiming t("Outer", &timings);
+    TimingLogger::ScopedTiming t2("Inner", &timings);
+  }
+  for (size_t i = 0; i < GcRecord::kMaxPhases + 1; ++i) {
+    TimingLogger::ScopedTiming t("AVeryLongPhaseNameThatDoesNotFitInTheRecord", &timings);
+  }
+  GcRecord record = MakeRecord(0);
+  record.SetPhases(timings);
+  // Only the top level timings are phases.
+  EXPECT_EQ(GcRecord::kMaxPhases + 2, record.num_phases);
+  EXPECT_STREQ("Outer", record.phases[0].name);
+  EXPECT_EQ(GcRecord::kMaxPhaseNameLength - 1, strlen(record.phases[1].name));
+}
+
+TEST_F(GcRecordTest, WriteToFile) {
+  GcRecordRing ring(2);
+  for (uint64_t i = 0; i < 3; ++i) {
+    ring.Append(MakeRecord(i));
+  }
+  ScratchFile scratch;
+  std::string error_msg;
+  ASSERT_TRUE(ring.WriteToFile(scratch.GetFilename(), &error_msg)) << error_msg;
+
+  std::unique_ptr<File> file(OS::OpenFileForReading(scratch.GetFilename().c_str()));
+  ASSERT_TRUE(file != nullptr);
+  GcRecordRing::FileHeader header;
+  ASSERT_TRUE(file->ReadFully(&header, sizeof(header)));
+  EXPECT_EQ(GcRecordRing::FileHeader::kMagic, header.magic);
+  EXPECT_EQ(GcRecordRing::FileHeader::kVersion, header.version);
+  EXPECT_EQ(sizeof(GcRecord), header.record_size);
+  EXPECT_EQ(2u, header.num_records);
+  EXPECT_EQ(3u, header.num_recorded);
+  GcRecord records[2];
+  ASSERT_TRUE(file->ReadFully(records, sizeof(records)));
+  EXPECT_EQ(1u, records[0].start_time_ns);
+  EXPECT_EQ(2u, records[1].start_time_ns);
+}
+
+}  // namespace gc
+}  // namespace art
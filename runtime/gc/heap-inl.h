@@ -313,16 +313,23 @@ inline mirror::Object* Heap::TryToAllocate(Thread* self,
     case kAllocatorTypeTLAB: {
       DCHECK_ALIGNED(alloc_size, space::BumpPointerSpace::kAlignment);
       if (UNLIKELY(self->TlabSize() < alloc_size)) {
-        const size_t new_tlab_size = alloc_size + kDefaultTLABSize;
-        if (UNLIKELY(IsOutOfMemoryOnAllocation<kGrow>(allocator_type, new_tlab_size))) {
-          return nullptr;
+        const uint64_t now = NanoTime();
+        size_t tlab_size = NextTlabSize(self, now);
+        if (UNLIKELY(IsOutOfMemoryOnAllocation<kGrow>(allocator_type, alloc_size + tlab_size))) {
+          // Do not throw an OOME because of a large TLAB.
+          tlab_size = kDefaultTLABSize;
+          if (UNLIKELY(IsOutOfMemoryOnAllocation<kGrow>(allocator_type, alloc_size + tlab_size))) {
+            return nullptr;
+          }
         }
         // Try allocating a new thread local buffer, if the allocaiton fails the space must be
         // full so return null.
-        if (!bump_pointer_space_->AllocNewTlab(self, new_tlab_size)) {
+        if (!bump_pointer_space_->AllocNewTlab(self, alloc_size + tlab_size)) {
           return nullptr;
         }
-        *bytes_tl_bulk_allocated = new_tlab_size;
+        // The next refill adapts the size that was actually allocated.
+        self->SetTlabRefill(tlab_size, now);
+        *bytes_tl_bulk_allocated = alloc_size + tlab_size;
       } else {
         *bytes_tl_bulk_allocated = 0;
       }
@@ -344,6 +351,15 @@ inline mirror::Object* Heap::TryToAllocate(Thread* self,
       DCHECK(region_space_ != nullptr);
       DCHECK_ALIGNED(alloc_size, space::RegionSpace::kAlignment);
       if (UNLIKELY(self->TlabSize() < alloc_size)) {
+        if (self->TlabSize() > kMaxRegionTLABWaste) {
+          // Keep the TLAB rather than waste what is left of it, as when a large array is
+          // allocated in a loop.
+          if (UNLIKELY(IsOutOfMemoryOnAllocation<kGrow>(allocator_type, alloc_size))) {
+            return nullptr;
+          }
+          return region_space_->AllocNonvirtual<false>(alloc_size, bytes_allocated, usable_size,
+                                                       bytes_tl_bulk_allocated);
+        }
         if (space::RegionSpace::kRegionSize >= alloc_size) {
           // Non-large. Check OOME for a tlab.
           if (LIKELY(!IsOutOfMemoryOnAllocation<kGrow>(allocator_type, space::RegionSpace::kRegionSize))) {
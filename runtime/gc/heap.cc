@@ -45,6 +45,7 @@
 #include "gc/collector/partial_mark_sweep.h"
 #include "gc/collector/semi_space.h"
 #include "gc/collector/sticky_mark_sweep.h"
+#include "gc/gc_record.h"
 #include "gc/reference_processor.h"
 #include "gc/space/bump_pointer_space.h"
 #include "gc/space/dlmalloc_space-inl.h"
@@ -120,6 +121,14 @@ static constexpr uint32_t kAllocSpaceBeginForDeterministicAoT = 0x40000000;
 static constexpr bool kDumpRosAllocStatsOnSigQuit = false;
 
 static constexpr size_t kNativeAllocationHistogramBuckets = 16;
+// Defragmentation compacts the main space when at least this fraction of its run pages, and
+// kDefragmentationMinFreeBytes, are free slots that only allocations of the same size can reuse.
+static constexpr float kDefragmentationMinFreeRatio = 0.25f;
+static constexpr size_t kDefragmentationMinFreeBytes = 8 * MB;
+// Minimal interval between two defragmentations, so that the pauses stay rare in the foreground.
+static constexpr uint64_t kDefragmentationMinInterval = MsToNs(60 * 1000);
+// Copy throughput, in bytes per nanosecond, assumed until a homogeneous space compaction is timed.
+static constexpr double kDefaultHomogeneousSpaceCompactionThroughput = 0.1;
 
 static inline bool CareAboutPauseTimes() {
   return Runtime::Current()->InJankPerceptibleProcessState();
@@ -224,12 +233,17 @@ Heap::Heap(size_t initial_size,
       total_wait_time_(0),
       verify_object_mode_(kVerifyObjectModeDisabled),
       disable_moving_gc_count_(0),
+      young_concurrent_copying_collector_(nullptr),
+      active_concurrent_copying_collector_(nullptr),
       is_running_on_memory_tool_(Runtime::Current()->IsRunningOnMemoryTool()),
       use_tlab_(use_tlab),
       main_space_backup_(nullptr),
       min_interval_homogeneous_space_compaction_by_oom_(
           min_interval_homogeneous_space_compaction_by_oom),
       last_time_homogeneous_space_compaction_by_oom_(NanoTime()),
+      defragmentation_max_pause_ns_(0u),
+      last_time_defragmentation_(NanoTime()),
+      homogeneous_space_compaction_throughput_(kDefaultHomogeneousSpaceCompactionThroughput),
       pending_collector_transition_(nullptr),
       pending_heap_trim_(nullptr),
       use_homogeneous_space_compaction_for_oom_(use_homogeneous_space_compaction_for_oom),
@@ -594,8 +608,13 @@ Heap::Heap(size_t initial_size,
       garbage_collectors_.push_back(semi_space_collector_);
     }
     if (MayUseCollector(kCollectorTypeCC)) {
-      concurrent_copying_collector_ = new collector::ConcurrentCopying(this);
+      concurrent_copying_collector_ = new collector::ConcurrentCopying(this, false);
       garbage_collectors_.push_back(concurrent_copying_collector_);
+      active_concurrent_copying_collector_ = concurrent_copying_collector_;
+      if (collector::ConcurrentCopying::kEnableGenerationalMode) {
+        young_concurrent_copying_collector_ = new collector::ConcurrentCopying(this, true, "young");
+        garbage_collectors_.push_back(young_concurrent_copying_collector_);
+      }
     }
     if (MayUseCollector(kCollectorTypeMC)) {
       mark_compact_collector_ = new collector::MarkCompact(this);
@@ -1188,6 +1207,9 @@ void Heap::DumpGcPerformanceInfo(std::ostream& os) {
     }
   }
 
+  if (rosalloc_space_ != nullptr) {
+    rosalloc_space_->DumpBracketHistogram(os);
+  }
   if (kDumpRosAllocStatsOnSigQuit && rosalloc_space_ != nullptr) {
     rosalloc_space_->DumpStats(os);
   }
@@ -1443,6 +1465,9 @@ void Heap::TrimSpaces(Thread* self) {
   uint64_t total_alloc_space_allocated = 0;
   uint64_t total_alloc_space_size = 0;
   uint64_t managed_reclaimed = 0;
+  size_t main_space_run_bytes = 0;
+  size_t main_space_free_run_bytes = 0;
+  size_t main_space_large_object_bytes = 0;
   {
     ScopedObjectAccess soa(self);
     for (const auto& space : continuous_spaces_) {
@@ -1456,6 +1481,12 @@ void Heap::TrimSpaces(Thread* self) {
         total_alloc_space_size += malloc_space->Size();
       }
     }
+    if (defragmentation_max_pause_ns_ != 0 && main_space_ != nullptr &&
+        main_space_->IsRosAllocSpace()) {
+      main_space_->AsRosAllocSpace()->EstimateFragmentation(&main_space_run_bytes,
+                                                            &main_space_free_run_bytes,
+                                                            &main_space_large_object_bytes);
+    }
   }
   total_alloc_space_allocated = GetBytesAllocated();
   if (large_object_space_ != nullptr) {
@@ -1476,6 +1507,38 @@ void Heap::TrimSpaces(Thread* self) {
   VLOG(heap) << "Heap trim of managed (duration=" << PrettyDuration(gc_heap_end_ns - start_ns)
       << ", advised=" << PrettySize(managed_reclaimed) << ") heap. Managed heap utilization of "
       << static_cast<int>(100 * managed_utilization) << "%.";
+
+  // Non-moving collectors never move objects out of sparse runs, so the free slots that only
+  // allocations of the same size can reuse accumulate. Compact the main space to release them when
+  // the pause is short enough to be taken in the foreground; the from-space is cleared afterwards,
+  // which returns its pages to the kernel.
+  const size_t main_space_live_bytes =
+      main_space_run_bytes - main_space_free_run_bytes + main_space_large_object_bytes;
+  if (ShouldDefragmentMainSpace(main_space_run_bytes,
+                                main_space_free_run_bytes,
+                                main_space_live_bytes)) {
+    VLOG(heap) << "Defragmenting main space with " << PrettySize(main_space_free_run_bytes)
+               << " free in " << PrettySize(main_space_run_bytes) << " of runs";
+    last_time_defragmentation_ = NanoTime();
+    PerformHomogeneousSpaceCompact();
+  }
+}
+
+bool Heap::ShouldDefragmentMainSpace(size_t run_bytes,
+                                     size_t free_run_bytes,
+                                     size_t live_bytes) const {
+  if (defragmentation_max_pause_ns_ == 0 || run_bytes == 0 ||
+      free_run_bytes < kDefragmentationMinFreeBytes ||
+      static_cast<float>(free_run_bytes) <
+          kDefragmentationMinFreeRatio * static_cast<float>(run_bytes)) {
+    return false;
+  }
+  if (NanoTime() - last_time_defragmentation_ < kDefragmentationMinInterval) {
+    return false;
+  }
+  const double expected_pause_ns =
+      static_cast<double>(live_bytes) / homogeneous_space_compaction_throughput_;
+  return expected_pause_ns <= static_cast<double>(defragmentation_max_pause_ns_);
 }
 
 bool Heap::IsValidObjectAddress(const mirror::Object* obj) const {
@@ -2052,9 +2115,11 @@ HomogeneousSpaceCompactResult Heap::PerformHomogeneousSpaceCompact() {
     return HomogeneousSpaceCompactResult::kErrorVMShuttingDown;
   }
   collector::GarbageCollector* collector;
+  uint64_t bytes_allocated_before_gc;
   {
     ScopedSuspendAll ssa(__FUNCTION__);
     uint64_t start_time = NanoTime();
+    bytes_allocated_before_gc = GetBytesAllocated();
     // Launch compaction.
     space::MallocSpace* to_space = main_space_backup_.release();
     space::MallocSpace* from_space = main_space_;
@@ -2073,6 +2138,10 @@ HomogeneousSpaceCompactResult Heap::PerformHomogeneousSpaceCompact() {
     count_performed_homogeneous_space_compaction_++;
     // Print statics log and resume all threads.
     uint64_t duration = NanoTime() - start_time;
+    if (duration != 0) {
+      homogeneous_space_compaction_throughput_ =
+          static_cast<double>(space_size_after_compaction) / static_cast<double>(duration);
+    }
     VLOG(heap) << "Heap homogeneous space compaction took " << PrettyDuration(duration) << " size: "
                << PrettySize(space_size_before_compaction) << " -> "
                << PrettySize(space_size_after_compaction) << " compact-ratio: "
@@ -2083,6 +2152,7 @@ HomogeneousSpaceCompactResult Heap::PerformHomogeneousSpaceCompact() {
   reference_processor_->EnqueueClearedReferences(self);
   GrowForUtilization(semi_space_collector_);
   LogGC(kGcCauseHomogeneousSpaceCompact, collector);
+  RecordGC(kGcCauseHomogeneousSpaceCompact, collector, bytes_allocated_before_gc);
   FinishGC(self, collector::kGcTypeFull);
   {
     ScopedObjectAccess soa(self);
@@ -2228,6 +2298,7 @@ void Heap::TransitionCollector(CollectorType collector_type) {
   GrowForUtilization(semi_space_collector_);
   DCHECK(collector != nullptr);
   LogGC(kGcCauseCollectorTransition, collector);
+  RecordGC(kGcCauseCollectorTransition, collector, before_allocated);
   FinishGC(self, collector::kGcTypeFull);
   {
     ScopedObjectAccess soa(self);
@@ -2256,6 +2327,9 @@ void Heap::ChangeCollector(CollectorType collector_type) {
     gc_plan_.clear();
     switch (collector_type_) {
       case kCollectorTypeCC: {
+        if (young_concurrent_copying_collector_ != nullptr) {
+          gc_plan_.push_back(collector::kGcTypeSticky);
+        }
         gc_plan_.push_back(collector::kGcTypeFull);
         if (use_tlab_) {
           ChangeAllocator(kAllocatorTypeRegionTLAB);
@@ -2675,8 +2749,20 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
         collector = semi_space_collector_;
         break;
       case kCollectorTypeCC:
-        concurrent_copying_collector_->SetRegionSpace(region_space_);
-        collector = concurrent_copying_collector_;
+        // Explicit and native allocation GCs, and the ones that clear soft references, are
+        // expected to free as much as possible and always collect the whole heap.
+        if (gc_type == collector::kGcTypeSticky &&
+            young_concurrent_copying_collector_ != nullptr &&
+            !clear_soft_references &&
+            !runtime->IsZygote() &&
+            gc_cause != kGcCauseExplicit &&
+            gc_cause != kGcCauseForNativeAlloc) {
+          active_concurrent_copying_collector_ = young_concurrent_copying_collector_;
+        } else {
+          active_concurrent_copying_collector_ = concurrent_copying_collector_;
+        }
+        active_concurrent_copying_collector_->SetRegionSpace(region_space_);
+        collector = active_concurrent_copying_collector_;
         break;
       case kCollectorTypeMC:
         mark_compact_collector_->SetSpace(bump_pointer_space_);
@@ -2685,7 +2771,9 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
       default:
         LOG(FATAL) << "Invalid collector type " << static_cast<size_t>(collector_type_);
     }
-    if (collector != mark_compact_collector_ && collector != concurrent_copying_collector_) {
+    if (collector != mark_compact_collector_ &&
+        collector != concurrent_copying_collector_ &&
+        collector != young_concurrent_copying_collector_) {
       temp_space_->GetMemMap()->Protect(PROT_READ | PROT_WRITE);
       if (kIsDebugBuild) {
         // Try to read each page of the memory map in case mprotect didn't work properly b/19894268.
@@ -2726,6 +2814,7 @@ collector::GcType Heap::CollectGarbageInternal(collector::GcType gc_type,
   // Grow the heap so that we know when to perform the next GC.
   GrowForUtilization(collector, bytes_allocated_before_gc);
   LogGC(gc_cause, collector);
+  RecordGC(gc_cause, collector, bytes_allocated_before_gc);
   FinishGC(self, gc_type);
   // Inform DDMS that a GC completed.
   Dbg::GcDidFinish();
@@ -2773,6 +2862,50 @@ void Heap::LogGC(GcCause gc_cause, collector::GarbageCollector* collector) {
   }
 }
 
+void Heap::RecordGC(GcCause gc_cause,
+                    collector::GarbageCollector* collector,
+                    uint64_t bytes_allocated_before_gc) {
+  if (gc_records_ == nullptr) {
+    return;
+  }
+  const collector::Iteration* iteration = GetCurrentGcIteration();
+  GcRecord record;
+  memset(&record, 0, sizeof(record));
+  record.start_time_ns = NanoTime() - iteration->GetDurationNs();
+  record.duration_ns = iteration->GetDurationNs();
+  record.gc_cause = gc_cause;
+  record.collector_type = collector->GetCollectorType();
+  record.gc_type = collector->GetGcType();
+  const std::vector<uint64_t>& pause_times = iteration->GetPauseTimes();
+  record.num_pauses = pause_times.size();
+  for (size_t i = 0; i < pause_times.size() && i < GcRecord::kMaxPauses; ++i) {
+    record.pauses_ns[i] = pause_times[i];
+  }
+  record.freed_objects = iteration->GetFreedObjects();
+  record.freed_bytes = iteration->GetFreedBytes();
+  record.freed_large_objects = iteration->GetFreedLargeObjects();
+  record.freed_large_object_bytes = iteration->GetFreedLargeObjectBytes();
+  record.bytes_moved = collector->GetBytesMoved();
+  record.bytes_allocated_before = bytes_allocated_before_gc;
+  record.bytes_allocated_after = GetBytesAllocated();
+  record.total_memory_after = GetTotalMemory();
+  record.SetPhases(*current_gc_iteration_.GetTimings());
+  gc_records_->Append(record);
+}
+
+void Heap::EnableGcRecords(size_t capacity, const std::string& filename) {
+  gc_records_.reset(capacity != 0 ? new GcRecordRing(capacity) : nullptr);
+  gc_record_file_ = filename;
+}
+
+bool Heap::GetGcRecords(std::vector<GcRecord>* records) const {
+  if (gc_records_ == nullptr) {
+    return false;
+  }
+  gc_records_->GetRecords(records);
+  return true;
+}
+
 void Heap::FinishGC(Thread* self, collector::GcType gc_type) {
   MutexLock mu(self, *gc_complete_lock_);
   collector_type_running_ = kCollectorTypeNone;
@@ -3491,6 +3624,14 @@ void Heap::DumpForSigQuit(std::ostream& os) {
   os << "Heap: " << GetPercentFree() << "% free, " << PrettySize(GetBytesAllocated()) << "/"
      << PrettySize(GetTotalMemory()) << "; " << GetObjectsAllocated() << " objects\n";
   DumpGcPerformanceInfo(os);
+  if (gc_records_ != nullptr && !gc_record_file_.empty()) {
+    std::string error_msg;
+    if (gc_records_->WriteToFile(gc_record_file_, &error_msg)) {
+      os << "Wrote records of the last GCs to " << gc_record_file_ << "\n";
+    } else {
+      os << error_msg << "\n";
+    }
+  }
 }
 
 size_t Heap::GetPercentFree() {
@@ -3529,6 +3670,21 @@ void Heap::UpdateMaxNativeFootprint() {
   native_footprint_gc_watermark_ = std::min(growth_limit_, target_size);
 }
 
+size_t Heap::NextTlabSize(Thread* self, uint64_t now) {
+  size_t tlab_size = self->GetTlabRefillSize();
+  if (tlab_size == 0) {
+    tlab_size = kDefaultTLABSize;
+  } else {
+    const uint64_t time_since_refill = now - self->GetTlabRefillTime();
+    if (time_since_refill < kTLABFastRefillTime) {
+      tlab_size = std::min(tlab_size * 2, kMaxTLABSize);
+    } else if (time_since_refill > kTLABSlowRefillTime) {
+      tlab_size = std::max(tlab_size / 2, kDefaultTLABSize);
+    }
+  }
+  return tlab_size;
+}
+
 collector::GarbageCollector* Heap::FindCollectorByGcType(collector::GcType gc_type) {
   for (const auto& collector : garbage_collectors_) {
     if (collector->GetCollectorType() == collector_type_ &&
@@ -3571,7 +3727,9 @@ void Heap::GrowForUtilization(collector::GarbageCollector* collector_ran,
     collector::GcType non_sticky_gc_type =
         HasZygoteSpace() ? collector::kGcTypePartial : collector::kGcTypeFull;
     // Find what the next non sticky collector will be.
-    collector::GarbageCollector* non_sticky_collector = FindCollectorByGcType(non_sticky_gc_type);
+    collector::GarbageCollector* non_sticky_collector = collector_type_ == kCollectorTypeCC
+        ? concurrent_copying_collector_
+        : FindCollectorByGcType(non_sticky_gc_type);
     // If the throughput of the current sticky GC >= throughput of the non sticky collector, then
     // do another sticky collection next.
     // We also check that the bytes allocated aren't over the footprint limit in order to prevent a
@@ -57,6 +57,8 @@ namespace mirror {
 namespace gc {
 
 class AllocRecordObjectMap;
+struct GcRecord;
+class GcRecordRing;
 class ReferenceProcessor;
 class TaskProcessor;
 
@@ -76,6 +78,7 @@ namespace collector {
 
 namespace allocator {
   class RosAlloc;
+  class RosAllocDefragmentationTest;
 }  // namespace allocator
 
 namespace space {
@@ -129,6 +132,14 @@ class Heap {
   static constexpr size_t kDefaultLongPauseLogThreshold = MsToNs(5);
   static constexpr size_t kDefaultLongGCLogThreshold = MsToNs(100);
   static constexpr size_t kDefaultTLABSize = 256 * KB;
+  // Threads that refill their TLAB more often than every kTLABFastRefillTime double its size, up
+  // to kMaxTLABSize. Those refilling less often than every kTLABSlowRefillTime halve it.
+  static constexpr size_t kMaxTLABSize = 2 * MB;
+  static constexpr uint64_t kTLABFastRefillTime = MsToNs(10);
+  static constexpr uint64_t kTLABSlowRefillTime = MsToNs(100);
+  // A region TLAB with more than this many bytes left is kept when an object does not fit in it,
+  // and the object is allocated in the shared region instead.
+  static constexpr size_t kMaxRegionTLABWaste = 64 * KB;
   static constexpr double kDefaultTargetUtilization = 0.5;
   static constexpr double kDefaultHeapGrowthMultiplier = 2.0;
   // Primitive arrays larger than this size are put in the large object space.
@@ -534,6 +545,14 @@ class Heap {
 
   void DumpForSigQuit(std::ostream& os) REQUIRES(!*gc_complete_lock_, !native_histogram_lock_);
 
+  // Keep a record of each of the last `capacity` GCs. The records are written to `filename`, if
+  // not empty, on SIGQUIT.
+  void EnableGcRecords(size_t capacity, const std::string& filename);
+
+  // Copy the records of the last GCs, oldest first. Does not block the GC. Returns false if GC
+  // records are not enabled.
+  bool GetGcRecords(std::vector<GcRecord>* records) const;
+
   // Do a pending collector transition.
   void DoPendingCollectorTransition() REQUIRES(!*gc_complete_lock_);
 
@@ -694,8 +713,10 @@ class Heap {
     return zygote_space_ != nullptr;
   }
 
+  // The concurrent copying collector currently, or last, running. Either the full or the young
+  // generation one.
   collector::ConcurrentCopying* ConcurrentCopyingCollector() {
-    return concurrent_copying_collector_;
+    return active_concurrent_copying_collector_;
   }
 
   CollectorType CurrentCollectorType() {
@@ -732,6 +753,12 @@ class Heap {
     min_interval_homogeneous_space_compaction_by_oom_ = interval;
   }
 
+  // Compact the main space after a heap trim when it is fragmented and the compaction is
+  // expected to pause for at most `max_pause_ns`. Zero disables the defragmentation.
+  void SetDefragmentationMaxPause(uint64_t max_pause_ns) {
+    defragmentation_max_pause_ns_ = max_pause_ns;
+  }
+
   // Helpers for android.os.Debug.getRuntimeStat().
   uint64_t GetGcCount() const;
   uint64_t GetGcTime() const;
@@ -796,6 +823,10 @@ class Heap {
       REQUIRES(Locks::mutator_lock_);
 
   void LogGC(GcCause gc_cause, collector::GarbageCollector* collector);
+  // Append the current GC iteration to the GC records, if enabled.
+  void RecordGC(GcCause gc_cause,
+                collector::GarbageCollector* collector,
+                uint64_t bytes_allocated_before_gc);
   void StartGC(Thread* self, GcCause cause, CollectorType collector_type)
       REQUIRES(!*gc_complete_lock_);
   void FinishGC(Thread* self, collector::GcType gc_type) REQUIRES(!*gc_complete_lock_);
@@ -850,6 +881,10 @@ class Heap {
       SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!*gc_complete_lock_, !*pending_task_lock_, !*backtrace_lock_);
 
+  // Returns the size of the next TLAB `self` allocates in the bump pointer space at time `now`,
+  // adapted to the allocation rate of the thread.
+  static size_t NextTlabSize(Thread* self, uint64_t now);
+
   // Handles Allocate()'s slow allocation path with GC involved after
   // an initial allocation attempt failed.
   mirror::Object* AllocateInternalWithGc(Thread* self,
@@ -1001,6 +1036,10 @@ class Heap {
   // Trim the managed and native spaces by releasing unused memory back to the OS.
   void TrimSpaces(Thread* self) REQUIRES(!*gc_complete_lock_);
 
+  // Returns true if the main space wastes enough memory in the free slots of its runs to be worth
+  // compacting, and the compaction of its `live_bytes` fits the defragmentation pause budget.
+  bool ShouldDefragmentMainSpace(size_t run_bytes, size_t free_run_bytes, size_t live_bytes) const;
+
   // Trim 0 pages at the end of reference tables.
   void TrimIndirectReferenceTables(Thread* self);
 
@@ -1114,6 +1153,12 @@ class Heap {
   // Reference processor;
   std::unique_ptr<ReferenceProcessor> reference_processor_;
 
+  // Records of the last GCs, null if disabled.
+  std::unique_ptr<GcRecordRing> gc_records_;
+
+  // File the GC records are written to on SIGQUIT, if not empty.
+  std::string gc_record_file_;
+
   // Task processor, proxies heap trim requests to the daemon threads.
   std::unique_ptr<TaskProcessor> task_processor_;
 
@@ -1272,6 +1317,10 @@ class Heap {
   collector::SemiSpace* semi_space_collector_;
   collector::MarkCompact* mark_compact_collector_;
   collector::ConcurrentCopying* concurrent_copying_collector_;
+  // Only collects the regions allocated since the last collection. Null if the generational
+  // mode is not supported.
+  collector::ConcurrentCopying* young_concurrent_copying_collector_;
+  collector::ConcurrentCopying* active_concurrent_copying_collector_;
 
   const bool is_running_on_memory_tool_;
   const bool use_tlab_;
@@ -1286,6 +1335,17 @@ class Heap {
   // Times of the last homogeneous space compaction caused by OOM.
   uint64_t last_time_homogeneous_space_compaction_by_oom_;
 
+  // Longest expected pause of a homogeneous space compaction done to defragment the main space
+  // after a heap trim, or zero if disabled.
+  uint64_t defragmentation_max_pause_ns_;
+
+  // Time of the last homogeneous space compaction done to defragment the main space.
+  uint64_t last_time_defragmentation_;
+
+  // Copy throughput of the last homogeneous space compaction, in bytes per nanosecond, used to
+  // estimate the pause of the next one.
+  double homogeneous_space_compaction_throughput_;
+
   // Saved OOMs by homogeneous space compaction.
   Atomic<size_t> count_delayed_oom_;
 
@@ -1349,6 +1409,8 @@ class Heap {
   // Boot image spaces.
   std::vector<space::ImageSpace*> boot_image_spaces_;
 
+  friend class allocator::RosAllocDefragmentationTest;  // For ShouldDefragmentMainSpace.
+  friend class HeapTest;  // For NextTlabSize.
   friend class CollectorTransitionTask;
   friend class collector::GarbageCollector;
   friend class collector::MarkCompact;
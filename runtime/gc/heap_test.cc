@@ -14,20 +14,30 @@
  * limitations under the License.
  */
 
+#include "base/time_utils.h"
 #include "class_linker-inl.h"
 #include "common_runtime_test.h"
 #include "gc/accounting/card_table-inl.h"
 #include "gc/accounting/space_bitmap-inl.h"
+#include "gc/collector/concurrent_copying.h"
 #include "handle_scope-inl.h"
+#include "mirror/array-inl.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
 #include "mirror/object_array-inl.h"
+#include "mirror/string-inl.h"
 #include "scoped_thread_state_change.h"
+#include "thread-inl.h"
 
 namespace art {
 namespace gc {
 
-class HeapTest : public CommonRuntimeTest {};
+class HeapTest : public CommonRuntimeTest {
+ protected:
+  static size_t NextTlabSize(Thread* self, uint64_t now) {
+    return Heap::NextTlabSize(self, now);
+  }
+};
 
 TEST_F(HeapTest, ClearGrowthLimit) {
   Heap* heap = Runtime::Current()->GetHeap();
@@ -62,6 +72,42 @@ TEST_F(HeapTest, GarbageCollectClassLinkerInit) {
   Runtime::Current()->GetHeap()->CollectGarbage(false);
 }
 
+TEST_F(HeapTest, NextTlabSize) {
+  Thread* self = Thread::Current();
+  const size_t old_refill_size = self->GetTlabRefillSize();
+  const uint64_t old_refill_time = self->GetTlabRefillTime();
+  const uint64_t now = MsToNs(1000000);
+  const uint64_t fast = now - Heap::kTLABFastRefillTime / 2;
+  const uint64_t slow = now - 2 * Heap::kTLABSlowRefillTime;
+  const uint64_t steady = now - (Heap::kTLABFastRefillTime + Heap::kTLABSlowRefillTime) / 2;
+
+  // The first TLAB has the default size.
+  self->SetTlabRefill(0u, 0u);
+  EXPECT_EQ(Heap::kDefaultTLABSize, NextTlabSize(self, now));
+
+  // Fast refills double the size, up to the maximum.
+  self->SetTlabRefill(Heap::kDefaultTLABSize, fast);
+  EXPECT_EQ(2 * Heap::kDefaultTLABSize, NextTlabSize(self, now));
+  self->SetTlabRefill(Heap::kMaxTLABSize / 2 + kObjectAlignment, fast);
+  EXPECT_EQ(Heap::kMaxTLABSize, NextTlabSize(self, now));
+  self->SetTlabRefill(Heap::kMaxTLABSize, fast);
+  EXPECT_EQ(Heap::kMaxTLABSize, NextTlabSize(self, now));
+
+  // Slow refills halve the size, down to the default.
+  self->SetTlabRefill(Heap::kMaxTLABSize, slow);
+  EXPECT_EQ(Heap::kMaxTLABSize / 2, NextTlabSize(self, now));
+  self->SetTlabRefill(Heap::kDefaultTLABSize + kObjectAlignment, slow);
+  EXPECT_EQ(Heap::kDefaultTLABSize, NextTlabSize(self, now));
+  self->SetTlabRefill(Heap::kDefaultTLABSize, slow);
+  EXPECT_EQ(Heap::kDefaultTLABSize, NextTlabSize(self, now));
+
+  // Refills in between keep the size.
+  self->SetTlabRefill(2 * Heap::kDefaultTLABSize, steady);
+  EXPECT_EQ(2 * Heap::kDefaultTLABSize, NextTlabSize(self, now));
+
+  self->SetTlabRefill(old_refill_size, old_refill_time);
+}
+
 TEST_F(HeapTest, HeapBitmapCapacityTest) {
   uint8_t* heap_begin = reinterpret_cast<uint8_t*>(0x1000);
   const size_t heap_capacity = kObjectAlignment * (sizeof(intptr_t) * 8 + 1);
@@ -84,5 +130,238 @@ TEST_F(ZygoteHeapTest, PreZygoteFork) {
   Runtime::Current()->GetHeap()->PreZygoteFork();
 }
 
+class YoungGenHeapTest : public CommonRuntimeTest {
+  void SetUpRuntimeOptions(RuntimeOptions* options) {
+    CommonRuntimeTest::SetUpRuntimeOptions(options);
+    if (collector::ConcurrentCopying::kEnableGenerationalMode) {
+      options->push_back(std::make_pair("-Xgc:CC", nullptr));
+    }
+  }
+};
+
+TEST_F(YoungGenHeapTest, YoungCollectionSkipsDeadOldObjects) {
+  if (!collector::ConcurrentCopying::kEnableGenerationalMode) {
+    // Young collections require the Baker read barrier.
+    return;
+  }
+  Thread* self = Thread::Current();
+  Heap* heap = Runtime::Current()->GetHeap();
+  ASSERT_EQ(kCollectorTypeCC, heap->CurrentCollectorType());
+  ScopedObjectAccess soa(self);
+  StackHandleScope<2> hs(self);
+  Handle<mirror::Class> c(
+      hs.NewHandle(class_linker_->FindSystemClass(soa.Self(), "[Ljava/lang/Object;")));
+  // Small arrays, so that the neighbours of each array share its card.
+  constexpr size_t kNumArrays = 1024;
+  Handle<mirror::ObjectArray<mirror::Object>> arrays(hs.NewHandle(
+      mirror::ObjectArray<mirror::Object>::Alloc(soa.Self(), c.Get(), kNumArrays)));
+  ASSERT_TRUE(arrays.Get() != nullptr);
+  for (size_t i = 0; i < kNumArrays; ++i) {
+    mirror::Object* array = mirror::ObjectArray<mirror::Object>::Alloc(soa.Self(), c.Get(), 1);
+    ASSERT_TRUE(array != nullptr);
+    arrays->Set<false>(i, array);
+  }
+  // The full collection copies the arrays next to each other, into regions that the next full
+  // collection does not evacuate.
+  heap->ConcurrentGC(soa.Self(), /* force_full */ true);
+
+  // Every other array dies while referring to an object that the next collection frees.
+  for (size_t i = 0; i < kNumArrays; i += 2) {
+    mirror::Object* dead = mirror::String::AllocFromModifiedUtf8(soa.Self(), "dead");
+    ASSERT_TRUE(dead != nullptr);
+    arrays->Get(i)->AsObjectArray<mirror::Object>()->Set<false>(0, dead);
+    arrays->Set<false>(i, nullptr);
+  }
+  heap->ConcurrentGC(soa.Self(), /* force_full */ true);
+
+  // Writing young objects into the live arrays dirties the cards of the dead ones too. The young
+  // collection that follows a full collection must only visit the live arrays.
+  for (size_t i = 1; i < kNumArrays; i += 2) {
+    mirror::Object* young = mirror::String::AllocFromModifiedUtf8(soa.Self(), "young");
+    ASSERT_TRUE(young != nullptr);
+    arrays->Get(i)->AsObjectArray<mirror::Object>()->Set<false>(0, young);
+  }
+  heap->ConcurrentGC(soa.Self(), /* force_full */ false);
+
+  for (size_t i = 1; i < kNumArrays; i += 2) {
+    mirror::Object* young = arrays->Get(i)->AsObjectArray<mirror::Object>()->Get(0);
+    ASSERT_TRUE(young != nullptr);
+    EXPECT_TRUE(young->AsString()->Equals("young")) << i;
+  }
+}
+
+class ParallelSweepHeapTest : public CommonRuntimeTest {
+  void SetUpRuntimeOptions(RuntimeOptions* options) {
+    CommonRuntimeTest::SetUpRuntimeOptions(options);
+    if (!kUseReadBarrier) {
+      options->push_back(std::make_pair("-Xgc:CMS", nullptr));
+    }
+    options->push_back(std::make_pair("-XX:ParallelGCThreads=4", nullptr));
+  }
+};
+
+TEST_F(ParallelSweepHeapTest, SweepKeepsLiveObjects) {
+  if (kUseReadBarrier) {
+    // The parallel sweep is a mark-sweep phase.
+    return;
+  }
+  Thread* self = Thread::Current();
+  Heap* heap = Runtime::Current()->GetHeap();
+  ASSERT_EQ(kCollectorTypeCMS, heap->CurrentCollectorType());
+  ScopedObjectAccess soa(self);
+  StackHandleScope<2> hs(self);
+  Handle<mirror::Class> c(
+      hs.NewHandle(class_linker_->FindSystemClass(soa.Self(), "[Ljava/lang/Object;")));
+  // Sizes of the RosAlloc thread-local and shared runs, and of the large object space.
+  const int32_t kLengths[] = { 8, 100, 1000, 2000, 4 * kPageSize };
+  constexpr size_t kNumArrays = 4000;
+  Handle<mirror::ObjectArray<mirror::Object>> arrays(hs.NewHandle(
+      mirror::ObjectArray<mirror::Object>::Alloc(soa.Self(), c.Get(), kNumArrays)));
+  ASSERT_TRUE(arrays.Get() != nullptr);
+  for (size_t i = 0; i < kNumArrays; ++i) {
+    mirror::ByteArray* array =
+        mirror::ByteArray::Alloc(soa.Self(), kLengths[i % arraysize(kLengths)]);
+    ASSERT_TRUE(array != nullptr);
+    array->Set<false>(0, static_cast<int8_t>(i));
+    arrays->Set<false>(i, array);
+  }
+  // Every other group of arrays dies, so that most runs keep some objects and lose others.
+  for (size_t i = 0; i < kNumArrays; ++i) {
+    if ((i / arraysize(kLengths)) % 2 == 0) {
+      arrays->Set<false>(i, nullptr);
+    }
+  }
+  const size_t bytes_allocated_before = heap->GetBytesAllocated();
+  {
+    ScopedThreadSuspension sts(soa.Self(), kSuspended);
+    heap->CollectGarbage(false);
+  }
+  EXPECT_LT(heap->GetBytesAllocated(), bytes_allocated_before);
+
+  for (size_t i = 0; i < kNumArrays; ++i) {
+    mirror::Object* array = arrays->Get(i);
+    if ((i / arraysize(kLengths)) % 2 == 0) {
+      EXPECT_TRUE(array == nullptr);
+      continue;
+    }
+    ASSERT_TRUE(array != nullptr) << i;
+    EXPECT_EQ(kLengths[i % arraysize(kLengths)], array->AsByteArray()->GetLength()) << i;
+    EXPECT_EQ(static_cast<int8_t>(i), array->AsByteArray()->Get(0)) << i;
+  }
+}
+
+class BumpPointerTlabHeapTest : public HeapTest {
+  void SetUpRuntimeOptions(RuntimeOptions* options) {
+    CommonRuntimeTest::SetUpRuntimeOptions(options);
+    if (!kUseReadBarrier) {
+      options->push_back(std::make_pair("-Xgc:SS", nullptr));
+      options->push_back(std::make_pair("-XX:UseTLAB", nullptr));
+    }
+  }
+};
+
+TEST_F(BumpPointerTlabHeapTest, RefillsAdaptTlabSize) {
+  if (kUseReadBarrier) {
+    // Read barriers use the region space, whose TLABs are one region.
+    return;
+  }
+  Thread* self = Thread::Current();
+  Heap* heap = Runtime::Current()->GetHeap();
+  ASSERT_EQ(kAllocatorTypeTLAB, heap->GetCurrentAllocator());
+  ScopedObjectAccess soa(self);
+  constexpr int32_t kLength = 16;
+
+  // Revoke the TLAB and record a refill at `refill_time` of size `refill_size`, so that the next
+  // allocation refills the TLAB. Returns the size of the new TLAB.
+  auto refill = [&](size_t refill_size, uint64_t refill_time) {
+    heap->RevokeThreadLocalBuffers(self);
+    EXPECT_EQ(0u, self->TlabSize());
+    self->SetTlabRefill(refill_size, refill_time);
+    mirror::ByteArray* array = mirror::ByteArray::Alloc(self, kLength);
+    EXPECT_TRUE(array != nullptr);
+    // The TLAB was allocated with room for the array on top of its size.
+    EXPECT_EQ(self->GetTlabRefillSize(), self->TlabSize());
+    return self->GetTlabRefillSize();
+  };
+
+  EXPECT_EQ(Heap::kDefaultTLABSize, refill(0u, 0u));
+  // Refilling right away grows the TLAB, refilling after a while shrinks it back.
+  EXPECT_EQ(2 * Heap::kDefaultTLABSize, refill(Heap::kDefaultTLABSize, NanoTime()));
+  EXPECT_EQ(4 * Heap::kDefaultTLABSize, refill(2 * Heap::kDefaultTLABSize, NanoTime()));
+  EXPECT_EQ(Heap::kMaxTLABSize, refill(Heap::kMaxTLABSize, NanoTime()));
+  const uint64_t slow = NanoTime() - 2 * Heap::kTLABSlowRefillTime;
+  EXPECT_EQ(Heap::kMaxTLABSize / 2, refill(Heap::kMaxTLABSize, slow));
+  EXPECT_EQ(Heap::kDefaultTLABSize, refill(Heap::kDefaultTLABSize, slow));
+
+  // Allocations that fit in the TLAB do not refill it.
+  const size_t refill_size = self->GetTlabRefillSize();
+  const uint64_t refill_time = self->GetTlabRefillTime();
+  ASSERT_TRUE(mirror::ByteArray::Alloc(self, kLength) != nullptr);
+  EXPECT_EQ(refill_size, self->GetTlabRefillSize());
+  EXPECT_EQ(refill_time, self->GetTlabRefillTime());
+  EXPECT_LT(self->TlabSize(), refill_size);
+}
+
+class RegionTlabHeapTest : public HeapTest {
+  void SetUpRuntimeOptions(RuntimeOptions* options) {
+    CommonRuntimeTest::SetUpRuntimeOptions(options);
+    if (kUseReadBarrier) {
+      options->push_back(std::make_pair("-Xgc:CC", nullptr));
+      options->push_back(std::make_pair("-XX:UseTLAB", nullptr));
+    }
+  }
+
+ protected:
+  // Allocate an object array of `size` bytes, a multiple of the object alignment.
+  static mirror::Object* AllocOfSize(Thread* self, mirror::Class* klass, size_t size)
+      SHARED_REQUIRES(Locks::mutator_lock_) {
+    const size_t data_offset =
+        mirror::Array::DataOffset(sizeof(mirror::HeapReference<mirror::Object>)).Uint32Value();
+    const size_t length = (size - data_offset) / sizeof(mirror::HeapReference<mirror::Object>);
+    return mirror::ObjectArray<mirror::Object>::Alloc(self, klass, length);
+  }
+};
+
+TEST_F(RegionTlabHeapTest, KeepsTlabAboveMaxWaste) {
+  if (!kUseReadBarrier) {
+    // Region TLABs are only used by the concurrent copying collector.
+    return;
+  }
+  Thread* self = Thread::Current();
+  Heap* heap = Runtime::Current()->GetHeap();
+  ASSERT_EQ(kAllocatorTypeRegionTLAB, heap->GetCurrentAllocator());
+  ScopedObjectAccess soa(self);
+  StackHandleScope<1> hs(self);
+  Handle<mirror::Class> c(
+      hs.NewHandle(class_linker_->FindSystemClass(soa.Self(), "[Ljava/lang/Object;")));
+  // Object arrays, unlike primitive arrays, are never large objects.
+  heap->RevokeThreadLocalBuffers(self);
+  ASSERT_TRUE(AllocOfSize(self, c.Get(), 4 * KB) != nullptr);
+  uint8_t* const tlab_start = self->GetTlabStart();
+  ASSERT_TRUE(tlab_start != nullptr);
+
+  // An object that does not fit in what is left of the TLAB, more than kMaxRegionTLABWaste, goes
+  // to a shared region and the TLAB is kept.
+  const size_t left = Heap::kMaxRegionTLABWaste + 16 * KB;
+  ASSERT_GT(self->TlabSize(), left);
+  ASSERT_TRUE(AllocOfSize(self, c.Get(), self->TlabSize() - left) != nullptr);
+  ASSERT_EQ(left, self->TlabSize());
+  mirror::Object* shared = AllocOfSize(self, c.Get(), left + 16 * KB);
+  ASSERT_TRUE(shared != nullptr);
+  EXPECT_EQ(tlab_start, self->GetTlabStart());
+  EXPECT_EQ(left, self->TlabSize());
+  EXPECT_FALSE(reinterpret_cast<uint8_t*>(shared) >= tlab_start &&
+               reinterpret_cast<uint8_t*>(shared) < tlab_start + space::RegionSpace::kRegionSize);
+
+  // Once no more than kMaxRegionTLABWaste is left, the object gets a new TLAB.
+  const size_t waste = Heap::kMaxRegionTLABWaste - 16 * KB;
+  ASSERT_TRUE(AllocOfSize(self, c.Get(), left - waste) != nullptr);
+  ASSERT_EQ(waste, self->TlabSize());
+  mirror::Object* refilled = AllocOfSize(self, c.Get(), waste + 16 * KB);
+  ASSERT_TRUE(refilled != nullptr);
+  EXPECT_NE(tlab_start, self->GetTlabStart());
+  EXPECT_EQ(self->GetTlabStart(), reinterpret_cast<uint8_t*>(refilled));
+}
+
 }  // namespace gc
 }  // namespace art
@@ -18,6 +18,7 @@
 
 #include "base/time_utils.h"
 #include "collector/garbage_collector.h"
+#include "heap.h"
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
 #include "mirror/reference-inl.h"
@@ -26,6 +27,7 @@
 #include "ScopedLocalRef.h"
 #include "scoped_thread_state_change.h"
 #include "task_processor.h"
+#include "thread_pool.h"
 #include "utils.h"
 #include "well_known_classes.h"
 
@@ -146,9 +148,9 @@ void ReferenceProcessor::ProcessReferences(bool concurrent, TimingLogger* timing
       StopPreservingReferences(self);
     }
   }
+  const size_t thread_count = GetThreadCount(concurrent);
   // Clear all remaining soft and weak references with white referents.
-  soft_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
-  weak_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
+  ClearWhiteReferences({&soft_reference_queue_, &weak_reference_queue_}, thread_count, collector);
   {
     TimingLogger::ScopedTiming t2(concurrent ? "EnqueueFinalizerReferences" :
         "(Paused)EnqueueFinalizerReferences", timings);
@@ -162,11 +164,11 @@ void ReferenceProcessor::ProcessReferences(bool concurrent, TimingLogger* timing
       StopPreservingReferences(self);
     }
   }
-  // Clear all finalizer referent reachable soft and weak references with white referents.
-  soft_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
-  weak_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
-  // Clear all phantom references with white referents.
-  phantom_reference_queue_.ClearWhiteReferences(&cleared_references_, collector);
+  // Clear all finalizer referent reachable soft and weak references with white referents, and all
+  // phantom references with white referents.
+  ClearWhiteReferences({&soft_reference_queue_, &weak_reference_queue_, &phantom_reference_queue_},
+                       thread_count,
+                       collector);
   // At this point all reference queues other than the cleared references should be empty.
   DCHECK(soft_reference_queue_.IsEmpty());
   DCHECK(weak_reference_queue_.IsEmpty());
@@ -186,6 +188,101 @@ void ReferenceProcessor::ProcessReferences(bool concurrent, TimingLogger* timing
   }
 }
 
+size_t ReferenceProcessor::GetThreadCount(bool concurrent) const {
+  Runtime* const runtime = Runtime::Current();
+  Heap* const heap = runtime->GetHeap();
+  // Transactions record the cleared referents, which is not thread safe. As for marking, leave
+  // the CPU to the foreground apps when in the background.
+  if (heap->GetThreadPool() == nullptr || runtime->IsActiveTransaction() ||
+      !runtime->InJankPerceptibleProcessState()) {
+    return 1;
+  }
+  return (concurrent ? heap->GetConcGCThreadCount() : heap->GetParallelGCThreadCount()) + 1;
+}
+
+// Clears the white referents of a shard of dequeued references, and compacts the cleared
+// references at the start of the shard.
+class ClearWhiteReferencesTask : public Task {
+ public:
+  ClearWhiteReferencesTask(collector::GarbageCollector* collector,
+                           mirror::Reference** begin,
+                           mirror::Reference** end)
+      : collector_(collector), begin_(begin), end_(end), cleared_end_(begin) {}
+
+  void Run(Thread* self ATTRIBUTE_UNUSED) OVERRIDE NO_THREAD_SAFETY_ANALYSIS {
+    mirror::Reference** out = begin_;
+    for (mirror::Reference** it = begin_; it != end_; ++it) {
+      if (ReferenceQueue::ClearWhiteReferent(*it, collector_)) {
+        *out++ = *it;
+      }
+    }
+    cleared_end_ = out;
+  }
+
+  mirror::Reference** GetClearedBegin() const {
+    return begin_;
+  }
+
+  mirror::Reference** GetClearedEnd() const {
+    return cleared_end_;
+  }
+
+ private:
+  collector::GarbageCollector* const collector_;
+  mirror::Reference** const begin_;
+  mirror::Reference** const end_;
+  mirror::Reference** cleared_end_;
+};
+
+void ReferenceProcessor::ClearWhiteReferences(std::initializer_list<ReferenceQueue*> queues,
+                                              size_t thread_count,
+                                              collector::GarbageCollector* collector) {
+  size_t num_references = 0;
+  if (thread_count > 1) {
+    for (ReferenceQueue* queue : queues) {
+      num_references += queue->GetLength();
+    }
+  }
+  if (num_references < 2 * kMinReferencesPerThread) {
+    for (ReferenceQueue* queue : queues) {
+      queue->ClearWhiteReferences(&cleared_references_, collector);
+    }
+    return;
+  }
+  // The queues are linked through the references, so they can't be split in place. Dequeue all
+  // the references, which also lets the concurrent copying collector fix up their colors on the
+  // GC thread, and shard the resulting array.
+  std::vector<mirror::Reference*> references;
+  references.reserve(num_references);
+  for (ReferenceQueue* queue : queues) {
+    while (!queue->IsEmpty()) {
+      references.push_back(queue->DequeuePendingReference());
+    }
+  }
+  thread_count = std::min(thread_count, num_references / kMinReferencesPerThread);
+  Thread* self = Thread::Current();
+  ThreadPool* thread_pool = Runtime::Current()->GetHeap()->GetThreadPool();
+  std::vector<std::unique_ptr<ClearWhiteReferencesTask>> tasks;
+  const size_t shard_size = RoundUp(num_references, thread_count) / thread_count;
+  for (size_t begin = 0; begin < num_references; begin += shard_size) {
+    const size_t end = std::min(begin + shard_size, num_references);
+    tasks.emplace_back(new ClearWhiteReferencesTask(collector,
+                                                    references.data() + begin,
+                                                    references.data() + end));
+    thread_pool->AddTask(self, tasks.back().get());
+  }
+  thread_pool->SetMaxActiveWorkers(thread_count - 1);
+  thread_pool->StartWorkers(self);
+  thread_pool->Wait(self, true, true);
+  thread_pool->StopWorkers(self);
+  // Enqueueing links the cleared references together, do it on the GC thread.
+  for (const std::unique_ptr<ClearWhiteReferencesTask>& task : tasks) {
+    for (mirror::Reference** it = task->GetClearedBegin(); it != task->GetClearedEnd(); ++it) {
+      cleared_references_.EnqueueReference(*it);
+    }
+  }
+}
+
 // Process the "referent" field in a java.lang.ref.Reference.  If the referent has not yet been
 // marked, put it on the appropriate list in the heap for later processing.
 void ReferenceProcessor::DelayReferenceReferent(mirror::Class* klass, mirror::Reference* ref,
@@ -17,6 +17,8 @@
 #ifndef ART_RUNTIME_GC_REFERENCE_PROCESSOR_H_
 #define ART_RUNTIME_GC_REFERENCE_PROCESSOR_H_
 
+#include <initializer_list>
+
 #include "base/mutex.h"
 #include "globals.h"
 #include "jni.h"
@@ -45,6 +47,10 @@ class Heap;
 // Used to process java.lang.References concurrently or paused.
 class ReferenceProcessor {
  public:
+  // Minimal number of references cleared by each thread, below which sharding them between the
+  // heap thread pool workers does not pay for the task overhead.
+  static constexpr size_t kMinReferencesPerThread = 1024;
+
   explicit ReferenceProcessor();
   void ProcessReferences(bool concurrent, TimingLogger* timings, bool clear_soft_references,
                          gc::collector::GarbageCollector* collector)
@@ -81,6 +87,14 @@ class ReferenceProcessor {
   // referents.
   void StartPreservingReferences(Thread* self) REQUIRES(!Locks::reference_processor_lock_);
   void StopPreservingReferences(Thread* self) REQUIRES(!Locks::reference_processor_lock_);
+  // Number of threads, including the GC thread, clearing white references.
+  size_t GetThreadCount(bool concurrent) const;
+  // Clear the references of `queues` with white referents, sharding the references of all the
+  // queues between `thread_count` threads when there are enough of them.
+  void ClearWhiteReferences(std::initializer_list<ReferenceQueue*> queues,
+                            size_t thread_count,
+                            collector::GarbageCollector* collector)
+      SHARED_REQUIRES(Locks::mutator_lock_);
   // Collector which is clearing references, used by the GetReferent to return referents which are
   // already marked.
   collector::GarbageCollector* collector_ GUARDED_BY(Locks::reference_processor_lock_);
@@ -82,6 +82,12 @@ class ReferenceQueue {
                             collector::GarbageCollector* collector)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Clears the referent of a dequeued reference if it is white. Returns true if it was cleared, in
+  // which case the reference needs to be enqueued on the cleared references. Only reads the
+  // marking state and writes `ref`, so it can be called on different references in parallel.
+  static bool ClearWhiteReferent(mirror::Reference* ref, collector::GarbageCollector* collector)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
   void Dump(std::ostream& os) const SHARED_REQUIRES(Locks::mutator_lock_);
   size_t GetLength() const SHARED_REQUIRES(Locks::mutator_lock_);
 
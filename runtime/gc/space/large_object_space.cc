@@ -582,7 +582,7 @@ void LargeObjectSpace::SweepCallback(size_t num_ptrs, mirror::Object** ptrs, voi
   SweepCallbackContext* context = static_cast<SweepCallbackContext*>(arg);
   space::LargeObjectSpace* space = context->space->AsLargeObjectSpace();
   Thread* self = context->self;
-  Locks::heap_bitmap_lock_->AssertExclusiveHeld(self);
+  Locks::heap_bitmap_lock_->AssertExclusiveHeld(context->gc_self);
   // If the bitmaps aren't swapped we need to clear the bits since the GC isn't going to re-swap
   // the bitmaps as an optimization.
   if (!context->swap_bitmaps) {
@@ -596,19 +596,42 @@ void LargeObjectSpace::SweepCallback(size_t num_ptrs, mirror::Object** ptrs, voi
 }
 
 collector::ObjectBytePair LargeObjectSpace::Sweep(bool swap_bitmaps) {
-  if (Begin() >= End()) {
-    return collector::ObjectBytePair(0, 0);
+  AllocSpace::SweepCallbackContext scc(swap_bitmaps, this);
+  SweepRange(&scc, Begin(), End());
+  return scc.freed;
+}
+
+collector::ObjectBytePair LargeObjectSpace::SweepRange(bool swap_bitmaps,
+                                                       uint8_t* begin,
+                                                       uint8_t* end,
+                                                       Thread* self,
+                                                       Thread* gc_self) {
+  AllocSpace::SweepCallbackContext scc(swap_bitmaps, this, self, gc_self);
+  SweepRange(&scc, begin, end);
+  return scc.freed;
+}
+
+void LargeObjectSpace::SweepRange(SweepCallbackContext* scc, uint8_t* begin, uint8_t* end) {
+  if (begin >= end) {
+    return;
   }
   accounting::LargeObjectBitmap* live_bitmap = GetLiveBitmap();
   accounting::LargeObjectBitmap* mark_bitmap = GetMarkBitmap();
-  if (swap_bitmaps) {
+  if (scc->swap_bitmaps) {
     std::swap(live_bitmap, mark_bitmap);
   }
-  AllocSpace::SweepCallbackContext scc(swap_bitmaps, this);
   accounting::LargeObjectBitmap::SweepWalk(*live_bitmap, *mark_bitmap,
-                                           reinterpret_cast<uintptr_t>(Begin()),
-                                           reinterpret_cast<uintptr_t>(End()), SweepCallback, &scc);
-  return scc.freed;
+                                           reinterpret_cast<uintptr_t>(begin),
+                                           reinterpret_cast<uintptr_t>(end), SweepCallback, scc);
+}
+
+uint8_t* LargeObjectSpace::RoundUpToSweepBoundary(uint8_t* addr) const {
+  // The live bitmap bits are cleared with non-atomic word writes, so the ranges swept in parallel
+  // must not share bitmap words.
+  static constexpr size_t kBitmapWordCoverage = kLargeObjectAlignment * kBitsPerIntPtrT;
+  const uintptr_t heap_begin = GetLiveBitmap()->HeapBegin();
+  return reinterpret_cast<uint8_t*>(
+      heap_begin + RoundUp(reinterpret_cast<uintptr_t>(addr) - heap_begin, kBitmapWordCoverage));
 }
 
 void LargeObjectSpace::LogFragmentationAllocFailure(std::ostream& /*os*/,
@@ -75,6 +75,16 @@ class LargeObjectSpace : public DiscontinuousSpace, public AllocSpace {
     return this;
   }
   collector::ObjectBytePair Sweep(bool swap_bitmaps);
+  // Sweep the objects in [begin, end) on `self`, a worker of a parallel sweep run by `gc_self`.
+  // The range boundaries must come from RoundUpToSweepBoundary().
+  collector::ObjectBytePair SweepRange(bool swap_bitmaps,
+                                       uint8_t* begin,
+                                       uint8_t* end,
+                                       Thread* self,
+                                       Thread* gc_self);
+  // Returns `addr` rounded up to a boundary for splitting the space into ranges to sweep in
+  // parallel.
+  uint8_t* RoundUpToSweepBoundary(uint8_t* addr) const;
   virtual bool CanMoveObjects() const OVERRIDE {
     return false;
   }
@@ -107,6 +117,7 @@ class LargeObjectSpace : public DiscontinuousSpace, public AllocSpace {
  protected:
   explicit LargeObjectSpace(const std::string& name, uint8_t* begin, uint8_t* end);
   static void SweepCallback(size_t num_ptrs, mirror::Object** ptrs, void* arg);
+  void SweepRange(SweepCallbackContext* scc, uint8_t* begin, uint8_t* end);
 
   // Approximate number of bytes which have been allocated into the space.
   uint64_t num_bytes_allocated_;
@@ -232,7 +232,7 @@ void MallocSpace::SweepCallback(size_t num_ptrs, mirror::Object** ptrs, void* ar
   SweepCallbackContext* context = static_cast<SweepCallbackContext*>(arg);
   space::MallocSpace* space = context->space->AsMallocSpace();
   Thread* self = context->self;
-  Locks::heap_bitmap_lock_->AssertExclusiveHeld(self);
+  Locks::heap_bitmap_lock_->AssertExclusiveHeld(context->gc_self);
   // If the bitmaps aren't swapped we need to clear the bits since the GC isn't going to re-swap
   // the bitmaps as an optimization.
   if (!context->swap_bitmaps) {
@@ -245,7 +245,9 @@ void MallocSpace::SweepCallback(size_t num_ptrs, mirror::Object** ptrs, void* ar
   // Documentation suggests better free performance with merging, but this may be at the expensive
   // of allocation.
   context->freed.objects += num_ptrs;
-  context->freed.bytes += space->FreeList(self, num_ptrs, ptrs);
+  context->freed.bytes += context->parallel
+      ? space->FreeListInParallelSweep(self, num_ptrs, ptrs)
+      : space->FreeList(self, num_ptrs, ptrs);
 }
 
 void MallocSpace::ClampGrowthLimit() {
@@ -66,6 +66,12 @@ class MallocSpace : public ContinuousMemMapAllocSpace {
       SHARED_REQUIRES(Locks::mutator_lock_) = 0;
   virtual size_t FreeList(Thread* self, size_t num_ptrs, mirror::Object** ptrs)
       SHARED_REQUIRES(Locks::mutator_lock_) = 0;
+  // Like FreeList(), for the parallel sweeping of the space. Other threads may be freeing the
+  // objects of other ranges of the space at the same time.
+  virtual size_t FreeListInParallelSweep(Thread* self, size_t num_ptrs, mirror::Object** ptrs)
+      SHARED_REQUIRES(Locks::mutator_lock_) {
+    return FreeList(self, num_ptrs, ptrs);
+  }
 
   // Returns the maximum bytes that could be allocated for the given
   // size in bulk, that is the maximum value for the
@@ -19,6 +19,11 @@
 
 #include "region_space.h"
 
+#include <algorithm>
+
+#include "gc/accounting/card_table-inl.h"
+#include "gc/accounting/space_bitmap-inl.h"
+
 namespace art {
 namespace gc {
 namespace space {
@@ -92,6 +97,7 @@ inline mirror::Object* RegionSpace::AllocNonvirtual(size_t num_bytes, size_t* by
         Region* r = &regions_[i];
         if (r->IsFree()) {
           r->Unfree(time_);
+          r->is_evac_ = true;
           ++num_non_free_regions_;
           obj = r->Alloc(num_bytes, bytes_allocated, usable_size, bytes_tl_bulk_allocated);
           CHECK(obj != nullptr);
@@ -235,11 +241,18 @@ void RegionSpace::WalkInternal(ObjectCallback* callback, void* arg) {
     }
     if (r->IsLarge()) {
       mirror::Object* obj = reinterpret_cast<mirror::Object*>(r->Begin());
-      if (obj->GetClass() != nullptr) {
+      if (obj->GetClass() != nullptr && (!r->IsKept() || mark_bitmap_->Test(obj))) {
         callback(obj, arg);
       }
     } else if (r->IsLargeTail()) {
       // Do nothing.
+    } else if (r->IsKept()) {
+      // The dead objects of the region may refer to classes that have been freed since.
+      mark_bitmap_->VisitMarkedRange(reinterpret_cast<uintptr_t>(r->Begin()),
+                                     reinterpret_cast<uintptr_t>(r->Top()),
+                                     [callback, arg](mirror::Object* obj) {
+        callback(obj, arg);
+      });
     } else {
       uint8_t* pos = r->Begin();
       uint8_t* top = r->Top();
@@ -256,6 +269,55 @@ void RegionSpace::WalkInternal(ObjectCallback* callback, void* arg) {
   }
 }
 
+template <typename Visitor>
+void RegionSpace::ScanAndClearCards(accounting::CardTable* card_table,
+                                    const Visitor& visitor,
+                                    uint8_t minimum_age) {
+  Locks::mutator_lock_->AssertExclusiveHeld(Thread::Current());
+  MutexLock mu(Thread::Current(), region_lock_);
+  auto is_old_enough = [minimum_age](uint8_t card) { return card >= minimum_age; };
+  for (size_t i = 0; i < num_regions_; ++i) {
+    Region* r = &regions_[i];
+    if (r->IsFree()) {
+      continue;
+    }
+    uint8_t* card_begin = card_table->CardFromAddr(r->Begin());
+    uint8_t* card_end = card_table->CardFromAddr(r->End());
+    if (r->IsInToSpace() && !r->IsLargeTail() &&
+        std::any_of(card_begin, card_end, is_old_enough)) {
+      // Objects mark the card of their first byte when their fields are written.
+      if (r->IsKept()) {
+        // The region may hold dead objects, whose classes and referents may have been freed.
+        // Only visit the objects the last full collection marked.
+        card_table->Scan<false>(mark_bitmap_.get(),
+                                r->Begin(),
+                                r->IsLarge() ? r->End() : r->Top(),
+                                visitor,
+                                minimum_age);
+      } else if (r->IsLarge()) {
+        mirror::Object* obj = reinterpret_cast<mirror::Object*>(r->Begin());
+        if (is_old_enough(*card_begin) && obj->GetClass() != nullptr) {
+          visitor(obj);
+        }
+      } else {
+        uint8_t* pos = r->Begin();
+        uint8_t* top = r->Top();
+        while (pos < top) {
+          mirror::Object* obj = reinterpret_cast<mirror::Object*>(pos);
+          if (obj->GetClass<kDefaultVerifyFlags, kWithoutReadBarrier>() == nullptr) {
+            break;
+          }
+          if (is_old_enough(*card_table->CardFromAddr(obj))) {
+            visitor(obj);
+          }
+          pos = reinterpret_cast<uint8_t*>(GetNextObject(obj));
+        }
+      }
+    }
+    std::fill(card_begin, card_end, accounting::CardTable::kCardClean);
+  }
+}
+
 inline mirror::Object* RegionSpace::GetNextObject(mirror::Object* obj) {
   const uintptr_t position = reinterpret_cast<uintptr_t>(obj) + obj->SizeOf();
   return reinterpret_cast<mirror::Object*>(RoundUp(position, kAlignment));
@@ -299,12 +361,14 @@ mirror::Object* RegionSpace::AllocLarge(size_t num_bytes, size_t* bytes_allocate
       Region* first_reg = &regions_[left];
       DCHECK(first_reg->IsFree());
       first_reg->UnfreeLarge(time_);
+      first_reg->is_evac_ = kForEvac;
       ++num_non_free_regions_;
       first_reg->SetTop(first_reg->Begin() + num_bytes);
       for (size_t p = left + 1; p < right; ++p) {
         DCHECK_LT(p, num_regions_);
         DCHECK(regions_[p].IsFree());
         regions_[p].UnfreeLargeTail(time_);
+        regions_[p].is_evac_ = kForEvac;
         ++num_non_free_regions_;
       }
       *bytes_allocated = num_bytes;
@@ -70,6 +70,9 @@ RegionSpace::RegionSpace(const std::string& name, MemMap* mem_map)
     }
     CHECK_EQ(regions_[num_regions_ - 1].End(), Limit());
   }
+  mark_bitmap_.reset(
+      accounting::ContinuousSpaceBitmap::Create("region space mark bitmap", Begin(), Capacity()));
+  CHECK(mark_bitmap_.get() != nullptr) << "Failed to create the region space mark bitmap";
   full_region_ = Region();
   DCHECK(!full_region_.IsFree());
   DCHECK(full_region_.IsAllocated());
@@ -144,8 +147,13 @@ inline bool RegionSpace::Region::ShouldBeEvacuated() {
 }
 
 // Determine which regions to evacuate and mark them as
-// from-space. Mark the rest as unevacuated from-space.
-void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool force_evacuate_all) {
+// from-space. Mark the rest as unevacuated from-space, or leave them
+// in the to-space in a young collection.
+void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table,
+                               bool force_evacuate_all,
+                               bool young_gen) {
+  DCHECK(!young_gen || !kUseTableLookupReadBarrier);
+  const uint32_t young_time = time_;
   ++time_;
   if (kUseTableLookupReadBarrier) {
     DCHECK(rb_table->IsAllCleared());
@@ -160,15 +168,23 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool forc
     RegionType type = r->Type();
     if (!r->IsFree()) {
       DCHECK(r->IsInToSpace());
+      if (!young_gen && r->IsKept()) {
+        // The region is either evacuated or marked again by this collection.
+        mark_bitmap_->ClearRange(reinterpret_cast<mirror::Object*>(r->Begin()),
+                                 reinterpret_cast<mirror::Object*>(r->IsAllocated() ? r->Top()
+                                                                                    : r->End()));
+      }
       if (LIKELY(num_expected_large_tails == 0U)) {
         DCHECK((state == RegionState::kRegionStateAllocated ||
                 state == RegionState::kRegionStateLarge) &&
                type == RegionType::kRegionTypeToSpace);
-        bool should_evacuate = force_evacuate_all || r->ShouldBeEvacuated();
+        bool should_evacuate = young_gen
+            ? r->IsYoung(young_time)
+            : force_evacuate_all || r->ShouldBeEvacuated();
         if (should_evacuate) {
           r->SetAsFromSpace();
           DCHECK(r->IsInFromSpace());
-        } else {
+        } else if (!young_gen) {
           r->SetAsUnevacFromSpace();
           DCHECK(r->IsInUnevacFromSpace());
         }
@@ -184,7 +200,7 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool forc
         if (prev_large_evacuated) {
           r->SetAsFromSpace();
           DCHECK(r->IsInFromSpace());
-        } else {
+        } else if (!young_gen) {
           r->SetAsUnevacFromSpace();
           DCHECK(r->IsInUnevacFromSpace());
         }
@@ -202,17 +218,39 @@ void RegionSpace::SetFromSpace(accounting::ReadBarrierTable* rb_table, bool forc
   evac_region_ = &full_region_;
 }
 
+void RegionSpace::ZeroAndReleasePages(void* address, size_t length) {
+  if (!kMadviseZeroes) {
+    memset(address, 0, length);
+  }
+  // The kernel hands out fresh zero pages on the next touch, which is cheaper than zeroing the
+  // pages in place for the whole regions that are cleared here.
+  CHECK_NE(madvise(address, length, MADV_DONTNEED), -1) << "madvise failed";
+}
+
 void RegionSpace::ClearFromSpace() {
   MutexLock mu(Thread::Current(), region_lock_);
+  // Release the pages of adjacent from-space regions with a single madvise call.
+  uint8_t* clear_block_begin = nullptr;
+  uint8_t* clear_block_end = nullptr;
   for (size_t i = 0; i < num_regions_; ++i) {
     Region* r = &regions_[i];
     if (r->IsInFromSpace()) {
-      r->Clear();
+      if (r->Begin() != clear_block_end) {
+        if (clear_block_begin != nullptr) {
+          ZeroAndReleasePages(clear_block_begin, clear_block_end - clear_block_begin);
+        }
+        clear_block_begin = r->Begin();
+      }
+      clear_block_end = r->End();
+      r->Clear(/*zero_and_release_pages*/false);
       --num_non_free_regions_;
     } else if (r->IsInUnevacFromSpace()) {
       r->SetUnevacFromSpaceAsToSpace();
     }
   }
+  if (clear_block_begin != nullptr) {
+    ZeroAndReleasePages(clear_block_begin, clear_block_end - clear_block_begin);
+  }
   evac_region_ = nullptr;
 }
 
@@ -274,8 +312,10 @@ void RegionSpace::Clear() {
     if (!r->IsFree()) {
       --num_non_free_regions_;
     }
-    r->Clear();
+    r->Clear(/*zero_and_release_pages*/false);
   }
+  ZeroAndReleasePages(Begin(), Limit() - Begin());
+  mark_bitmap_->Clear();
   current_region_ = &full_region_;
   evac_region_ = &full_region_;
 }
@@ -299,7 +339,7 @@ void RegionSpace::FreeLarge(mirror::Object* large_obj, size_t bytes_allocated) {
     } else {
       DCHECK(reg->IsLargeTail());
     }
-    reg->Clear();
+    reg->Clear(/*zero_and_release_pages*/true);
     --num_non_free_regions_;
   }
   if (end_addr < Limit()) {
@@ -413,7 +453,8 @@ void RegionSpace::Region::Dump(std::ostream& os) const {
      << " state=" << static_cast<uint>(state_) << " type=" << static_cast<uint>(type_)
      << " objects_allocated=" << objects_allocated_
      << " alloc_time=" << alloc_time_ << " live_bytes=" << live_bytes_
-     << " is_newly_allocated=" << is_newly_allocated_ << " is_a_tlab=" << is_a_tlab_ << " thread=" << thread_ << "\n";
+     << " is_newly_allocated=" << is_newly_allocated_ << " is_evac=" << is_evac_
+     << " is_a_tlab=" << is_a_tlab_ << " thread=" << thread_ << "\n";
 }
 
 }  // namespace space
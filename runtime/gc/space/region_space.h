@@ -24,6 +24,11 @@
 
 namespace art {
 namespace gc {
+
+namespace accounting {
+class CardTable;
+}  // namespace accounting
+
 namespace space {
 
 // A space that consists of equal-sized regions.
@@ -202,9 +207,21 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     return RegionType::kRegionTypeNone;
   }
 
-  void SetFromSpace(accounting::ReadBarrierTable* rb_table, bool force_evacuate_all)
+  // Determine which regions to evacuate. In a young collection (`young_gen`), only the regions
+  // mutators allocated since the last collection are evacuated and the others are left in the
+  // to-space.
+  void SetFromSpace(accounting::ReadBarrierTable* rb_table, bool force_evacuate_all,
+                    bool young_gen)
       REQUIRES(!region_lock_);
 
+  // Visit the objects of the to-space regions that start on a card at least `minimum_age` and
+  // clear the cards of all the non-free regions. In the regions kept by the last full collection,
+  // only the objects it marked are visited. Called in the pause after SetFromSpace().
+  template <typename Visitor>
+  void ScanAndClearCards(accounting::CardTable* card_table, const Visitor& visitor,
+                         uint8_t minimum_age)
+      REQUIRES(Locks::mutator_lock_) REQUIRES(!region_lock_);
+
   size_t FromSpaceSize() REQUIRES(!region_lock_);
   size_t UnevacFromSpaceSize() REQUIRES(!region_lock_);
   size_t ToSpaceSize() REQUIRES(!region_lock_);
@@ -217,6 +234,13 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
 
   void AssertAllRegionLiveBytesZeroOrCleared() REQUIRES(!region_lock_);
 
+  // The bitmap the concurrent copying collector marks the objects of the unevacuated regions in.
+  // The marks outlive the collection: the regions it kept may hold dead objects, and only the
+  // marked ones are live.
+  accounting::ContinuousSpaceBitmap* GetRegionMarkBitmap() const {
+    return mark_bitmap_.get();
+  }
+
   void RecordAlloc(mirror::Object* ref) REQUIRES(!region_lock_);
   bool AllocNewTlab(Thread* self) REQUIRES(!region_lock_);
 
@@ -227,6 +251,9 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
  private:
   RegionSpace(const std::string& name, MemMap* mem_map);
 
+  // Zero the pages in the range and give them back to the kernel.
+  static void ZeroAndReleasePages(void* address, size_t length);
+
   template<bool kToSpaceOnly>
   void WalkInternal(ObjectCallback* callback, void* arg) NO_THREAD_SAFETY_ANALYSIS;
 
@@ -237,13 +264,13 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
           begin_(nullptr), top_(nullptr), end_(nullptr),
           state_(RegionState::kRegionStateAllocated), type_(RegionType::kRegionTypeToSpace),
           objects_allocated_(0), alloc_time_(0), live_bytes_(static_cast<size_t>(-1)),
-          is_newly_allocated_(false), is_a_tlab_(false), thread_(nullptr) {}
+          is_newly_allocated_(false), is_evac_(false), is_a_tlab_(false), thread_(nullptr) {}
 
     Region(size_t idx, uint8_t* begin, uint8_t* end)
         : idx_(idx), begin_(begin), top_(begin), end_(end),
           state_(RegionState::kRegionStateFree), type_(RegionType::kRegionTypeNone),
           objects_allocated_(0), alloc_time_(0), live_bytes_(static_cast<size_t>(-1)),
-          is_newly_allocated_(false), is_a_tlab_(false), thread_(nullptr) {
+          is_newly_allocated_(false), is_evac_(false), is_a_tlab_(false), thread_(nullptr) {
       DCHECK_LT(begin, end);
       DCHECK_EQ(static_cast<size_t>(end - begin), kRegionSize);
     }
@@ -256,18 +283,20 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
       return type_;
     }
 
-    void Clear() {
+    // Reset the region to free. Unless `zero_and_release_pages` is false, in which case the caller
+    // is responsible for it, the pages of the region are zeroed and released.
+    void Clear(bool zero_and_release_pages) {
       top_ = begin_;
       state_ = RegionState::kRegionStateFree;
       type_ = RegionType::kRegionTypeNone;
       objects_allocated_ = 0;
       alloc_time_ = 0;
       live_bytes_ = static_cast<size_t>(-1);
-      if (!kMadviseZeroes) {
-        memset(begin_, 0, end_ - begin_);
+      if (zero_and_release_pages) {
+        ZeroAndReleasePages(begin_, end_ - begin_);
       }
-      madvise(begin_, end_ - begin_, MADV_DONTNEED);
       is_newly_allocated_ = false;
+      is_evac_ = false;
       is_a_tlab_ = false;
       thread_ = nullptr;
     }
@@ -312,6 +341,12 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
       is_newly_allocated_ = true;
     }
 
+    // Young regions were allocated by mutators since the last flip at `time`. The regions the
+    // collector evacuates objects into hold survivors and are old.
+    bool IsYoung(uint32_t time) const {
+      return alloc_time_ == time && !is_evac_;
+    }
+
     // Non-large, non-large-tail allocated.
     bool IsAllocated() const {
       return state_ == RegionState::kRegionStateAllocated;
@@ -372,6 +407,12 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
       type_ = RegionType::kRegionTypeToSpace;
     }
 
+    // Whether the last full collection kept the region instead of evacuating it. The live objects
+    // of such a region are the ones marked in the region mark bitmap.
+    bool IsKept() const {
+      return IsInToSpace() && live_bytes_ != static_cast<size_t>(-1);
+    }
+
     ALWAYS_INLINE bool ShouldBeEvacuated();
 
     void AddLiveBytes(size_t live_bytes) {
@@ -472,6 +513,7 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
     uint32_t alloc_time_;          // The allocation time of the region.
     size_t live_bytes_;            // The live bytes. Used to compute the live percent.
     bool is_newly_allocated_;      // True if it's allocated after the last collection.
+    bool is_evac_;                 // True if it's allocated to evacuate objects into.
     bool is_a_tlab_;               // True if it's a tlab.
     Thread* thread_;               // The owning thread if it's a tlab.
 
@@ -518,6 +560,8 @@ class RegionSpace FINAL : public ContinuousMemMapAllocSpace {
   Region* current_region_;         // The region that's being allocated currently.
   Region* evac_region_;            // The region that's being evacuated to currently.
   Region full_region_;             // The dummy/sentinel region that looks full.
+  // The marks of the objects of the unevacuated and kept regions.
+  std::unique_ptr<accounting::ContinuousSpaceBitmap> mark_bitmap_;
 
   DISALLOW_COPY_AND_ASSIGN(RegionSpace);
 };
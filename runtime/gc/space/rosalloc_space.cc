@@ -201,6 +201,21 @@ size_t RosAllocSpace::Free(Thread* self, mirror::Object* ptr) {
 }
 
 size_t RosAllocSpace::FreeList(Thread* self, size_t num_ptrs, mirror::Object** ptrs) {
+  return FreeListInternal(self, num_ptrs, ptrs, /* disjoint_runs */ false);
+}
+
+size_t RosAllocSpace::FreeListInParallelSweep(Thread* self,
+                                              size_t num_ptrs,
+                                              mirror::Object** ptrs) {
+  // The parallel sweep splits the space at RoundUpToSweepBoundary(), so the objects freed by the
+  // different threads are in different runs.
+  return FreeListInternal(self, num_ptrs, ptrs, /* disjoint_runs */ true);
+}
+
+size_t RosAllocSpace::FreeListInternal(Thread* self,
+                                       size_t num_ptrs,
+                                       mirror::Object** ptrs,
+                                       bool disjoint_runs) {
   DCHECK(ptrs != nullptr);
 
   size_t verify_bytes = 0;
@@ -234,7 +249,9 @@ size_t RosAllocSpace::FreeList(Thread* self, size_t num_ptrs, mirror::Object** p
     CHECK_EQ(num_broken_ptrs, 0u);
   }
 
-  const size_t bytes_freed = rosalloc_->BulkFree(self, reinterpret_cast<void**>(ptrs), num_ptrs);
+  const size_t bytes_freed = disjoint_runs
+      ? rosalloc_->BulkFreeDisjoint(self, reinterpret_cast<void**>(ptrs), num_ptrs)
+      : rosalloc_->BulkFree(self, reinterpret_cast<void**>(ptrs), num_ptrs);
   if (kVerifyFreedBytes) {
     CHECK_EQ(verify_bytes, bytes_freed);
   }
@@ -67,6 +67,8 @@ class RosAllocSpace : public MallocSpace {
       SHARED_REQUIRES(Locks::mutator_lock_);
   size_t FreeList(Thread* self, size_t num_ptrs, mirror::Object** ptrs) OVERRIDE
       SHARED_REQUIRES(Locks::mutator_lock_);
+  size_t FreeListInParallelSweep(Thread* self, size_t num_ptrs, mirror::Object** ptrs) OVERRIDE
+      SHARED_REQUIRES(Locks::mutator_lock_);
 
   mirror::Object* AllocNonvirtual(Thread* self, size_t num_bytes, size_t* bytes_allocated,
                                   size_t* usable_size, size_t* bytes_tl_bulk_allocated) {
@@ -146,6 +148,22 @@ class RosAllocSpace : public MallocSpace {
 
   void DumpStats(std::ostream& os);
 
+  void DumpBracketHistogram(std::ostream& os) {
+    rosalloc_->DumpBracketHistogram(os);
+  }
+
+  void EstimateFragmentation(size_t* run_bytes,
+                             size_t* free_run_bytes,
+                             size_t* large_object_bytes) {
+    rosalloc_->EstimateFragmentation(run_bytes, free_run_bytes, large_object_bytes);
+  }
+
+  // Returns `addr` rounded up to a boundary for splitting the space into ranges to sweep in
+  // parallel. The ranges do not share runs, so their objects can be freed concurrently.
+  uint8_t* RoundUpToSweepBoundary(uint8_t* addr) {
+    return rosalloc_->RoundUpToRunBoundary(addr);
+  }
+
  protected:
   RosAllocSpace(MemMap* mem_map, size_t initial_size, const std::string& name,
                 allocator::RosAlloc* rosalloc, uint8_t* begin, uint8_t* end, uint8_t* limit,
@@ -153,6 +171,9 @@ class RosAllocSpace : public MallocSpace {
                 bool low_memory_mode);
 
  private:
+  size_t FreeListInternal(Thread* self, size_t num_ptrs, mirror::Object** ptrs, bool disjoint_runs)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
   template<bool kThreadSafe = true>
   mirror::Object* AllocCommon(Thread* self, size_t num_bytes, size_t* bytes_allocated,
                               size_t* usable_size, size_t* bytes_tl_bulk_allocated);
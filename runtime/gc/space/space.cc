@@ -87,21 +87,39 @@ DiscontinuousSpace::DiscontinuousSpace(const std::string& name,
 }
 
 collector::ObjectBytePair ContinuousMemMapAllocSpace::Sweep(bool swap_bitmaps) {
+  SweepCallbackContext scc(swap_bitmaps, this);
+  SweepRange(&scc, Begin(), End());
+  return scc.freed;
+}
+
+collector::ObjectBytePair ContinuousMemMapAllocSpace::SweepRange(bool swap_bitmaps,
+                                                                 uint8_t* begin,
+                                                                 uint8_t* end,
+                                                                 Thread* self,
+                                                                 Thread* gc_self) {
+  DCHECK_LE(Begin(), begin);
+  DCHECK_LE(end, End());
+  SweepCallbackContext scc(swap_bitmaps, this, self, gc_self);
+  SweepRange(&scc, begin, end);
+  return scc.freed;
+}
+
+void ContinuousMemMapAllocSpace::SweepRange(SweepCallbackContext* scc,
+                                            uint8_t* begin,
+                                            uint8_t* end) {
   accounting::ContinuousSpaceBitmap* live_bitmap = GetLiveBitmap();
   accounting::ContinuousSpaceBitmap* mark_bitmap = GetMarkBitmap();
   // If the bitmaps are bound then sweeping this space clearly won't do anything.
   if (live_bitmap == mark_bitmap) {
-    return collector::ObjectBytePair(0, 0);
+    return;
   }
-  SweepCallbackContext scc(swap_bitmaps, this);
-  if (swap_bitmaps) {
+  if (scc->swap_bitmaps) {
     std::swap(live_bitmap, mark_bitmap);
   }
   // Bitmaps are pre-swapped for optimization which enables sweeping with the heap unlocked.
   accounting::ContinuousSpaceBitmap::SweepWalk(
-      *live_bitmap, *mark_bitmap, reinterpret_cast<uintptr_t>(Begin()),
-      reinterpret_cast<uintptr_t>(End()), GetSweepCallback(), reinterpret_cast<void*>(&scc));
-  return scc.freed;
+      *live_bitmap, *mark_bitmap, reinterpret_cast<uintptr_t>(begin),
+      reinterpret_cast<uintptr_t>(end), GetSweepCallback(), reinterpret_cast<void*>(scc));
 }
 
 // Returns the old mark bitmap.
@@ -139,7 +157,22 @@ void ContinuousMemMapAllocSpace::SwapBitmaps() {
 }
 
 AllocSpace::SweepCallbackContext::SweepCallbackContext(bool swap_bitmaps_in, space::Space* space_in)
-    : swap_bitmaps(swap_bitmaps_in), space(space_in), self(Thread::Current()) {
+    : swap_bitmaps(swap_bitmaps_in),
+      space(space_in),
+      self(Thread::Current()),
+      gc_self(self),
+      parallel(false) {
+}
+
+AllocSpace::SweepCallbackContext::SweepCallbackContext(bool swap_bitmaps_in,
+                                                       space::Space* space_in,
+                                                       Thread* self_in,
+                                                       Thread* gc_self_in)
+    : swap_bitmaps(swap_bitmaps_in),
+      space(space_in),
+      self(self_in),
+      gc_self(gc_self_in),
+      parallel(true) {
 }
 
 }  // namespace space
@@ -249,9 +249,15 @@ class AllocSpace {
  protected:
   struct SweepCallbackContext {
     SweepCallbackContext(bool swap_bitmaps, space::Space* space);
+    // For sweeping a range of the space on `self`, concurrently with other threads sweeping the
+    // other ranges, while `gc_self` holds the heap bitmap lock.
+    SweepCallbackContext(bool swap_bitmaps, space::Space* space, Thread* self, Thread* gc_self);
     const bool swap_bitmaps;
     space::Space* const space;
     Thread* const self;
+    // The thread holding the heap bitmap lock, `self` unless the sweep is parallel.
+    Thread* const gc_self;
+    const bool parallel;
     collector::ObjectBytePair freed;
   };
 
@@ -438,9 +444,19 @@ class ContinuousMemMapAllocSpace : public MemMapSpace, public AllocSpace {
   }
 
   collector::ObjectBytePair Sweep(bool swap_bitmaps);
+  // Sweep the objects in [begin, end) on `self`, a worker of a parallel sweep of the space run by
+  // `gc_self`. The ranges swept at the same time must not share allocator state other than what
+  // the allocator locks, see RosAllocSpace::RoundUpToSweepBoundary().
+  collector::ObjectBytePair SweepRange(bool swap_bitmaps,
+                                       uint8_t* begin,
+                                       uint8_t* end,
+                                       Thread* self,
+                                       Thread* gc_self);
   virtual accounting::ContinuousSpaceBitmap::SweepCallback* GetSweepCallback() = 0;
 
  protected:
+  void SweepRange(SweepCallbackContext* scc, uint8_t* begin, uint8_t* end);
+
   std::unique_ptr<accounting::ContinuousSpaceBitmap> live_bitmap_;
   std::unique_ptr<accounting::ContinuousSpaceBitmap> mark_bitmap_;
   std::unique_ptr<accounting::ContinuousSpaceBitmap> temp_bitmap_;
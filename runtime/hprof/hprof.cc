@@ -27,17 +27,22 @@
 #include <cutils/open_memstream.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <signal.h>
 #include <stdio.h>
 #include <string.h>
 #include <sys/time.h>
 #include <sys/uio.h>
+#include <sys/wait.h>
 #include <time.h>
 #include <time.h>
 #include <unistd.h>
+#include <zlib.h>
 
+#include <algorithm>
 #include <set>
 
 #include "art_field-inl.h"
+#include "atomic.h"
 #include "base/logging.h"
 #include "base/stringprintf.h"
 #include "base/time_utils.h"
@@ -74,6 +79,14 @@ static constexpr uint32_t kHprofNullThread = 0;
 static constexpr size_t kMaxObjectsPerSegment = 128;
 static constexpr size_t kMaxBytesPerSegment = 4096;
 
+// Records written to a file are accumulated, and compressed if requested, until there is that much
+// data to write.
+static constexpr size_t kFileWriteBufferSize = 1 * MB;
+static constexpr size_t kDeflateChunkSize = 64 * KB;
+
+// Number of classes listed in the log by a sampled heap dump.
+static constexpr size_t kHistogramClassesToLog = 20;
+
 // The static field-name for the synthetic object generated to account for class static overhead.
 static constexpr const char* kClassOverheadName = "$classOverhead";
 
@@ -366,29 +379,118 @@ class EndianOutputBuffered : public EndianOutput {
   std::vector<uint8_t> buffer_;
 };
 
+// Writes the records to a file, optionally compressed in the gzip format. Call Finish() once all
+// the records are written.
 class FileEndianOutput FINAL : public EndianOutputBuffered {
  public:
-  FileEndianOutput(File* fp, size_t reserved_size)
-      : EndianOutputBuffered(reserved_size), fp_(fp), errors_(false) {
+  FileEndianOutput(File* fp, size_t reserved_size, bool compress)
+      : EndianOutputBuffered(reserved_size), fp_(fp), compress_(compress), errors_(false) {
     DCHECK(fp != nullptr);
+    write_buffer_.reserve(kFileWriteBufferSize + kDeflateChunkSize);
+    if (compress_) {
+      memset(&zstream_, 0, sizeof(zstream_));
+      // Favor speed: the heap is paused while dumping. Add 16 to the window bits for a gzip header.
+      errors_ = deflateInit2(&zstream_, Z_BEST_SPEED, Z_DEFLATED, 15 + 16, 8,
+                             Z_DEFAULT_STRATEGY) != Z_OK;
+    }
   }
   ~FileEndianOutput() {
+    if (compress_) {
+      deflateEnd(&zstream_);
+    }
   }
 
   bool Errors() {
     return errors_;
   }
 
+  // Append data after the records flushed so far.
+  void WriteBytes(const uint8_t* data, size_t length) {
+    if (errors_) {
+      return;
+    }
+    if (compress_) {
+      Deflate(data, length, Z_NO_FLUSH);
+    } else {
+      write_buffer_.insert(write_buffer_.end(), data, data + length);
+    }
+    if (write_buffer_.size() >= kFileWriteBufferSize) {
+      FlushWriteBuffer();
+    }
+  }
+
+  // Write out all the buffered data. Returns false on error.
+  bool Finish() {
+    EndRecord();
+    if (compress_ && !errors_) {
+      Deflate(nullptr, 0, Z_FINISH);
+    }
+    FlushWriteBuffer();
+    return !errors_;
+  }
+
  protected:
   void HandleFlush(const uint8_t* buffer, size_t length) OVERRIDE {
-    if (!errors_) {
-      errors_ = !fp_->WriteFully(buffer, length);
-    }
+    WriteBytes(buffer, length);
   }
 
  private:
+  void Deflate(const uint8_t* data, size_t length, int flush) {
+    zstream_.next_in = const_cast<Bytef*>(data);
+    zstream_.avail_in = length;
+    while (true) {
+      const size_t old_size = write_buffer_.size();
+      write_buffer_.resize(old_size + kDeflateChunkSize);
+      zstream_.next_out = write_buffer_.data() + old_size;
+      zstream_.avail_out = kDeflateChunkSize;
+      int result = deflate(&zstream_, flush);
+      write_buffer_.resize(write_buffer_.size() - zstream_.avail_out);
+      if (result == Z_STREAM_ERROR) {
+        errors_ = true;
+        return;
+      }
+      if (write_buffer_.size() >= kFileWriteBufferSize) {
+        FlushWriteBuffer();
+      }
+      bool done = (flush == Z_FINISH)
+          ? result == Z_STREAM_END
+          : zstream_.avail_in == 0 && zstream_.avail_out != 0;
+      if (done) {
+        return;
+      }
+    }
+  }
+
+  void FlushWriteBuffer() {
+    if (!errors_ && !write_buffer_.empty()) {
+      errors_ = !fp_->WriteFully(write_buffer_.data(), write_buffer_.size());
+    }
+    write_buffer_.clear();
+  }
+
   File* fp_;
+  const bool compress_;
   bool errors_;
+  z_stream zstream_;
+  std::vector<uint8_t> write_buffer_;
+};
+
+// Writes its records to a FileEndianOutput, before the record currently built by that output.
+class ForwardingEndianOutput FINAL : public EndianOutputBuffered {
+ public:
+  explicit ForwardingEndianOutput(FileEndianOutput* target)
+      : EndianOutputBuffered(0), target_(target) {
+    DCHECK(target != nullptr);
+  }
+  ~ForwardingEndianOutput() {}
+
+ protected:
+  void HandleFlush(const uint8_t* buffer, size_t length) OVERRIDE {
+    target_->WriteBytes(buffer, length);
+  }
+
+ private:
+  FileEndianOutput* const target_;
 };
 
 class NetStateEndianOutput FINAL : public EndianOutputBuffered {
@@ -416,14 +518,23 @@ class NetStateEndianOutput FINAL : public EndianOutputBuffered {
 
 class Hprof : public SingleRootVisitor {
  public:
-  Hprof(const char* output_filename, int fd, bool direct_to_ddms)
+  Hprof(const char* output_filename,
+        int fd,
+        bool direct_to_ddms,
+        bool compress,
+        size_t sample_interval,
+        bool in_snapshot_process)
       : filename_(output_filename),
         fd_(fd),
-        direct_to_ddms_(direct_to_ddms) {
+        direct_to_ddms_(direct_to_ddms),
+        streaming_(!direct_to_ddms),
+        compress_(compress && !direct_to_ddms),
+        sample_interval_(sample_interval),
+        in_snapshot_process_(in_snapshot_process) {
     LOG(INFO) << "hprof: heap dump \"" << filename_ << "\" starting...";
   }
 
-  void Dump()
+  bool Dump()
     REQUIRES(Locks::mutator_lock_)
     REQUIRES(!Locks::heap_bitmap_lock_, !Locks::alloc_tracker_lock_) {
     {
@@ -433,27 +544,28 @@ class Hprof : public SingleRootVisitor {
       }
     }
 
-    // First pass to measure the size of the dump.
-    size_t overall_size;
-    size_t max_length;
-    {
-      EndianOutput count_output;
-      output_ = &count_output;
-      ProcessHeap(false);
-      overall_size = count_output.SumLength();
-      max_length = count_output.MaxLength();
-      output_ = nullptr;
-    }
-
     bool okay;
+    size_t overall_size = 0;
     if (direct_to_ddms_) {
+      // First pass to measure the size of the dump, which DDMS needs before the data.
+      size_t max_length;
+      {
+        EndianOutput count_output;
+        output_ = &count_output;
+        ProcessHeap(false);
+        overall_size = count_output.SumLength();
+        max_length = count_output.MaxLength();
+        output_ = nullptr;
+      }
       if (kDirectStream) {
         okay = DumpToDdmsDirect(overall_size, max_length, CHUNK_TYPE("HPDS"));
       } else {
         okay = DumpToDdmsBuffered(overall_size, max_length);
       }
     } else {
-      okay = DumpToFile(overall_size, max_length);
+      // A file is written in a single pass. The string and class records are written as they
+      // are discovered, before the first heap dump segment referring to them.
+      okay = DumpToFile(&overall_size);
     }
 
     if (okay) {
@@ -462,7 +574,11 @@ class Hprof : public SingleRootVisitor {
                 << ") in " << PrettyDuration(duration)
                 << " objects " << total_objects_
                 << " objects with stack traces " << total_objects_with_stack_trace_;
+      if (sample_interval_ != 0) {
+        LogClassHistogram();
+      }
     }
+    return okay;
   }
 
  private:
@@ -490,6 +606,8 @@ class Hprof : public SingleRootVisitor {
     // Reset current heap and object count.
     current_heap_ = HPROF_HEAP_DEFAULT;
     objects_in_segment_ = 0;
+    instances_seen_ = 0;
+    class_histogram_.clear();
 
     if (header_first) {
       ProcessHeader(true);
@@ -510,6 +628,7 @@ class Hprof : public SingleRootVisitor {
     runtime->VisitImageRoots(this);
     runtime->GetHeap()->VisitObjectsPaused(VisitObjectCallback, this);
 
+    WritePendingRecords();
     output_->StartNewRecord(HPROF_TAG_HEAP_DUMP_END, kHprofTime);
     output_->EndRecord();
   }
@@ -517,6 +636,16 @@ class Hprof : public SingleRootVisitor {
   void ProcessHeader(bool string_first) REQUIRES(Locks::mutator_lock_) {
     // Write the header.
     WriteFixedHeader();
+    if (streaming_) {
+      // Nothing has been discovered yet, except for the stack traces. Write the records they
+      // refer to before them.
+      output_->EndRecord();
+      LookupStackTraceStringsAndClasses();
+      WritePendingRecords();
+      WriteStackTraces();
+      output_->EndRecord();
+      return;
+    }
     // Write the string and class tables, and any stack traces, to the header.
     // (jhat requires that these appear before any of the data in the body that refers to them.)
     // jhat also requires the string table appear before class table and stack traces.
@@ -535,39 +664,138 @@ class Hprof : public SingleRootVisitor {
 
   void WriteClassTable() SHARED_REQUIRES(Locks::mutator_lock_) {
     for (const auto& p : classes_) {
-      mirror::Class* c = p.first;
-      HprofClassSerialNumber sn = p.second;
-      CHECK(c != nullptr);
-      output_->StartNewRecord(HPROF_TAG_LOAD_CLASS, kHprofTime);
-      // LOAD CLASS format:
-      // U4: class serial number (always > 0)
-      // ID: class object ID. We use the address of the class object structure as its ID.
-      // U4: stack trace serial number
-      // ID: class name string ID
-      __ AddU4(sn);
-      __ AddObjectId(c);
-      __ AddStackTraceSerialNumber(LookupStackTraceSerialNumber(c));
-      __ AddStringId(LookupClassNameId(c));
+      WriteClassRecord(p.first, p.second);
     }
   }
 
+  void WriteClassRecord(mirror::Class* c, HprofClassSerialNumber sn)
+      SHARED_REQUIRES(Locks::mutator_lock_) {
+    CHECK(c != nullptr);
+    output_->StartNewRecord(HPROF_TAG_LOAD_CLASS, kHprofTime);
+    // LOAD CLASS format:
+    // U4: class serial number (always > 0)
+    // ID: class object ID. We use the address of the class object structure as its ID.
+    // U4: stack trace serial number
+    // ID: class name string ID
+    __ AddU4(sn);
+    __ AddObjectId(c);
+    __ AddStackTraceSerialNumber(LookupStackTraceSerialNumber(c));
+    __ AddStringId(LookupClassNameId(c));
+  }
+
   void WriteStringTable() {
     for (const std::pair<std::string, HprofStringId>& p : strings_) {
-      const std::string& string = p.first;
-      const size_t id = p.second;
+      WriteStringRecord(p.first, p.second);
+    }
+  }
 
-      output_->StartNewRecord(HPROF_TAG_STRING, kHprofTime);
+  void WriteStringRecord(const std::string& string, HprofStringId id) {
+    output_->StartNewRecord(HPROF_TAG_STRING, kHprofTime);
 
-      // STRING format:
-      // ID:  ID for this string
-      // U1*: UTF8 characters for string (NOT null terminated)
-      //      (the record format encodes the length)
-      __ AddU4(id);
-      __ AddUtf8String(string.c_str());
+    // STRING format:
+    // ID:  ID for this string
+    // U1*: UTF8 characters for string (NOT null terminated)
+    //      (the record format encodes the length)
+    __ AddU4(id);
+    __ AddUtf8String(string.c_str());
+  }
+
+  // When streaming, write the records of the strings and classes discovered since the last call.
+  // They go before the record being built, which may refer to them.
+  void WritePendingRecords() SHARED_REQUIRES(Locks::mutator_lock_) {
+    if (!streaming_ || (pending_strings_.empty() && pending_classes_.empty())) {
+      return;
+    }
+    EndianOutput* record_output = output_;
+    output_ = pending_output_;
+    // The class records refer to the strings of the class names.
+    for (const auto& it : pending_strings_) {
+      WriteStringRecord(it->first, it->second);
+    }
+    for (const auto& it : pending_classes_) {
+      WriteClassRecord(it->first, it->second);
     }
+    output_->EndRecord();
+    output_ = record_output;
+    pending_strings_.clear();
+    pending_classes_.clear();
   }
 
-  void StartNewHeapDumpSegment() {
+  void LookupStackTraceStringsAndClasses() SHARED_REQUIRES(Locks::mutator_lock_) {
+    for (const auto& it : traces_) {
+      const gc::AllocRecordStackTrace* trace = it.first;
+      for (size_t i = 0, depth = trace->GetDepth(); i < depth; ++i) {
+        ArtMethod* method = trace->GetStackElement(i).GetMethod();
+        CHECK(method != nullptr);
+        LookupStringId(method->GetName());
+        LookupStringId(method->GetSignature().ToString());
+        const char* source_file = method->GetDeclaringClassSourceFile();
+        LookupStringId(source_file != nullptr ? source_file : "");
+        LookupClassId(method->GetDeclaringClass());
+      }
+    }
+  }
+
+  // Record the object in the class histogram and return whether it is written to a sampled dump.
+  bool SampleObject(mirror::Object* obj, mirror::Class* c) SHARED_REQUIRES(Locks::mutator_lock_) {
+    if (sample_interval_ == 0 || c == nullptr || obj->IsClass()) {
+      return true;
+    }
+    ClassHistogramEntry& entry = class_histogram_[c];
+    ++entry.count;
+    entry.bytes += obj->SizeOf();
+    ++instances_seen_;
+    return IsSampled(obj);
+  }
+
+  // Whether a sampled dump writes the object. Classes are always written. Instances are picked
+  // by a hash of their address rather than by the heap walk order, so that references can be
+  // checked against the same choice. References to instances that are not written are written
+  // as null, a sampled dump does not refer to objects missing from it.
+  bool IsSampled(mirror::Object* obj) SHARED_REQUIRES(Locks::mutator_lock_) {
+    if (sample_interval_ == 0 || obj == nullptr) {
+      return true;
+    }
+    mirror::Class* c = obj->GetClass();
+    if (c == nullptr || c->IsClassClass()) {
+      return true;
+    }
+    const uint64_t hash =
+        (reinterpret_cast<uintptr_t>(obj) / kObjectAlignment) * UINT64_C(0x9e3779b97f4a7c15);
+    return ((hash >> 32) % sample_interval_) == 0;
+  }
+
+  mirror::Object* SampledReference(mirror::Object* obj) SHARED_REQUIRES(Locks::mutator_lock_) {
+    return IsSampled(obj) ? obj : nullptr;
+  }
+
+  // The ID written for a reference field with the raw value `value`.
+  uint32_t SampledReferenceId(uint32_t value) SHARED_REQUIRES(Locks::mutator_lock_) {
+    mirror::Object* obj = reinterpret_cast<mirror::Object*>(static_cast<uintptr_t>(value));
+    return IsSampled(obj) ? value : 0u;
+  }
+
+  void LogClassHistogram() SHARED_REQUIRES(Locks::mutator_lock_) {
+    std::vector<std::pair<mirror::Class*, ClassHistogramEntry>> entries(class_histogram_.begin(),
+                                                                        class_histogram_.end());
+    const size_t num_logged = std::min(entries.size(), kHistogramClassesToLog);
+    std::partial_sort(entries.begin(),
+                      entries.begin() + num_logged,
+                      entries.end(),
+                      [](const std::pair<mirror::Class*, ClassHistogramEntry>& lhs,
+                         const std::pair<mirror::Class*, ClassHistogramEntry>& rhs) {
+                        return lhs.second.bytes > rhs.second.bytes;
+                      });
+    LOG(INFO) << "hprof: sampled 1 in " << sample_interval_ << " of " << instances_seen_
+              << " instances, largest classes:";
+    for (size_t i = 0; i < num_logged; ++i) {
+      LOG(INFO) << "hprof:   " << PrettySize(entries[i].second.bytes) << " in "
+                << entries[i].second.count << " " << PrettyDescriptor(entries[i].first);
+    }
+  }
+
+  void StartNewHeapDumpSegment() SHARED_REQUIRES(Locks::mutator_lock_) {
+    WritePendingRecords();
     // This flushes the old segment and starts a new one.
     output_->StartNewRecord(HPROF_TAG_HEAP_DUMP_SEGMENT, kHprofTime);
     objects_in_segment_ = 0;
@@ -575,7 +803,7 @@ class Hprof : public SingleRootVisitor {
     current_heap_ = HPROF_HEAP_DEFAULT;
   }
 
-  void CheckHeapSegmentConstraints() {
+  void CheckHeapSegmentConstraints() SHARED_REQUIRES(Locks::mutator_lock_) {
     if (objects_in_segment_ >= kMaxObjectsPerSegment || output_->Length() >= kMaxBytesPerSegment) {
       StartNewHeapDumpSegment();
     }
@@ -592,9 +820,12 @@ class Hprof : public SingleRootVisitor {
       if (it == classes_.end()) {
         // first time to see this class
         HprofClassSerialNumber sn = next_class_serial_number_++;
-        classes_.Put(c, sn);
+        auto new_it = classes_.Put(c, sn);
         // Make sure that we've assigned a string ID for this class' name
         LookupClassNameId(c);
+        if (streaming_) {
+          pending_classes_.push_back(new_it);
+        }
       }
     }
     return PointerToLowMemUInt32(c);
@@ -627,7 +858,10 @@ class Hprof : public SingleRootVisitor {
       return it->second;
     }
     HprofStringId id = next_string_id_++;
-    strings_.Put(string, id);
+    auto new_it = strings_.Put(string, id);
+    if (streaming_) {
+      pending_strings_.push_back(new_it);
+    }
     return id;
   }
 
@@ -734,21 +968,20 @@ class Hprof : public SingleRootVisitor {
     //        Dbg::DdmSendChunkV(CHUNK_TYPE("HPDS"), iov, 2);
   }
 
-  bool DumpToFile(size_t overall_size, size_t max_length)
-      REQUIRES(Locks::mutator_lock_) {
+  bool DumpToFile(size_t* overall_size) REQUIRES(Locks::mutator_lock_) {
     // Where exactly are we writing to?
     int out_fd;
     if (fd_ >= 0) {
       out_fd = dup(fd_);
       if (out_fd < 0) {
-        ThrowRuntimeException("Couldn't dump heap; dup(%d) failed: %s", fd_, strerror(errno));
+        ReportError(StringPrintf("Couldn't dump heap; dup(%d) failed: %s", fd_, strerror(errno)));
         return false;
       }
     } else {
       out_fd = open(filename_.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0644);
       if (out_fd < 0) {
-        ThrowRuntimeException("Couldn't dump heap; open(\"%s\") failed: %s", filename_.c_str(),
-                              strerror(errno));
+        ReportError(StringPrintf("Couldn't dump heap; open(\"%s\") failed: %s", filename_.c_str(),
+                                 strerror(errno)));
         return false;
       }
     }
@@ -756,17 +989,15 @@ class Hprof : public SingleRootVisitor {
     std::unique_ptr<File> file(new File(out_fd, filename_, true));
     bool okay;
     {
-      FileEndianOutput file_output(file.get(), max_length);
+      FileEndianOutput file_output(file.get(), kMaxBytesPerSegment, compress_);
+      ForwardingEndianOutput pending_output(&file_output);
       output_ = &file_output;
+      pending_output_ = &pending_output;
       ProcessHeap(true);
-      okay = !file_output.Errors();
-
-      if (okay) {
-        // Check for expected size. Output is expected to be less-or-equal than first phase, see
-        // b/23521263.
-        DCHECK_LE(file_output.SumLength(), overall_size);
-      }
+      okay = file_output.Finish();
+      *overall_size = file_output.SumLength() + pending_output.SumLength();
       output_ = nullptr;
+      pending_output_ = nullptr;
     }
 
     if (okay) {
@@ -777,13 +1008,22 @@ class Hprof : public SingleRootVisitor {
     if (!okay) {
       std::string msg(StringPrintf("Couldn't dump heap; writing \"%s\" failed: %s",
                                    filename_.c_str(), strerror(errno)));
-      ThrowRuntimeException("%s", msg.c_str());
+      ReportError(msg);
       LOG(ERROR) << msg;
     }
 
     return okay;
   }
 
+  void ReportError(const std::string& msg) REQUIRES(Locks::mutator_lock_) {
+    if (in_snapshot_process_) {
+      // Nothing can run Java code in the snapshot process. The parent reports the failure.
+      LOG(ERROR) << msg;
+    } else {
+      ThrowRuntimeException("%s", msg.c_str());
+    }
+  }
+
   bool DumpToDdmsDirect(size_t overall_size, size_t max_length, uint32_t chunk_type)
       REQUIRES(Locks::mutator_lock_) {
     CHECK(direct_to_ddms_);
@@ -861,10 +1101,19 @@ class Hprof : public SingleRootVisitor {
   std::string filename_;
   int fd_;
   bool direct_to_ddms_;
+  // Whether the dump is written in a single pass.
+  const bool streaming_;
+  const bool compress_;
+  // If not 0, about one in `sample_interval_` instances is written, see IsSampled().
+  const size_t sample_interval_;
+  // Whether the dump runs in a process forked to snapshot the heap.
+  const bool in_snapshot_process_;
 
   uint64_t start_ns_ = NanoTime();
 
   EndianOutput* output_ = nullptr;
+  // When streaming, where the string and class records are written.
+  EndianOutput* pending_output_ = nullptr;
 
   HprofHeapId current_heap_ = HPROF_HEAP_DEFAULT;  // Which heap we're currently dumping.
   size_t objects_in_segment_ = 0;
@@ -876,6 +1125,17 @@ class Hprof : public SingleRootVisitor {
   SafeMap<std::string, HprofStringId> strings_;
   HprofClassSerialNumber next_class_serial_number_ = 1;
   SafeMap<mirror::Class*, HprofClassSerialNumber> classes_;
+  // When streaming, the strings and classes whose records are not written yet.
+  std::vector<SafeMap<std::string, HprofStringId>::iterator> pending_strings_;
+  std::vector<SafeMap<mirror::Class*, HprofClassSerialNumber>::iterator> pending_classes_;
+
+  struct ClassHistogramEntry {
+    size_t count = 0u;
+    size_t bytes = 0u;
+  };
+  // For sampled dumps, the number and size of the instances of each class.
+  std::unordered_map<mirror::Class*, ClassHistogramEntry> class_histogram_;
+  size_t instances_seen_ = 0u;
 
   std::unordered_map<const gc::AllocRecordStackTrace*, HprofStackTraceSerialNumber,
                      gc::HashAllocRecordTypesPtr<gc::AllocRecordStackTrace>,
@@ -1076,11 +1336,14 @@ void Hprof::DumpHeapObject(mirror::Object* obj) {
     return;
   }
 
-  ++total_objects_;
-
   GcRootVisitor visitor(this);
   obj->VisitReferences(visitor, VoidFunctor());
 
+  if (!SampleObject(obj, obj->GetClass())) {
+    return;
+  }
+  ++total_objects_;
+
   gc::Heap* const heap = Runtime::Current()->GetHeap();
   const gc::space::ContinuousSpace* const space = heap->FindContinuousSpaceFromObject(obj, true);
   HprofHeapId heap_type = HPROF_HEAP_APP;
@@ -1174,7 +1437,7 @@ void Hprof::DumpHeapClass(mirror::Class* klass) {
   __ AddClassId(LookupClassId(klass));
   __ AddStackTraceSerialNumber(LookupStackTraceSerialNumber(klass));
   __ AddClassId(LookupClassId(klass->GetSuperClass()));
-  __ AddObjectId(klass->GetClassLoader());
+  __ AddObjectId(SampledReference(klass->GetClassLoader()));
   __ AddObjectId(nullptr);    // no signer
   __ AddObjectId(nullptr);    // no prot domain
   __ AddObjectId(nullptr);    // reserved
@@ -1226,9 +1489,11 @@ void Hprof::DumpHeapClass(mirror::Class* klass) {
           break;
         case hprof_basic_float:
         case hprof_basic_int:
-        case hprof_basic_object:
           __ AddU4(f->Get32(klass));
           break;
+        case hprof_basic_object:
+          __ AddU4(SampledReferenceId(f->Get32(klass)));
+          break;
         case hprof_basic_double:
         case hprof_basic_long:
           __ AddU8(f->Get64(klass));
@@ -1273,7 +1538,14 @@ void Hprof::DumpHeapArray(mirror::Array* obj, mirror::Class* klass) {
     __ AddClassId(LookupClassId(klass));
 
     // Dump the elements, which are always objects or null.
-    __ AddIdList(obj->AsObjectArray<mirror::Object>());
+    mirror::ObjectArray<mirror::Object>* elements = obj->AsObjectArray<mirror::Object>();
+    if (sample_interval_ == 0) {
+      __ AddIdList(elements);
+    } else {
+      for (int32_t i = 0; i < static_cast<int32_t>(length); ++i) {
+        __ AddObjectId(SampledReference(elements->GetWithoutChecks(i)));
+      }
+    }
   } else {
     size_t size;
     HprofBasicType t = SignatureToBasicTypeAndSize(
@@ -1337,9 +1609,11 @@ void Hprof::DumpHeapInstanceObject(mirror::Object* obj, mirror::Class* klass) {
         break;
       case hprof_basic_float:
       case hprof_basic_int:
-      case hprof_basic_object:
         __ AddU4(f->Get32(obj));
         break;
+      case hprof_basic_object:
+        __ AddU4(SampledReferenceId(f->Get32(obj)));
+        break;
       case hprof_basic_double:
       case hprof_basic_long:
         __ AddU8(f->Get64(obj));
@@ -1397,19 +1671,111 @@ void Hprof::VisitRoot(mirror::Object* obj, const RootInfo& info) {
     HPROF_ROOT_JNI_MONITOR,
   };
   CHECK_LT(info.GetType(), sizeof(xlate) / sizeof(HprofHeapTag));
-  if (obj == nullptr) {
+  if (obj == nullptr || !IsSampled(obj)) {
     return;
   }
   MarkRootObject(obj, 0, xlate[info.GetType()], info.GetThreadId());
 }
 
+// How long the dumping thread waits for the snapshot process. Only the thread that forked exists
+// in the child, which deadlocks if it needs a lock that another thread held at the time of the
+// fork, for instance a native lock of a thread in native code.
+static constexpr uint64_t kSnapshotTimeoutMs = 2 * 60 * 1000;
+static constexpr useconds_t kSnapshotPollIntervalUs = 10 * 1000;
+
+// Number of heap dumps written by a snapshot process.
+static Atomic<size_t> num_snapshot_dumps(0u);
+
+size_t GetNumSnapshotDumps() {
+  return num_snapshot_dumps.LoadRelaxed();
+}
+
+// Dump the heap to the file from a child process forked with the threads suspended, and wait for
+// it. Returns false if the heap must be dumped in this process instead, that is if the fork
+// failed or the child timed out.
+static bool DumpHeapInSnapshotProcess(const char* filename,
+                                      int fd,
+                                      bool compress,
+                                      size_t sample_interval) {
+  Thread* self = Thread::Current();
+  gc::Heap* heap = Runtime::Current()->GetHeap();
+  if (heap->IsGcConcurrentAndMoving()) {
+    // Need to take a heap dump while GC isn't running. See the
+    // comment in Heap::VisitObjects().
+    heap->IncrementDisableMovingGC(self);
+  }
+  pid_t snapshot_pid;
+  {
+    ScopedSuspendAll ssa(__FUNCTION__, true /* long suspend */);
+    snapshot_pid = fork();
+    if (snapshot_pid == 0) {
+      // Only this thread exists in the child, and it holds the mutator lock exclusively.
+      Hprof hprof(filename, fd, false, compress, sample_interval, true);
+      _exit(hprof.Dump() ? 0 : 1);
+    }
+  }
+  if (heap->IsGcConcurrentAndMoving()) {
+    heap->DecrementDisableMovingGC(self);
+  }
+  if (snapshot_pid < 0) {
+    PLOG(WARNING) << "hprof: fork failed, dumping the heap with all threads suspended";
+    return false;
+  }
+
+  // Wait for the dump to be complete, as for a dump in this process. The other threads run.
+  const uint64_t deadline = MilliTime() + kSnapshotTimeoutMs;
+  int status;
+  pid_t result;
+  while ((result = TEMP_FAILURE_RETRY(waitpid(snapshot_pid, &status, WNOHANG))) == 0) {
+    if (MilliTime() >= deadline) {
+      LOG(WARNING) << "hprof: snapshot process " << snapshot_pid << " timed out, dumping the heap"
+                   << " with all threads suspended";
+      kill(snapshot_pid, SIGKILL);
+      TEMP_FAILURE_RETRY(waitpid(snapshot_pid, &status, 0));
+      // The child shares the file offset of `fd`, and may have written part of the dump.
+      if (fd >= 0 && (lseek(fd, 0, SEEK_SET) != 0 || ftruncate(fd, 0) != 0)) {
+        ScopedObjectAccess soa(self);
+        ThrowRuntimeException("Couldn't dump heap; the snapshot process %d timed out and "
+                              "rewinding fd %d failed: %s", snapshot_pid, fd, strerror(errno));
+        return true;
+      }
+      return false;
+    }
+    usleep(kSnapshotPollIntervalUs);
+  }
+  if (result != snapshot_pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    ScopedObjectAccess soa(self);
+    ThrowRuntimeException("Couldn't dump heap; the snapshot process %d failed", snapshot_pid);
+  } else {
+    num_snapshot_dumps.FetchAndAddRelaxed(1u);
+  }
+  return true;
+}
+
 // If "direct_to_ddms" is true, the other arguments are ignored, and data is
 // sent directly to DDMS.
 // If "fd" is >= 0, the output will be written to that file descriptor.
 // Otherwise, "filename" is used to create an output file.
-void DumpHeap(const char* filename, int fd, bool direct_to_ddms) {
+// If "compress" is true, the file is compressed in the gzip format.
+// If "sample_interval" is not 0, only one in "sample_interval" instances is
+// written, and a histogram of all the instances by class is logged.
+// If "fork_snapshot" is true, the heap is dumped to the file by a forked
+// child process working on a copy-on-write snapshot of the heap. The other
+// threads are only suspended for the duration of the fork. If the child
+// does not complete in time, it is killed and the heap is dumped in process.
+void DumpHeap(const char* filename,
+              int fd,
+              bool direct_to_ddms,
+              bool compress,
+              size_t sample_interval,
+              bool fork_snapshot) {
   CHECK(filename != nullptr);
 
+  if (fork_snapshot && !direct_to_ddms &&
+      DumpHeapInSnapshotProcess(filename, fd, compress, sample_interval)) {
+    return;
+  }
+
   Thread* self = Thread::Current();
   gc::Heap* heap = Runtime::Current()->GetHeap();
   if (heap->IsGcConcurrentAndMoving()) {
@@ -1419,7 +1785,7 @@ void DumpHeap(const char* filename, int fd, bool direct_to_ddms) {
   }
   {
     ScopedSuspendAll ssa(__FUNCTION__, true /* long suspend */);
-    Hprof hprof(filename, fd, direct_to_ddms);
+    Hprof hprof(filename, fd, direct_to_ddms, compress, sample_interval, false);
     hprof.Dump();
   }
   if (heap->IsGcConcurrentAndMoving()) {
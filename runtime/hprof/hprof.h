@@ -17,11 +17,21 @@
 #ifndef ART_RUNTIME_HPROF_HPROF_H_
 #define ART_RUNTIME_HPROF_HPROF_H_
 
+#include <stddef.h>
+
 namespace art {
 
 namespace hprof {
 
-void DumpHeap(const char* filename, int fd, bool direct_to_ddms);
+void DumpHeap(const char* filename,
+              int fd,
+              bool direct_to_ddms,
+              bool compress = false,
+              size_t sample_interval = 0,
+              bool fork_snapshot = false);
+
+// Returns the number of heap dumps that a forked snapshot process wrote successfully. For tests.
+size_t GetNumSnapshotDumps();
 
 }  // namespace hprof
 
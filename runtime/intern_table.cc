@@ -36,22 +36,48 @@ InternTable::InternTable()
     : images_added_to_intern_table_(false),
       log_new_roots_(false),
       weak_intern_condition_("New intern condition", *Locks::intern_table_lock_),
+      image_tables_for_lookup_(nullptr),
       weak_root_state_(gc::kWeakRootStateNormal) {
+  // No image tables yet.
+  image_table_arrays_.emplace_back(new ImageTables());
+  image_tables_for_lookup_.StoreRelaxed(image_table_arrays_.back().get());
+}
+
+InternTable::Shard::Shard() : lock_("InternTable shard lock", kInternTableShardLock) {
+}
+
+InternTable::Shard* InternTable::GetShard(mirror::String* s) {
+  return GetShard(s->GetHashCode());
 }
 
 size_t InternTable::Size() const {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return strong_interns_.Size() + weak_interns_.Size();
+  return StrongSize() + WeakSize();
 }
 
 size_t InternTable::StrongSize() const {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return strong_interns_.Size();
+  Thread* const self = Thread::Current();
+  size_t size = 0;
+  {
+    MutexLock mu(self, *Locks::intern_table_lock_);
+    for (const std::unique_ptr<UnorderedSet>& table : image_tables_) {
+      size += table->Size();
+    }
+  }
+  for (const Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+    size += shard.strong_interns_.Size();
+  }
+  return size;
 }
 
 size_t InternTable::WeakSize() const {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return weak_interns_.Size();
+  Thread* const self = Thread::Current();
+  size_t size = 0;
+  for (const Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+    size += shard.weak_interns_.Size();
+  }
+  return size;
 }
 
 void InternTable::DumpForSigQuit(std::ostream& os) const {
@@ -59,42 +85,61 @@ void InternTable::DumpForSigQuit(std::ostream& os) const {
 }
 
 void InternTable::VisitRoots(RootVisitor* visitor, VisitRootFlags flags) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
+  Thread* const self = Thread::Current();
+  MutexLock mu(self, *Locks::intern_table_lock_);
   if ((flags & kVisitRootFlagAllRoots) != 0) {
-    strong_interns_.VisitRoots(visitor);
-  } else if ((flags & kVisitRootFlagNewRoots) != 0) {
-    for (auto& root : new_strong_intern_roots_) {
-      mirror::String* old_ref = root.Read<kWithoutReadBarrier>();
-      root.VisitRoot(visitor, RootInfo(kRootInternedString));
-      mirror::String* new_ref = root.Read<kWithoutReadBarrier>();
-      if (new_ref != old_ref) {
-        // The GC moved a root in the log. Need to search the strong interns and update the
-        // corresponding object. This is slow, but luckily for us, this may only happen with a
-        // concurrent moving GC.
-        strong_interns_.Remove(old_ref);
-        strong_interns_.Insert(new_ref);
+    BufferedRootVisitor<kDefaultBufferedRootCount> buffered_visitor(
+        visitor, RootInfo(kRootInternedString));
+    for (std::unique_ptr<UnorderedSet>& table : image_tables_) {
+      for (auto& intern : *table) {
+        buffered_visitor.VisitRoot(intern);
       }
     }
   }
-  if ((flags & kVisitRootFlagClearRootLog) != 0) {
-    new_strong_intern_roots_.clear();
+  for (Shard& shard : shards_) {
+    MutexLock mu2(self, shard.lock_);
+    if ((flags & kVisitRootFlagAllRoots) != 0) {
+      shard.strong_interns_.VisitRoots(visitor);
+    } else if ((flags & kVisitRootFlagNewRoots) != 0) {
+      for (auto& root : shard.new_strong_intern_roots_) {
+        mirror::String* old_ref = root.Read<kWithoutReadBarrier>();
+        root.VisitRoot(visitor, RootInfo(kRootInternedString));
+        mirror::String* new_ref = root.Read<kWithoutReadBarrier>();
+        if (new_ref != old_ref) {
+          // The GC moved a root in the log. Need to search the strong interns and update the
+          // corresponding object. This is slow, but luckily for us, this may only happen with a
+          // concurrent moving GC.
+          shard.strong_interns_.Remove(old_ref);
+          shard.strong_interns_.Insert(new_ref);
+        }
+      }
+    }
+    if ((flags & kVisitRootFlagClearRootLog) != 0) {
+      shard.new_strong_intern_roots_.clear();
+    }
   }
   if ((flags & kVisitRootFlagStartLoggingNewRoots) != 0) {
-    log_new_roots_ = true;
+    log_new_roots_.StoreRelaxed(true);
   } else if ((flags & kVisitRootFlagStopLoggingNewRoots) != 0) {
-    log_new_roots_ = false;
+    log_new_roots_.StoreRelaxed(false);
   }
   // Note: we deliberately don't visit the weak_interns_ table and the immutable image roots.
 }
 
 mirror::String* InternTable::LookupWeak(Thread* self, mirror::String* s) {
-  MutexLock mu(self, *Locks::intern_table_lock_);
-  return LookupWeakLocked(s);
+  Shard* const shard = GetShard(s);
+  MutexLock mu(self, shard->lock_);
+  return shard->weak_interns_.Find(s);
 }
 
 mirror::String* InternTable::LookupStrong(Thread* self, mirror::String* s) {
-  MutexLock mu(self, *Locks::intern_table_lock_);
-  return LookupStrongLocked(s);
+  mirror::String* const image_string = LookupImageString(s);
+  if (image_string != nullptr) {
+    return image_string;
+  }
+  Shard* const shard = GetShard(s);
+  MutexLock mu(self, shard->lock_);
+  return shard->strong_interns_.Find(s);
 }
 
 mirror::String* InternTable::LookupStrong(Thread* self,
@@ -104,77 +149,113 @@ mirror::String* InternTable::LookupStrong(Thread* self,
   Utf8String string(utf16_length,
                     utf8_data,
                     ComputeUtf16HashFromModifiedUtf8(utf8_data, utf16_length));
-  MutexLock mu(self, *Locks::intern_table_lock_);
-  return strong_interns_.Find(string);
-}
-
-mirror::String* InternTable::LookupWeakLocked(mirror::String* s) {
-  return weak_interns_.Find(s);
+  mirror::String* const image_string = LookupImageString(string);
+  if (image_string != nullptr) {
+    return image_string;
+  }
+  Shard* const shard = GetShard(string.GetHash());
+  MutexLock mu(self, shard->lock_);
+  return shard->strong_interns_.Find(string);
+}
+
+mirror::String* InternTable::LookupImageString(mirror::String* s) {
+  // The image tables are never modified in place and the array is only replaced, the replaced
+  // arrays stay valid until the intern table is deleted.
+  const ImageTables* const image_tables = image_tables_for_lookup_.LoadAcquire();
+  for (const UnorderedSet* table : *image_tables) {
+    auto it = table->Find(GcRoot<mirror::String>(s));
+    if (it != table->end()) {
+      return it->Read();
+    }
+  }
+  return nullptr;
 }
 
-mirror::String* InternTable::LookupStrongLocked(mirror::String* s) {
-  return strong_interns_.Find(s);
+mirror::String* InternTable::LookupImageString(const Utf8String& string) {
+  const ImageTables* const image_tables = image_tables_for_lookup_.LoadAcquire();
+  for (const UnorderedSet* table : *image_tables) {
+    auto it = table->Find(string);
+    if (it != table->end()) {
+      return it->Read();
+    }
+  }
+  return nullptr;
 }
 
 void InternTable::AddNewTable() {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  weak_interns_.AddNewTable();
-  strong_interns_.AddNewTable();
+  Thread* const self = Thread::Current();
+  for (Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+    shard.weak_interns_.AddNewTable();
+    shard.strong_interns_.AddNewTable();
+  }
 }
 
-mirror::String* InternTable::InsertStrong(mirror::String* s) {
+mirror::String* InternTable::InsertStrong(Shard* shard, mirror::String* s) {
   Runtime* runtime = Runtime::Current();
   if (runtime->IsActiveTransaction()) {
+    Locks::intern_table_lock_->AssertHeld(Thread::Current());
     runtime->RecordStrongStringInsertion(s);
   }
-  if (log_new_roots_) {
-    new_strong_intern_roots_.push_back(GcRoot<mirror::String>(s));
+  if (log_new_roots_.LoadRelaxed()) {
+    shard->new_strong_intern_roots_.push_back(GcRoot<mirror::String>(s));
   }
-  strong_interns_.Insert(s);
+  shard->strong_interns_.Insert(s);
   return s;
 }
 
-mirror::String* InternTable::InsertWeak(mirror::String* s) {
+mirror::String* InternTable::InsertWeak(Shard* shard, mirror::String* s) {
   Runtime* runtime = Runtime::Current();
   if (runtime->IsActiveTransaction()) {
+    Locks::intern_table_lock_->AssertHeld(Thread::Current());
     runtime->RecordWeakStringInsertion(s);
   }
-  weak_interns_.Insert(s);
+  shard->weak_interns_.Insert(s);
   return s;
 }
 
-void InternTable::RemoveStrong(mirror::String* s) {
-  strong_interns_.Remove(s);
+void InternTable::RemoveStrong(Shard* shard, mirror::String* s) {
+  shard->strong_interns_.Remove(s);
 }
 
-void InternTable::RemoveWeak(mirror::String* s) {
+void InternTable::RemoveWeak(Shard* shard, mirror::String* s) {
   Runtime* runtime = Runtime::Current();
   if (runtime->IsActiveTransaction()) {
+    Locks::intern_table_lock_->AssertHeld(Thread::Current());
     runtime->RecordWeakStringRemoval(s);
   }
-  weak_interns_.Remove(s);
+  shard->weak_interns_.Remove(s);
 }
 
 // Insert/remove methods used to undo changes made during an aborted transaction.
 mirror::String* InternTable::InsertStrongFromTransaction(mirror::String* s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
-  return InsertStrong(s);
+  Shard* const shard = GetShard(s);
+  MutexLock mu(Thread::Current(), shard->lock_);
+  return InsertStrong(shard, s);
 }
 mirror::String* InternTable::InsertWeakFromTransaction(mirror::String* s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
-  return InsertWeak(s);
+  Shard* const shard = GetShard(s);
+  MutexLock mu(Thread::Current(), shard->lock_);
+  return InsertWeak(shard, s);
 }
 void InternTable::RemoveStrongFromTransaction(mirror::String* s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
-  RemoveStrong(s);
+  Shard* const shard = GetShard(s);
+  MutexLock mu(Thread::Current(), shard->lock_);
+  RemoveStrong(shard, s);
 }
 void InternTable::RemoveWeakFromTransaction(mirror::String* s) {
   DCHECK(!Runtime::Current()->IsActiveTransaction());
-  RemoveWeak(s);
+  Shard* const shard = GetShard(s);
+  MutexLock mu(Thread::Current(), shard->lock_);
+  RemoveWeak(shard, s);
 }
 
 void InternTable::AddImagesStringsToTable(const std::vector<gc::space::ImageSpace*>& image_spaces) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
+  Thread* const self = Thread::Current();
+  MutexLock mu(self, *Locks::intern_table_lock_);
   for (gc::space::ImageSpace* image_space : image_spaces) {
     const ImageHeader* const header = &image_space->GetImageHeader();
     // Check if we have the interned strings section.
@@ -191,9 +272,14 @@ void InternTable::AddImagesStringsToTable(const std::vector<gc::space::ImageSpac
         for (size_t j = 0; j < num_strings; ++j) {
           mirror::String* image_string = dex_cache->GetResolvedString(j);
           if (image_string != nullptr) {
-            mirror::String* found = LookupStrongLocked(image_string);
+            Shard* const shard = GetShard(image_string);
+            MutexLock mu2(self, shard->lock_);
+            mirror::String* found = LookupImageString(image_string);
             if (found == nullptr) {
-              InsertStrong(image_string);
+              found = shard->strong_interns_.Find(image_string);
+            }
+            if (found == nullptr) {
+              InsertStrong(shard, image_string);
             } else {
               DCHECK_EQ(found, image_string);
             }
@@ -202,11 +288,11 @@ void InternTable::AddImagesStringsToTable(const std::vector<gc::space::ImageSpac
       }
     }
   }
-  images_added_to_intern_table_ = true;
+  images_added_to_intern_table_.StoreRelease(true);
 }
 
 mirror::String* InternTable::LookupStringFromImage(mirror::String* s) {
-  DCHECK(!images_added_to_intern_table_);
+  DCHECK(!images_added_to_intern_table_.LoadRelaxed());
   const std::vector<gc::space::ImageSpace*>& image_spaces =
       Runtime::Current()->GetHeap()->GetBootImageSpaces();
   if (image_spaces.empty()) {
@@ -241,42 +327,71 @@ void InternTable::BroadcastForNewInterns() {
   weak_intern_condition_.Broadcast(self);
 }
 
-void InternTable::WaitUntilAccessible(Thread* self) {
-  Locks::intern_table_lock_->ExclusiveUnlock(self);
+void InternTable::WaitUntilAccessible(Thread* self, Shard* shard, bool in_transaction) {
+  shard->lock_.ExclusiveUnlock(self);
+  if (in_transaction) {
+    Locks::intern_table_lock_->ExclusiveUnlock(self);
+  }
   {
     ScopedThreadSuspension sts(self, kWaitingWeakGcRootRead);
     MutexLock mu(self, *Locks::intern_table_lock_);
-    while (weak_root_state_ == gc::kWeakRootStateNoReadsOrWrites) {
+    while (weak_root_state_.LoadAcquire() == gc::kWeakRootStateNoReadsOrWrites) {
       weak_intern_condition_.Wait(self);
     }
   }
-  Locks::intern_table_lock_->ExclusiveLock(self);
+  if (in_transaction) {
+    Locks::intern_table_lock_->ExclusiveLock(self);
+  }
+  shard->lock_.ExclusiveLock(self);
 }
 
 mirror::String* InternTable::Insert(mirror::String* s, bool is_strong, bool holding_locks) {
   if (s == nullptr) {
     return nullptr;
   }
+  // Strings interned from the image are found without taking any lock.
+  mirror::String* const image_string = LookupImageString(s);
+  if (image_string != nullptr) {
+    return image_string;
+  }
+  Thread* const self = Thread::Current();
+  Shard* const shard = GetShard(s);
+  if (UNLIKELY(Runtime::Current()->IsActiveTransaction())) {
+    // The transaction records the changes to the tables under the intern table lock.
+    MutexLock mu(self, *Locks::intern_table_lock_);
+    MutexLock mu2(self, shard->lock_);
+    return InsertLocked(shard, s, is_strong, holding_locks, /* in_transaction */ true);
+  }
+  MutexLock mu(self, shard->lock_);
+  return InsertLocked(shard, s, is_strong, holding_locks, /* in_transaction */ false);
+}
+
+mirror::String* InternTable::InsertLocked(Shard* shard,
+                                          mirror::String* s,
+                                          bool is_strong,
+                                          bool holding_locks,
+                                          bool in_transaction) {
   Thread* const self = Thread::Current();
-  MutexLock mu(self, *Locks::intern_table_lock_);
   if (kDebugLocking && !holding_locks) {
     Locks::mutator_lock_->AssertSharedHeld(self);
-    CHECK_EQ(2u, self->NumberOfHeldMutexes()) << "may only safely hold the mutator lock";
+    CHECK_EQ(in_transaction ? 3u : 2u, self->NumberOfHeldMutexes())
+        << "may only safely hold the mutator lock";
   }
   while (true) {
     if (holding_locks) {
       if (!kUseReadBarrier) {
-        CHECK_EQ(weak_root_state_, gc::kWeakRootStateNormal);
+        CHECK_EQ(weak_root_state_.LoadAcquire(), gc::kWeakRootStateNormal);
       } else {
         CHECK(self->GetWeakRefAccessEnabled());
       }
     }
     // Check the strong table for a match.
-    mirror::String* strong = LookupStrongLocked(s);
+    mirror::String* strong = shard->strong_interns_.Find(s);
     if (strong != nullptr) {
       return strong;
     }
-    if ((!kUseReadBarrier && weak_root_state_ != gc::kWeakRootStateNoReadsOrWrites) ||
+    if ((!kUseReadBarrier &&
+         weak_root_state_.LoadAcquire() != gc::kWeakRootStateNoReadsOrWrites) ||
         (kUseReadBarrier && self->GetWeakRefAccessEnabled())) {
       break;
     }
@@ -286,32 +401,32 @@ mirror::String* InternTable::Insert(mirror::String* s, bool is_strong, bool hold
     CHECK(!holding_locks);
     StackHandleScope<1> hs(self);
     auto h = hs.NewHandleWrapper(&s);
-    WaitUntilAccessible(self);
+    WaitUntilAccessible(self, shard, in_transaction);
   }
   if (!kUseReadBarrier) {
-    CHECK_EQ(weak_root_state_, gc::kWeakRootStateNormal);
+    CHECK_EQ(weak_root_state_.LoadAcquire(), gc::kWeakRootStateNormal);
   } else {
     CHECK(self->GetWeakRefAccessEnabled());
   }
   // There is no match in the strong table, check the weak table.
-  mirror::String* weak = LookupWeakLocked(s);
+  mirror::String* weak = shard->weak_interns_.Find(s);
   if (weak != nullptr) {
     if (is_strong) {
       // A match was found in the weak table. Promote to the strong table.
-      RemoveWeak(weak);
-      return InsertStrong(weak);
+      RemoveWeak(shard, weak);
+      return InsertStrong(shard, weak);
     }
     return weak;
   }
-  // Check the image for a match.
-  if (!images_added_to_intern_table_) {
+  // Check the image for a match. The image string has the same hash, so it belongs to this shard.
+  if (!images_added_to_intern_table_.LoadAcquire()) {
     mirror::String* const image_string = LookupStringFromImage(s);
     if (image_string != nullptr) {
-      return is_strong ? InsertStrong(image_string) : InsertWeak(image_string);
+      return is_strong ? InsertStrong(shard, image_string) : InsertWeak(shard, image_string);
     }
   }
   // No match in the strong table or the weak table. Insert into the strong / weak table.
-  return is_strong ? InsertStrong(s) : InsertWeak(s);
+  return is_strong ? InsertStrong(shard, s) : InsertWeak(shard, s);
 }
 
 mirror::String* InternTable::InternStrong(int32_t utf16_length, const char* utf8_data) {
@@ -343,8 +458,11 @@ bool InternTable::ContainsWeak(mirror::String* s) {
 }
 
 void InternTable::SweepInternTableWeaks(IsMarkedVisitor* visitor) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  weak_interns_.SweepWeaks(visitor);
+  Thread* const self = Thread::Current();
+  for (Shard& shard : shards_) {
+    MutexLock mu(self, shard.lock_);
+    shard.weak_interns_.SweepWeaks(visitor);
+  }
 }
 
 size_t InternTable::AddTableFromMemory(const uint8_t* ptr) {
@@ -353,12 +471,56 @@ size_t InternTable::AddTableFromMemory(const uint8_t* ptr) {
 }
 
 size_t InternTable::AddTableFromMemoryLocked(const uint8_t* ptr) {
-  return strong_interns_.AddTableFromMemory(ptr);
+  size_t read_count = 0;
+  std::unique_ptr<UnorderedSet> set(new UnorderedSet(ptr, /*make copy*/false, &read_count));
+  if (set->Empty()) {
+    // Avoid inserting empty sets.
+    return read_count;
+  }
+  // TODO: Disable this for app images if app images have intern tables.
+  static constexpr bool kCheckDuplicates = true;
+  if (kCheckDuplicates) {
+    Thread* const self = Thread::Current();
+    for (GcRoot<mirror::String>& string : *set) {
+      mirror::String* const s = string.Read();
+      CHECK(LookupImageString(s) == nullptr) << "Already found " << s->ToModifiedUtf8();
+      if (kIsDebugBuild) {
+        Shard* const shard = GetShard(s);
+        MutexLock mu(self, shard->lock_);
+        CHECK(shard->strong_interns_.Find(s) == nullptr) << "Already found " << s->ToModifiedUtf8();
+      }
+    }
+  }
+  image_tables_.push_back(std::move(set));
+  PublishImageTables();
+  return read_count;
+}
+
+void InternTable::PublishImageTables() {
+  std::unique_ptr<ImageTables> tables(new ImageTables());
+  tables->reserve(image_tables_.size());
+  for (const std::unique_ptr<UnorderedSet>& table : image_tables_) {
+    tables->push_back(table.get());
+  }
+  image_tables_for_lookup_.StoreRelease(tables.get());
+  image_table_arrays_.push_back(std::move(tables));
 }
 
 size_t InternTable::WriteToMemory(uint8_t* ptr) {
-  MutexLock mu(Thread::Current(), *Locks::intern_table_lock_);
-  return strong_interns_.WriteToMemory(ptr);
+  Thread* const self = Thread::Current();
+  MutexLock mu(self, *Locks::intern_table_lock_);
+  // Combine the image tables and the tables of all the shards into a single table.
+  UnorderedSet combined;
+  for (const std::unique_ptr<UnorderedSet>& table : image_tables_) {
+    for (const GcRoot<mirror::String>& string : *table) {
+      combined.Insert(string);
+    }
+  }
+  for (Shard& shard : shards_) {
+    MutexLock mu2(self, shard.lock_);
+    shard.strong_interns_.AddToSet(&combined);
+  }
+  return combined.WriteToMemory(ptr);
 }
 
 std::size_t InternTable::StringHashEquals::operator()(const GcRoot<mirror::String>& root) const {
@@ -390,42 +552,12 @@ bool InternTable::StringHashEquals::operator()(const GcRoot<mirror::String>& a,
   return CompareModifiedUtf8ToUtf16AsCodePointValues(b.GetUtf8Data(), a_value, a_length) == 0;
 }
 
-size_t InternTable::Table::AddTableFromMemory(const uint8_t* ptr) {
-  size_t read_count = 0;
-  UnorderedSet set(ptr, /*make copy*/false, &read_count);
-  if (set.Empty()) {
-    // Avoid inserting empty sets.
-    return read_count;
-  }
-  // TODO: Disable this for app images if app images have intern tables.
-  static constexpr bool kCheckDuplicates = true;
-  if (kCheckDuplicates) {
-    for (GcRoot<mirror::String>& string : set) {
-      CHECK(Find(string.Read()) == nullptr) << "Already found " << string.Read()->ToModifiedUtf8();
-    }
-  }
-  // Insert at the front since we add new interns into the back.
-  tables_.insert(tables_.begin(), std::move(set));
-  return read_count;
-}
-
-size_t InternTable::Table::WriteToMemory(uint8_t* ptr) {
-  if (tables_.empty()) {
-    return 0;
-  }
-  UnorderedSet* table_to_write;
-  UnorderedSet combined;
-  if (tables_.size() > 1) {
-    table_to_write = &combined;
-    for (UnorderedSet& table : tables_) {
-      for (GcRoot<mirror::String>& string : table) {
-        combined.Insert(string);
-      }
+void InternTable::Table::AddToSet(UnorderedSet* set) {
+  for (UnorderedSet& table : tables_) {
+    for (GcRoot<mirror::String>& string : table) {
+      set->Insert(string);
     }
-  } else {
-    table_to_write = &tables_.back();
   }
-  return table_to_write->WriteToMemory(ptr);
 }
 
 void InternTable::Table::Remove(mirror::String* s) {
@@ -440,7 +572,6 @@ void InternTable::Table::Remove(mirror::String* s) {
 }
 
 mirror::String* InternTable::Table::Find(mirror::String* s) {
-  Locks::intern_table_lock_->AssertHeld(Thread::Current());
   for (UnorderedSet& table : tables_) {
     auto it = table.Find(GcRoot<mirror::String>(s));
     if (it != table.end()) {
@@ -451,7 +582,6 @@ mirror::String* InternTable::Table::Find(mirror::String* s) {
 }
 
 mirror::String* InternTable::Table::Find(const Utf8String& string) {
-  Locks::intern_table_lock_->AssertHeld(Thread::Current());
   for (UnorderedSet& table : tables_) {
     auto it = table.Find(string);
     if (it != table.end()) {
@@ -518,7 +648,7 @@ void InternTable::ChangeWeakRootState(gc::WeakRootState new_state) {
 
 void InternTable::ChangeWeakRootStateLocked(gc::WeakRootState new_state) {
   CHECK(!kUseReadBarrier);
-  weak_root_state_ = new_state;
+  weak_root_state_.StoreRelease(new_state);
   if (new_state != gc::kWeakRootStateNoReadsOrWrites) {
     weak_intern_condition_.Broadcast(Thread::Current());
   }
@@ -17,7 +17,9 @@
 #ifndef ART_RUNTIME_INTERN_TABLE_H_
 #define ART_RUNTIME_INTERN_TABLE_H_
 
+#include <memory>
 #include <unordered_set>
+#include <vector>
 
 #include "atomic.h"
 #include "base/allocator.h"
@@ -51,6 +53,11 @@ class Transaction;
  * String.intern. Some code (XML parsers being a prime example) relies on being able to intern
  * arbitrarily many strings for the duration of a parse without permanently increasing the memory
  * footprint.
+ *
+ * Both tables are split into shards by string hash, each with its own lock, so that threads
+ * interning different strings rarely contend. The strong interns read from images are never
+ * modified and are searched without any lock. Locks::intern_table_lock_ only guards the image
+ * tables, the weak root state and transactions.
  */
 class InternTable {
  public:
@@ -78,6 +85,7 @@ class InternTable {
   mirror::String* InternWeak(mirror::String* s) SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!Roles::uninterruptible_);
 
+  // Sweeps the weak interns one shard at a time, lookups in other shards are not blocked.
   void SweepInternTableWeaks(IsMarkedVisitor* visitor) SHARED_REQUIRES(Locks::mutator_lock_)
       REQUIRES(!Locks::intern_table_lock_);
 
@@ -176,70 +184,89 @@ class InternTable {
     }
   };
 
+  typedef HashSet<GcRoot<mirror::String>, GcRootEmptyFn, StringHashEquals, StringHashEquals,
+      TrackingAllocator<GcRoot<mirror::String>, kAllocatorTagInternTable>> UnorderedSet;
+
   // Table which holds pre zygote and post zygote interned strings. There is one instance for
-  // weak interns and strong interns.
+  // weak interns and strong interns in each shard, guarded by the lock of the shard.
   class Table {
    public:
     Table();
-    mirror::String* Find(mirror::String* s) SHARED_REQUIRES(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
-    mirror::String* Find(const Utf8String& string) SHARED_REQUIRES(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
-    void Insert(mirror::String* s) SHARED_REQUIRES(Locks::mutator_lock_)
-        REQUIRES(Locks::intern_table_lock_);
-    void Remove(mirror::String* s)
-        SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-    void VisitRoots(RootVisitor* visitor)
-        SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-    void SweepWeaks(IsMarkedVisitor* visitor)
-        SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+    mirror::String* Find(mirror::String* s) SHARED_REQUIRES(Locks::mutator_lock_);
+    mirror::String* Find(const Utf8String& string) SHARED_REQUIRES(Locks::mutator_lock_);
+    void Insert(mirror::String* s) SHARED_REQUIRES(Locks::mutator_lock_);
+    void Remove(mirror::String* s) SHARED_REQUIRES(Locks::mutator_lock_);
+    void VisitRoots(RootVisitor* visitor) SHARED_REQUIRES(Locks::mutator_lock_);
+    void SweepWeaks(IsMarkedVisitor* visitor) SHARED_REQUIRES(Locks::mutator_lock_);
     // Add a new intern table that will only be inserted into from now on.
-    void AddNewTable() REQUIRES(Locks::intern_table_lock_);
-    size_t Size() const REQUIRES(Locks::intern_table_lock_);
-    // Read and add an intern table from ptr.
-    // Tables read are inserted at the front of the table array. Only checks for conflicts in
-    // debug builds. Returns how many bytes were read.
-    size_t AddTableFromMemory(const uint8_t* ptr)
-        REQUIRES(Locks::intern_table_lock_) SHARED_REQUIRES(Locks::mutator_lock_);
-    // Write the intern tables to ptr, if there are multiple tables they are combined into a single
-    // one. Returns how many bytes were written.
-    size_t WriteToMemory(uint8_t* ptr)
-        REQUIRES(Locks::intern_table_lock_) SHARED_REQUIRES(Locks::mutator_lock_);
+    void AddNewTable();
+    size_t Size() const;
+    // Insert all the interned strings into `set`.
+    void AddToSet(UnorderedSet* set) SHARED_REQUIRES(Locks::mutator_lock_);
 
    private:
-    typedef HashSet<GcRoot<mirror::String>, GcRootEmptyFn, StringHashEquals, StringHashEquals,
-        TrackingAllocator<GcRoot<mirror::String>, kAllocatorTagInternTable>> UnorderedSet;
-
     void SweepWeaks(UnorderedSet* set, IsMarkedVisitor* visitor)
-        SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+        SHARED_REQUIRES(Locks::mutator_lock_);
 
     // We call AddNewTable when we create the zygote to reduce private dirty pages caused by
     // modifying the zygote intern table. The back of table is modified when strings are interned.
     std::vector<UnorderedSet> tables_;
   };
 
+  // The interned strings whose hashes select this shard.
+  struct Shard {
+    Shard();
+
+    mutable Mutex lock_ ACQUIRED_AFTER(Locks::intern_table_lock_);
+    // Since these contain roots, they need a read barrier. Do not directly access the strings in
+    // them. Use functions that contain read barriers.
+    Table strong_interns_ GUARDED_BY(lock_);
+    Table weak_interns_ GUARDED_BY(lock_);
+    std::vector<GcRoot<mirror::String>> new_strong_intern_roots_ GUARDED_BY(lock_);
+
+    DISALLOW_COPY_AND_ASSIGN(Shard);
+  };
+
+  typedef std::vector<const UnorderedSet*> ImageTables;
+
+  static constexpr size_t kNumShardsBits = 4;
+  static constexpr size_t kNumShards = 1u << kNumShardsBits;
+
+  Shard* GetShard(int32_t hash) {
+    // Use the high bits of a multiplicative hash, string hashes of short strings are small.
+    return &shards_[(static_cast<uint32_t>(hash) * 0x9e3779b1u) >> (32 - kNumShardsBits)];
+  }
+  Shard* GetShard(mirror::String* s) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Look up a strong intern read from an image, without any lock.
+  mirror::String* LookupImageString(mirror::String* s) SHARED_REQUIRES(Locks::mutator_lock_);
+  mirror::String* LookupImageString(const Utf8String& string)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
   // Insert if non null, otherwise return null. Must be called holding the mutator lock.
   // If holding_locks is true, then we may also hold other locks. If holding_locks is true, then we
   // require GC is not running since it is not safe to wait while holding locks.
   mirror::String* Insert(mirror::String* s, bool is_strong, bool holding_locks)
       REQUIRES(!Locks::intern_table_lock_) SHARED_REQUIRES(Locks::mutator_lock_);
-
-  mirror::String* LookupStrongLocked(mirror::String* s)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  mirror::String* LookupWeakLocked(mirror::String* s)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  mirror::String* InsertStrong(mirror::String* s)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  mirror::String* InsertWeak(mirror::String* s)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  void RemoveStrong(mirror::String* s)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
-  void RemoveWeak(mirror::String* s)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+  mirror::String* InsertLocked(Shard* shard,
+                               mirror::String* s,
+                               bool is_strong,
+                               bool holding_locks,
+                               bool in_transaction)
+      REQUIRES(shard->lock_) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  mirror::String* InsertStrong(Shard* shard, mirror::String* s)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(shard->lock_);
+  mirror::String* InsertWeak(Shard* shard, mirror::String* s)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(shard->lock_);
+  void RemoveStrong(Shard* shard, mirror::String* s)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(shard->lock_);
+  void RemoveWeak(Shard* shard, mirror::String* s)
+      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(shard->lock_);
 
   // Transaction rollback access.
   mirror::String* LookupStringFromImage(mirror::String* s)
-      SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
+      SHARED_REQUIRES(Locks::mutator_lock_);
   mirror::String* InsertStrongFromTransaction(mirror::String* s)
       SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::intern_table_lock_);
   mirror::String* InsertWeakFromTransaction(mirror::String* s)
@@ -252,30 +279,36 @@ class InternTable {
   size_t AddTableFromMemoryLocked(const uint8_t* ptr)
       REQUIRES(Locks::intern_table_lock_) SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Publish the array of the image tables for the lock-free lookups.
+  void PublishImageTables() REQUIRES(Locks::intern_table_lock_);
+
   // Change the weak root state. May broadcast to waiters.
   void ChangeWeakRootStateLocked(gc::WeakRootState new_state)
       REQUIRES(Locks::intern_table_lock_);
 
-  // Wait until we can read weak roots.
-  void WaitUntilAccessible(Thread* self)
-      REQUIRES(Locks::intern_table_lock_) SHARED_REQUIRES(Locks::mutator_lock_);
+  // Wait until we can read weak roots. Releases the lock of `shard`, and the intern table lock if
+  // `in_transaction`, while waiting.
+  void WaitUntilAccessible(Thread* self, Shard* shard, bool in_transaction)
+      SHARED_REQUIRES(Locks::mutator_lock_) NO_THREAD_SAFETY_ANALYSIS;
 
-  bool images_added_to_intern_table_ GUARDED_BY(Locks::intern_table_lock_);
-  bool log_new_roots_ GUARDED_BY(Locks::intern_table_lock_);
+  // Set once the image strings are in image_tables_, written with the intern table lock held.
+  Atomic<bool> images_added_to_intern_table_;
+  // Written with the intern table lock held, in GC pauses.
+  Atomic<bool> log_new_roots_;
   ConditionVariable weak_intern_condition_ GUARDED_BY(Locks::intern_table_lock_);
-  // Since this contains (strong) roots, they need a read barrier to
-  // enable concurrent intern table (strong) root scan. Do not
-  // directly access the strings in it. Use functions that contain
-  // read barriers.
-  Table strong_interns_ GUARDED_BY(Locks::intern_table_lock_);
-  std::vector<GcRoot<mirror::String>> new_strong_intern_roots_
+  Shard shards_[kNumShards];
+  // Strong interns read from images. They are never modified, except for the GC visiting their
+  // roots, and are allocated separately so that their addresses stay valid for the lock-free
+  // lookups.
+  std::vector<std::unique_ptr<UnorderedSet>> image_tables_ GUARDED_BY(Locks::intern_table_lock_);
+  // The image tables searched by the lock-free lookups. Replaced by a new array when an image
+  // table is added, the replaced arrays are kept until the intern table is deleted.
+  Atomic<const ImageTables*> image_tables_for_lookup_;
+  std::vector<std::unique_ptr<ImageTables>> image_table_arrays_
       GUARDED_BY(Locks::intern_table_lock_);
-  // Since this contains (weak) roots, they need a read barrier. Do
-  // not directly access the strings in it. Use functions that contain
-  // read barriers.
-  Table weak_interns_ GUARDED_BY(Locks::intern_table_lock_);
-  // Weak root state, used for concurrent system weak processing and more.
-  gc::WeakRootState weak_root_state_ GUARDED_BY(Locks::intern_table_lock_);
+  // Weak root state, used for concurrent system weak processing and more. Written with the intern
+  // table lock held, read with the lock of a shard held.
+  Atomic<gc::WeakRootState> weak_root_state_;
 
   friend class Transaction;
   DISALLOW_COPY_AND_ASSIGN(InternTable);
@@ -16,6 +16,7 @@
 
 #include "intern_table.h"
 
+#include "base/stringprintf.h"
 #include "common_runtime_test.h"
 #include "mirror/object.h"
 #include "handle_scope-inl.h"
@@ -212,4 +213,30 @@ TEST_F(InternTableTest, LookupStrong) {
   EXPECT_TRUE(lookup_foobbS == nullptr);
 }
 
+TEST_F(InternTableTest, AddTableFromMemory) {
+  static constexpr size_t kNumStrings = 64;
+  ScopedObjectAccess soa(Thread::Current());
+  InternTable intern_table;
+  std::vector<mirror::String*> strings;
+  for (size_t i = 0; i < kNumStrings; ++i) {
+    strings.push_back(intern_table.InternStrong(StringPrintf("string%zu", i).c_str()));
+    ASSERT_TRUE(strings.back() != nullptr);
+  }
+  EXPECT_EQ(kNumStrings, intern_table.StrongSize());
+  const size_t size = intern_table.WriteToMemory(nullptr);
+  std::unique_ptr<uint8_t[]> memory(new uint8_t[size]);
+  EXPECT_EQ(size, intern_table.WriteToMemory(memory.get()));
+
+  // The strings of the shards are found in the table read from memory, as with an image.
+  InternTable image_intern_table;
+  EXPECT_EQ(size, image_intern_table.AddTableFromMemory(memory.get()));
+  EXPECT_EQ(kNumStrings, image_intern_table.StrongSize());
+  for (mirror::String* s : strings) {
+    EXPECT_EQ(s, image_intern_table.LookupStrong(soa.Self(), s));
+    EXPECT_EQ(s, image_intern_table.InternStrong(s));
+  }
+  EXPECT_EQ(kNumStrings, image_intern_table.StrongSize());
+  EXPECT_EQ(0u, image_intern_table.WeakSize());
+}
+
 }  // namespace art
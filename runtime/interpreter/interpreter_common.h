@@ -752,7 +752,8 @@ static inline String* ResolveString(Thread* self, ShadowFrame& shadow_frame, uin
   mirror::Class* declaring_class = method->GetDeclaringClass();
   // MethodVerifier refuses methods with string_idx out of bounds.
   DCHECK_LT(string_idx, declaring_class->GetDexCache()->NumStrings());
-  mirror::String* s = declaring_class->GetDexCacheStrings()[string_idx].Read();
+  // The dex cache strings array of the class may be hash-indexed, go through the dex cache.
+  mirror::String* s = declaring_class->GetDexCache()->GetResolvedString(string_idx);
   if (UNLIKELY(s == nullptr)) {
     StackHandleScope<1> hs(self);
     Handle<mirror::DexCache> dex_cache(hs.NewHandle(declaring_class->GetDexCache()));
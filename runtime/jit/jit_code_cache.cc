@@ -16,6 +16,7 @@
 
 #include "jit_code_cache.h"
 
+#include <algorithm>
 #include <sstream>
 
 #include "art_method-inl.h"
@@ -245,6 +246,15 @@ static uintptr_t FromCodeToAllocation(const void* code) {
 void JitCodeCache::FreeCode(const void* code_ptr, ArtMethod* method ATTRIBUTE_UNUSED) {
   uintptr_t allocation = FromCodeToAllocation(code_ptr);
   const OatQuickMethodHeader* method_header = OatQuickMethodHeader::FromCodePointer(code_ptr);
+  for (auto& entry : cha_dependents_) {
+    std::vector<std::pair<const void*, ArtMethod*>>& dependents = entry.second;
+    dependents.erase(std::remove_if(dependents.begin(),
+                                    dependents.end(),
+                                    [code_ptr](const std::pair<const void*, ArtMethod*>& pair) {
+                                      return pair.first == code_ptr;
+                                    }),
+                     dependents.end());
+  }
   // Notify native debugger that we are about to remove the code.
   // It does nothing if we are not using native debugger.
   DeleteJITCodeEntryForAddress(reinterpret_cast<uintptr_t>(code_ptr));
@@ -284,6 +294,15 @@ void JitCodeCache::RemoveMethodsIn(Thread* self, const LinearAlloc& alloc) {
       ++it;
     }
   }
+  for (auto it = cha_dependents_.begin(); it != cha_dependents_.end();) {
+    if (alloc.ContainsUnsafe(it->first)) {
+      // The code depending on the method cannot be invalidated anymore, as no class
+      // overriding the method can be linked.
+      it = cha_dependents_.erase(it);
+    } else {
+      ++it;
+    }
+  }
   for (auto it = profiling_infos_.begin(); it != profiling_infos_.end();) {
     ProfilingInfo* info = *it;
     if (alloc.ContainsUnsafe(info->GetMethod())) {
@@ -976,6 +995,12 @@ size_t JitCodeCache::GetMemorySizeOfCodePointer(const void* ptr) {
 
 void JitCodeCache::InvalidateCompiledCodeFor(ArtMethod* method,
                                              const OatQuickMethodHeader* header) {
+  MutexLock mu(Thread::Current(), lock_);
+  InvalidateCompiledCodeForLocked(method, header);
+}
+
+void JitCodeCache::InvalidateCompiledCodeForLocked(ArtMethod* method,
+                                                   const OatQuickMethodHeader* header) {
   ProfilingInfo* profiling_info = method->GetProfilingInfo(sizeof(void*));
   if ((profiling_info != nullptr) &&
       (profiling_info->GetSavedEntryPoint() == header->GetEntryPoint())) {
@@ -991,17 +1016,53 @@ void JitCodeCache::InvalidateCompiledCodeFor(ArtMethod* method,
         method, GetQuickToInterpreterBridge());
     method->ClearCounter();
   } else {
-    MutexLock mu(Thread::Current(), lock_);
     auto it = osr_code_map_.find(method);
     if (it != osr_code_map_.end() && OatQuickMethodHeader::FromCodePointer(it->second) == header) {
       // Remove the OSR method, to avoid using it again.
       osr_code_map_.erase(it);
     }
   }
-  MutexLock mu(Thread::Current(), lock_);
   number_of_deoptimizations_++;
 }
 
+bool JitCodeCache::AddSingleImplementationDependency(Thread* self,
+                                                     ArtMethod* single_implementation,
+                                                     ArtMethod* method,
+                                                     const OatQuickMethodHeader* code) {
+  MutexLock mu(self, lock_);
+  // The class linker clears the flag with the cha_lock_ held and then invalidates the
+  // dependents, so either the flag is still set and the invalidation will find the code,
+  // or the caller needs to invalidate it.
+  MutexLock cha_mu(self, *Locks::cha_lock_);
+  if (!single_implementation->HasSingleImplementation()) {
+    return false;
+  }
+  auto it = cha_dependents_.lower_bound(single_implementation);
+  if (it == cha_dependents_.end() || it->first != single_implementation) {
+    it = cha_dependents_.PutBefore(
+        it, single_implementation, std::vector<std::pair<const void*, ArtMethod*>>());
+  }
+  it->second.emplace_back(code->GetCode(), method);
+  return true;
+}
+
+void JitCodeCache::InvalidateSingleImplementationDependents(ArtMethod* single_implementation) {
+  // Keep the lock while invalidating: the code of the dependents is only guaranteed to be
+  // alive while they are in `cha_dependents_`, as freeing the code removes them under `lock_`.
+  MutexLock mu(Thread::Current(), lock_);
+  auto it = cha_dependents_.find(single_implementation);
+  if (it == cha_dependents_.end()) {
+    return;
+  }
+  for (const std::pair<const void*, ArtMethod*>& dependent : it->second) {
+    VLOG(jit) << "Invalidating compiled code of " << PrettyMethod(dependent.second)
+              << " as " << PrettyMethod(single_implementation) << " got overridden";
+    InvalidateCompiledCodeForLocked(dependent.second,
+                                    OatQuickMethodHeader::FromCodePointer(dependent.first));
+  }
+  cha_dependents_.erase(it);
+}
+
 uint8_t* JitCodeCache::AllocateCode(size_t code_size) {
   size_t alignment = GetInstructionSetAlignment(kRuntimeISA);
   uint8_t* result = reinterpret_cast<uint8_t*>(
@@ -184,11 +184,32 @@ class JitCodeCache {
       REQUIRES(!lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Record that the compiled code `code` of `method` assumes `single_implementation` is not
+  // overridden. Return false if the assumption is already invalid, in which case the caller
+  // must invalidate the code.
+  bool AddSingleImplementationDependency(Thread* self,
+                                         ArtMethod* single_implementation,
+                                         ArtMethod* method,
+                                         const OatQuickMethodHeader* code)
+      REQUIRES(!lock_)
+      REQUIRES(!Locks::cha_lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Invalidate the compiled code that assumed `single_implementation` was not overridden.
+  // Called by the class linker when a class overriding it gets linked.
+  void InvalidateSingleImplementationDependents(ArtMethod* single_implementation)
+      REQUIRES(!lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
   void Dump(std::ostream& os) REQUIRES(!lock_);
 
   bool IsOsrCompiled(ArtMethod* method) REQUIRES(!lock_);
 
  private:
+  void InvalidateCompiledCodeForLocked(ArtMethod* method, const OatQuickMethodHeader* code)
+      REQUIRES(lock_)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
   // Take ownership of maps.
   JitCodeCache(MemMap* code_map,
                MemMap* data_map,
@@ -283,6 +304,10 @@ class JitCodeCache {
   SafeMap<ArtMethod*, const void*> osr_code_map_ GUARDED_BY(lock_);
   // ProfilingInfo objects we have allocated.
   std::vector<ProfilingInfo*> profiling_infos_ GUARDED_BY(lock_);
+  // Holds, for each method assumed to have a single implementation, the compiled code relying
+  // on that assumption, as pairs of the code pointer and the compiled method.
+  SafeMap<ArtMethod*, std::vector<std::pair<const void*, ArtMethod*>>> cha_dependents_
+      GUARDED_BY(lock_);
 
   // The maximum capacity in bytes this code cache can go to.
   size_t max_capacity_ GUARDED_BY(lock_);
@@ -59,9 +59,7 @@ bool ProfileCompilationInfo::AddMethodsAndClasses(
     const std::vector<MethodReference>& methods,
     const std::set<DexCacheResolvedClasses>& resolved_classes) {
   for (const MethodReference& method : methods) {
-    if (!AddMethodIndex(GetProfileDexFileKey(method.dex_file->GetLocation()),
-                        method.dex_file->GetLocationChecksum(),
-                        method.dex_method_index)) {
+    if (!AddMethod(method)) {
       return false;
     }
   }
@@ -73,6 +71,18 @@ bool ProfileCompilationInfo::AddMethodsAndClasses(
   return true;
 }
 
+bool ProfileCompilationInfo::AddMethod(const MethodReference& method_ref) {
+  return AddMethodIndex(GetProfileDexFileKey(method_ref.dex_file->GetLocation()),
+                        method_ref.dex_file->GetLocationChecksum(),
+                        method_ref.dex_method_index);
+}
+
+bool ProfileCompilationInfo::AddClass(const DexFile& dex_file, uint16_t class_def_idx) {
+  return AddClassIndex(GetProfileDexFileKey(dex_file.GetLocation()),
+                       dex_file.GetLocationChecksum(),
+                       class_def_idx);
+}
+
 bool ProfileCompilationInfo::MergeAndSave(const std::string& filename,
                                           uint64_t* bytes_written,
                                           bool force) {
@@ -225,10 +235,11 @@ bool ProfileCompilationInfo::Save(int fd) {
 
     AddStringToBuffer(&buffer, dex_location);
 
-    for (auto method_it : dex_data.method_set) {
+    // Write the elements in insertion order so that Load() restores it.
+    for (auto method_it : dex_data.method_order) {
       AddUintToBuffer(&buffer, method_it);
     }
-    for (auto class_id : dex_data.class_set) {
+    for (auto class_id : dex_data.class_order) {
       AddUintToBuffer(&buffer, class_id);
     }
     DCHECK_EQ(required_capacity, buffer.size())
@@ -259,7 +270,11 @@ bool ProfileCompilationInfo::AddResolvedClasses(const DexCacheResolvedClasses& c
   if (data == nullptr) {
     return false;
   }
-  data->class_set.insert(classes.GetClasses().begin(), classes.GetClasses().end());
+  for (uint16_t class_def_idx : classes.GetClasses()) {
+    if (data->class_set.insert(class_def_idx).second) {
+      data->class_order.push_back(class_def_idx);
+    }
+  }
   return true;
 }
 
@@ -270,7 +285,9 @@ bool ProfileCompilationInfo::AddMethodIndex(const std::string& dex_location,
   if (data == nullptr) {
     return false;
   }
-  data->method_set.insert(method_idx);
+  if (data->method_set.insert(method_idx).second) {
+    data->method_order.push_back(method_idx);
+  }
   return true;
 }
 
@@ -281,7 +298,9 @@ bool ProfileCompilationInfo::AddClassIndex(const std::string& dex_location,
   if (data == nullptr) {
     return false;
   }
-  data->class_set.insert(class_idx);
+  if (data->class_set.insert(class_idx).second) {
+    data->class_order.push_back(class_idx);
+  }
   return true;
 }
 
@@ -538,14 +557,31 @@ bool ProfileCompilationInfo::MergeWith(const ProfileCompilationInfo& other) {
     if (info_it == info_.end()) {
       info_it = info_.Put(other_dex_location, DexFileData(other_dex_data.checksum));
     }
-    info_it->second.method_set.insert(other_dex_data.method_set.begin(),
-                                      other_dex_data.method_set.end());
-    info_it->second.class_set.insert(other_dex_data.class_set.begin(),
-                                     other_dex_data.class_set.end());
+    // Elements new to this profile go after the existing ones, in the order of `other`.
+    DexFileData* const dex_data = &info_it->second;
+    for (uint16_t method_idx : other_dex_data.method_order) {
+      if (dex_data->method_set.insert(method_idx).second) {
+        dex_data->method_order.push_back(method_idx);
+      }
+    }
+    for (uint16_t class_def_idx : other_dex_data.class_order) {
+      if (dex_data->class_set.insert(class_def_idx).second) {
+        dex_data->class_order.push_back(class_def_idx);
+      }
+    }
   }
   return true;
 }
 
+const ProfileCompilationInfo::DexFileData* ProfileCompilationInfo::FindDexFileData(
+    const DexFile& dex_file) const {
+  auto info_it = info_.find(GetProfileDexFileKey(dex_file.GetLocation()));
+  if (info_it == info_.end() || info_it->second.checksum != dex_file.GetLocationChecksum()) {
+    return nullptr;
+  }
+  return &info_it->second;
+}
+
 bool ProfileCompilationInfo::ContainsMethod(const MethodReference& method_ref) const {
   auto info_it = info_.find(GetProfileDexFileKey(method_ref.dex_file->GetLocation()));
   if (info_it != info_.end()) {
@@ -655,7 +691,18 @@ std::set<DexCacheResolvedClasses> ProfileCompilationInfo::GetResolvedClasses() c
 void ProfileCompilationInfo::ClearResolvedClasses() {
   for (auto& pair : info_) {
     pair.second.class_set.clear();
+    pair.second.class_order.clear();
   }
 }
 
+std::vector<uint16_t> ProfileCompilationInfo::GetClassesInOrder(const DexFile& dex_file) const {
+  const DexFileData* data = FindDexFileData(dex_file);
+  return (data != nullptr) ? data->class_order : std::vector<uint16_t>();
+}
+
+std::vector<uint16_t> ProfileCompilationInfo::GetMethodsInOrder(const DexFile& dex_file) const {
+  const DexFileData* data = FindDexFileData(dex_file);
+  return (data != nullptr) ? data->method_order : std::vector<uint16_t>();
+}
+
 }  // namespace art
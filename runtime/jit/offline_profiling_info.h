@@ -44,6 +44,10 @@ class ProfileCompilationInfo {
   // Add the given methods and classes to the current profile object.
   bool AddMethodsAndClasses(const std::vector<MethodReference>& methods,
                             const std::set<DexCacheResolvedClasses>& resolved_classes);
+  // Add a single method or class to the current profile object. Elements are kept in the order
+  // they are first added.
+  bool AddMethod(const MethodReference& method_ref);
+  bool AddClass(const DexFile& dex_file, uint16_t class_def_idx);
   // Loads profile information from the given file descriptor.
   bool Load(int fd);
   // Merge the data from another ProfileCompilationInfo into the current object.
@@ -87,6 +91,14 @@ class ProfileCompilationInfo {
   // Clears the resolved classes from the current object.
   void ClearResolvedClasses();
 
+  // Returns the class def indexes of the classes of `dex_file` in the order they were added to
+  // the profile. For profiles created from startup traces, this is their first-touch order.
+  std::vector<uint16_t> GetClassesInOrder(const DexFile& dex_file) const;
+
+  // Returns the method indexes of the methods of `dex_file` in the order they were added to the
+  // profile.
+  std::vector<uint16_t> GetMethodsInOrder(const DexFile& dex_file) const;
+
  private:
   enum ProfileLoadSatus {
     kProfileLoadIOError,
@@ -100,6 +112,10 @@ class ProfileCompilationInfo {
     uint32_t checksum;
     std::set<uint16_t> method_set;
     std::set<uint16_t> class_set;
+    // The elements of the sets above, in insertion order. This is also the order they are saved
+    // and loaded in, so the order is kept without changing the file format.
+    std::vector<uint16_t> method_order;
+    std::vector<uint16_t> class_order;
 
     bool operator==(const DexFileData& other) const {
       return checksum == other.checksum && method_set == other.method_set;
@@ -109,6 +125,7 @@ class ProfileCompilationInfo {
   using DexFileToProfileInfoMap = SafeMap<const std::string, DexFileData>;
 
   DexFileData* GetOrAddDexFileData(const std::string& dex_location, uint32_t checksum);
+  const DexFileData* FindDexFileData(const DexFile& dex_file) const;
   bool AddMethodIndex(const std::string& dex_location, uint32_t checksum, uint16_t method_idx);
   bool AddClassIndex(const std::string& dex_location, uint32_t checksum, uint16_t class_idx);
   bool AddResolvedClasses(const DexCacheResolvedClasses& classes);
@@ -324,4 +324,38 @@ TEST_F(ProfileCompilationInfoTest, UnexpectedContent) {
   ASSERT_FALSE(loaded_info.Load(GetFd(profile)));
 }
 
+TEST_F(ProfileCompilationInfoTest, KeepsInsertionOrder) {
+  ScratchFile profile;
+  const DexFile& dex_file = *java_lang_dex_file_;
+  const std::vector<uint16_t> methods = { 5u, 1u, 3u };
+  const std::vector<uint16_t> classes = { 7u, 2u };
+
+  ProfileCompilationInfo saved_info;
+  for (uint16_t method_idx : methods) {
+    ASSERT_TRUE(saved_info.AddMethod(MethodReference(&dex_file, method_idx)));
+  }
+  for (uint16_t class_def_idx : classes) {
+    ASSERT_TRUE(saved_info.AddClass(dex_file, class_def_idx));
+  }
+  // Duplicates keep their first position.
+  ASSERT_TRUE(saved_info.AddMethod(MethodReference(&dex_file, 5u)));
+  EXPECT_EQ(methods, saved_info.GetMethodsInOrder(dex_file));
+  EXPECT_EQ(classes, saved_info.GetClassesInOrder(dex_file));
+  ASSERT_TRUE(saved_info.Save(GetFd(profile)));
+  ASSERT_EQ(0, profile.GetFile()->Flush());
+
+  ProfileCompilationInfo loaded_info;
+  ASSERT_TRUE(profile.GetFile()->ResetOffset());
+  ASSERT_TRUE(loaded_info.Load(GetFd(profile)));
+  EXPECT_EQ(methods, loaded_info.GetMethodsInOrder(dex_file));
+  EXPECT_EQ(classes, loaded_info.GetClassesInOrder(dex_file));
+
+  // Merged elements go after the existing ones.
+  ProfileCompilationInfo other_info;
+  ASSERT_TRUE(other_info.AddMethod(MethodReference(&dex_file, 4u)));
+  ASSERT_TRUE(other_info.AddMethod(MethodReference(&dex_file, 1u)));
+  ASSERT_TRUE(loaded_info.MergeWith(other_info));
+  EXPECT_EQ(std::vector<uint16_t>({ 5u, 1u, 3u, 4u }), loaded_info.GetMethodsInOrder(dex_file));
+}
+
 }  // namespace art
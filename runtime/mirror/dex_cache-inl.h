@@ -19,8 +19,11 @@
 
 #include "dex_cache.h"
 
+#include <string.h>
+
 #include "art_field-inl.h"
 #include "art_method-inl.h"
+#include "atomic.h"
 #include "base/casts.h"
 #include "base/logging.h"
 #include "mirror/class.h"
@@ -34,15 +37,42 @@ inline uint32_t DexCache::ClassSize(size_t pointer_size) {
   return Class::ComputeClassSize(true, vtable_entries, 0, 0, 0, 0, 0, pointer_size);
 }
 
+inline StringDexCachePair DexCache::LoadStringPair(StringDexCachePair* pair) {
+  int64_t raw = QuasiAtomic::Read64(reinterpret_cast<volatile const int64_t*>(pair));
+  StringDexCachePair value;
+  memcpy(&value, &raw, sizeof(value));
+  return value;
+}
+
+inline void DexCache::StoreStringPair(StringDexCachePair* pair, StringDexCachePair value) {
+  int64_t raw;
+  memcpy(&raw, &value, sizeof(raw));
+  QuasiAtomic::Write64(reinterpret_cast<volatile int64_t*>(pair), raw);
+}
+
 inline String* DexCache::GetResolvedString(uint32_t string_idx) {
   DCHECK_LT(string_idx, NumStrings());
+  if (HasHashedStrings()) {
+    StringDexCachePair* slot = &GetHashedStrings()[string_idx % kDexCacheStringCacheSize];
+    StringDexCachePair pair = LoadStringPair(slot);
+    // The string of another index is a miss. Note that all pairs start out with a null string.
+    return (pair.string_index == string_idx) ? pair.string.Read() : nullptr;
+  }
   return GetStrings()[string_idx].Read();
 }
 
 inline void DexCache::SetResolvedString(uint32_t string_idx, String* resolved) {
   DCHECK_LT(string_idx, NumStrings());
   // TODO default transaction support.
-  GetStrings()[string_idx] = GcRoot<String>(resolved);
+  if (HasHashedStrings()) {
+    StringDexCachePair* slot = &GetHashedStrings()[string_idx % kDexCacheStringCacheSize];
+    StringDexCachePair pair;
+    pair.string = GcRoot<String>(resolved);
+    pair.string_index = string_idx;
+    StoreStringPair(slot, pair);
+  } else {
+    GetStrings()[string_idx] = GcRoot<String>(resolved);
+  }
   // TODO: Fine-grained marking, so that we don't need to go through all arrays in full.
   Runtime::Current()->GetHeap()->WriteBarrierEveryFieldOf(this);
 }
@@ -130,9 +160,16 @@ inline void DexCache::VisitReferences(mirror::Class* klass, const Visitor& visit
   VisitInstanceFieldsReferences<kVerifyFlags, kReadBarrierOption>(klass, visitor);
   // Visit arrays after.
   if (kVisitNativeRoots) {
-    GcRoot<mirror::String>* strings = GetStrings();
-    for (size_t i = 0, num_strings = NumStrings(); i != num_strings; ++i) {
-      visitor.VisitRootIfNonNull(strings[i].AddressWithoutBarrier());
+    if (HasHashedStrings()) {
+      StringDexCachePair* pairs = GetHashedStrings();
+      for (size_t i = 0; i != kDexCacheStringCacheSize; ++i) {
+        visitor.VisitRootIfNonNull(pairs[i].string.AddressWithoutBarrier());
+      }
+    } else {
+      GcRoot<mirror::String>* strings = GetStrings();
+      for (size_t i = 0, num_strings = NumStrings(); i != num_strings; ++i) {
+        visitor.VisitRootIfNonNull(strings[i].AddressWithoutBarrier());
+      }
     }
     GcRoot<mirror::Class>* resolved_types = GetResolvedTypes();
     for (size_t i = 0, num_types = NumResolvedTypes(); i != num_types; ++i) {
@@ -143,6 +180,17 @@ inline void DexCache::VisitReferences(mirror::Class* klass, const Visitor& visit
 
 template <ReadBarrierOption kReadBarrierOption, typename Visitor>
 inline void DexCache::FixupStrings(GcRoot<mirror::String>* dest, const Visitor& visitor) {
+  if (HasHashedStrings()) {
+    StringDexCachePair* src = GetHashedStrings();
+    StringDexCachePair* dest_pairs = reinterpret_cast<StringDexCachePair*>(dest);
+    for (size_t i = 0; i < kDexCacheStringCacheSize; ++i) {
+      mirror::String* source = src[i].string.Read<kReadBarrierOption>();
+      mirror::String* new_source = visitor(source);
+      dest_pairs[i].string = GcRoot<mirror::String>(new_source);
+      dest_pairs[i].string_index = src[i].string_index;
+    }
+    return;
+  }
   GcRoot<mirror::String>* src = GetStrings();
   for (size_t i = 0, count = NumStrings(); i < count; ++i) {
     mirror::String* source = src[i].Read<kReadBarrierOption>();
@@ -35,6 +35,18 @@ namespace mirror {
 
 class String;
 
+// A resolved string and its string index, an element of the hash-indexed strings array of a
+// DexCache, see DexCache::HasHashedStrings(). Pairs are read and written with single 64-bit
+// atomic accesses so that a reader never sees the string of one index with another index.
+struct alignas(8) StringDexCachePair {
+  GcRoot<String> string;
+  uint32_t string_index;
+};
+static_assert(sizeof(StringDexCachePair) == 8u, "Unexpected StringDexCachePair size");
+// Compiled code loads a pair as a 64-bit value and takes the string from the low half.
+static_assert(offsetof(StringDexCachePair, string) == 0u, "Unexpected string offset");
+static_assert(offsetof(StringDexCachePair, string_index) == 4u, "Unexpected string_index offset");
+
 // C++ mirror of java.lang.DexCache.
 class MANAGED DexCache FINAL : public Object {
  public:
@@ -46,6 +58,29 @@ class MANAGED DexCache FINAL : public Object {
     return sizeof(DexCache);
   }
 
+  // Number of elements of the hash-indexed strings array.
+  static constexpr size_t kDexCacheStringCacheSize = 4096;
+
+  // Dex files with more string ids than this use a hash-indexed strings array of
+  // kDexCacheStringCacheSize pairs instead of a strings array with an element per string id.
+  // String `string_idx` can only be cached in the pair `string_idx % kDexCacheStringCacheSize`
+  // and a lookup misses if that pair holds another string. Compiled code loads these strings
+  // with HLoadString::LoadKind::kHashedDexCacheViaMethod.
+  // TODO: Hash the resolved types, methods and fields arrays of large dex files the same way.
+  static constexpr size_t kDexCacheStringHashThreshold = 16 * KB;
+
+  static_assert(kDexCacheStringCacheSize <= kDexCacheStringHashThreshold,
+                "The hash-indexed strings array must not be larger than the full one");
+
+  static constexpr bool HasHashedStrings(size_t num_string_ids) {
+    return num_string_ids > kDexCacheStringHashThreshold;
+  }
+
+  // Number of elements of the strings array of a dex file with `num_string_ids` string ids.
+  static constexpr size_t NumStringsArrayElements(size_t num_string_ids) {
+    return HasHashedStrings(num_string_ids) ? kDexCacheStringCacheSize : num_string_ids;
+  }
+
   void Init(const DexFile* dex_file,
             String* location,
             GcRoot<String>* strings,
@@ -133,10 +168,16 @@ class MANAGED DexCache FINAL : public Object {
   ALWAYS_INLINE void SetResolvedField(uint32_t idx, ArtField* field, size_t ptr_size)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // The strings array, an array of StringDexCachePair if HasHashedStrings().
   GcRoot<String>* GetStrings() ALWAYS_INLINE SHARED_REQUIRES(Locks::mutator_lock_) {
     return GetFieldPtr<GcRoot<String>*>(StringsOffset());
   }
 
+  StringDexCachePair* GetHashedStrings() ALWAYS_INLINE SHARED_REQUIRES(Locks::mutator_lock_) {
+    DCHECK(HasHashedStrings());
+    return reinterpret_cast<StringDexCachePair*>(GetStrings());
+  }
+
   void SetStrings(GcRoot<String>* strings) ALWAYS_INLINE SHARED_REQUIRES(Locks::mutator_lock_) {
     SetFieldPtr<false>(StringsOffset(), strings);
   }
@@ -171,10 +212,16 @@ class MANAGED DexCache FINAL : public Object {
     SetFieldPtr<false>(ResolvedFieldsOffset(), resolved_fields);
   }
 
+  // Number of string ids of the dex file. This is larger than the number of elements of the
+  // strings array if HasHashedStrings().
   size_t NumStrings() SHARED_REQUIRES(Locks::mutator_lock_) {
     return GetField32(NumStringsOffset());
   }
 
+  bool HasHashedStrings() ALWAYS_INLINE SHARED_REQUIRES(Locks::mutator_lock_) {
+    return HasHashedStrings(NumStrings());
+  }
+
   size_t NumResolvedTypes() SHARED_REQUIRES(Locks::mutator_lock_) {
     return GetField32(NumResolvedTypesOffset());
   }
@@ -216,17 +263,20 @@ class MANAGED DexCache FINAL : public Object {
   void VisitReferences(mirror::Class* klass, const Visitor& visitor)
       SHARED_REQUIRES(Locks::mutator_lock_) REQUIRES(Locks::heap_bitmap_lock_);
 
+  static StringDexCachePair LoadStringPair(StringDexCachePair* pair) ALWAYS_INLINE;
+  static void StoreStringPair(StringDexCachePair* pair, StringDexCachePair value) ALWAYS_INLINE;
+
   HeapReference<Object> dex_;
   HeapReference<String> location_;
   uint64_t dex_file_;           // const DexFile*
   uint64_t resolved_fields_;    // ArtField*, array with num_resolved_fields_ elements.
   uint64_t resolved_methods_;   // ArtMethod*, array with num_resolved_methods_ elements.
   uint64_t resolved_types_;     // GcRoot<Class>*, array with num_resolved_types_ elements.
-  uint64_t strings_;            // GcRoot<String>*, array with num_strings_ elements.
+  uint64_t strings_;            // GcRoot<String>*, see GetStrings().
   uint32_t num_resolved_fields_;    // Number of elements in the resolved_fields_ array.
   uint32_t num_resolved_methods_;   // Number of elements in the resolved_methods_ array.
   uint32_t num_resolved_types_;     // Number of elements in the resolved_types_ array.
-  uint32_t num_strings_;            // Number of elements in the strings_ array.
+  uint32_t num_strings_;            // Number of string ids, see NumStrings().
 
   friend struct art::DexCacheOffsets;  // for verifying offset information
   friend class Object;  // For VisitReferences
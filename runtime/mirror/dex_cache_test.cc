@@ -46,6 +46,46 @@ TEST_F(DexCacheTest, Open) {
   EXPECT_EQ(java_lang_dex_file_->NumFieldIds(),  dex_cache->NumResolvedFields());
 }
 
+TEST_F(DexCacheTest, HashedStrings) {
+  ScopedObjectAccess soa(Thread::Current());
+  StackHandleScope<1> hs(soa.Self());
+  ASSERT_TRUE(java_lang_dex_file_ != nullptr);
+  // The core library has enough strings to use a hash-indexed strings array.
+  ASSERT_GT(java_lang_dex_file_->NumStringIds(), DexCache::kDexCacheStringHashThreshold);
+  Handle<DexCache> dex_cache(
+      hs.NewHandle(class_linker_->AllocDexCache(soa.Self(),
+                                                *java_lang_dex_file_,
+                                                Runtime::Current()->GetLinearAlloc())));
+  ASSERT_TRUE(dex_cache.Get() != nullptr);
+  ASSERT_TRUE(dex_cache->HasHashedStrings());
+  EXPECT_EQ(java_lang_dex_file_->NumStringIds(), dex_cache->NumStrings());
+
+  // Both indexes map to the same pair of the strings array.
+  const uint32_t first_idx = 1u;
+  const uint32_t second_idx = first_idx + DexCache::kDexCacheStringCacheSize;
+  EXPECT_TRUE(dex_cache->GetResolvedString(first_idx) == nullptr);
+  String* first = class_linker_->ResolveString(*java_lang_dex_file_, first_idx, dex_cache);
+  ASSERT_TRUE(first != nullptr);
+  EXPECT_EQ(first, dex_cache->GetResolvedString(first_idx));
+  EXPECT_TRUE(dex_cache->GetResolvedString(second_idx) == nullptr);
+
+  String* second = class_linker_->ResolveString(*java_lang_dex_file_, second_idx, dex_cache);
+  ASSERT_TRUE(second != nullptr);
+  EXPECT_NE(first, second);
+  EXPECT_EQ(second, dex_cache->GetResolvedString(second_idx));
+  EXPECT_TRUE(dex_cache->GetResolvedString(first_idx) == nullptr);
+
+  // An evicted string is found again in the intern table.
+  EXPECT_EQ(first, class_linker_->LookupString(*java_lang_dex_file_, first_idx, dex_cache));
+  EXPECT_EQ(first, dex_cache->GetResolvedString(first_idx));
+
+  // Compiled code finds the hash-indexed strings array through the declaring class.
+  Class* object_class = class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;");
+  ASSERT_TRUE(object_class != nullptr);
+  ASSERT_TRUE(object_class->GetDexCache()->HasHashedStrings());
+  EXPECT_EQ(object_class->GetDexCache()->GetStrings(), object_class->GetDexCacheStrings());
+}
+
 TEST_F(DexCacheTest, LinearAlloc) {
   ScopedObjectAccess soa(Thread::Current());
   jobject jclass_loader(LoadDex("Main"));
@@ -38,6 +38,7 @@
 #include "ScopedUtfChars.h"
 #include "scoped_fast_native_object_access.h"
 #include "trace.h"
+#include "utils.h"
 #include "well_known_classes.h"
 
 namespace art {
@@ -229,7 +230,15 @@ static void VMDebug_dumpHprofData(JNIEnv* env, jclass, jstring javaFilename, job
     }
   }
 
-  hprof::DumpHeap(filename.c_str(), fd, false);
+  // A file name ending with ".gz" asks for a compressed dump.
+  const bool compress = EndsWith(filename, ".gz");
+  Runtime* runtime = Runtime::Current();
+  hprof::DumpHeap(filename.c_str(),
+                  fd,
+                  false,
+                  compress,
+                  runtime->GetHprofSampleInterval(),
+                  runtime->UseHprofForkSnapshot());
 }
 
 static void VMDebug_dumpHprofDataDdms(JNIEnv*, jclass) {
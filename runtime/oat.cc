@@ -76,6 +76,8 @@ OatHeader::OatHeader(InstructionSet instruction_set,
       quick_imt_conflict_trampoline_offset_(0),
       quick_resolution_trampoline_offset_(0),
       quick_to_interpreter_bridge_offset_(0),
+      verifier_deps_offset_(0),
+      verifier_deps_size_(0),
       image_patch_delta_(0),
       image_file_location_oat_checksum_(0),
       image_file_location_oat_data_begin_(0) {
@@ -178,6 +180,8 @@ void OatHeader::UpdateChecksumWithHeaderData() {
                  sizeof(quick_resolution_trampoline_offset_));
   UpdateChecksum(&quick_to_interpreter_bridge_offset_,
                  sizeof(quick_to_interpreter_bridge_offset_));
+  UpdateChecksum(&verifier_deps_offset_, sizeof(verifier_deps_offset_));
+  UpdateChecksum(&verifier_deps_size_, sizeof(verifier_deps_size_));
 }
 
 void OatHeader::UpdateChecksum(const void* data, size_t length) {
@@ -343,6 +347,23 @@ void OatHeader::SetQuickToInterpreterBridgeOffset(uint32_t offset) {
   quick_to_interpreter_bridge_offset_ = offset;
 }
 
+uint32_t OatHeader::GetVerifierDepsOffset() const {
+  DCHECK(IsValid());
+  return verifier_deps_offset_;
+}
+
+uint32_t OatHeader::GetVerifierDepsSize() const {
+  DCHECK(IsValid());
+  return verifier_deps_size_;
+}
+
+void OatHeader::SetVerifierDeps(uint32_t offset, uint32_t size) {
+  DCHECK(IsValid());
+  CHECK_ALIGNED(offset, sizeof(uint32_t));
+  verifier_deps_offset_ = offset;
+  verifier_deps_size_ = size;
+}
+
 int32_t OatHeader::GetImagePatchDelta() const {
   CHECK(IsValid());
   return image_patch_delta_;
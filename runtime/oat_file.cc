@@ -260,6 +260,19 @@ bool OatFileBase::Setup(const char* abs_dex_location, std::string* error_msg) {
     return false;
   }
 
+  uint32_t verifier_deps_offset = GetOatHeader().GetVerifierDepsOffset();
+  uint32_t verifier_deps_size = GetOatHeader().GetVerifierDepsSize();
+  if (verifier_deps_size != 0u &&
+      (verifier_deps_offset > Size() || Size() - verifier_deps_offset < verifier_deps_size)) {
+    *error_msg = StringPrintf("In oat file '%s' found truncated verifier dependencies: "
+                                  "%u + %u > %zu",
+                              GetLocation().c_str(),
+                              verifier_deps_offset,
+                              verifier_deps_size,
+                              Size());
+    return false;
+  }
+
   size_t pointer_size = GetInstructionSetPointerSize(GetOatHeader().GetInstructionSet());
   uint8_t* dex_cache_arrays = bss_begin_;
   uint32_t dex_file_count = GetOatHeader().GetDexFileCount();
@@ -1070,6 +1083,17 @@ const uint8_t* OatFile::BssEnd() const {
   return bss_end_;
 }
 
+const uint8_t* OatFile::GetVerifierDepsBegin() const {
+  const OatHeader& oat_header = GetOatHeader();
+  return (oat_header.GetVerifierDepsSize() != 0u)
+      ? Begin() + oat_header.GetVerifierDepsOffset()
+      : nullptr;
+}
+
+size_t OatFile::GetVerifierDepsSize() const {
+  return GetOatHeader().GetVerifierDepsSize();
+}
+
 const OatFile::OatDexFile* OatFile::GetOatDexFile(const char* dex_location,
                                                   const uint32_t* dex_location_checksum,
                                                   bool warn_if_not_found) const {
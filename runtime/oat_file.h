@@ -240,6 +240,10 @@ class OatFile {
   const uint8_t* BssBegin() const;
   const uint8_t* BssEnd() const;
 
+  // The encoded verifier::VerifierDepsTable, null if the oat file has none.
+  const uint8_t* GetVerifierDepsBegin() const;
+  size_t GetVerifierDepsSize() const;
+
   // Returns the absolute dex location for the encoded relative dex location.
   //
   // If not null, abs_dex_location is used to resolve the absolute dex
@@ -138,13 +138,12 @@ std::vector<const OatFile*> OatFileManager::RegisterImageOatFiles(
   return oat_files;
 }
 
+// A dex file ordered by the descriptor of its first class.
 class DexFileAndClassPair : ValueObject {
  public:
-  DexFileAndClassPair(const DexFile* dex_file, size_t current_class_index, bool from_loaded_oat)
-     : cached_descriptor_(GetClassDescriptor(dex_file, current_class_index)),
-       dex_file_(dex_file),
-       current_class_index_(current_class_index),
-       from_loaded_oat_(from_loaded_oat) {}
+  explicit DexFileAndClassPair(const DexFile* dex_file)
+     : cached_descriptor_(GetClassDescriptor(dex_file, 0u)),
+       dex_file_(dex_file) {}
 
   DexFileAndClassPair(const DexFileAndClassPair& rhs) = default;
 
@@ -164,23 +163,6 @@ class DexFileAndClassPair : ValueObject {
     return dex_file_ < rhs.dex_file_;
   }
 
-  bool DexFileHasMoreClasses() const {
-    return current_class_index_ + 1 < dex_file_->NumClassDefs();
-  }
-
-  void Next() {
-    ++current_class_index_;
-    cached_descriptor_ = GetClassDescriptor(dex_file_, current_class_index_);
-  }
-
-  size_t GetCurrentClassIndex() const {
-    return current_class_index_;
-  }
-
-  bool FromLoadedOat() const {
-    return from_loaded_oat_;
-  }
-
   const DexFile* GetDexFile() const {
     return dex_file_;
   }
@@ -194,35 +176,96 @@ class DexFileAndClassPair : ValueObject {
 
   const char* cached_descriptor_;
   const DexFile* dex_file_;
-  size_t current_class_index_;
-  bool from_loaded_oat_;  // We only need to compare mismatches between what we load now
-                          // and what was loaded before. Any old duplicates must have been
-                          // OK, and any new "internal" duplicates are as well (they must
-                          // be from multidex, which resolves correctly).
 };
 
-static void AddDexFilesFromOat(const OatFile* oat_file,
-                               bool already_loaded,
-                               /*out*/std::priority_queue<DexFileAndClassPair>* heap,
-                               std::vector<std::unique_ptr<const DexFile>>* opened_dex_files) {
+// Open the dex files of `oat_file` that define classes.
+static void OpenDexFilesWithClasses(
+    const OatFile* oat_file,
+    /*out*/std::vector<std::unique_ptr<const DexFile>>* opened_dex_files) {
   for (const OatDexFile* oat_dex_file : oat_file->GetOatDexFiles()) {
     std::string error;
     std::unique_ptr<const DexFile> dex_file = oat_dex_file->OpenDexFile(&error);
     if (dex_file == nullptr) {
       LOG(WARNING) << "Could not create dex file from oat file: " << error;
     } else if (dex_file->NumClassDefs() > 0U) {
-      heap->emplace(dex_file.get(), /*current_class_index*/0U, already_loaded);
       opened_dex_files->push_back(std::move(dex_file));
     }
   }
 }
 
-static void AddNext(/*inout*/DexFileAndClassPair* original,
-                    /*inout*/std::priority_queue<DexFileAndClassPair>* heap) {
-  if (original->DexFileHasMoreClasses()) {
-    original->Next();
-    heap->push(std::move(*original));
+static void AddDexFilesFromOat(const OatFile* oat_file,
+                               /*out*/std::priority_queue<DexFileAndClassPair>* heap,
+                               std::vector<std::unique_ptr<const DexFile>>* opened_dex_files) {
+  size_t first_new_dex_file = opened_dex_files->size();
+  OpenDexFilesWithClasses(oat_file, opened_dex_files);
+  for (size_t i = first_new_dex_file; i != opened_dex_files->size(); ++i) {
+    heap->emplace((*opened_dex_files)[i].get());
+  }
+}
+
+// A class descriptor with its TypeLookupTable hash.
+struct DescriptorAndHash {
+  const char* descriptor;
+  size_t hash;
+  const DexFile* dex_file;
+};
+
+static std::vector<DescriptorAndHash> GetClassDescriptors(const DexFile* dex_file) {
+  std::vector<DescriptorAndHash> descriptors;
+  descriptors.reserve(dex_file->NumClassDefs());
+  for (size_t i = 0; i != dex_file->NumClassDefs(); ++i) {
+    const DexFile::ClassDef& class_def = dex_file->GetClassDef(i);
+    const char* descriptor = dex_file->StringByTypeIdx(class_def.class_idx_);
+    descriptors.push_back(DescriptorAndHash {
+        descriptor, ComputeModifiedUtf8Hash(descriptor), dex_file });
+  }
+  return descriptors;
+}
+
+// The new dex files come with the TypeLookupTable of the oat file, or get one, so checking
+// whether they define a loaded class costs a hash and a probe of their tables, and strings are
+// only compared when the hash bits match. Loaded dex files that have a TypeLookupTable and more
+// classes than the new dex files are checked the other way around, so that loading a small dex
+// file next to a large app does not touch all the classes of the app.
+bool OatFileManager::FindDuplicateClass(const std::vector<const DexFile*>& loaded_dex_files,
+                                        const std::vector<const DexFile*>& new_dex_files,
+                                        /*out*/std::string* error_msg) {
+  std::vector<DescriptorAndHash> new_classes;
+  for (const DexFile* new_dex_file : new_dex_files) {
+    if (new_dex_file->GetTypeLookupTable() == nullptr) {
+      new_dex_file->CreateTypeLookupTable();
+    }
+    std::vector<DescriptorAndHash> classes = GetClassDescriptors(new_dex_file);
+    new_classes.insert(new_classes.end(), classes.begin(), classes.end());
+  }
+  auto report = [error_msg](const char* descriptor,
+                            const DexFile* loaded_dex_file,
+                            const DexFile* new_dex_file) {
+    *error_msg = StringPrintf("Found duplicated class when checking oat files: '%s' in %s and %s",
+                              descriptor,
+                              loaded_dex_file->GetLocation().c_str(),
+                              new_dex_file->GetLocation().c_str());
+    return true;
+  };
+  for (const DexFile* loaded_dex_file : loaded_dex_files) {
+    if (loaded_dex_file->GetTypeLookupTable() != nullptr &&
+        new_classes.size() < loaded_dex_file->NumClassDefs()) {
+      for (const DescriptorAndHash& new_class : new_classes) {
+        if (loaded_dex_file->FindClassDef(new_class.descriptor, new_class.hash) != nullptr) {
+          return report(new_class.descriptor, loaded_dex_file, new_class.dex_file);
+        }
+      }
+    } else {
+      for (const DescriptorAndHash& loaded_class : GetClassDescriptors(loaded_dex_file)) {
+        for (const DexFile* new_dex_file : new_dex_files) {
+          if (new_dex_file->FindClassDef(loaded_class.descriptor, loaded_class.hash) != nullptr) {
+            return report(loaded_class.descriptor, loaded_dex_file, new_dex_file);
+          }
+        }
+      }
+    }
   }
+  return false;
 }
 
 static void IterateOverJavaDexFile(mirror::Object* dex_file,
@@ -312,7 +355,7 @@ static bool GetDexFilesFromClassLoader(
   auto GetDexFilesFn = [&] (const DexFile* cp_dex_file)
             SHARED_REQUIRES(Locks::mutator_lock_) {
     if (cp_dex_file->NumClassDefs() > 0) {
-      queue->emplace(cp_dex_file, 0U, true);
+      queue->emplace(cp_dex_file);
     }
     return true;  // Continue looking.
   };
@@ -349,7 +392,7 @@ static void GetDexFilesFromDexElementsArray(
   auto GetDexFilesFn = [&] (const DexFile* cp_dex_file)
       SHARED_REQUIRES(Locks::mutator_lock_) {
     if (cp_dex_file != nullptr && cp_dex_file->NumClassDefs() > 0) {
-      queue->emplace(cp_dex_file, 0U, true);
+      queue->emplace(cp_dex_file);
     }
     return true;  // Continue looking.
   };
@@ -422,11 +465,8 @@ static bool AreSharedLibrariesOk(const std::string shared_libraries,
 // This first checks whether the shared libraries are in the expected order and the oat files
 // have the expected checksums. If so, we exit early. Otherwise, we do the collision check.
 //
-// The collision check works by maintaining a heap with one class from each dex file, sorted by the
-// class descriptor. Then a dex-file/class pair is continually removed from the heap and compared
-// against the following top element. If the descriptor is the same, it is now checked whether
-// the two elements agree on whether their dex file was from an already-loaded oat-file or the
-// new oat file. Any disagreement indicates a collision.
+// The collision check looks up the classes of the already loaded dex files in the dex files of the
+// new oat file, or the other way around, by descriptor hash. See FindDuplicateClass().
 bool OatFileManager::HasCollisions(const OatFile* oat_file,
                                    jobject class_loader,
                                    jobjectArray dex_elements,
@@ -487,10 +527,7 @@ bool OatFileManager::HasCollisions(const OatFile* oat_file,
           boot_oat_files.end() && location != oat_file->GetLocation() &&
           unique_locations.find(location) == unique_locations.end()) {
         unique_locations.insert(location);
-        AddDexFilesFromOat(loaded_oat_file.get(),
-                           /*already_loaded*/true,
-                           &queue,
-                           /*out*/&opened_dex_files);
+        AddDexFilesFromOat(loaded_oat_file.get(), &queue, /*out*/&opened_dex_files);
       }
     }
   }
@@ -502,40 +539,21 @@ bool OatFileManager::HasCollisions(const OatFile* oat_file,
     return false;
   }
 
-  // Add dex files from the oat file to check.
-  AddDexFilesFromOat(oat_file, /*already_loaded*/false, &queue, &opened_dex_files);
-
-  // Now drain the queue.
-  while (!queue.empty()) {
-    // Modifying the top element is only safe if we pop right after.
-    DexFileAndClassPair compare_pop(queue.top());
-    queue.pop();
+  std::vector<const DexFile*> loaded_dex_files;
+  loaded_dex_files.reserve(queue.size());
+  for (; !queue.empty(); queue.pop()) {
+    loaded_dex_files.push_back(queue.top().GetDexFile());
+  }
 
-    // Compare against the following elements.
-    while (!queue.empty()) {
-      DexFileAndClassPair top(queue.top());
-
-      if (strcmp(compare_pop.GetCachedDescriptor(), top.GetCachedDescriptor()) == 0) {
-        // Same descriptor. Check whether it's crossing old-oat-files to new-oat-files.
-        if (compare_pop.FromLoadedOat() != top.FromLoadedOat()) {
-          *error_msg =
-              StringPrintf("Found duplicated class when checking oat files: '%s' in %s and %s",
-                           compare_pop.GetCachedDescriptor(),
-                           compare_pop.GetDexFile()->GetLocation().c_str(),
-                           top.GetDexFile()->GetLocation().c_str());
-          return true;
-        }
-        queue.pop();
-        AddNext(&top, &queue);
-      } else {
-        // Something else. Done here.
-        break;
-      }
-    }
-    AddNext(&compare_pop, &queue);
+  // Add dex files from the oat file to check.
+  size_t first_new_dex_file = opened_dex_files.size();
+  OpenDexFilesWithClasses(oat_file, &opened_dex_files);
+  std::vector<const DexFile*> new_dex_files;
+  for (size_t i = first_new_dex_file; i != opened_dex_files.size(); ++i) {
+    new_dex_files.push_back(opened_dex_files[i].get());
   }
 
-  return false;
+  return FindDuplicateClass(loaded_dex_files, new_dex_files, error_msg);
 }
 
 std::vector<std::unique_ptr<const DexFile>> OatFileManager::OpenDexFilesFromOat(
@@ -110,6 +110,13 @@ class OatFileManager {
     filter_ = filter;
   }
 
+  // Look for a class defined both in `loaded_dex_files` and `new_dex_files`. Duplicates within
+  // either set are fine: old ones were accepted before and new ones come from multidex, which
+  // resolves them correctly. Returns true and sets `error_msg` if there is one. Public for tests.
+  static bool FindDuplicateClass(const std::vector<const DexFile*>& loaded_dex_files,
+                                 const std::vector<const DexFile*>& new_dex_files,
+                                 /*out*/std::string* error_msg);
+
  private:
   // Check that the shared libraries in the given oat file match those in the given class loader and
   // dex elements. If the class loader is null or we do not support one of the class loaders in the
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "oat_file_manager.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "common_runtime_test.h"
+#include "dex_file.h"
+#include "oat_file.h"
+
+namespace art {
+
+class OatFileManagerTest : public CommonRuntimeTest {
+ protected:
+  static std::vector<const DexFile*> ToPointers(
+      const std::vector<std::unique_ptr<const DexFile>>& dex_files) {
+    std::vector<const DexFile*> result;
+    for (const std::unique_ptr<const DexFile>& dex_file : dex_files) {
+      result.push_back(dex_file.get());
+    }
+    return result;
+  }
+};
+
+// The loaded dex file has a TypeLookupTable and more classes than the new one, so the classes of
+// the new dex file are looked up in it.
+TEST_F(OatFileManagerTest, FindDuplicateClassInLoadedDexFile) {
+  std::unique_ptr<const DexFile> loaded = OpenTestDexFile("MainAndNested");
+  std::unique_ptr<const DexFile> added = OpenTestDexFile("Main");
+  loaded->CreateTypeLookupTable();
+  ASSERT_TRUE(loaded->GetTypeLookupTable() != nullptr);
+  ASSERT_LT(added->NumClassDefs(), loaded->NumClassDefs());
+
+  std::string error_msg;
+  EXPECT_TRUE(OatFileManager::FindDuplicateClass({ loaded.get() }, { added.get() }, &error_msg));
+  EXPECT_NE(std::string::npos, error_msg.find("'LMain;'")) << error_msg;
+  EXPECT_NE(std::string::npos, error_msg.find(loaded->GetLocation())) << error_msg;
+  EXPECT_NE(std::string::npos, error_msg.find(added->GetLocation())) << error_msg;
+}
+
+// The new dex files have at least as many classes as the loaded one, so the classes of the loaded
+// dex file are looked up in them.
+TEST_F(OatFileManagerTest, FindDuplicateClassInNewDexFiles) {
+  std::unique_ptr<const DexFile> loaded = OpenTestDexFile("Main");
+  std::vector<std::unique_ptr<const DexFile>> added = OpenTestDexFiles("MainAndNested");
+  loaded->CreateTypeLookupTable();
+  ASSERT_EQ(1u, added.size());
+  ASSERT_GE(added[0]->NumClassDefs(), loaded->NumClassDefs());
+
+  std::string error_msg;
+  EXPECT_TRUE(OatFileManager::FindDuplicateClass({ loaded.get() }, ToPointers(added), &error_msg));
+  EXPECT_NE(std::string::npos, error_msg.find("'LMain;'")) << error_msg;
+
+  // Without a TypeLookupTable, the loaded dex file is always walked.
+  std::unique_ptr<const DexFile> large_loaded = OpenTestDexFile("MainAndNested");
+  std::unique_ptr<const DexFile> small_added = OpenTestDexFile("Main");
+  ASSERT_TRUE(large_loaded->GetTypeLookupTable() == nullptr);
+  error_msg.clear();
+  EXPECT_TRUE(OatFileManager::FindDuplicateClass({ large_loaded.get() },
+                                                 { small_added.get() },
+                                                 &error_msg));
+  EXPECT_NE(std::string::npos, error_msg.find("'LMain;'")) << error_msg;
+}
+
+TEST_F(OatFileManagerTest, FindDuplicateClassIgnoresMultiDex) {
+  std::vector<std::unique_ptr<const DexFile>> multidex = OpenTestDexFiles("MultiDex");
+  std::unique_ptr<const DexFile> main = OpenTestDexFile("Main");
+  std::unique_ptr<const DexFile> nested = OpenTestDexFile("Nested");
+  ASSERT_EQ(2u, multidex.size());
+  // Main is defined twice within with_main, which shares no class with Nested.
+  std::vector<const DexFile*> with_main = ToPointers(multidex);
+  with_main.push_back(main.get());
+
+  std::string error_msg;
+  EXPECT_FALSE(OatFileManager::FindDuplicateClass({ nested.get() }, with_main, &error_msg))
+      << error_msg;
+  EXPECT_FALSE(OatFileManager::FindDuplicateClass(with_main, { nested.get() }, &error_msg))
+      << error_msg;
+
+  // But the classes of a new multidex file are still checked against the loaded ones.
+  EXPECT_TRUE(OatFileManager::FindDuplicateClass({ main.get() }, ToPointers(multidex), &error_msg));
+  EXPECT_NE(std::string::npos, error_msg.find("'LMain;'")) << error_msg;
+}
+
+}  // namespace art
@@ -126,12 +126,32 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-XX:MaxSpinsBeforeThinLockInflation=_")
           .WithType<unsigned int>()
           .IntoKey(M::MaxSpinsBeforeThinLockInflation)
+      .Define("-XX:HprofSampleInterval=_")
+          .WithType<unsigned int>()
+          .IntoKey(M::HprofSampleInterval)
+      .Define("-XX:HprofForkSnapshot")
+          .IntoKey(M::HprofForkSnapshot)
+      .Define("-XX:RosAllocMaxThreadLocalBracketSize=_")
+          .WithType<unsigned int>()
+          .IntoKey(M::RosAllocMaxThreadLocalBracketSize)
+      .Define("-XX:RosAllocRunPages=_")
+          .WithType<std::string>()
+          .IntoKey(M::RosAllocRunPages)
       .Define("-XX:LongPauseLogThreshold=_")  // in ms
           .WithType<MillisecondsToNanoseconds>()  // store as ns
           .IntoKey(M::LongPauseLogThreshold)
       .Define("-XX:LongGCLogThreshold=_")  // in ms
           .WithType<MillisecondsToNanoseconds>()  // store as ns
           .IntoKey(M::LongGCLogThreshold)
+      .Define("-XX:DefragmentationMaxPause=_")  // in ms
+          .WithType<MillisecondsToNanoseconds>()  // store as ns
+          .IntoKey(M::DefragmentationMaxPause)
+      .Define("-XX:GcRecordCount=_")
+          .WithType<unsigned int>()
+          .IntoKey(M::GcRecordCount)
+      .Define("-XX:GcRecordFile=_")
+          .WithType<std::string>()
+          .IntoKey(M::GcRecordFile)
       .Define("-XX:DumpGCPerformanceOnShutdown")
           .IntoKey(M::DumpGCPerformanceOnShutdown)
       .Define("-XX:DumpJITInfoOnShutdown")
@@ -178,6 +198,9 @@ std::unique_ptr<RuntimeParser> ParsedOptions::MakeParser(bool ignore_unrecognize
       .Define("-Xjitsaveprofilinginfo")
           .WithValue(true)
           .IntoKey(M::JITSaveProfilingInfo)
+      .Define("-XX:ProfileClassPreloadThreads=_")
+          .WithType<unsigned int>()
+          .IntoKey(M::ProfileClassPreloadThreads)
       .Define("-XX:HspaceCompactForOOMMinIntervalMs=_")  // in ms
           .WithType<MillisecondsToNanoseconds>()  // store as ns
           .IntoKey(M::HSpaceCompactForOOMMinIntervalsMs)
@@ -680,8 +703,15 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -XX:ParallelGCThreads=integervalue\n");
   UsageMessage(stream, "  -XX:ConcGCThreads=integervalue\n");
   UsageMessage(stream, "  -XX:MaxSpinsBeforeThinLockInflation=integervalue\n");
+  UsageMessage(stream, "  -XX:HprofSampleInterval=integervalue\n");
+  UsageMessage(stream, "  -XX:HprofForkSnapshot\n");
+  UsageMessage(stream, "  -XX:RosAllocMaxThreadLocalBracketSize=integervalue\n");
+  UsageMessage(stream, "  -XX:RosAllocRunPages=bracketsize:numpages,...\n");
   UsageMessage(stream, "  -XX:LongPauseLogThreshold=integervalue\n");
   UsageMessage(stream, "  -XX:LongGCLogThreshold=integervalue\n");
+  UsageMessage(stream, "  -XX:DefragmentationMaxPause=integervalue\n");
+  UsageMessage(stream, "  -XX:GcRecordCount=integervalue\n");
+  UsageMessage(stream, "  -XX:GcRecordFile=filename\n");
   UsageMessage(stream, "  -XX:DumpGCPerformanceOnShutdown\n");
   UsageMessage(stream, "  -XX:DumpJITInfoOnShutdown\n");
   UsageMessage(stream, "  -XX:IgnoreMaxFootprint\n");
@@ -714,6 +744,7 @@ void ParsedOptions::Usage(const char* fmt, ...) {
   UsageMessage(stream, "  -Xjitwarmupthreshold:integervalue\n");
   UsageMessage(stream, "  -Xjitosrthreshold:integervalue\n");
   UsageMessage(stream, "  -Xjitprithreadweight:integervalue\n");
+  UsageMessage(stream, "  -XX:ProfileClassPreloadThreads=integervalue\n");
   UsageMessage(stream, "  -X[no]relocate\n");
   UsageMessage(stream, "  -X[no]dex2oat (Whether to invoke dex2oat on the application)\n");
   UsageMessage(stream, "  -X[no]image-dex2oat (Whether to create and use a boot image)\n");
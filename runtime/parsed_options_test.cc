@@ -128,6 +128,67 @@ TEST_F(ParsedOptionsTest, ParsedOptionsGc) {
   EXPECT_EQ(gc::kCollectorTypeMC, xgc.collector_type_);
 }
 
+TEST_F(ParsedOptionsTest, ParsedOptionsRosAllocRunPages) {
+  using Opt = RuntimeArgumentMap;
+
+  {
+    // Nothing set, the default run sizes.
+    RuntimeOptions options;
+    RuntimeArgumentMap map;
+    bool parsed = ParsedOptions::Parse(options, false, &map);
+    ASSERT_TRUE(parsed);
+    EXPECT_FALSE(map.Exists(Opt::RosAllocRunPages));
+    EXPECT_EQ(std::string(), map.GetOrDefault(Opt::RosAllocRunPages));
+  }
+
+  RuntimeOptions options;
+  options.push_back(std::make_pair("-XX:RosAllocRunPages=16:2,1024:8", nullptr));
+  RuntimeArgumentMap map;
+  bool parsed = ParsedOptions::Parse(options, false, &map);
+  ASSERT_TRUE(parsed);
+  EXPECT_EQ(std::string("16:2,1024:8"), map.GetOrDefault(Opt::RosAllocRunPages));
+}
+
+TEST_F(ParsedOptionsTest, ParsedOptionsRosAllocMaxThreadLocalBracketSize) {
+  using Opt = RuntimeArgumentMap;
+
+  {
+    // Nothing set, the default cutoff.
+    RuntimeOptions options;
+    RuntimeArgumentMap map;
+    bool parsed = ParsedOptions::Parse(options, false, &map);
+    ASSERT_TRUE(parsed);
+    EXPECT_EQ(128u, map.GetOrDefault(Opt::RosAllocMaxThreadLocalBracketSize));
+  }
+
+  RuntimeOptions options;
+  options.push_back(std::make_pair("-XX:RosAllocMaxThreadLocalBracketSize=256", nullptr));
+  RuntimeArgumentMap map;
+  bool parsed = ParsedOptions::Parse(options, false, &map);
+  ASSERT_TRUE(parsed);
+  EXPECT_EQ(256u, map.GetOrDefault(Opt::RosAllocMaxThreadLocalBracketSize));
+}
+
+TEST_F(ParsedOptionsTest, ParsedOptionsProfileClassPreloadThreads) {
+  using Opt = RuntimeArgumentMap;
+
+  {
+    // Nothing set, no preloading.
+    RuntimeOptions options;
+    RuntimeArgumentMap map;
+    bool parsed = ParsedOptions::Parse(options, false, &map);
+    ASSERT_TRUE(parsed);
+    EXPECT_EQ(0u, map.GetOrDefault(Opt::ProfileClassPreloadThreads));
+  }
+
+  RuntimeOptions options;
+  options.push_back(std::make_pair("-XX:ProfileClassPreloadThreads=2", nullptr));
+  RuntimeArgumentMap map;
+  bool parsed = ParsedOptions::Parse(options, false, &map);
+  ASSERT_TRUE(parsed);
+  EXPECT_EQ(2u, map.GetOrDefault(Opt::ProfileClassPreloadThreads));
+}
+
 TEST_F(ParsedOptionsTest, ParsedOptionsInstructionSet) {
   using Opt = RuntimeArgumentMap;
 
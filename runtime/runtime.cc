@@ -61,6 +61,7 @@
 #include "atomic.h"
 #include "base/arena_allocator.h"
 #include "base/dumpable.h"
+#include "base/scoped_flock.h"
 #include "base/stl_util.h"
 #include "base/systrace.h"
 #include "base/unix_file/fd_file.h"
@@ -73,6 +74,7 @@
 #include "experimental_flags.h"
 #include "fault_handler.h"
 #include "gc/accounting/card_table-inl.h"
+#include "gc/allocator/rosalloc.h"
 #include "gc/heap.h"
 #include "gc/space/image_space.h"
 #include "gc/space/space-inl.h"
@@ -82,6 +84,7 @@
 #include "intern_table.h"
 #include "interpreter/interpreter.h"
 #include "jit/jit.h"
+#include "jit/offline_profiling_info.h"
 #include "jni_internal.h"
 #include "linear_alloc.h"
 #include "lambda/box_table.h"
@@ -193,6 +196,8 @@ Runtime::Runtime()
       default_stack_size_(0),
       heap_(nullptr),
       max_spins_before_thin_lock_inflation_(Monitor::kDefaultMaxSpinsBeforeThinLockInflation),
+      hprof_sample_interval_(0),
+      hprof_fork_snapshot_(false),
       monitor_list_(nullptr),
       monitor_pool_(nullptr),
       thread_list_(nullptr),
@@ -230,6 +235,7 @@ Runtime::Runtime()
       is_native_bridge_loaded_(false),
       is_native_debuggable_(false),
       zygote_max_failed_boots_(0),
+      profile_class_preload_threads_(0u),
       experimental_flags_(ExperimentalFlags::kNone),
       oat_file_manager_(nullptr),
       is_low_memory_mode_(false),
@@ -303,6 +309,9 @@ Runtime::~Runtime() {
     // Similarly, stop the profile saver thread before deleting the thread list.
     jit_->StopProfileSaver();
   }
+  if (class_linker_ != nullptr) {
+    class_linker_->DeletePreloadThreadPool();
+  }
 
   // Make sure our internal threads are dead before we start tearing down things they're using.
   Dbg::StopJdwp();
@@ -983,6 +992,8 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
 
   max_spins_before_thin_lock_inflation_ =
       runtime_options.GetOrDefault(Opt::MaxSpinsBeforeThinLockInflation);
+  hprof_sample_interval_ = runtime_options.GetOrDefault(Opt::HprofSampleInterval);
+  hprof_fork_snapshot_ = runtime_options.Exists(Opt::HprofForkSnapshot);
 
   monitor_list_ = new MonitorList;
   monitor_pool_ = MonitorPool::Create();
@@ -1004,6 +1015,7 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
   }
 
   zygote_max_failed_boots_ = runtime_options.GetOrDefault(Opt::ZygoteMaxFailedBoots);
+  profile_class_preload_threads_ = runtime_options.GetOrDefault(Opt::ProfileClassPreloadThreads);
   experimental_flags_ = runtime_options.GetOrDefault(Opt::Experimental);
   is_low_memory_mode_ = runtime_options.Exists(Opt::LowMemoryMode);
 
@@ -1017,6 +1029,18 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
     OatFileManager::SetCompilerFilter(filter);
   }
 
+  {
+    // The RosAlloc size brackets need to be configured before the heap creates its spaces.
+    std::string error_msg;
+    if (!gc::allocator::RosAlloc::ConfigureSizeBrackets(
+            runtime_options.GetOrDefault(Opt::RosAllocMaxThreadLocalBracketSize),
+            runtime_options.GetOrDefault(Opt::RosAllocRunPages),
+            &error_msg)) {
+      LOG(ERROR) << "Cannot configure the RosAlloc size brackets: " << error_msg;
+      return false;
+    }
+  }
+
   XGcOption xgc_option = runtime_options.GetOrDefault(Opt::GcOption);
   heap_ = new gc::Heap(runtime_options.GetOrDefault(Opt::MemoryInitialSize),
                        runtime_options.GetOrDefault(Opt::HeapGrowthLimit),
@@ -1048,6 +1072,10 @@ bool Runtime::Init(RuntimeArgumentMap&& runtime_options_in) {
                        xgc_option.gcstress_,
                        runtime_options.GetOrDefault(Opt::EnableHSpaceCompactForOOM),
                        runtime_options.GetOrDefault(Opt::HSpaceCompactForOOMMinIntervalsMs));
+  heap_->SetDefragmentationMaxPause(
+      runtime_options.GetOrDefault(Opt::DefragmentationMaxPause).GetNanoseconds());
+  heap_->EnableGcRecords(runtime_options.GetOrDefault(Opt::GcRecordCount),
+                         runtime_options.GetOrDefault(Opt::GcRecordFile));
 
   if (!heap_->HasBootImageSpace() && !allow_dex_file_fallback_) {
     LOG(ERROR) << "Dex file fallback disabled, cannot continue without image.";
@@ -1780,6 +1808,10 @@ void Runtime::RegisterAppInfo(const std::vector<std::string>& code_paths,
                               const std::string& profile_output_filename,
                               const std::string& foreign_dex_profile_path,
                               const std::string& app_dir) {
+  if (profile_class_preload_threads_ != 0u) {
+    PreloadClassesFromProfile(profile_output_filename);
+  }
+
   if (jit_.get() == nullptr) {
     // We are not JITing. Nothing to do.
     return;
@@ -1808,6 +1840,27 @@ void Runtime::RegisterAppInfo(const std::vector<std::string>& code_paths,
                           app_dir);
 }
 
+void Runtime::PreloadClassesFromProfile(const std::string& profile_filename) {
+  ScopedTrace trace(__FUNCTION__);
+  if (profile_filename.empty()) {
+    return;
+  }
+  ScopedFlock flock;
+  std::string error;
+  if (!flock.Init(profile_filename.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC, /* block */ false,
+                  &error)) {
+    VLOG(class_linker) << "Not preloading the classes of " << profile_filename << ": " << error;
+    return;
+  }
+  ProfileCompilationInfo info;
+  if (!info.Load(flock.GetFile()->Fd())) {
+    LOG(WARNING) << "Not preloading the classes of " << profile_filename << ": failed to load it";
+    return;
+  }
+  class_linker_->PreloadClassesFromProfile(info.GetResolvedClasses(),
+                                           profile_class_preload_threads_);
+}
+
 void Runtime::NotifyDexLoaded(const std::string& dex_location) {
   VLOG(profiler) << "Notify dex loaded: " << dex_location;
   // We know that if the ProfileSaver is started then we can record profile information.
@@ -284,6 +284,14 @@ class Runtime {
     return max_spins_before_thin_lock_inflation_;
   }
 
+  size_t GetHprofSampleInterval() const {
+    return hprof_sample_interval_;
+  }
+
+  bool UseHprofForkSnapshot() const {
+    return hprof_fork_snapshot_;
+  }
+
   MonitorList* GetMonitorList() const {
     return monitor_list_;
   }
@@ -475,6 +483,11 @@ class Runtime {
                        const std::string& app_dir);
   void NotifyDexLoaded(const std::string& dex_location);
 
+  // Preload the classes of the dex files of the app listed in the profile, on
+  // profile_class_preload_threads_ background threads.
+  void PreloadClassesFromProfile(const std::string& profile_filename)
+      REQUIRES(!Locks::mutator_lock_);
+
   // Transaction support.
   bool IsActiveTransaction() const {
     return preinitialization_transaction_ != nullptr;
@@ -731,6 +744,13 @@ class Runtime {
 
   // The number of spins that are done before thread suspension is used to forcibly inflate.
   size_t max_spins_before_thin_lock_inflation_;
+
+  // If not 0, heap dumps only write one in that many instances. See hprof::DumpHeap().
+  size_t hprof_sample_interval_;
+
+  // Whether heap dumps to files are written by a forked process. See hprof::DumpHeap().
+  bool hprof_fork_snapshot_;
+
   MonitorList* monitor_list_;
   MonitorPool* monitor_pool_;
 
@@ -848,6 +868,9 @@ class Runtime {
   // zygote.
   uint32_t zygote_max_failed_boots_;
 
+  // Number of threads preloading the classes of the app profile, or 0 not to preload them.
+  uint32_t profile_class_preload_threads_;
+
   // Enable experimental opcodes that aren't fully specified yet. The intent is to
   // eventually publish them as public-usable opcodes, but they aren't ready yet.
   //
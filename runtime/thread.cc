@@ -1823,7 +1823,9 @@ Thread::Thread(bool daemon)
     : tls32_(daemon),
       wait_monitor_(nullptr),
       interrupted_(false),
-      can_call_into_java_(true) {
+      can_call_into_java_(true),
+      tlab_refill_size_(0),
+      tlab_refill_time_(0) {
   wait_mutex_ = new Mutex("a thread wait mutex");
   wait_cond_ = new ConditionVariable("a thread wait condition variable", *wait_mutex_);
   tlsPtr_.instrumentation_stack = new std::deque<instrumentation::InstrumentationStackFrame>;
@@ -116,8 +116,11 @@ enum class StackedShadowFrameType {
   kSingleFrameDeoptimizationShadowFrame
 };
 
-// This should match RosAlloc::kNumThreadLocalSizeBrackets.
-static constexpr size_t kNumRosAllocThreadLocalSizeBracketsInThread = 16;
+// This should match RosAlloc::kMaxNumThreadLocalSizeBrackets.
+static constexpr size_t kNumRosAllocThreadLocalSizeBracketsInThread = 24;
+
+// How far ahead of the TLAB allocation pointer the memory is prefetched.
+static constexpr size_t kTlabPrefetchDistance = 256;
 
 // Thread's stack layout for implicit stack overflow checks:
 //
@@ -1036,6 +1039,19 @@ class Thread {
     return tlsPtr_.thread_local_pos;
   }
 
+  // The size of the last TLAB allocated from a bump pointer space, 0 if none, and when it was
+  // allocated. Used by the heap to size the TLABs after the allocation rate of the thread.
+  size_t GetTlabRefillSize() const {
+    return tlab_refill_size_;
+  }
+  uint64_t GetTlabRefillTime() const {
+    return tlab_refill_time_;
+  }
+  void SetTlabRefill(size_t size, uint64_t time) {
+    tlab_refill_size_ = size;
+    tlab_refill_time_ = time;
+  }
+
   // Remove the suspend trigger for this thread by making the suspend_trigger_ TLS value
   // equal to a valid pointer.
   // TODO: does this need to atomic?  I don't think so.
@@ -1546,7 +1562,8 @@ class Thread {
     void* mterp_default_ibase;
     void* mterp_alt_ibase;
 
-    // There are RosAlloc::kNumThreadLocalSizeBrackets thread-local size brackets per thread.
+    // There are up to RosAlloc::kMaxNumThreadLocalSizeBrackets thread-local size brackets per
+    // thread.
     void* rosalloc_runs[kNumRosAllocThreadLocalSizeBracketsInThread];
 
     // Thread-local allocation stack data/routines.
@@ -1587,6 +1604,10 @@ class Thread {
   // By default this is true.
   bool can_call_into_java_;
 
+  // See GetTlabRefillSize().
+  size_t tlab_refill_size_;
+  uint64_t tlab_refill_time_;
+
   friend class Dbg;  // For SetStateUnsafe.
   friend class gc::collector::SemiSpace;  // For getting stack traces.
   friend class Runtime;  // For CreatePeer.
@@ -117,6 +117,7 @@ ThreadPool::ThreadPool(const char* name, size_t num_threads, bool create_peers)
     completion_condition_("task completion condition", task_queue_lock_),
     started_(false),
     shutting_down_(false),
+    exit_when_drained_(false),
     waiting_count_(0),
     start_time_(0),
     total_wait_time_(0),
@@ -168,6 +169,13 @@ void ThreadPool::StopWorkers(Thread* self) {
   started_ = false;
 }
 
+void ThreadPool::ExitWorkersWhenDrained(Thread* self) {
+  MutexLock mu(self, task_queue_lock_);
+  exit_when_drained_ = true;
+  // Wake up the waiting workers so that they exit if there is nothing left to do.
+  task_queue_condition_.Broadcast(self);
+}
+
 Task* ThreadPool::GetTask(Thread* self) {
   MutexLock mu(self, task_queue_lock_);
   while (!IsShuttingDown()) {
@@ -181,6 +189,9 @@ Task* ThreadPool::GetTask(Thread* self) {
         return task;
       }
     }
+    if (exit_when_drained_ && tasks_.empty()) {
+      break;
+    }
 
     ++waiting_count_;
     if (waiting_count_ == GetThreadCount() && tasks_.empty()) {
@@ -196,7 +207,7 @@ Task* ThreadPool::GetTask(Thread* self) {
     --waiting_count_;
   }
 
-  // We are shutting down, return null to tell the worker thread to stop looping.
+  // We are shutting down or drained, return null to tell the worker thread to stop looping.
   return nullptr;
 }
 
@@ -91,6 +91,11 @@ class ThreadPool {
   // Do not allow workers to grab any new tasks.
   void StopWorkers(Thread* self) REQUIRES(!task_queue_lock_);
 
+  // Let the workers exit once the task queue is empty instead of waiting for new tasks. The tasks
+  // added after the queue drained are not run, and Wait() must not be called since the workers
+  // may be gone. The destructor still joins the workers.
+  void ExitWorkersWhenDrained(Thread* self) REQUIRES(!task_queue_lock_);
+
   // Add a new task, the first available started worker will process it. Does not delete the task
   // after running it, it is the caller's responsibility.
   void AddTask(Thread* self, Task* task) REQUIRES(!task_queue_lock_);
@@ -143,6 +148,8 @@ class ThreadPool {
   ConditionVariable completion_condition_ GUARDED_BY(task_queue_lock_);
   volatile bool started_ GUARDED_BY(task_queue_lock_);
   volatile bool shutting_down_ GUARDED_BY(task_queue_lock_);
+  // Whether the workers exit when there are no tasks, see ExitWorkersWhenDrained().
+  bool exit_when_drained_ GUARDED_BY(task_queue_lock_);
   // How many worker threads are waiting on the condition.
   volatile size_t waiting_count_ GUARDED_BY(task_queue_lock_);
   std::deque<Task*> tasks_ GUARDED_BY(task_queue_lock_);
@@ -22,6 +22,7 @@
 #include "common_runtime_test.h"
 #include "scoped_thread_state_change.h"
 #include "thread-inl.h"
+#include "thread_list.h"
 
 namespace art {
 
@@ -99,6 +100,33 @@ TEST_F(ThreadPoolTest, StopStart) {
   thread_pool.Wait(self, false, false);
 }
 
+// Returns the number of threads attached to the runtime.
+static size_t NumAttachedThreads(Thread* self) {
+  MutexLock mu(self, *Locks::thread_list_lock_);
+  return Runtime::Current()->GetThreadList()->GetList().size();
+}
+
+// Check that the workers run the queued tasks and then exit when asked to once drained.
+TEST_F(ThreadPoolTest, ExitWorkersWhenDrained) {
+  Thread* self = Thread::Current();
+  const size_t num_attached_threads = NumAttachedThreads(self);
+  ThreadPool thread_pool("Thread pool test thread pool", num_threads);
+  EXPECT_EQ(num_attached_threads + num_threads, NumAttachedThreads(self));
+  AtomicInteger count(0);
+  static const int32_t num_tasks = num_threads * 4;
+  for (int32_t i = 0; i < num_tasks; ++i) {
+    thread_pool.AddTask(self, new CountTask(&count));
+  }
+  thread_pool.StartWorkers(self);
+  thread_pool.ExitWorkersWhenDrained(self);
+  // The workers detach once they are done.
+  for (size_t i = 0; i < 1000 && NumAttachedThreads(self) != num_attached_threads; ++i) {
+    usleep(10 * 1000);
+  }
+  EXPECT_EQ(num_attached_threads, NumAttachedThreads(self));
+  EXPECT_EQ(num_tasks, count.LoadSequentiallyConsistent());
+}
+
 class TreeTask : public Task {
  public:
   TreeTask(ThreadPool* const thread_pool, AtomicInteger* count, int depth)
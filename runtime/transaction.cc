@@ -196,10 +196,16 @@ void Transaction::Rollback() {
   Thread* self = Thread::Current();
   self->AssertNoPendingException();
   MutexLock mu1(self, *Locks::intern_table_lock_);
-  MutexLock mu2(self, log_lock_);
-  UndoObjectModifications();
-  UndoArrayModifications();
-  UndoInternStringTableModifications();
+  std::list<InternStringLog> intern_string_logs;
+  {
+    MutexLock mu2(self, log_lock_);
+    UndoObjectModifications();
+    UndoArrayModifications();
+    intern_string_logs.swap(intern_string_logs_);
+  }
+  // Undoing the intern string changes takes the locks of the intern table shards, which cannot be
+  // acquired while holding the log lock.
+  UndoInternStringTableModifications(&intern_string_logs);
 }
 
 void Transaction::UndoObjectModifications() {
@@ -220,14 +226,15 @@ void Transaction::UndoArrayModifications() {
   array_logs_.clear();
 }
 
-void Transaction::UndoInternStringTableModifications() {
+void Transaction::UndoInternStringTableModifications(
+    std::list<InternStringLog>* intern_string_logs) {
   InternTable* const intern_table = Runtime::Current()->GetInternTable();
   // We want to undo each operation from the most recent to the oldest. List has been filled so the
   // most recent operation is at list begin so just have to iterate over it.
-  for (InternStringLog& string_log : intern_string_logs_) {
+  for (InternStringLog& string_log : *intern_string_logs) {
     string_log.Undo(intern_table);
   }
-  intern_string_logs_.clear();
+  intern_string_logs->clear();
 }
 
 void Transaction::VisitRoots(RootVisitor* visitor) {
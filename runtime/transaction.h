@@ -202,9 +202,9 @@ class Transaction FINAL {
   void UndoArrayModifications()
       REQUIRES(log_lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
-  void UndoInternStringTableModifications()
+  void UndoInternStringTableModifications(std::list<InternStringLog>* intern_string_logs)
       REQUIRES(Locks::intern_table_lock_)
-      REQUIRES(log_lock_)
+      REQUIRES(!log_lock_)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   void VisitObjectLogs(RootVisitor* visitor)
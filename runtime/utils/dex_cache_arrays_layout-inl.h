@@ -23,6 +23,7 @@
 #include "base/logging.h"
 #include "gc_root.h"
 #include "globals.h"
+#include "mirror/dex_cache.h"
 #include "primitive.h"
 
 namespace art {
@@ -47,12 +48,18 @@ inline DexCacheArraysLayout::DexCacheArraysLayout(size_t pointer_size, const Dex
 }
 
 inline size_t DexCacheArraysLayout::Alignment() const {
+  return Alignment(pointer_size_);
+}
+
+inline size_t DexCacheArraysLayout::Alignment(size_t pointer_size) {
   // GcRoot<> alignment is 4, i.e. lower than or equal to the pointer alignment.
   static_assert(alignof(GcRoot<mirror::Class>) == 4, "Expecting alignof(GcRoot<>) == 4");
   static_assert(alignof(GcRoot<mirror::String>) == 4, "Expecting alignof(GcRoot<>) == 4");
-  DCHECK(pointer_size_ == 4u || pointer_size_ == 8u);
-  // Pointer alignment is the same as pointer size.
-  return pointer_size_;
+  DCHECK(pointer_size == 4u || pointer_size == 8u);
+  // Pointer alignment is the same as pointer size. The 64-bit pairs of hash-indexed strings
+  // arrays need 8-byte alignment for atomic accesses on 32-bit targets as well.
+  static_assert(alignof(mirror::StringDexCachePair) == 8, "Expecting 8-byte aligned pairs");
+  return std::max(pointer_size, alignof(mirror::StringDexCachePair));
 }
 
 inline size_t DexCacheArraysLayout::TypeOffset(uint32_t type_idx) const {
@@ -86,12 +93,16 @@ inline size_t DexCacheArraysLayout::StringOffset(uint32_t string_idx) const {
   return strings_offset_ + ElementOffset(sizeof(GcRoot<mirror::String>), string_idx);
 }
 
-inline size_t DexCacheArraysLayout::StringsSize(size_t num_elements) const {
-  return ArraySize(sizeof(GcRoot<mirror::String>), num_elements);
+inline size_t DexCacheArraysLayout::StringsSize(size_t num_string_ids) const {
+  if (mirror::DexCache::HasHashedStrings(num_string_ids)) {
+    return ArraySize(sizeof(mirror::StringDexCachePair),
+                     mirror::DexCache::NumStringsArrayElements(num_string_ids));
+  }
+  return ArraySize(sizeof(GcRoot<mirror::String>), num_string_ids);
 }
 
 inline size_t DexCacheArraysLayout::StringsAlignment() const {
-  return alignof(GcRoot<mirror::String>);
+  return alignof(mirror::StringDexCachePair);
 }
 
 inline size_t DexCacheArraysLayout::FieldOffset(uint32_t field_idx) const {
@@ -54,6 +54,8 @@ class DexCacheArraysLayout {
 
   size_t Alignment() const;
 
+  static size_t Alignment(size_t pointer_size);
+
   size_t TypesOffset() const {
     return types_offset_;
   }
@@ -78,9 +80,11 @@ class DexCacheArraysLayout {
     return strings_offset_;
   }
 
+  // Only valid for dex files without a hash-indexed strings array,
+  // see mirror::DexCache::HasHashedStrings().
   size_t StringOffset(uint32_t string_idx) const;
 
-  size_t StringsSize(size_t num_elements) const;
+  size_t StringsSize(size_t num_string_ids) const;
 
   size_t StringsAlignment() const;
 
@@ -102,8 +106,6 @@ class DexCacheArraysLayout {
   const size_t fields_offset_;
   const size_t size_;
 
-  static size_t Alignment(size_t pointer_size);
-
   static size_t ElementOffset(size_t element_size, uint32_t idx);
 
   static size_t ArraySize(size_t element_size, uint32_t num_elements);
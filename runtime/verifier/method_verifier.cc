@@ -46,6 +46,7 @@
 #include "runtime.h"
 #include "scoped_thread_state_change.h"
 #include "utils.h"
+#include "verifier_deps.h"
 #include "handle_scope-inl.h"
 
 namespace art {
@@ -123,7 +124,8 @@ MethodVerifier::FailureKind MethodVerifier::VerifyClass(Thread* self,
                                                         CompilerCallbacks* callbacks,
                                                         bool allow_soft_failures,
                                                         LogSeverity log_level,
-                                                        std::string* error) {
+                                                        std::string* error,
+                                                        VerifierDeps* verifier_deps) {
   if (klass->IsVerified()) {
     return kNoFailure;
   }
@@ -151,6 +153,10 @@ MethodVerifier::FailureKind MethodVerifier::VerifyClass(Thread* self,
     }
     return kHardFailure;
   }
+  if (verifier_deps != nullptr) {
+    // The checks above depend on the superclass of the class.
+    verifier_deps->AddResolvedClass(klass);
+  }
   StackHandleScope<2> hs(self);
   Handle<mirror::DexCache> dex_cache(hs.NewHandle(klass->GetDexCache()));
   Handle<mirror::ClassLoader> class_loader(hs.NewHandle(klass->GetClassLoader()));
@@ -162,7 +168,8 @@ MethodVerifier::FailureKind MethodVerifier::VerifyClass(Thread* self,
                      callbacks,
                      allow_soft_failures,
                      log_level,
-                     error);
+                     error,
+                     verifier_deps);
 }
 
 template <bool kDirect>
@@ -197,6 +204,7 @@ MethodVerifier::FailureData MethodVerifier::VerifyMethods(Thread* self,
                                                           bool allow_soft_failures,
                                                           LogSeverity log_level,
                                                           bool need_precise_constants,
+                                                          VerifierDeps* verifier_deps,
                                                           std::string* error_string) {
   DCHECK(it != nullptr);
 
@@ -238,6 +246,7 @@ MethodVerifier::FailureData MethodVerifier::VerifyMethods(Thread* self,
                                                       allow_soft_failures,
                                                       log_level,
                                                       need_precise_constants,
+                                                      verifier_deps,
                                                       &hard_failure_msg);
     if (result.kind == kHardFailure) {
       if (failure_data.kind == kHardFailure) {
@@ -267,7 +276,8 @@ MethodVerifier::FailureKind MethodVerifier::VerifyClass(Thread* self,
                                                         CompilerCallbacks* callbacks,
                                                         bool allow_soft_failures,
                                                         LogSeverity log_level,
-                                                        std::string* error) {
+                                                        std::string* error,
+                                                        VerifierDeps* verifier_deps) {
   DCHECK(class_def != nullptr);
   ScopedTrace trace(__FUNCTION__);
 
@@ -301,6 +311,7 @@ MethodVerifier::FailureKind MethodVerifier::VerifyClass(Thread* self,
                                                           allow_soft_failures,
                                                           log_level,
                                                           false /* need precise constants */,
+                                                          verifier_deps,
                                                           error);
   // Virtual methods.
   MethodVerifier::FailureData data2 = VerifyMethods<false>(self,
@@ -314,6 +325,7 @@ MethodVerifier::FailureKind MethodVerifier::VerifyClass(Thread* self,
                                                            allow_soft_failures,
                                                            log_level,
                                                            false /* need precise constants */,
+                                                           verifier_deps,
                                                            error);
 
   data1.Merge(data2);
@@ -362,6 +374,7 @@ MethodVerifier::FailureData MethodVerifier::VerifyMethod(Thread* self,
                                                          bool allow_soft_failures,
                                                          LogSeverity log_level,
                                                          bool need_precise_constants,
+                                                         VerifierDeps* verifier_deps,
                                                          std::string* hard_failure_msg) {
   MethodVerifier::FailureData result;
   uint64_t start_ns = kTimeVerifyMethod ? NanoTime() : 0;
@@ -380,10 +393,14 @@ MethodVerifier::FailureData MethodVerifier::VerifyMethod(Thread* self,
                           need_precise_constants,
                           false /* verify to dump */,
                           true /* allow_thread_suspension */);
+  verifier.verifier_deps_ = verifier_deps;
+  verifier.reg_types_.SetVerifierDeps(verifier_deps);
   if (verifier.Verify()) {
     // Verification completed, however failures may be pending that didn't cause the verification
     // to hard fail.
     CHECK(!verifier.have_pending_hard_failure_);
+    // Access flags to set on the method.
+    uint32_t access_flags = 0u;
 
     if (code_item != nullptr && callbacks != nullptr) {
       // Let the interested party know that the method was verified.
@@ -396,17 +413,21 @@ MethodVerifier::FailureData MethodVerifier::VerifyMethod(Thread* self,
                                                     << PrettyMethod(method_idx, *dex_file) << "\n");
       }
       result.kind = kSoftFailure;
-      if (method != nullptr &&
-          !CanCompilerHandleVerificationFailure(verifier.encountered_failure_types_)) {
-        method->SetAccessFlags(method->GetAccessFlags() | kAccCompileDontBother);
+      if (!CanCompilerHandleVerificationFailure(verifier.encountered_failure_types_)) {
+        access_flags |= kAccCompileDontBother;
       }
     }
-    if (method != nullptr) {
-      if (verifier.HasInstructionThatWillThrow()) {
-        method->SetAccessFlags(method->GetAccessFlags() | kAccCompileDontBother);
-      }
-      if ((verifier.encountered_failure_types_ & VerifyError::VERIFY_ERROR_LOCKING) != 0) {
-        method->SetAccessFlags(method->GetAccessFlags() | kAccMustCountLocks);
+    if (verifier.HasInstructionThatWillThrow()) {
+      access_flags |= kAccCompileDontBother;
+    }
+    if ((verifier.encountered_failure_types_ & VerifyError::VERIFY_ERROR_LOCKING) != 0) {
+      access_flags |= kAccMustCountLocks;
+    }
+    if (access_flags != 0u) {
+      if (verifier_deps != nullptr) {
+        verifier_deps->AddMethodAccessFlags(method_idx, access_flags);
+      } else if (method != nullptr) {
+        method->SetAccessFlags(method->GetAccessFlags() | access_flags);
       }
     }
   } else {
@@ -541,7 +562,8 @@ MethodVerifier::MethodVerifier(Thread* self,
       verify_to_dump_(verify_to_dump),
       allow_thread_suspension_(allow_thread_suspension),
       is_constructor_(false),
-      link_(nullptr) {
+      link_(nullptr),
+      verifier_deps_(nullptr) {
   self->PushVerifier(this);
   DCHECK(class_def != nullptr);
 }
@@ -591,6 +613,21 @@ static bool HasMonitorEnterInstructions(const DexFile::CodeItem* const code_item
   return false;
 }
 
+bool MethodVerifier::IsAotMode() const {
+  // Dependencies are recorded for the runtime verification, so we verify as the runtime would.
+  return Runtime::Current()->IsAotCompiler() && verifier_deps_ == nullptr;
+}
+
+void MethodVerifier::RecordClassResolution(const char* descriptor, mirror::Class* klass) {
+  if (verifier_deps_ != nullptr) {
+    if (klass != nullptr) {
+      verifier_deps_->AddResolvedClass(klass);
+    } else {
+      verifier_deps_->AddUnresolvedClass(descriptor);
+    }
+  }
+}
+
 void MethodVerifier::FindLocksAtDexPc() {
   CHECK(monitor_enter_dex_pcs_ != nullptr);
   CHECK(code_item_ != nullptr);  // This only makes sense for methods with code.
@@ -866,7 +903,7 @@ std::ostream& MethodVerifier::Fail(VerifyError error) {
     case VERIFY_ERROR_CLASS_CHANGE:
     case VERIFY_ERROR_FORCE_INTERPRETER:
     case VERIFY_ERROR_LOCKING:
-      if (Runtime::Current()->IsAotCompiler() || !can_load_classes_) {
+      if (IsAotMode() || !can_load_classes_) {
         // If we're optimistically running verification at compile time, turn NO_xxx, ACCESS_xxx,
         // class change and instantiation errors into soft verification errors so that we re-verify
         // at runtime. We may fail to find or to agree on access because of not yet available class
@@ -1049,6 +1086,8 @@ bool MethodVerifier::ScanTryCatchBlocks() {
         mirror::Class* exception_type = linker->ResolveType(*dex_file_,
                                                             iterator.GetHandlerTypeIndex(),
                                                             dex_cache_, class_loader_);
+        RecordClassResolution(dex_file_->StringByTypeIdx(iterator.GetHandlerTypeIndex()),
+                              exception_type);
         if (exception_type == nullptr) {
           DCHECK(self_->IsExceptionPending());
           self_->ClearException();
@@ -3399,7 +3438,7 @@ bool MethodVerifier::CodeFlowVerifyInstruction(uint32_t* start_guess) {
   }  // end - switch (dec_insn.opcode)
 
   if (have_pending_hard_failure_) {
-    if (Runtime::Current()->IsAotCompiler()) {
+    if (IsAotMode()) {
       /* When AOT compiling, check that the last failure is a hard failure */
       if (failures_[failures_.size() - 1] != VERIFY_ERROR_BAD_CLASS_HARD) {
         LOG(ERROR) << "Pending failures:";
@@ -3527,6 +3566,7 @@ bool MethodVerifier::CodeFlowVerifyInstruction(uint32_t* start_guess) {
         // It is also a catch-all if it is java.lang.Throwable.
         mirror::Class* klass = linker->ResolveType(*dex_file_, handler_type_idx, dex_cache_,
                                                    class_loader_);
+        RecordClassResolution(dex_file_->StringByTypeIdx(handler_type_idx), klass);
         if (klass != nullptr) {
           if (klass == mirror::Throwable::GetJavaLangThrowable()) {
             has_catch_all_handler = true;
@@ -4590,7 +4630,7 @@ ArtField* MethodVerifier::GetInstanceField(const RegType& obj_type, int field_id
       // of C1. For resolution to occur the declared class of the field must be compatible with
       // obj_type, we've discovered this wasn't so, so report the field didn't exist.
       VerifyError type;
-      bool is_aot = Runtime::Current()->IsAotCompiler();
+      bool is_aot = IsAotMode();
       if (is_aot && (field_klass.IsUnresolvedTypes() || obj_type.IsUnresolvedTypes())) {
         // Compiler & unresolved types involved, retry at runtime.
         type = VerifyError::VERIFY_ERROR_NO_CLASS;
@@ -4658,6 +4698,7 @@ void MethodVerifier::VerifyISFieldAccess(const Instruction* inst, const RegType&
 
     mirror::Class* field_type_class =
         can_load_classes_ ? field->GetType<true>() : field->GetType<false>();
+    RecordClassResolution(field->GetTypeDescriptor(), field_type_class);
     if (field_type_class != nullptr) {
       field_type = &FromClass(field->GetTypeDescriptor(), field_type_class,
                               field_type_class->CannotBeAssignedFromOtherTypes());
@@ -4781,6 +4822,7 @@ void MethodVerifier::VerifyQuickFieldAccess(const Instruction* inst, const RegTy
   {
     mirror::Class* field_type_class = can_load_classes_ ? field->GetType<true>() :
         field->GetType<false>();
+    RecordClassResolution(field->GetTypeDescriptor(), field_type_class);
 
     if (field_type_class != nullptr) {
       field_type = &FromClass(field->GetTypeDescriptor(),
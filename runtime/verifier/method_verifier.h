@@ -45,6 +45,7 @@ namespace verifier {
 
 class MethodVerifier;
 class RegisterLine;
+class VerifierDeps;
 using RegisterLineArenaUniquePtr = std::unique_ptr<RegisterLine, RegisterLineArenaDelete>;
 class RegType;
 
@@ -151,12 +152,17 @@ class MethodVerifier {
   }
 
   // Verify a class. Returns "kNoFailure" on success.
+  //
+  // When `verifier_deps` is not null, the class is verified as the runtime would verify it, even
+  // in the compiler, and the classes the verifier resolves and the access flags it would set on
+  // the methods are recorded in `verifier_deps` instead of being applied.
   static FailureKind VerifyClass(Thread* self,
                                  mirror::Class* klass,
                                  CompilerCallbacks* callbacks,
                                  bool allow_soft_failures,
                                  LogSeverity log_level,
-                                 std::string* error)
+                                 std::string* error,
+                                 VerifierDeps* verifier_deps = nullptr)
       SHARED_REQUIRES(Locks::mutator_lock_);
   static FailureKind VerifyClass(Thread* self,
                                  const DexFile* dex_file,
@@ -166,7 +172,8 @@ class MethodVerifier {
                                  CompilerCallbacks* callbacks,
                                  bool allow_soft_failures,
                                  LogSeverity log_level,
-                                 std::string* error)
+                                 std::string* error,
+                                 VerifierDeps* verifier_deps = nullptr)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   static MethodVerifier* VerifyMethodAndDump(Thread* self,
@@ -341,6 +348,7 @@ class MethodVerifier {
                                    bool allow_soft_failures,
                                    LogSeverity log_level,
                                    bool need_precise_constants,
+                                   VerifierDeps* verifier_deps,
                                    std::string* error_string)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
@@ -367,11 +375,20 @@ class MethodVerifier {
                                   bool allow_soft_failures,
                                   LogSeverity log_level,
                                   bool need_precise_constants,
+                                  VerifierDeps* verifier_deps,
                                   std::string* hard_failure_msg)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
   void FindLocksAtDexPc() SHARED_REQUIRES(Locks::mutator_lock_);
 
+  // Whether verifying optimistically for the compiler, deferring failures that may be due to the
+  // class loading environment to the runtime.
+  bool IsAotMode() const;
+
+  // Record the result of resolving `descriptor` in `verifier_deps_`, if any.
+  void RecordClassResolution(const char* descriptor, mirror::Class* klass)
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
   ArtField* FindAccessedFieldAtDexPc(uint32_t dex_pc)
       SHARED_REQUIRES(Locks::mutator_lock_);
 
@@ -843,6 +860,9 @@ class MethodVerifier {
   // Link, for the method verifier root linked list.
   MethodVerifier* link_;
 
+  // Where to record the dependencies of the verification, null if not recording.
+  VerifierDeps* verifier_deps_;
+
   friend class art::Thread;
 
   DISALLOW_COPY_AND_ASSIGN(MethodVerifier);
@@ -26,6 +26,7 @@
 #include "mirror/class-inl.h"
 #include "mirror/object-inl.h"
 #include "reg_type-inl.h"
+#include "verifier_deps.h"
 
 namespace art {
 namespace verifier {
@@ -185,6 +186,9 @@ const RegType& RegTypeCache::From(mirror::ClassLoader* loader,
   // Try resolving class.
   mirror::Class* klass = ResolveClass(descriptor, loader);
   if (klass != nullptr) {
+    if (verifier_deps_ != nullptr) {
+      verifier_deps_->AddResolvedClass(klass);
+    }
     // Class resolved, first look for the class in the list of entries
     // Class was not found, must create new type.
     // To pass the verification, the type should be imprecise,
@@ -212,6 +216,9 @@ const RegType& RegTypeCache::From(mirror::ClassLoader* loader,
     } else {
       DCHECK(!Thread::Current()->IsExceptionPending());
     }
+    if (verifier_deps_ != nullptr) {
+      verifier_deps_->AddUnresolvedClass(descriptor);
+    }
     if (IsValidDescriptor(descriptor)) {
       return AddEntry(
           new (&arena_) UnresolvedReferenceType(AddString(sp_descriptor), entries_.size()));
@@ -247,6 +254,9 @@ const RegType* RegTypeCache::InsertClass(const StringPiece& descriptor,
                                          bool precise) {
   // No reference to the class was found, create new reference.
   DCHECK(FindClass(klass, precise) == nullptr);
+  if (verifier_deps_ != nullptr) {
+    verifier_deps_->AddResolvedClass(klass);
+  }
   RegType* const reg_type = precise
       ? static_cast<RegType*>(
           new (&arena_) PreciseReferenceType(klass, descriptor, entries_.size()))
@@ -267,7 +277,8 @@ RegTypeCache::RegTypeCache(bool can_load_classes, ScopedArenaAllocator& arena)
     : entries_(arena.Adapter(kArenaAllocVerifier)),
       klass_entries_(arena.Adapter(kArenaAllocVerifier)),
       can_load_classes_(can_load_classes),
-      arena_(arena) {
+      arena_(arena),
+      verifier_deps_(nullptr) {
   if (kIsDebugBuild) {
     Thread::Current()->AssertThreadSuspensionIsAllowable(gAborting == 0);
   }
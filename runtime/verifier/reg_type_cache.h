@@ -38,6 +38,7 @@ class StringPiece;
 namespace verifier {
 
 class RegType;
+class VerifierDeps;
 
 // Use 8 bytes since that is the default arena allocator alignment.
 static constexpr size_t kDefaultArenaBitVectorBytes = 8;
@@ -55,6 +56,10 @@ class RegTypeCache {
     }
   }
   static void ShutDown();
+  // Record the classes resolved from now on in `verifier_deps`, if not null.
+  void SetVerifierDeps(VerifierDeps* verifier_deps) {
+    verifier_deps_ = verifier_deps;
+  }
   const art::verifier::RegType& GetFromId(uint16_t id) const;
   const RegType& From(mirror::ClassLoader* loader, const char* descriptor, bool precise)
       SHARED_REQUIRES(Locks::mutator_lock_);
@@ -202,6 +207,9 @@ class RegTypeCache {
   // Arena allocator.
   ScopedArenaAllocator& arena_;
 
+  // Where to record the classes the verifier resolves, null if not recording.
+  VerifierDeps* verifier_deps_;
+
   DISALLOW_COPY_AND_ASSIGN(RegTypeCache);
 };
 
@@ -0,0 +1,351 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "verifier_deps.h"
+
+#include <string.h>
+#include <algorithm>
+
+#include "base/stringprintf.h"
+#include "class_linker.h"
+#include "dex_file.h"
+#include "leb128.h"
+#include "mirror/class-inl.h"
+#include "mirror/class_loader.h"
+#include "mirror/dex_cache-inl.h"
+#include "mirror/iftable-inl.h"
+#include "oat_file.h"
+#include "runtime.h"
+#include "thread.h"
+#include "utils.h"
+
+namespace art {
+namespace verifier {
+
+static void EncodeString(const std::string& str, std::vector<uint8_t>* buffer) {
+  EncodeUnsignedLeb128(buffer, str.size());
+  buffer->insert(buffer->end(), str.begin(), str.end());
+}
+
+// Decode a uleb128 value, checking that it does not extend past `end`.
+static bool DecodeUint32(const uint8_t** data, const uint8_t* end, uint32_t* value) {
+  const uint8_t* ptr = *data;
+  for (size_t i = 0; ptr + i != end && i != 5u; ++i) {
+    if ((ptr[i] & 0x80) == 0) {
+      *value = DecodeUnsignedLeb128(data);
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool DecodeString(const uint8_t** data, const uint8_t* end, std::string* str) {
+  uint32_t length;
+  if (!DecodeUint32(data, end, &length) || length > static_cast<size_t>(end - *data)) {
+    return false;
+  }
+  str->assign(reinterpret_cast<const char*>(*data), length);
+  *data += length;
+  return true;
+}
+
+VerifierDeps::VerifierDeps(const std::vector<const DexFile*>& dex_files)
+    : dex_files_(&dex_files), usable_(true), soft_failure_(false) {}
+
+VerifierDeps::VerifierDeps()
+    : dex_files_(nullptr), usable_(true), soft_failure_(false) {}
+
+void VerifierDeps::AddResolvedClass(mirror::Class* klass) {
+  DCHECK(dex_files_ != nullptr);
+  while (klass->IsArrayClass()) {
+    klass = klass->GetComponentType();
+  }
+  if (klass->IsPrimitive() || !usable_) {
+    return;
+  }
+  std::string temp;
+  const char* descriptor = klass->GetDescriptor(&temp);
+  if (resolved_classes_.find(descriptor) != resolved_classes_.end()) {
+    return;
+  }
+  if (klass->GetClassLoader() == nullptr) {
+    resolved_classes_.emplace(descriptor, ClassLocation { kBootClassPathIndex, 0u });
+    return;
+  }
+  if (klass->IsProxyClass() || klass->IsErroneous() || klass->GetDexCache() == nullptr) {
+    usable_ = false;
+    return;
+  }
+  auto it = std::find(dex_files_->begin(), dex_files_->end(), &klass->GetDexFile());
+  if (it == dex_files_->end()) {
+    // Defined by a class loader we do not know about at compile time.
+    usable_ = false;
+    return;
+  }
+  ClassLocation location = {
+      static_cast<uint32_t>(std::distance(dex_files_->begin(), it)),
+      klass->GetDexClassDefIndex() };
+  resolved_classes_.emplace(descriptor, location);
+  if (klass->GetSuperClass() != nullptr) {
+    AddResolvedClass(klass->GetSuperClass());
+  }
+  mirror::IfTable* iftable = klass->GetIfTable();
+  for (int32_t i = 0, count = klass->GetIfTableCount(); i < count; ++i) {
+    AddResolvedClass(iftable->GetInterface(i));
+  }
+}
+
+void VerifierDeps::AddUnresolvedClass(const char* descriptor) {
+  if (IsValidDescriptor(descriptor)) {
+    unresolved_classes_.insert(descriptor);
+  }
+}
+
+void VerifierDeps::AddMethodAccessFlags(uint32_t method_idx, uint32_t access_flags) {
+  method_access_flags_[method_idx] |= access_flags;
+}
+
+uint32_t VerifierDeps::GetMethodAccessFlags(uint32_t method_idx) const {
+  auto it = method_access_flags_.find(method_idx);
+  return (it != method_access_flags_.end()) ? it->second : 0u;
+}
+
+bool VerifierDeps::Validate(Thread* self,
+                            Handle<mirror::ClassLoader> class_loader,
+                            const OatFile& oat_file,
+                            std::string* error_msg) const {
+  ClassLinker* class_linker = Runtime::Current()->GetClassLinker();
+  const std::vector<const OatDexFile*>& oat_dex_files = oat_file.GetOatDexFiles();
+  for (const auto& entry : resolved_classes_) {
+    const char* descriptor = entry.first.c_str();
+    const ClassLocation& location = entry.second;
+    mirror::Class* klass = class_linker->FindClass(self, descriptor, class_loader);
+    if (klass == nullptr) {
+      self->ClearException();
+      *error_msg = StringPrintf("Class %s is not resolved anymore", descriptor);
+      return false;
+    }
+    bool same_class;
+    if (location.dex_file_index == kBootClassPathIndex) {
+      same_class = (klass->GetClassLoader() == nullptr);
+    } else {
+      same_class = klass->GetClassLoader() == class_loader.Get() &&
+          !klass->IsProxyClass() &&
+          location.dex_file_index < oat_dex_files.size() &&
+          klass->GetDexFile().GetOatDexFile() == oat_dex_files[location.dex_file_index] &&
+          klass->GetDexClassDefIndex() == location.class_def_index;
+    }
+    if (!same_class) {
+      *error_msg = StringPrintf("Class %s resolves to a different definition", descriptor);
+      return false;
+    }
+  }
+  for (const std::string& descriptor : unresolved_classes_) {
+    mirror::Class* klass = class_linker->FindClass(self, descriptor.c_str(), class_loader);
+    if (klass != nullptr) {
+      *error_msg = StringPrintf("Class %s is resolved now", descriptor.c_str());
+      return false;
+    }
+    self->ClearException();
+  }
+  return true;
+}
+
+void VerifierDeps::Encode(std::vector<uint8_t>* buffer) const {
+  DCHECK(usable_);
+  EncodeUnsignedLeb128(buffer, soft_failure_ ? 1u : 0u);
+  EncodeUnsignedLeb128(buffer, resolved_classes_.size());
+  for (const auto& entry : resolved_classes_) {
+    EncodeString(entry.first, buffer);
+    // Boot class path classes are stored with index 0.
+    EncodeUnsignedLeb128(buffer, entry.second.dex_file_index + 1u);
+    EncodeUnsignedLeb128(buffer, entry.second.class_def_index);
+  }
+  EncodeUnsignedLeb128(buffer, unresolved_classes_.size());
+  for (const std::string& descriptor : unresolved_classes_) {
+    EncodeString(descriptor, buffer);
+  }
+  EncodeUnsignedLeb128(buffer, method_access_flags_.size());
+  uint32_t previous_method_idx = 0u;
+  for (const auto& entry : method_access_flags_) {
+    EncodeUnsignedLeb128(buffer, entry.first - previous_method_idx);
+    EncodeUnsignedLeb128(buffer, entry.second);
+    previous_method_idx = entry.first;
+  }
+}
+
+bool VerifierDeps::Decode(const uint8_t* data, const uint8_t* end) {
+  DCHECK(dex_files_ == nullptr);
+  resolved_classes_.clear();
+  unresolved_classes_.clear();
+  method_access_flags_.clear();
+  uint32_t flags;
+  uint32_t count;
+  if (!DecodeUint32(&data, end, &flags) || !DecodeUint32(&data, end, &count)) {
+    return false;
+  }
+  soft_failure_ = (flags & 1u) != 0u;
+  std::string descriptor;
+  for (uint32_t i = 0; i != count; ++i) {
+    ClassLocation location;
+    if (!DecodeString(&data, end, &descriptor) ||
+        !DecodeUint32(&data, end, &location.dex_file_index) ||
+        !DecodeUint32(&data, end, &location.class_def_index)) {
+      return false;
+    }
+    location.dex_file_index -= 1u;
+    resolved_classes_.emplace(descriptor, location);
+  }
+  if (!DecodeUint32(&data, end, &count)) {
+    return false;
+  }
+  for (uint32_t i = 0; i != count; ++i) {
+    if (!DecodeString(&data, end, &descriptor)) {
+      return false;
+    }
+    unresolved_classes_.insert(descriptor);
+  }
+  if (!DecodeUint32(&data, end, &count)) {
+    return false;
+  }
+  uint32_t method_idx = 0u;
+  for (uint32_t i = 0; i != count; ++i) {
+    uint32_t delta;
+    uint32_t access_flags;
+    if (!DecodeUint32(&data, end, &delta) || !DecodeUint32(&data, end, &access_flags)) {
+      return false;
+    }
+    method_idx += delta;
+    method_access_flags_.emplace(method_idx, access_flags);
+  }
+  return true;
+}
+
+static void AppendUint32(uint32_t value, std::vector<uint8_t>* buffer) {
+  const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+  buffer->insert(buffer->end(), bytes, bytes + sizeof(value));
+}
+
+static void SetUint32(size_t offset, uint32_t value, std::vector<uint8_t>* buffer) {
+  DCHECK_LE(offset + sizeof(value), buffer->size());
+  memcpy(buffer->data() + offset, &value, sizeof(value));
+}
+
+static bool ReadUint32(const uint8_t* table, size_t size, size_t offset, uint32_t* value) {
+  if (offset > size || size - offset < sizeof(uint32_t)) {
+    return false;
+  }
+  memcpy(value, table + offset, sizeof(uint32_t));
+  return true;
+}
+
+VerifierDepsTable::VerifierDepsTable(const std::vector<const DexFile*>& dex_files)
+    : dex_files_(dex_files),
+      lock_("verifier deps table lock"),
+      classes_(dex_files.size()) {}
+
+void VerifierDepsTable::AddClass(const DexFile& dex_file,
+                                 uint16_t class_def_index,
+                                 const VerifierDeps& deps) {
+  auto it = std::find(dex_files_.begin(), dex_files_.end(), &dex_file);
+  DCHECK(it != dex_files_.end()) << dex_file.GetLocation();
+  std::vector<uint8_t> encoded;
+  deps.Encode(&encoded);
+  MutexLock mu(Thread::Current(), lock_);
+  classes_[std::distance(dex_files_.begin(), it)][class_def_index] = std::move(encoded);
+}
+
+void VerifierDepsTable::Encode(std::vector<uint8_t>* buffer) const {
+  MutexLock mu(Thread::Current(), lock_);
+  if (std::all_of(classes_.begin(),
+                  classes_.end(),
+                  [](const std::map<uint16_t, std::vector<uint8_t>>& classes) {
+                    return classes.empty();
+                  })) {
+    return;
+  }
+  const size_t start = buffer->size();
+  AppendUint32(static_cast<uint32_t>(classes_.size()), buffer);
+  const size_t section_offsets = buffer->size();
+  buffer->resize(section_offsets + classes_.size() * sizeof(uint32_t), 0u);
+  for (size_t i = 0; i != classes_.size(); ++i) {
+    if (classes_[i].empty()) {
+      continue;
+    }
+    SetUint32(section_offsets + i * sizeof(uint32_t),
+              static_cast<uint32_t>(buffer->size() - start),
+              buffer);
+    AppendUint32(static_cast<uint32_t>(classes_[i].size()), buffer);
+    const size_t entries = buffer->size();
+    buffer->resize(entries + classes_[i].size() * 2u * sizeof(uint32_t), 0u);
+    size_t entry_offset = entries;
+    for (const auto& entry : classes_[i]) {
+      SetUint32(entry_offset, entry.first, buffer);
+      SetUint32(entry_offset + sizeof(uint32_t),
+                static_cast<uint32_t>(buffer->size() - start),
+                buffer);
+      entry_offset += 2u * sizeof(uint32_t);
+      buffer->insert(buffer->end(), entry.second.begin(), entry.second.end());
+    }
+  }
+}
+
+bool VerifierDepsTable::FindClass(const uint8_t* table,
+                                  size_t size,
+                                  uint32_t dex_file_index,
+                                  uint16_t class_def_index,
+                                  VerifierDeps* deps) {
+  uint32_t num_dex_files;
+  uint32_t section_offset;
+  uint32_t num_classes;
+  if (!ReadUint32(table, size, 0u, &num_dex_files) ||
+      dex_file_index >= num_dex_files ||
+      !ReadUint32(table, size, (1u + dex_file_index) * sizeof(uint32_t), &section_offset) ||
+      section_offset == 0u ||
+      !ReadUint32(table, size, section_offset, &num_classes)) {
+    return false;
+  }
+  // Binary search the sorted class def indexes.
+  const size_t entries = section_offset + sizeof(uint32_t);
+  size_t low = 0u;
+  size_t high = num_classes;
+  while (low < high) {
+    size_t mid = low + (high - low) / 2u;
+    uint32_t entry_class_def_index;
+    if (!ReadUint32(table, size, entries + mid * 2u * sizeof(uint32_t), &entry_class_def_index)) {
+      return false;
+    }
+    if (entry_class_def_index < class_def_index) {
+      low = mid + 1u;
+    } else if (entry_class_def_index > class_def_index) {
+      high = mid;
+    } else {
+      uint32_t record_offset;
+      if (!ReadUint32(table,
+                      size,
+                      entries + (mid * 2u + 1u) * sizeof(uint32_t),
+                      &record_offset) ||
+          record_offset >= size) {
+        return false;
+      }
+      return deps->Decode(table + record_offset, table + size);
+    }
+  }
+  return false;
+}
+
+}  // namespace verifier
+}  // namespace art
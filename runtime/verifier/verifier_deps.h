@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ART_RUNTIME_VERIFIER_VERIFIER_DEPS_H_
+#define ART_RUNTIME_VERIFIER_VERIFIER_DEPS_H_
+
+#include <stdint.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "base/macros.h"
+#include "base/mutex.h"
+#include "handle.h"
+
+namespace art {
+
+class DexFile;
+class OatFile;
+class Thread;
+
+namespace mirror {
+class Class;
+class ClassLoader;
+}  // namespace mirror
+
+namespace verifier {
+
+// Dependencies of the runtime verification of a class on the class loading environment.
+//
+// dex2oat records them when it verifies a class whose verification has to be retried at runtime,
+// running the verifier as the runtime would. The result of the verifier only depends on the
+// classes it resolves, so if all the classes recorded here resolve to the same definitions at
+// runtime, the recorded result can be used instead of verifying the class again.
+class VerifierDeps {
+ public:
+  // Recording constructor. Classes defined in `dex_files` are identified by their index in it.
+  explicit VerifierDeps(const std::vector<const DexFile*>& dex_files);
+  // Constructor for Decode().
+  VerifierDeps();
+
+  // Record that `klass` was resolved. As the verifier looks at the members and the supertypes of
+  // the classes it resolves, the superclasses and interfaces of `klass` are recorded as well.
+  // Classes defined outside of the boot class path and of the dex files being compiled make the
+  // dependencies unusable.
+  void AddResolvedClass(mirror::Class* klass) SHARED_REQUIRES(Locks::mutator_lock_);
+
+  // Record that `descriptor` failed to resolve.
+  void AddUnresolvedClass(const char* descriptor);
+
+  // Record access flags the verifier sets on the method `method_idx` of the verified class.
+  void AddMethodAccessFlags(uint32_t method_idx, uint32_t access_flags);
+
+  void SetSoftFailure(bool soft_failure) {
+    soft_failure_ = soft_failure;
+  }
+
+  bool HasSoftFailure() const {
+    return soft_failure_;
+  }
+
+  bool IsUsable() const {
+    return usable_;
+  }
+
+  // Returns the recorded access flags of the method `method_idx`, 0 if there are none.
+  uint32_t GetMethodAccessFlags(uint32_t method_idx) const;
+
+  // Check that the recorded classes resolve with `class_loader` to the same definitions, where
+  // `oat_file` holds the dex files the dependencies were recorded with.
+  bool Validate(Thread* self,
+                Handle<mirror::ClassLoader> class_loader,
+                const OatFile& oat_file,
+                std::string* error_msg) const
+      SHARED_REQUIRES(Locks::mutator_lock_);
+
+  void Encode(std::vector<uint8_t>* buffer) const;
+  // Returns false if the encoded data between `data` and `end` is malformed.
+  bool Decode(const uint8_t* data, const uint8_t* end);
+
+ private:
+  // Dex file index of the classes of the boot class path. The boot class path is checked when
+  // the oat file is opened, so these are only checked to still come from it.
+  static constexpr uint32_t kBootClassPathIndex = 0xffffffffu;
+
+  struct ClassLocation {
+    uint32_t dex_file_index;
+    uint32_t class_def_index;
+  };
+
+  const std::vector<const DexFile*>* const dex_files_;
+  bool usable_;
+  bool soft_failure_;
+  std::map<std::string, ClassLocation> resolved_classes_;
+  std::set<std::string> unresolved_classes_;
+  std::map<uint32_t, uint32_t> method_access_flags_;
+
+  DISALLOW_COPY_AND_ASSIGN(VerifierDeps);
+};
+
+// The verifier dependencies of the classes of a set of dex files, as stored in an oat file.
+//
+// The encoded table is a uint32_t count of dex files followed by the offset of the section of
+// each dex file, 0 for dex files without dependencies. A section is a uint32_t count of classes
+// followed by (class def index, offset of the encoded VerifierDeps) pairs of uint32_t sorted by
+// class def index. Offsets are relative to the start of the table.
+class VerifierDepsTable {
+ public:
+  explicit VerifierDepsTable(const std::vector<const DexFile*>& dex_files);
+
+  const std::vector<const DexFile*>& GetDexFiles() const {
+    return dex_files_;
+  }
+
+  void AddClass(const DexFile& dex_file, uint16_t class_def_index, const VerifierDeps& deps)
+      REQUIRES(!lock_);
+
+  // Encode the table, or nothing if no class was added.
+  void Encode(std::vector<uint8_t>* buffer) const REQUIRES(!lock_);
+
+  // Look up the dependencies of a class in an encoded table. Returns false if there are none.
+  static bool FindClass(const uint8_t* table,
+                        size_t size,
+                        uint32_t dex_file_index,
+                        uint16_t class_def_index,
+                        VerifierDeps* deps);
+
+ private:
+  const std::vector<const DexFile*> dex_files_;
+  mutable Mutex lock_ DEFAULT_MUTEX_ACQUIRED_AFTER;
+  // Encoded dependencies, per dex file and class def index.
+  std::vector<std::map<uint16_t, std::vector<uint8_t>>> classes_ GUARDED_BY(lock_);
+
+  DISALLOW_COPY_AND_ASSIGN(VerifierDepsTable);
+};
+
+}  // namespace verifier
+}  // namespace art
+
+#endif  // ART_RUNTIME_VERIFIER_VERIFIER_DEPS_H_
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "verifier_deps.h"
+
+#include "class_linker-inl.h"
+#include "common_runtime_test.h"
+#include "dex_file.h"
+#include "modifiers.h"
+#include "scoped_thread_state_change.h"
+
+namespace art {
+namespace verifier {
+
+class VerifierDepsTest : public CommonRuntimeTest {};
+
+TEST_F(VerifierDepsTest, EncodeAndFindClass) {
+  ScopedObjectAccess soa(Thread::Current());
+  std::vector<const DexFile*> dex_files = { java_lang_dex_file_ };
+  VerifierDeps deps(dex_files);
+  deps.AddResolvedClass(class_linker_->FindSystemClass(soa.Self(), "[Ljava/lang/String;"));
+  deps.AddUnresolvedClass("LDoesNotExist;");
+  deps.AddUnresolvedClass("not a descriptor");
+  deps.AddMethodAccessFlags(3u, kAccCompileDontBother);
+  deps.AddMethodAccessFlags(3u, kAccMustCountLocks);
+  deps.AddMethodAccessFlags(200u, kAccCompileDontBother);
+  deps.SetSoftFailure(true);
+  // Boot class path classes do not need to be in the dex files.
+  EXPECT_TRUE(deps.IsUsable());
+
+  VerifierDepsTable table(dex_files);
+  std::vector<uint8_t> encoded;
+  table.Encode(&encoded);
+  EXPECT_TRUE(encoded.empty());
+  table.AddClass(*java_lang_dex_file_, 7u, deps);
+  table.AddClass(*java_lang_dex_file_, 2u, VerifierDeps(dex_files));
+  table.Encode(&encoded);
+  ASSERT_FALSE(encoded.empty());
+
+  VerifierDeps decoded;
+  ASSERT_TRUE(VerifierDepsTable::FindClass(encoded.data(), encoded.size(), 0u, 7u, &decoded));
+  EXPECT_TRUE(decoded.HasSoftFailure());
+  EXPECT_EQ(kAccCompileDontBother | kAccMustCountLocks, decoded.GetMethodAccessFlags(3u));
+  EXPECT_EQ(kAccCompileDontBother, decoded.GetMethodAccessFlags(200u));
+  EXPECT_EQ(0u, decoded.GetMethodAccessFlags(4u));
+  std::vector<uint8_t> reencoded;
+  decoded.Encode(&reencoded);
+  std::vector<uint8_t> expected;
+  deps.Encode(&expected);
+  EXPECT_EQ(expected, reencoded);
+
+  ASSERT_TRUE(VerifierDepsTable::FindClass(encoded.data(), encoded.size(), 0u, 2u, &decoded));
+  EXPECT_FALSE(decoded.HasSoftFailure());
+  EXPECT_EQ(0u, decoded.GetMethodAccessFlags(3u));
+
+  EXPECT_FALSE(VerifierDepsTable::FindClass(encoded.data(), encoded.size(), 0u, 5u, &decoded));
+  EXPECT_FALSE(VerifierDepsTable::FindClass(encoded.data(), encoded.size(), 1u, 7u, &decoded));
+}
+
+TEST_F(VerifierDepsTest, RejectTruncatedTable) {
+  ScopedObjectAccess soa(Thread::Current());
+  std::vector<const DexFile*> dex_files = { java_lang_dex_file_ };
+  VerifierDeps deps(dex_files);
+  deps.AddResolvedClass(class_linker_->FindSystemClass(soa.Self(), "Ljava/lang/Object;"));
+  VerifierDepsTable table(dex_files);
+  table.AddClass(*java_lang_dex_file_, 0u, deps);
+  std::vector<uint8_t> encoded;
+  table.Encode(&encoded);
+  VerifierDeps decoded;
+  for (size_t size = 0u; size != encoded.size(); ++size) {
+    EXPECT_FALSE(VerifierDepsTable::FindClass(encoded.data(), size, 0u, 0u, &decoded)) << size;
+  }
+  EXPECT_TRUE(VerifierDepsTable::FindClass(encoded.data(), encoded.size(), 0u, 0u, &decoded));
+}
+
+}  // namespace verifier
+}  // namespace art
@@ -18,11 +18,13 @@
 
 #include <fcntl.h>
 #include <stdio.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
 #include <vector>
 
+#include "base/bit_utils.h"
 #include "base/stringprintf.h"
 #include "base/unix_file/fd_file.h"
 
@@ -74,6 +76,45 @@ MemMap* ZipEntry::ExtractToMemMap(const char* zip_filename, const char* entry_fi
   return map.release();
 }
 
+bool ZipEntry::IsUncompressed() {
+  return zip_entry_->method == kCompressStored;
+}
+
+bool ZipEntry::IsAlignedTo(size_t alignment) {
+  DCHECK(IsPowerOfTwo(alignment)) << alignment;
+  return IsAlignedParam(zip_entry_->offset, alignment);
+}
+
+MemMap* ZipEntry::MapDirectlyFromFile(const char* zip_filename, const char* entry_filename,
+                                      std::string* error_msg) {
+  if (!IsUncompressed() || zip_entry_->compressed_length != zip_entry_->uncompressed_length) {
+    *error_msg = StringPrintf("Cannot map '%s' from '%s' as it is compressed",
+                              entry_filename, zip_filename);
+    return nullptr;
+  }
+
+  std::string name(entry_filename);
+  name += " mapped directly in memory from ";
+  name += zip_filename;
+  // The zip archive checked that the entry data lies within the file when it found the entry.
+  // The mapping is private and writable like an extracted entry, pages are only copied if they
+  // are written to.
+  std::unique_ptr<MemMap> map(MemMap::MapFile(GetUncompressedLength(),
+                                              PROT_READ | PROT_WRITE,
+                                              MAP_PRIVATE,
+                                              GetFileDescriptor(handle_),
+                                              zip_entry_->offset,
+                                              false,
+                                              name.c_str(),
+                                              error_msg));
+  if (map.get() == nullptr) {
+    DCHECK(!error_msg->empty());
+    return nullptr;
+  }
+
+  return map.release();
+}
+
 static void SetCloseOnExec(int fd) {
   // This dance is more portable than Linux's O_CLOEXEC open(2) flag.
   int flags = fcntl(fd, F_GETFD);
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "art_method-inl.h"
+#include "jit/jit.h"
+#include "jit/jit_code_cache.h"
+#include "oat_quick_method_header.h"
+#include "scoped_thread_state_change.h"
+#include "ScopedUtfChars.h"
+#include "stack_map.h"
+
+namespace art {
+
+static ArtMethod* FindMethod(ScopedObjectAccess& soa, JNIEnv* env, jclass cls, jstring name)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  ScopedUtfChars chars(env, name);
+  CHECK(chars.c_str() != nullptr);
+  mirror::Class* klass = soa.Decode<mirror::Class*>(cls);
+  ArtMethod* method = klass->FindDeclaredVirtualMethodByName(chars.c_str(), sizeof(void*));
+  if (method == nullptr) {
+    method = klass->FindDeclaredDirectMethodByName(chars.c_str(), sizeof(void*));
+  }
+  CHECK(method != nullptr) << chars.c_str();
+  return method;
+}
+
+// Returns the header of the JIT code `method` currently runs, or null.
+static const OatQuickMethodHeader* GetJitCodeHeader(ArtMethod* method)
+    SHARED_REQUIRES(Locks::mutator_lock_) {
+  jit::JitCodeCache* code_cache = Runtime::Current()->GetJit()->GetCodeCache();
+  const void* entry_point = method->GetEntryPointFromQuickCompiledCode();
+  if (!code_cache->ContainsPc(entry_point)) {
+    return nullptr;
+  }
+  return OatQuickMethodHeader::FromEntryPoint(entry_point);
+}
+
+extern "C" JNIEXPORT jboolean JNICALL Java_Main_hasJit(JNIEnv*, jclass) {
+  return Runtime::Current()->GetJit() != nullptr;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL Java_Main_hasSingleImplementation(JNIEnv* env,
+                                                                        jclass,
+                                                                        jclass cls,
+                                                                        jstring method_name) {
+  ScopedObjectAccess soa(Thread::Current());
+  return FindMethod(soa, env, cls, method_name)->HasSingleImplementation();
+}
+
+extern "C" JNIEXPORT jboolean JNICALL Java_Main_hasJitCompiledCode(JNIEnv* env,
+                                                                   jclass,
+                                                                   jclass cls,
+                                                                   jstring method_name) {
+  ScopedObjectAccess soa(Thread::Current());
+  return GetJitCodeHeader(FindMethod(soa, env, cls, method_name)) != nullptr;
+}
+
+extern "C" JNIEXPORT jboolean JNICALL Java_Main_hasInlineInfo(JNIEnv* env,
+                                                              jclass,
+                                                              jclass cls,
+                                                              jstring method_name) {
+  ScopedObjectAccess soa(Thread::Current());
+  const OatQuickMethodHeader* header = GetJitCodeHeader(FindMethod(soa, env, cls, method_name));
+  if (header == nullptr) {
+    return JNI_FALSE;
+  }
+  CodeInfo info = header->GetOptimizedCodeInfo();
+  CodeInfoEncoding encoding = info.ExtractEncoding();
+  return info.HasInlineInfo(encoding);
+}
+
+}  // namespace art
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+class Base {
+  int foo() {
+    return 1;
+  }
+}
+
+class Sub1 extends Base {}
+class Sub2 extends Base {}
+class Sub3 extends Base {}
+class Sub4 extends Base {}
+class Sub5 extends Base {}
+
+// Only loaded by name, once the caller of `Base.foo` has been compiled.
+class Override extends Base {
+  int foo() {
+    return 2;
+  }
+}
+
+public class Main {
+  public static void assertEquals(int expected, int actual) {
+    if (expected != actual) {
+      throw new Error("Expected " + expected  + ", got " + actual);
+    }
+  }
+
+  public static void assertTrue(boolean condition, String message) {
+    if (!condition) {
+      throw new Error(message);
+    }
+  }
+
+  // Ahead-of-time compilation cannot rely on class hierarchy analysis, as
+  // it cannot invalidate the code when `Base.foo` gets overridden.
+
+  /// CHECK-START: int Main.$noinline$callFoo(Base) inliner (after)
+  /// CHECK:                InvokeVirtual
+
+  public static int $noinline$callFoo(Base b) {
+    return b.foo();
+  }
+
+  public static void main(String[] args) throws Exception {
+    System.loadLibrary(args[0]);
+    // More receiver types than an inline cache holds, so that the JIT can only
+    // inline `Base.foo` through class hierarchy analysis.
+    Base[] receivers = {
+      new Base(), new Sub1(), new Sub2(), new Sub3(), new Sub4(), new Sub5()
+    };
+    for (int i = 0; i < 10000; ++i) {
+      for (Base b : receivers) {
+        assertEquals(1, $noinline$callFoo(b));
+      }
+    }
+
+    ensureJitCompiled(Main.class, "$noinline$callFoo");
+    if (hasJit()) {
+      assertTrue(hasSingleImplementation(Base.class, "foo"), "Base.foo overridden");
+      assertTrue(hasJitCompiledCode(Main.class, "$noinline$callFoo"), "Not compiled");
+      assertTrue(hasInlineInfo(Main.class, "$noinline$callFoo"), "Base.foo not inlined");
+    }
+
+    Base override = (Base) Class.forName("Override").newInstance();
+    if (hasJit()) {
+      assertTrue(!hasSingleImplementation(Base.class, "foo"), "Base.foo not overridden");
+      assertTrue(!hasJitCompiledCode(Main.class, "$noinline$callFoo"), "Code not invalidated");
+    }
+    assertEquals(2, $noinline$callFoo(override));
+    for (Base b : receivers) {
+      assertEquals(1, $noinline$callFoo(b));
+    }
+    System.out.println("passed");
+  }
+
+  private static native void ensureJitCompiled(Class cls, String methodName);
+  private static native boolean hasJit();
+  private static native boolean hasSingleImplementation(Class cls, String methodName);
+  private static native boolean hasJitCompiledCode(Class cls, String methodName);
+  private static native boolean hasInlineInfo(Class cls, String methodName);
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+public class Main {
+  public static void main(String[] args) {
+    // The intrinsic compares eight characters per vector iteration, and
+    // finishes with the remaining characters.
+    int[] lengths = { 0, 1, 7, 8, 9, 15, 16, 17, 31, 32, 33 };
+    for (int length : lengths) {
+      String str = makeString(length);
+      assertTrue($noinline$equals(str, makeString(length)), length, -1);
+      assertFalse($noinline$equals(str, makeString(length + 1)), length, -1);
+      if (length != 0) {
+        assertFalse($noinline$equals(str, makeString(length - 1)), length, -1);
+      }
+      for (int i = 0; i < length; ++i) {
+        // Differ in the low byte of a character.
+        assertFalse($noinline$equals(str, makeString(length, i, 'z')), length, i);
+        // Differ in the high byte of a character only.
+        char c = (char) ('a' + (i % 26) + 0x100);
+        assertFalse($noinline$equals(str, makeString(length, i, c)), length, i);
+        assertFalse($noinline$equals(makeString(length, i, c), str), length, i);
+      }
+    }
+  }
+
+  public static boolean $noinline$equals(String a, Object b) {
+    if (doThrow) { throw new Error(); }
+    return a.equals(b);
+  }
+
+  // Build the strings at runtime so that each comparison compares the characters.
+  public static String makeString(int length) {
+    return makeString(length, -1, 'a');
+  }
+
+  public static String makeString(int length, int index, char c) {
+    char[] chars = new char[length];
+    for (int i = 0; i < length; ++i) {
+      chars[i] = (i == index) ? c : (char) ('a' + (i % 26));
+    }
+    return new String(chars);
+  }
+
+  public static void assertTrue(boolean result, int length, int index) {
+    if (!result) {
+      throw new Error("Expected equal strings of length " + length);
+    }
+  }
+
+  public static void assertFalse(boolean result, int length, int index) {
+    if (result) {
+      throw new Error("Expected different strings of length " + length + " at " + index);
+    }
+  }
+
+  static boolean doThrow = false;
+}
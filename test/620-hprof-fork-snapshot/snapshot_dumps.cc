@@ -0,0 +1,28 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "hprof/hprof.h"
+#include "jni.h"
+
+namespace art {
+namespace {
+
+extern "C" JNIEXPORT jint JNICALL Java_Main_getNumSnapshotDumps(JNIEnv*, jclass) {
+  return static_cast<jint>(hprof::GetNumSnapshotDumps());
+}
+
+}  // namespace
+}  // namespace art
@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+import java.io.DataInputStream;
+import java.io.File;
+import java.io.FileDescriptor;
+import java.io.FileInputStream;
+import java.io.FileOutputStream;
+import java.lang.reflect.Method;
+
+public class Main {
+    private static final int TEST_LENGTH = 100;
+    private static final String HPROF_HEADER = "JAVA PROFILE 1.0";
+
+    static volatile boolean done = false;
+
+    public static void main(String[] args) throws Exception {
+        System.loadLibrary(args[0]);
+
+        // Create some data.
+        Object data[] = new Object[TEST_LENGTH];
+        for (int i = 0; i < data.length; i++) {
+            data[i] = (i % 10 == 0) ? new Object[TEST_LENGTH] : String.valueOf(i);
+        }
+        System.out.println("Generated data.");
+
+        // Keep another thread allocating while the snapshot process dumps the heap.
+        Thread allocator = new Thread() {
+            public void run() {
+                while (!done) {
+                    Object[] garbage = new Object[TEST_LENGTH];
+                    garbage[0] = String.valueOf(garbage.length);
+                }
+            }
+        };
+        allocator.start();
+
+        Class<?> vmDebug = Class.forName("dalvik.system.VMDebug");
+        File dumpFile = File.createTempFile("test-620-hprof", "dump");
+        try {
+            Method dumpToFile = vmDebug.getMethod("dumpHprofData", String.class);
+            dumpToFile.invoke(null, dumpFile.getAbsolutePath());
+            checkDump(dumpFile);
+            checkNumSnapshotDumps(1);
+            System.out.println("Dumped to file.");
+
+            Method dumpToFd =
+                vmDebug.getMethod("dumpHprofData", String.class, FileDescriptor.class);
+            FileOutputStream out = new FileOutputStream(dumpFile);
+            try {
+                dumpToFd.invoke(null, dumpFile.getAbsolutePath(), out.getFD());
+            } finally {
+                out.close();
+            }
+            checkDump(dumpFile);
+            checkNumSnapshotDumps(2);
+            System.out.println("Dumped to file descriptor.");
+        } finally {
+            dumpFile.delete();
+            done = true;
+            allocator.join();
+        }
+
+        // The data is still reachable.
+        if (data[TEST_LENGTH - 1] == null) {
+            throw new Error("Lost data");
+        }
+    }
+
+    // The dumps were written by snapshot processes rather than with the threads suspended.
+    private static void checkNumSnapshotDumps(int expected) {
+        int numSnapshotDumps = getNumSnapshotDumps();
+        if (numSnapshotDumps != expected) {
+            throw new Error("Expected " + expected + " snapshot dumps, got " + numSnapshotDumps);
+        }
+    }
+
+    private static native int getNumSnapshotDumps();
+
+    // The snapshot process wrote a complete dump before the dumping thread returned.
+    private static void checkDump(File dumpFile) throws Exception {
+        DataInputStream in = new DataInputStream(new FileInputStream(dumpFile));
+        try {
+            byte[] header = new byte[HPROF_HEADER.length()];
+            in.readFully(header);
+            if (!HPROF_HEADER.equals(new String(header, "US-ASCII"))) {
+                throw new Error("Unexpected header " + new String(header, "US-ASCII"));
+            }
+        } finally {
+            in.close();
+        }
+        if (dumpFile.length() < TEST_LENGTH * 4) {
+            throw new Error("Dump too short: " + dumpFile.length());
+        }
+    }
+}
@@ -0,0 +1,372 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.io.BufferedInputStream;
+import java.io.ByteArrayInputStream;
+import java.io.DataInputStream;
+import java.io.File;
+import java.io.FileInputStream;
+import java.io.IOException;
+import java.io.InputStream;
+import java.lang.reflect.Method;
+import java.util.HashMap;
+import java.util.HashSet;
+import java.util.Map;
+import java.util.zip.GZIPInputStream;
+
+public class Main {
+    private static final int NUM_NODES = 1000;
+    private static final String HPROF_HEADER = "JAVA PROFILE 1.0";
+
+    // Record tags.
+    private static final int TAG_STRING = 0x01;
+    private static final int TAG_LOAD_CLASS = 0x02;
+    private static final int TAG_HEAP_DUMP = 0x0c;
+    private static final int TAG_HEAP_DUMP_SEGMENT = 0x1c;
+    private static final int TAG_HEAP_DUMP_END = 0x2c;
+
+    // Heap dump sub-record tags.
+    private static final int ROOT_UNKNOWN = 0xff;
+    private static final int ROOT_JNI_GLOBAL = 0x01;
+    private static final int ROOT_JNI_LOCAL = 0x02;
+    private static final int ROOT_JAVA_FRAME = 0x03;
+    private static final int ROOT_NATIVE_STACK = 0x04;
+    private static final int ROOT_STICKY_CLASS = 0x05;
+    private static final int ROOT_THREAD_BLOCK = 0x06;
+    private static final int ROOT_MONITOR_USED = 0x07;
+    private static final int ROOT_THREAD_OBJECT = 0x08;
+    private static final int CLASS_DUMP = 0x20;
+    private static final int INSTANCE_DUMP = 0x21;
+    private static final int OBJECT_ARRAY_DUMP = 0x22;
+    private static final int PRIMITIVE_ARRAY_DUMP = 0x23;
+    private static final int HEAP_DUMP_INFO = 0xfe;
+    private static final int ROOT_INTERNED_STRING = 0x89;
+    private static final int ROOT_DEBUGGER = 0x8b;
+    private static final int ROOT_VM_INTERNAL = 0x8d;
+    private static final int ROOT_JNI_MONITOR = 0x8e;
+
+    private static final int TYPE_OBJECT = 2;
+
+    static class Node {
+        Node next;
+        Object payload;
+    }
+
+    static Node head;
+
+    public static void main(String[] args) throws Exception {
+        boolean sampled = args.length > 0 && args[0].equals("sampled");
+
+        // A list of nodes referring to each other, most of which a sampled dump leaves out.
+        for (int i = 0; i < NUM_NODES; i++) {
+            Node node = new Node();
+            node.next = head;
+            node.payload = (i % 2 == 0) ? new int[i % 16] : String.valueOf(i);
+            head = node;
+        }
+
+        Class<?> vmDebug = Class.forName("dalvik.system.VMDebug");
+        Method dumpHprofData = vmDebug.getMethod("dumpHprofData", String.class);
+        for (String suffix : new String[] { ".hprof", ".hprof.gz" }) {
+            File dumpFile = File.createTempFile("test-621-hprof", suffix);
+            try {
+                dumpHprofData.invoke(null, dumpFile.getAbsolutePath());
+                Dump dump = new Dump(dumpFile, suffix.endsWith(".gz"));
+                dump.read(/* check */ false);
+                dump.read(/* check */ true);
+                int nodes = dump.countInstances("Main$Node");
+                if (sampled ? (nodes == 0 || nodes >= NUM_NODES) : nodes != NUM_NODES) {
+                    throw new Error("Unexpected number of nodes " + nodes);
+                }
+                System.out.println("Checked " + suffix + ", " + (sampled ? "some" : "all") +
+                                   " nodes written.");
+            } finally {
+                dumpFile.delete();
+            }
+        }
+    }
+
+    // The superclass and the instance field types of a class.
+    static class ClassLayout {
+        int superId;
+        byte[] fieldTypes;
+    }
+
+    // Reads a dump twice, first to find the objects it has records for, then to check that the
+    // references it holds are to these objects.
+    static class Dump {
+        private final File file;
+        private final boolean compressed;
+        private final HashSet<Integer> objects = new HashSet<Integer>();
+        private final HashMap<Integer, ClassLayout> classes = new HashMap<Integer, ClassLayout>();
+        private final HashMap<Integer, String> strings = new HashMap<Integer, String>();
+        private final HashMap<Integer, Integer> classNames = new HashMap<Integer, Integer>();
+        private final HashMap<Integer, Integer> instanceCounts = new HashMap<Integer, Integer>();
+        private boolean check;
+
+        Dump(File file, boolean compressed) {
+            this.file = file;
+            this.compressed = compressed;
+        }
+
+        void read(boolean check) throws IOException {
+            this.check = check;
+            InputStream raw = new FileInputStream(file);
+            if (compressed) {
+                // Throws if the file is not in the gzip format.
+                raw = new GZIPInputStream(raw, 64 * 1024);
+            }
+            DataInputStream in = new DataInputStream(new BufferedInputStream(raw, 64 * 1024));
+            try {
+                readHeader(in);
+                boolean ended = false;
+                int tag;
+                while ((tag = in.read()) != -1) {
+                    in.readInt();  // Time.
+                    int length = in.readInt();
+                    if (ended) {
+                        throw new Error("Record after the end of the heap dump");
+                    }
+                    switch (tag) {
+                        case TAG_STRING: {
+                            int id = in.readInt();
+                            byte[] utf8 = new byte[length - 4];
+                            in.readFully(utf8);
+                            strings.put(id, new String(utf8, "UTF-8"));
+                            break;
+                        }
+                        case TAG_LOAD_CLASS:
+                            in.readInt();  // Serial number.
+                            int classId = in.readInt();
+                            in.readInt();  // Stack trace serial number.
+                            classNames.put(classId, in.readInt());
+                            break;
+                        case TAG_HEAP_DUMP:
+                        case TAG_HEAP_DUMP_SEGMENT: {
+                            byte[] segment = new byte[length];
+                            in.readFully(segment);
+                            readHeapDump(new DataInputStream(new ByteArrayInputStream(segment)));
+                            break;
+                        }
+                        case TAG_HEAP_DUMP_END:
+                            ended = true;
+                            in.skipBytes(length);
+                            break;
+                        default:
+                            skipFully(in, length);
+                            break;
+                    }
+                }
+                if (!ended) {
+                    throw new Error("Missing heap dump end");
+                }
+            } finally {
+                in.close();
+            }
+        }
+
+        int countInstances(String className) {
+            int count = 0;
+            for (Map.Entry<Integer, Integer> entry : instanceCounts.entrySet()) {
+                Integer nameId = classNames.get(entry.getKey());
+                if (nameId != null && className.equals(strings.get(nameId))) {
+                    count += entry.getValue();
+                }
+            }
+            return count;
+        }
+
+        private void readHeader(DataInputStream in) throws IOException {
+            byte[] header = new byte[HPROF_HEADER.length()];
+            in.readFully(header);
+            if (!HPROF_HEADER.equals(new String(header, "US-ASCII")) || in.read() != 0) {
+                throw new Error("Unexpected header " + new String(header, "US-ASCII"));
+            }
+            int idSize = in.readInt();
+            if (idSize != 4) {
+                throw new Error("Unexpected ID size " + idSize);
+            }
+            in.readLong();  // Timestamp.
+        }
+
+        private void readHeapDump(DataInputStream in) throws IOException {
+            while (in.available() > 0) {
+                int tag = in.readUnsignedByte();
+                switch (tag) {
+                    case ROOT_UNKNOWN:
+                    case ROOT_STICKY_CLASS:
+                    case ROOT_MONITOR_USED:
+                    case ROOT_INTERNED_STRING:
+                    case ROOT_DEBUGGER:
+                    case ROOT_VM_INTERNAL:
+                        reference(in.readInt());
+                        break;
+                    case ROOT_JNI_GLOBAL:
+                        reference(in.readInt());
+                        in.readInt();  // JNI global ref ID.
+                        break;
+                    case ROOT_JNI_LOCAL:
+                    case ROOT_JAVA_FRAME:
+                    case ROOT_JNI_MONITOR:
+                    case ROOT_THREAD_OBJECT:
+                        reference(in.readInt());
+                        in.readInt();  // Thread serial number.
+                        in.readInt();  // Frame number or stack trace serial number.
+                        break;
+                    case ROOT_NATIVE_STACK:
+                    case ROOT_THREAD_BLOCK:
+                        reference(in.readInt());
+                        in.readInt();  // Thread serial number.
+                        break;
+                    case HEAP_DUMP_INFO:
+                        in.readInt();  // Heap type.
+                        in.readInt();  // Heap name string ID.
+                        break;
+                    case CLASS_DUMP:
+                        readClassDump(in);
+                        break;
+                    case INSTANCE_DUMP:
+                        readInstanceDump(in);
+                        break;
+                    case OBJECT_ARRAY_DUMP: {
+                        define(in.readInt());
+                        in.readInt();  // Stack trace serial number.
+                        int length = in.readInt();
+                        reference(in.readInt());  // Array class.
+                        for (int i = 0; i < length; i++) {
+                            reference(in.readInt());
+                        }
+                        break;
+                    }
+                    case PRIMITIVE_ARRAY_DUMP: {
+                        define(in.readInt());
+                        in.readInt();  // Stack trace serial number.
+                        int length = in.readInt();
+                        int type = in.readUnsignedByte();
+                        skipFully(in, length * typeSize(type));
+                        break;
+                    }
+                    default:
+                        throw new Error("Unexpected heap dump tag " + tag);
+                }
+            }
+        }
+
+        private void readClassDump(DataInputStream in) throws IOException {
+            int classId = in.readInt();
+            define(classId);
+            in.readInt();  // Stack trace serial number.
+            ClassLayout layout = new ClassLayout();
+            layout.superId = in.readInt();
+            reference(layout.superId);
+            reference(in.readInt());  // Class loader.
+            for (int i = 0; i < 4; i++) {
+                reference(in.readInt());  // Signer, protection domain and reserved.
+            }
+            in.readInt();  // Instance size.
+            int constantPoolSize = in.readUnsignedShort();
+            for (int i = 0; i < constantPoolSize; i++) {
+                in.readUnsignedShort();  // Index.
+                readValue(in, in.readUnsignedByte());
+            }
+            int numStaticFields = in.readUnsignedShort();
+            for (int i = 0; i < numStaticFields; i++) {
+                in.readInt();  // Name string ID.
+                readValue(in, in.readUnsignedByte());
+            }
+            int numInstanceFields = in.readUnsignedShort();
+            layout.fieldTypes = new byte[numInstanceFields];
+            for (int i = 0; i < numInstanceFields; i++) {
+                in.readInt();  // Name string ID.
+                layout.fieldTypes[i] = in.readByte();
+            }
+            classes.put(classId, layout);
+        }
+
+        private void readInstanceDump(DataInputStream in) throws IOException {
+            define(in.readInt());
+            in.readInt();  // Stack trace serial number.
+            int classId = in.readInt();
+            reference(classId);
+            byte[] fields = new byte[in.readInt()];
+            in.readFully(fields);
+            if (!check) {
+                Integer count = instanceCounts.get(classId);
+                instanceCounts.put(classId, (count == null) ? 1 : count + 1);
+                return;
+            }
+            // The fields of the class come first, then those of its superclass, and so on.
+            DataInputStream fieldsIn = new DataInputStream(new ByteArrayInputStream(fields));
+            for (int id = classId; id != 0; ) {
+                ClassLayout layout = classes.get(id);
+                if (layout == null) {
+                    throw new Error("No class dump for " + Integer.toHexString(id));
+                }
+                for (byte type : layout.fieldTypes) {
+                    readValue(fieldsIn, type);
+                }
+                id = layout.superId;
+            }
+            if (fieldsIn.available() != 0) {
+                throw new Error("Instance fields too long for " + Integer.toHexString(classId));
+            }
+        }
+
+        private void readValue(DataInputStream in, int type) throws IOException {
+            if (type == TYPE_OBJECT) {
+                reference(in.readInt());
+            } else {
+                skipFully(in, typeSize(type));
+            }
+        }
+
+        private void define(int id) {
+            if (!check) {
+                objects.add(id);
+            }
+        }
+
+        private void reference(int id) {
+            if (check && id != 0 && !objects.contains(id)) {
+                throw new Error("Unresolved object " + Integer.toHexString(id));
+            }
+        }
+
+        private static int typeSize(int type) {
+            switch (type) {
+                case 2: return 4;   // Object.
+                case 4: return 1;   // Boolean.
+                case 5: return 2;   // Char.
+                case 6: return 4;   // Float.
+                case 7: return 8;   // Double.
+                case 8: return 1;   // Byte.
+                case 9: return 2;   // Short.
+                case 10: return 4;  // Int.
+                case 11: return 8;  // Long.
+                default: throw new Error("Unexpected type " + type);
+            }
+        }
+
+        private static void skipFully(DataInputStream in, int length) throws IOException {
+            byte[] buffer = new byte[Math.min(length, 4096)];
+            while (length > 0) {
+                int count = Math.min(length, buffer.length);
+                in.readFully(buffer, 0, count);
+                length -= count;
+            }
+        }
+    }
+}
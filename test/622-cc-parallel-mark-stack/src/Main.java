@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.util.concurrent.CountDownLatch;
+
+public class Main {
+    // The concurrent copying collector only hands its mark stacks to the GC threads when they hold
+    // at least 1024 gray objects. Each frame of the threads below holds an object that is only
+    // reachable from the stack, so the roots alone are well over that.
+    private static final int NUM_THREADS = 4;
+    private static final int DEPTH = 600;
+    private static final int NUM_CHILDREN = 8;
+    private static final int NUM_COLLECTIONS = 5;
+
+    static class Node {
+        final int value;
+        final Node[] children;
+
+        Node(int value, int numChildren) {
+            this.value = value;
+            this.children = new Node[numChildren];
+            for (int i = 0; i < numChildren; i++) {
+                children[i] = new Node(value + i + 1, 0);
+            }
+        }
+
+        int sum() {
+            int result = value;
+            for (Node child : children) {
+                result += child.sum();
+            }
+            return result;
+        }
+    }
+
+    static int expectedSum(int value) {
+        int result = value;
+        for (int i = 0; i < NUM_CHILDREN; i++) {
+            result += value + i + 1;
+        }
+        return result;
+    }
+
+    static CountDownLatch ready = new CountDownLatch(NUM_THREADS);
+    static CountDownLatch release = new CountDownLatch(1);
+    static volatile String failure = null;
+
+    static void recurse(int depth) throws InterruptedException {
+        Node node = new Node(depth, NUM_CHILDREN);
+        if (depth == 0) {
+            ready.countDown();
+            release.await();
+        } else {
+            recurse(depth - 1);
+        }
+        // The node moved during the collections, check that it and its children are intact.
+        if (node.sum() != expectedSum(depth)) {
+            failure = "Unexpected sum " + node.sum() + " at depth " + depth;
+        }
+    }
+
+    public static void main(String[] args) throws Exception {
+        Thread[] threads = new Thread[NUM_THREADS];
+        for (int i = 0; i < NUM_THREADS; i++) {
+            threads[i] = new Thread() {
+                public void run() {
+                    try {
+                        recurse(DEPTH);
+                    } catch (InterruptedException e) {
+                        failure = e.toString();
+                    }
+                }
+            };
+            threads[i].start();
+        }
+        ready.await();
+        System.out.println("Threads ready.");
+
+        for (int i = 0; i < NUM_COLLECTIONS; i++) {
+            // Leave some garbage between the live objects.
+            Object[] garbage = new Object[DEPTH * NUM_CHILDREN];
+            for (int j = 0; j < garbage.length; j++) {
+                garbage[j] = new Node(j, 1);
+            }
+            garbage = null;
+            Runtime.getRuntime().gc();
+        }
+        System.out.println("Collected.");
+
+        release.countDown();
+        for (Thread thread : threads) {
+            thread.join();
+        }
+        if (failure != null) {
+            System.out.println(failure);
+        }
+        System.out.println("Threads done.");
+    }
+}
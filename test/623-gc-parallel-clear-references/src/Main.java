@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2016 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+import java.lang.ref.PhantomReference;
+import java.lang.ref.Reference;
+import java.lang.ref.ReferenceQueue;
+import java.lang.ref.SoftReference;
+import java.lang.ref.WeakReference;
+import java.util.ArrayList;
+
+public class Main {
+    // The GC clears the references on several threads once there are at least 2048 of them, and
+    // uses up to one thread per 1024 references. Have enough of each kind for four threads.
+    private static final int NUM_REFERENCES = 5000;
+    private static final long ENQUEUE_TIMEOUT_MS = 10000;
+
+    static class IndexedWeakReference extends WeakReference<Object> {
+        final int index;
+
+        IndexedWeakReference(Object referent, ReferenceQueue<Object> queue, int index) {
+            super(referent, queue);
+            this.index = index;
+        }
+    }
+
+    static class IndexedPhantomReference extends PhantomReference<Object> {
+        final int index;
+
+        IndexedPhantomReference(Object referent, ReferenceQueue<Object> queue, int index) {
+            super(referent, queue);
+            this.index = index;
+        }
+    }
+
+    static class IndexedSoftReference extends SoftReference<Object> {
+        final int index;
+
+        IndexedSoftReference(Object referent, ReferenceQueue<Object> queue, int index) {
+            super(referent, queue);
+            this.index = index;
+        }
+    }
+
+    // The referents at even indexes stay reachable, the others are only reachable through the
+    // references. Each kind of reference has its own referents, since the soft references keep
+    // theirs alive across explicit collections.
+    static Object[] liveWeak = new Object[NUM_REFERENCES];
+    static Object[] livePhantom = new Object[NUM_REFERENCES];
+    static Object[] liveSoft = new Object[NUM_REFERENCES];
+    static IndexedWeakReference[] weak = new IndexedWeakReference[NUM_REFERENCES];
+    static IndexedPhantomReference[] phantom = new IndexedPhantomReference[NUM_REFERENCES];
+    static IndexedSoftReference[] soft = new IndexedSoftReference[NUM_REFERENCES];
+
+    static boolean isLive(int index) {
+        return index % 2 == 0;
+    }
+
+    public static void main(String[] args) throws Exception {
+        ReferenceQueue<Object> weakQueue = new ReferenceQueue<Object>();
+        ReferenceQueue<Object> phantomQueue = new ReferenceQueue<Object>();
+        ReferenceQueue<Object> softQueue = new ReferenceQueue<Object>();
+        allocateReferences(weakQueue, phantomQueue, softQueue);
+
+        // An explicit collection preserves the soft referents, so this only clears the weak and
+        // phantom references.
+        Runtime.getRuntime().gc();
+        checkReferences("Weak", weak, weakQueue);
+        checkReferences("Phantom", phantom, phantomQueue);
+
+        // Running out of memory clears the soft references with dead referents.
+        exhaustMemory();
+        checkReferences("Soft", soft, softQueue);
+    }
+
+    static void allocateReferences(ReferenceQueue<Object> weakQueue,
+                                   ReferenceQueue<Object> phantomQueue,
+                                   ReferenceQueue<Object> softQueue) {
+        // Live and dead referents alternate, so that each thread clears some of the references.
+        for (int i = 0; i < NUM_REFERENCES; i++) {
+            Object weakReferent = new Object();
+            Object phantomReferent = new Object();
+            Object softReferent = new Object();
+            if (isLive(i)) {
+                liveWeak[i] = weakReferent;
+                livePhantom[i] = phantomReferent;
+                liveSoft[i] = softReferent;
+            }
+            weak[i] = new IndexedWeakReference(weakReferent, weakQueue, i);
+            phantom[i] = new IndexedPhantomReference(phantomReferent, phantomQueue, i);
+            soft[i] = new IndexedSoftReference(softReferent, softQueue, i);
+        }
+    }
+
+    static void exhaustMemory() {
+        ArrayList<byte[]> chunks = new ArrayList<byte[]>();
+        try {
+            while (true) {
+                chunks.add(new byte[64 * 1024]);
+            }
+        } catch (OutOfMemoryError e) {
+            chunks = null;
+        }
+    }
+
+    static int getIndex(Reference<?> reference) {
+        if (reference instanceof IndexedWeakReference) {
+            return ((IndexedWeakReference) reference).index;
+        } else if (reference instanceof IndexedPhantomReference) {
+            return ((IndexedPhantomReference) reference).index;
+        }
+        return ((IndexedSoftReference) reference).index;
+    }
+
+    static void checkReferences(String kind,
+                                Reference<?>[] references,
+                                ReferenceQueue<Object> queue) throws InterruptedException {
+        int cleared = 0;
+        int kept = 0;
+        for (Reference<?> reference : references) {
+            // Phantom references always return null.
+            if (reference instanceof PhantomReference) {
+                continue;
+            }
+            int index = getIndex(reference);
+            if (reference.get() == null) {
+                if (isLive(index)) {
+                    System.out.println(kind + " reference " + index + " cleared while live");
+                }
+            } else if (!isLive(index)) {
+                System.out.println(kind + " reference " + index + " kept with a dead referent");
+            }
+        }
+        // The references are enqueued by a daemon, wait for the dead ones.
+        boolean[] enqueued = new boolean[references.length];
+        for (int i = 0; i < references.length / 2; i++) {
+            Reference<?> reference = queue.remove(ENQUEUE_TIMEOUT_MS);
+            if (reference == null) {
+                System.out.println(kind + " references: timed out after " + cleared + " enqueued");
+                break;
+            }
+            int index = getIndex(reference);
+            if (isLive(index)) {
+                System.out.println(kind + " reference " + index + " enqueued while live");
+            } else if (enqueued[index]) {
+                System.out.println(kind + " reference " + index + " enqueued twice");
+            } else {
+                enqueued[index] = true;
+                ++cleared;
+            }
+        }
+        for (int i = 0; i < references.length; i++) {
+            if (isLive(i) && !references[i].isEnqueued()) {
+                ++kept;
+            }
+        }
+        if (queue.poll() != null) {
+            System.out.println(kind + " references: more enqueued than dead referents");
+        }
+        System.out.println(kind + " references: " + cleared + " cleared, " + kept + " kept.");
+    }
+}